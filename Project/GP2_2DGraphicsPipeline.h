@@ -10,6 +10,7 @@
 #include "GP2_Shader.h"
 #include "GP2_CommandBuffer.h"
 #include "GP2_DescriptorPool.h"
+#include "GP2_ParallelRecorder.h"
 
 using pMesh2D = std::unique_ptr<GP2_2DMesh>;
 
@@ -26,12 +27,16 @@ public:
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(const VulkanContext& context);
+	void Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator);
 
 	void Cleanup();
 
 	void Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx);
-	void DrawScene(const GP2_CommandBuffer& buffer);
+	// Same as Record, split into the recorder's ranges recorded on the job threads into secondary command buffers appended to commandBuffers
+	void RecordSecondaries(GP2_ParallelRecorder& recorder, VkFramebuffer framebuffer, VkExtent2D extent, int imageIdx,
+						   std::vector<VkCommandBuffer>& commandBuffers);
+	// Binds the descriptor set of imageIdx, the frame in flight's slot SetUBO wrote to
+	void DrawScene(const GP2_CommandBuffer& buffer, int imageIdx);
 	void AddMesh(pMesh2D mesh); 
 	 
 	void SetUBO(UBO2D ubo, size_t uboIndex);
@@ -42,6 +47,9 @@ private:
 	//-----------
 	void CreateGraphicsPipeline(); 
 	VkPushConstantRange CreatePushConstantRange();
+	void RecordPipelineState(VkCommandBuffer commandBuffer, VkExtent2D extent) const;
+	void DrawMeshes(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end, GP2_GeometryArena::BindState& bindState) const;
+	void ReportDraws(const GP2_GeometryArena::BindState& bindState);
 
 	//-----------
 	// Variables
@@ -54,6 +62,11 @@ private:
 	GP2_Shader<Vertex2D> m_Shader;  
 	std::vector<pMesh2D> m_pMeshes; 
 	GP2_DescriptorPool<UBO2D>* m_pDescriptorPool;
+
+	// the bind counts are printed whenever the number of meshes drawn changes
+	uint32_t m_ReportedDrawCount;
+	// one per recorder range
+	std::vector<GP2_GeometryArena::BindState> m_RangeBindStates;
 };
 
 template <class UBO2D>
@@ -64,12 +77,14 @@ GP2_2DGraphicsPipeline<UBO2D>::GP2_2DGraphicsPipeline(const std::string& vertexS
 	m_PipelineLayout{},
 	m_Shader{ vertexShaderFile, fragmentShaderFile },
 	m_pMeshes{},
-	m_pDescriptorPool{}
+	m_pDescriptorPool{},
+	m_ReportedDrawCount{},
+	m_RangeBindStates{}
 {
 }
 
 template <class UBO2D>
-void GP2_2DGraphicsPipeline<UBO2D>::Initialize(const VulkanContext& context)
+void GP2_2DGraphicsPipeline<UBO2D>::Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator)
 {
 	m_Device = context.device;
 	m_RenderPass = context.renderPass;
@@ -79,7 +94,7 @@ void GP2_2DGraphicsPipeline<UBO2D>::Initialize(const VulkanContext& context)
 	for (pMesh2D& pMesh : m_pMeshes)
 	{
 		m_pDescriptorPool = new GP2_DescriptorPool<UBO2D>{ m_Device, MAX_FRAMES_IN_FLIGHT }; 
-		m_pDescriptorPool->Initialize(context, pMesh->GetTexture(0)->GetTextureImageView(), pMesh->GetTexture(0)->GetTextureSampler());
+		m_pDescriptorPool->Initialize(context, frameAllocator, pMesh->GetTexture(0)->GetTextureImageView(), pMesh->GetTexture(0)->GetTextureSampler());
 	}
 
 	CreateGraphicsPipeline();
@@ -232,7 +247,49 @@ void GP2_2DGraphicsPipeline<UBO2D>::Cleanup()
 template <class UBO2D>
 void GP2_2DGraphicsPipeline<UBO2D>::Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx)
 {
-	vkCmdBindPipeline(buffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+	RecordPipelineState(buffer.GetVkCommandBuffer(), extent);
+
+	DrawScene(buffer, imageIdx);
+}
+
+template <class UBO2D>
+void GP2_2DGraphicsPipeline<UBO2D>::RecordSecondaries(GP2_ParallelRecorder& recorder, VkFramebuffer framebuffer, VkExtent2D extent,
+													   int imageIdx, std::vector<VkCommandBuffer>& commandBuffers)
+{
+	m_RangeBindStates.resize(recorder.GetRangeCount());
+	const std::vector<VkCommandBuffer>& recorded{ recorder.Record(m_RenderPass, framebuffer, static_cast<uint32_t>(m_pMeshes.size()),
+		[this, extent, imageIdx](VkCommandBuffer commandBuffer, uint32_t rangeIndex, uint32_t begin, uint32_t end)
+		{
+			RecordPipelineState(commandBuffer, extent);
+			m_pDescriptorPool->BindDescriptorSet(commandBuffer, m_PipelineLayout, imageIdx);
+
+			m_RangeBindStates[rangeIndex] = GP2_GeometryArena::BindState{};
+			DrawMeshes(commandBuffer, begin, end, m_RangeBindStates[rangeIndex]);
+		}) };
+	commandBuffers.insert(commandBuffers.end(), recorded.begin(), recorded.end());
+
+	GP2_GeometryArena::BindState total{};
+	for (size_t rangeIndex = 0; rangeIndex < recorded.size(); ++rangeIndex)
+	{
+		total.bindCount += m_RangeBindStates[rangeIndex].bindCount;
+	}
+	ReportDraws(total);
+}
+
+template <class UBO2D>
+void GP2_2DGraphicsPipeline<UBO2D>::DrawScene(const GP2_CommandBuffer& buffer, int imageIdx)
+{
+	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx); 
+
+	GP2_GeometryArena::BindState bindState{};
+	DrawMeshes(buffer.GetVkCommandBuffer(), 0, static_cast<uint32_t>(m_pMeshes.size()), bindState);
+	ReportDraws(bindState);
+}
+
+template <class UBO2D>
+void GP2_2DGraphicsPipeline<UBO2D>::RecordPipelineState(VkCommandBuffer commandBuffer, VkExtent2D extent) const
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
 
 	VkViewport viewport{};
 	viewport.x = 0.0f;
@@ -241,26 +298,30 @@ void GP2_2DGraphicsPipeline<UBO2D>::Record(const GP2_CommandBuffer& buffer, VkEx
 	viewport.height = (float)extent.height;
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
-	vkCmdSetViewport(buffer.GetVkCommandBuffer(), 0, 1, &viewport);
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor{};
 	scissor.offset = { 0, 0 };
 	scissor.extent = extent;
-	vkCmdSetScissor(buffer.GetVkCommandBuffer(), 0, 1, &scissor);
-
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx);
-
-	DrawScene(buffer);
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
 template <class UBO2D>
-void GP2_2DGraphicsPipeline<UBO2D>::DrawScene(const GP2_CommandBuffer& buffer)
+void GP2_2DGraphicsPipeline<UBO2D>::DrawMeshes(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end, GP2_GeometryArena::BindState& bindState) const
 {
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, 0); 
+	for (uint32_t idx = begin; idx < end; ++idx)
+	{
+		m_pMeshes[idx]->Draw(m_PipelineLayout, commandBuffer, bindState);
+	}
+}
 
-	for (auto& mesh : m_pMeshes)
+template <class UBO2D>
+void GP2_2DGraphicsPipeline<UBO2D>::ReportDraws(const GP2_GeometryArena::BindState& bindState)
+{
+	if (m_pMeshes.size() != m_ReportedDrawCount)
 	{
-		mesh->Draw(m_PipelineLayout, buffer.GetVkCommandBuffer());
+		GP2_GeometryArena::PrintBinds(std::cout, "2D", static_cast<uint32_t>(m_pMeshes.size()), bindState);
+		m_ReportedDrawCount = static_cast<uint32_t>(m_pMeshes.size());
 	}
 }
 
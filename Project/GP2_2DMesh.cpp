@@ -1,64 +1,50 @@
 #include "GP2_2DMesh.h"
 
-GP2_2DMesh::GP2_2DMesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool) :
+GP2_2DMesh::GP2_2DMesh(VulkanContext context, GP2_GeometryArena& geometryArena) :
 	m_Device{ context.device },
 	m_PhysicalDevice{ context.physicalDevice },
 	m_VertexConstant{ glm::mat4(1.f) },
-	m_pVertexBuffer{},
-	m_pIndexBuffer{},
+	m_pGeometryArena{ &geometryArena },
+	m_GeometryHandle{ GP2_GeometryArena::InvalidHandle },
 	//m_pTextures(5)
 {
 	/*for (auto& pTexture : m_pTextures)
 	{
-		pTexture = new GP2_Texture{ context, graphicsQueue, commandPool };
+		pTexture = new GP2_Texture{ context };
 	}*/
 }
 
-void GP2_2DMesh::Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices)
+void GP2_2DMesh::Initialize(GP2_UploadContext& uploadContext)
 {
-	//VERTEX BUFFER
-	GP2_Buffer vertexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshVertices[0]) * m_MeshVertices.size() };
-	vertexStagingBuffer.TransferDeviceLocal(m_MeshVertices.data());
+	if (m_pGeometryArena->GetVertexStride() != sizeof(Vertex2D))
+	{
+		throw std::runtime_error("mesh vertex format doesn't match the geometry arena!");
+	}
+	m_GeometryHandle = m_pGeometryArena->Allocate(static_cast<uint32_t>(m_MeshVertices.size()), static_cast<uint32_t>(m_MeshIndices.size()),
+												  VK_INDEX_TYPE_UINT16);
 
-	m_pVertexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshVertices[0]) * m_MeshVertices.size() };
-	m_pVertexBuffer->CopyBuffer(vertexStagingBuffer, graphicsQueue, queueFamilyIndices);
+	//VERTEX BUFFER
+	uploadContext.UploadBuffer(m_MeshVertices.data(), sizeof(m_MeshVertices[0]) * m_MeshVertices.size(),
+							   m_pGeometryArena->GetVertexBuffer(), m_pGeometryArena->GetVertexByteOffset(m_GeometryHandle));
 
 	//INDEX BUFFER
-	GP2_Buffer indexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshIndices[0]) * m_MeshIndices.size() };
-	indexStagingBuffer.TransferDeviceLocal(m_MeshIndices.data());
-
-	m_pIndexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshIndices[0]) * m_MeshIndices.size() };
-	m_pIndexBuffer->CopyBuffer(indexStagingBuffer, graphicsQueue, queueFamilyIndices);
+	uploadContext.UploadBuffer(m_MeshIndices.data(), sizeof(m_MeshIndices[0]) * m_MeshIndices.size(),
+							   m_pGeometryArena->GetIndexBuffer(), m_pGeometryArena->GetIndexByteOffset(m_GeometryHandle));
 
 	/*for (const auto& pTexture : m_pTextures)
 	{
-		pTexture->CreateTextureImage("resources/texture.jpg");
+		pTexture->CreateTextureImage("resources/texture.jpg", uploadContext);
 		pTexture->CreateTextureImageView();
 		pTexture->CreateTextureSampler();
 	}*/
-
-	vertexStagingBuffer.Destroy();
-	indexStagingBuffer.Destroy();
 }
 
 void GP2_2DMesh::DestroyMesh()
 {
-	if (m_pIndexBuffer)
-	{
-		m_pIndexBuffer->Destroy();
-		delete m_pIndexBuffer;
-		m_pIndexBuffer = nullptr;
-	}
-
-	if (m_pVertexBuffer)
+	if (m_GeometryHandle != GP2_GeometryArena::InvalidHandle)
 	{
-		m_pVertexBuffer->Destroy();
-		delete m_pVertexBuffer;
-		m_pVertexBuffer = nullptr;
+		m_pGeometryArena->Free(m_GeometryHandle);
+		m_GeometryHandle = GP2_GeometryArena::InvalidHandle;
 	}
 
 	/*for (auto pTexture : m_pTextures)
@@ -67,10 +53,9 @@ void GP2_2DMesh::DestroyMesh()
 	}*/
 }
 
-void GP2_2DMesh::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer)
+void GP2_2DMesh::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer, GP2_GeometryArena::BindState& bindState)
 {
-	m_pVertexBuffer->BindAsVertexBuffer(buffer);
-	m_pIndexBuffer->BindAsIndexBuffer(buffer);
+	m_pGeometryArena->Bind(buffer, m_GeometryHandle, bindState);
 
 	vkCmdPushConstants(
 		buffer,
@@ -81,7 +66,8 @@ void GP2_2DMesh::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer)
 		&m_VertexConstant		   // Pointer to the data
 	);
 
-	vkCmdDrawIndexed(buffer, static_cast<uint32_t>(m_MeshIndices.size()), 1, 0, 0, 0);
+	const GP2_GeometryArena::Range& range{ m_pGeometryArena->GetRange(m_GeometryHandle) };
+	vkCmdDrawIndexed(buffer, range.indexCount, 1, range.firstIndex, static_cast<int32_t>(range.vertexOffset), 0);
 }
 
 void GP2_2DMesh::AddVertex(const glm::vec3 pos, const glm::vec3 color)
@@ -8,8 +8,9 @@
 #include "Vertex.h"
 #include "GP2_Shader.h"
 #include "GP2_Buffer.h"
+#include "GP2_GeometryArena.h"
 //#include "GP2_Texture.h"
-#include "GP2_CommandPool.h"
+#include "GP2_UploadContext.h"
 #include "vulkanbase/VulkanUtil.h"
 
 class GP2_2DMesh final
@@ -18,15 +19,16 @@ public:
 	//---------------------------
 	// Constructors & Destructor
 	//---------------------------
-	GP2_2DMesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool);
+	GP2_2DMesh(VulkanContext context, GP2_GeometryArena& geometryArena);
 	~GP2_2DMesh() = default;
 
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices);
+	void Initialize(GP2_UploadContext& uploadContext);
 	void DestroyMesh();
-	void Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer);
+	// Binds the arena's buffers unless bindState has them bound already
+	void Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer, GP2_GeometryArena::BindState& bindState);
 
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color);
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color, const glm::vec2 texCoord);
@@ -46,8 +48,8 @@ private:
 	VkDevice m_Device;
 	VkPhysicalDevice m_PhysicalDevice;
 
-	GP2_Buffer* m_pVertexBuffer;
-	GP2_Buffer* m_pIndexBuffer;
+	GP2_GeometryArena* m_pGeometryArena;
+	uint32_t m_GeometryHandle;
 
 	std::vector<Vertex2D> m_MeshVertices; 
 	std::vector<uint16_t> m_MeshIndices;
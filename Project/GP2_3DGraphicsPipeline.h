@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <type_traits>
 #include <vulkanbase/VulkanUtil.h>
 #include <vulkanbase/VulkanBase.h>
 
@@ -9,10 +13,12 @@
 #include "GP2_Shader.h"
 #include "GP2_CommandBuffer.h"
 #include "GP2_DescriptorPool.h"
+#include "GP2_ParallelRecorder.h"
 
 using pMesh3D = std::unique_ptr<GP2_3DMesh>;
 
-template <class UBO3D>
+// VertexType is Vertex3D or Vertex3DQuantized, the meshes added have to upload the same type
+template <class UBO3D, class VertexType = Vertex3D>
 class GP2_3DGraphicsPipeline final
 {
 public:
@@ -25,22 +31,67 @@ public:
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(const VulkanContext& context);
+	void Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator);
 
 	void Cleanup();
 
 	void Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx);
-	void DrawScene(const GP2_CommandBuffer& buffer);
+	// Same as Record, split into the recorder's ranges recorded on the job threads into secondary command buffers appended to commandBuffers.
+	// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS and execute them.
+	void RecordSecondaries(GP2_ParallelRecorder& recorder, VkFramebuffer framebuffer, VkExtent2D extent, int imageIdx,
+						   std::vector<VkCommandBuffer>& commandBuffers);
+	// Binds the descriptor set of imageIdx, the frame in flight's slot SetUBO wrote to
+	void DrawScene(const GP2_CommandBuffer& buffer, int imageIdx);
 	void AddMesh(pMesh3D mesh);
 
 	void SetUBO(UBO3D ubo, size_t uboIndex);
+	// Meshes pick their level of detail and cull their meshlets against this camera while recording,
+	// without a camera nothing is culled and every mesh stays at level 0
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection);
+	// Largest simplification error in pixels a level of detail may show, 1 by default
+	void SetLodThreshold(float threshold) { m_LodThreshold = threshold; }
+	// Prints draws, triangles and frame time per level of detail every LodReportInterval seconds
+	void SetLodReporting(bool isLodReporting) { m_IsLodReporting = isLodReporting; }
+	// Sampled instead of the first mesh's texture while that one isn't resident, set before Initialize.
+	// Meshes themselves are only drawn once they're resident.
+	void SetPlaceholderTexture(GP2_Texture* pTexture) { m_pPlaceholderTexture = pTexture; }
 
 private:
+	//-----------
+	// Structs
+	//-----------
+	struct LodStatistics
+	{
+		uint32_t frameDrawCount;
+		// frames in which at least one mesh was drawn at this level and how long they took together
+		uint32_t frameCount;
+		double frameTime;
+		uint64_t drawCount;
+		uint64_t triangleCount;
+	};
+
+	// what recording a range of the meshes drew, merged into the pipeline's statistics on the render thread
+	struct DrawResult
+	{
+		GP2_GeometryArena::BindState bindState;
+		uint32_t drawCount;
+		std::vector<LodStatistics> lodStatistics;
+	};
+
 	//-----------
 	// Functions
 	//-----------
 	void CreateGraphicsPipeline();
 	VkPushConstantRange CreatePushConstantRange();
+	void UpdateLodStatistics();
+	GP2_Texture* GetSampledTexture() const;
+	void UpdateSampledTexture(VkExtent2D extent, int imageIdx);
+	// pipeline, viewport and scissor, every secondary command buffer starts without them
+	void RecordPipelineState(VkCommandBuffer commandBuffer, VkExtent2D extent) const;
+	// Culls and draws meshes [begin, end), only touches those meshes and result so ranges can be recorded in parallel
+	void DrawMeshes(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end, DrawResult& result) const;
+	static void AddLodStatistics(const std::vector<LodStatistics>& src, std::vector<LodStatistics>& dst);
+	void ReportDraws(const DrawResult& result);
 
 	//-----------
 	// Variables
@@ -50,53 +101,90 @@ private:
 	VkPipeline m_GraphicsPipeline;
 	VkPipelineLayout m_PipelineLayout;
 
-	GP2_Shader<Vertex3D> m_Shader;
+	GP2_Shader<VertexType> m_Shader;
 	std::vector<pMesh3D> m_pMeshes;
 	GP2_DescriptorPool<UBO3D>* m_pDescriptorPool;
+	GP2_Texture* m_pPlaceholderTexture;
+	// the texture each descriptor set samples
+	std::vector<GP2_Texture*> m_pSampledTextures;
+	// the meshes' indirect draws are copied into it every frame
+	GP2_FrameAllocator* m_pFrameAllocator;
+
+	glm::mat4 m_View;
+	glm::mat4 m_Projection;
+	bool m_HasCamera;
+	float m_ViewportHeight;
+	float m_LodThreshold;
+
+	static constexpr float LodReportInterval{ 5.f };
+	bool m_IsLodReporting;
+	std::vector<LodStatistics> m_LodStatistics;
+	std::chrono::steady_clock::time_point m_FrameStart;
+	std::chrono::steady_clock::time_point m_ReportStart;
+
+	// the bind counts are printed whenever the number of meshes drawn changes
+	uint32_t m_ReportedDrawCount;
+	// one per recorder range
+	std::vector<DrawResult> m_RangeResults;
 };
 
-template <class UBO3D>
-GP2_3DGraphicsPipeline<UBO3D>::GP2_3DGraphicsPipeline(const std::string& vertexShaderFile, const std::string& fragmentShaderFile) :
+template <class UBO3D, class VertexType>
+GP2_3DGraphicsPipeline<UBO3D, VertexType>::GP2_3DGraphicsPipeline(const std::string& vertexShaderFile, const std::string& fragmentShaderFile) :
 	m_Device{},
 	m_RenderPass{},
 	m_GraphicsPipeline{},
 	m_PipelineLayout{},
 	m_Shader{ vertexShaderFile, fragmentShaderFile },
 	m_pMeshes{},
-	m_pDescriptorPool{}
+	m_pDescriptorPool{},
+	m_pPlaceholderTexture{},
+	m_pSampledTextures{},
+	m_pFrameAllocator{},
+	m_View{ 1.f },
+	m_Projection{ 1.f },
+	m_HasCamera{},
+	m_ViewportHeight{},
+	m_LodThreshold{ 1.f },
+	m_IsLodReporting{},
+	m_LodStatistics{},
+	m_FrameStart{},
+	m_ReportStart{},
+	m_ReportedDrawCount{},
+	m_RangeResults{}
 {
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::Initialize(const VulkanContext& context)
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator)
 {
 	m_Device = context.device;
 	m_RenderPass = context.renderPass;
 
 	m_Shader.Initialize(m_Device);
 
-	for (pMesh3D& pMesh : m_pMeshes)
-	{
-		m_pDescriptorPool = new GP2_DescriptorPool<UBO3D>{ m_Device, MAX_FRAMES_IN_FLIGHT }; 
-		m_pDescriptorPool->Initialize(context, pMesh->GetTexture(0)->GetTextureImageView(), pMesh->GetTexture(0)->GetTextureSampler());
-	}
+	// one set per frame in flight, each samples the first mesh's texture
+	GP2_Texture* pSampledTexture{ GetSampledTexture() };
+	m_pSampledTextures.assign(MAX_FRAMES_IN_FLIGHT, pSampledTexture);
+	m_pFrameAllocator = &frameAllocator;
+	m_pDescriptorPool = new GP2_DescriptorPool<UBO3D>{ m_Device, MAX_FRAMES_IN_FLIGHT }; 
+	m_pDescriptorPool->Initialize(context, frameAllocator, pSampledTexture->GetTextureImageView(), pSampledTexture->GetTextureSampler());
 
 	CreateGraphicsPipeline();
 }
 
-template <class UBO3D>
-VkPushConstantRange GP2_3DGraphicsPipeline<UBO3D>::CreatePushConstantRange()
+template <class UBO3D, class VertexType>
+VkPushConstantRange GP2_3DGraphicsPipeline<UBO3D, VertexType>::CreatePushConstantRange()
 {
 	VkPushConstantRange pushConstantRange = {};
 	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Stage the push constant is accessible from
 	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(MeshData); // Size of push constant block
+	pushConstantRange.size = sizeof(typename VertexType::MeshConstants); // Size of push constant block
 
 	return pushConstantRange;
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::CreateGraphicsPipeline()
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::CreateGraphicsPipeline()
 {
 	VkPipelineViewportStateCreateInfo viewportState{};
 	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -214,8 +302,8 @@ void GP2_3DGraphicsPipeline<UBO3D>::CreateGraphicsPipeline()
 	m_Shader.DestroyShaderModule(m_Device);
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::Cleanup()
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::Cleanup()
 {
 	for (size_t idx = 0; idx < m_pMeshes.size(); ++idx)
 	{
@@ -228,10 +316,78 @@ void GP2_3DGraphicsPipeline<UBO3D>::Cleanup()
 	delete m_pDescriptorPool;
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx)
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx)
 {
-	vkCmdBindPipeline(buffer.GetVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+	UpdateSampledTexture(extent, imageIdx);
+	RecordPipelineState(buffer.GetVkCommandBuffer(), extent);
+
+	DrawScene(buffer, imageIdx);
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::RecordSecondaries(GP2_ParallelRecorder& recorder, VkFramebuffer framebuffer, VkExtent2D extent,
+																   int imageIdx, std::vector<VkCommandBuffer>& commandBuffers)
+{
+	UpdateSampledTexture(extent, imageIdx);
+	UpdateLodStatistics();
+
+	// every range culls and draws its own meshes, the results are merged in range order afterwards
+	m_RangeResults.resize(recorder.GetRangeCount());
+	const std::vector<VkCommandBuffer>& recorded{ recorder.Record(m_RenderPass, framebuffer, static_cast<uint32_t>(m_pMeshes.size()),
+		[this, extent, imageIdx](VkCommandBuffer commandBuffer, uint32_t rangeIndex, uint32_t begin, uint32_t end)
+		{
+			RecordPipelineState(commandBuffer, extent);
+			m_pDescriptorPool->BindDescriptorSet(commandBuffer, m_PipelineLayout, imageIdx);
+
+			DrawResult& result{ m_RangeResults[rangeIndex] };
+			result.bindState = GP2_GeometryArena::BindState{};
+			result.drawCount = 0;
+			result.lodStatistics.clear();
+			DrawMeshes(commandBuffer, begin, end, result);
+		}) };
+	commandBuffers.insert(commandBuffers.end(), recorded.begin(), recorded.end());
+
+	DrawResult total{};
+	for (size_t rangeIndex = 0; rangeIndex < recorded.size(); ++rangeIndex)
+	{
+		const DrawResult& result{ m_RangeResults[rangeIndex] };
+		total.bindState.bindCount += result.bindState.bindCount;
+		total.drawCount += result.drawCount;
+		AddLodStatistics(result.lodStatistics, total.lodStatistics);
+	}
+	ReportDraws(total);
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::DrawScene(const GP2_CommandBuffer& buffer, int imageIdx)
+{
+	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx);
+	UpdateLodStatistics();
+
+	DrawResult result{};
+	DrawMeshes(buffer.GetVkCommandBuffer(), 0, static_cast<uint32_t>(m_pMeshes.size()), result);
+	ReportDraws(result);
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::UpdateSampledTexture(VkExtent2D extent, int imageIdx)
+{
+	m_ViewportHeight = static_cast<float>(extent.height);
+
+	// the frame that used this set last has finished by the time the next one is recorded, the other sets may still be in flight
+	GP2_Texture* pSampledTexture{ GetSampledTexture() };
+	if (pSampledTexture != m_pSampledTextures[imageIdx])
+	{
+		m_pDescriptorPool->UpdateTexture(pSampledTexture->GetTextureImageView(), pSampledTexture->GetTextureSampler(), imageIdx);
+		m_pSampledTextures[imageIdx] = pSampledTexture;
+	}
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::RecordPipelineState(VkCommandBuffer commandBuffer, VkExtent2D extent) const
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
 
 	VkViewport viewport{};
 	viewport.x = 0.0f;
@@ -240,37 +396,163 @@ void GP2_3DGraphicsPipeline<UBO3D>::Record(const GP2_CommandBuffer& buffer, VkEx
 	viewport.height = (float)extent.height;
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
-	vkCmdSetViewport(buffer.GetVkCommandBuffer(), 0, 1, &viewport);
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor{};
 	scissor.offset = { 0, 0 };
 	scissor.extent = extent;
-	vkCmdSetScissor(buffer.GetVkCommandBuffer(), 0, 1, &scissor);
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
 
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx);
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::DrawMeshes(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end, DrawResult& result) const
+{
+	// the meshes share the buffers of their arena, only the first draw and a change of index type bind
+	for (uint32_t idx = begin; idx < end; ++idx)
+	{
+		GP2_3DMesh* mesh{ m_pMeshes[idx].get() };
+		if (!mesh->IsResident())
+		{
+			continue;
+		}
+
+		if (m_HasCamera)
+		{
+			mesh->SelectLod(m_View, m_Projection, m_ViewportHeight, m_LodThreshold);
+			mesh->Cull(m_View, m_Projection);
+		}
+		mesh->Draw(m_PipelineLayout, commandBuffer, result.bindState, *m_pFrameAllocator);
+		++result.drawCount;
+
+		if (m_IsLodReporting)
+		{
+			if (result.lodStatistics.size() <= mesh->GetLod())
+			{
+				result.lodStatistics.resize(mesh->GetLod() + 1, LodStatistics{});
+			}
+
+			LodStatistics& statistics{ result.lodStatistics[mesh->GetLod()] };
+			++statistics.frameDrawCount;
+			++statistics.drawCount;
+			statistics.triangleCount += mesh->GetTriangleCount();
+		}
+	}
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::AddLodStatistics(const std::vector<LodStatistics>& src, std::vector<LodStatistics>& dst)
+{
+	if (dst.size() < src.size())
+	{
+		dst.resize(src.size(), LodStatistics{});
+	}
 
-	DrawScene(buffer);
+	for (size_t lod = 0; lod < src.size(); ++lod)
+	{
+		dst[lod].frameDrawCount += src[lod].frameDrawCount;
+		dst[lod].drawCount += src[lod].drawCount;
+		dst[lod].triangleCount += src[lod].triangleCount;
+	}
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::DrawScene(const GP2_CommandBuffer& buffer)
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::ReportDraws(const DrawResult& result)
 {
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, 0);
+	AddLodStatistics(result.lodStatistics, m_LodStatistics);
 
-	for (auto& mesh : m_pMeshes)
+	if (result.drawCount != m_ReportedDrawCount)
 	{
-		mesh->Draw(m_PipelineLayout, buffer.GetVkCommandBuffer());
+		GP2_GeometryArena::PrintBinds(std::cout, "3D", result.drawCount, result.bindState);
+		m_ReportedDrawCount = result.drawCount;
 	}
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::AddMesh(pMesh3D mesh) 
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::AddMesh(pMesh3D mesh) 
 {
+	if (mesh->IsQuantized() != std::is_same_v<VertexType, Vertex3DQuantized>)
+	{
+		throw std::runtime_error("mesh vertex format doesn't match the pipeline!");
+	}
+
 	m_pMeshes.push_back(std::move(mesh));
 }
 
-template <class UBO3D>
-void GP2_3DGraphicsPipeline<UBO3D>::SetUBO(UBO3D ubo, size_t uboIndex)
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::SetUBO(UBO3D ubo, size_t uboIndex)
 {
 	m_pDescriptorPool->SetUBO(ubo, uboIndex);
-}
\ No newline at end of file
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::SetCamera(const glm::mat4& view, const glm::mat4& projection)
+{
+	m_View = view;
+	m_Projection = projection;
+	m_HasCamera = true;
+}
+
+template <class UBO3D, class VertexType>
+void GP2_3DGraphicsPipeline<UBO3D, VertexType>::UpdateLodStatistics()
+{
+	// the time between two recordings is the whole previous frame, it counts for every level drawn in it
+	const auto now{ std::chrono::steady_clock::now() };
+	const double frameTime{ std::chrono::duration<double>(now - m_FrameStart).count() };
+	m_FrameStart = now;
+
+	if (!m_IsLodReporting)
+	{
+		return;
+	}
+
+	bool isEmpty{ true };
+	for (LodStatistics& statistics : m_LodStatistics)
+	{
+		if (statistics.frameDrawCount > 0)
+		{
+			++statistics.frameCount;
+			statistics.frameTime += frameTime;
+			statistics.frameDrawCount = 0;
+		}
+		isEmpty = isEmpty && statistics.frameCount == 0;
+	}
+
+	if (isEmpty)
+	{
+		m_ReportStart = now;
+		return;
+	}
+
+	if (std::chrono::duration<float>(now - m_ReportStart).count() < LodReportInterval)
+	{
+		return;
+	}
+
+	for (size_t lod = 0; lod < m_LodStatistics.size(); ++lod)
+	{
+		const LodStatistics& statistics{ m_LodStatistics[lod] };
+		if (statistics.frameCount == 0)
+		{
+			continue;
+		}
+
+		std::cout << "LOD " << lod << ": " << double(statistics.drawCount) / statistics.frameCount << " meshes, "
+				  << statistics.triangleCount / statistics.frameCount << " triangles, "
+				  << statistics.frameTime * 1000.0 / statistics.frameCount << " ms per frame over " << statistics.frameCount << " frames\n";
+	}
+
+	m_LodStatistics.clear();
+	m_ReportStart = now;
+}
+
+template <class UBO3D, class VertexType>
+GP2_Texture* GP2_3DGraphicsPipeline<UBO3D, VertexType>::GetSampledTexture() const
+{
+	GP2_Texture* pTexture{ m_pMeshes.empty() ? nullptr : m_pMeshes[0]->GetTexture(0) };
+	if (m_pPlaceholderTexture && (!pTexture || !pTexture->IsResident()))
+	{
+		return m_pPlaceholderTexture;
+	}
+
+	return pTexture;
+}
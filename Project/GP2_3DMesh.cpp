@@ -1,87 +1,303 @@
 #include "GP2_3DMesh.h"
 
-GP2_3DMesh::GP2_3DMesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool) :
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+GP2_3DMesh::GP2_3DMesh(VulkanContext context, GP2_TextureRegistry& textureRegistry, GP2_GeometryArena& geometryArena) :
 	m_Device{ context.device },
 	m_PhysicalDevice{ context.physicalDevice },
 	m_VertexConstant{ glm::mat4(1.f) },
-	m_pVertexBuffer{},
-	m_pIndexBuffer{},
-	m_pTextures(5)
+	m_pGeometryArena{ &geometryArena },
+	m_GeometryHandle{ GP2_GeometryArena::InvalidHandle },
+	m_QuantizedVertices{},
+	m_Bounds{},
+	m_IsQuantized{},
+	m_MeshCache{},
+	m_GLBParser{},
+	m_IndexCount{},
+	m_IndexType{ VK_INDEX_TYPE_UINT16 },
+	m_Lods{},
+	m_Lod{},
+	m_Meshlets{},
+	m_IndirectCommands{},
+	m_IndirectDrawCount{},
+	m_IndirectFirstIndex{},
+	m_IndirectVertexOffset{},
+	m_DrawnTriangleCount{},
+	m_IsMultiDrawIndirect{},
+	m_IsBackfaceCulling{},
+	m_pTextures(5),
+	m_IsResident{}
 {
 	for (auto& pTexture : m_pTextures)
 	{
-		pTexture = new GP2_Texture{ context, graphicsQueue, commandPool };
+		pTexture = textureRegistry.Acquire(GetTexturePath());
 	}
 }
 
-void GP2_3DMesh::Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices)
+void GP2_3DMesh::Initialize(GP2_UploadContext& uploadContext)
 {
-	//VERTEX BUFFER
-	GP2_Buffer vertexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshVertices[0]) * m_MeshVertices.size() };
-	vertexStagingBuffer.TransferDeviceLocal(m_MeshVertices.data());
+	// draws are submitted after the uploads on the same queue and the context's closing barrier orders them
+	RecordUpload(uploadContext);
+	m_IsResident = true;
+
+	// shared textures are only loaded by the first mesh using them
+	for (const auto& pTexture : m_pTextures)
+	{
+		if (pTexture->IsResident())
+		{
+			continue;
+		}
+
+		pTexture->CreateTextureImage(GetTexturePath(), uploadContext);
+		pTexture->CreateTextureImageView();
+		pTexture->CreateTextureSampler();
+	}
+}
+
+const char* GP2_3DMesh::GetTexturePath()
+{
+	static const bool isCompressed{ std::filesystem::exists(CompressedTexturePath) };
+	return isCompressed ? CompressedTexturePath : TexturePath;
+}
+
+void GP2_3DMesh::RecordUpload(GP2_UploadContext& uploadContext)
+{
+	// a mapped cache is copied and a mapped .glb interleaved straight into the staging memory, otherwise the parsed vectors are copied
+	const bool isCached{ m_MeshCache.IsOpen() };
+	const bool isStreamed{ m_GLBParser.IsOpen() };
+
+	if (isCached)
+	{
+		m_Bounds = m_MeshCache.GetBounds();
+		m_Meshlets.assign(m_MeshCache.GetMeshlets(), m_MeshCache.GetMeshlets() + m_MeshCache.GetMeshletCount());
+		m_Lods.assign(m_MeshCache.GetLods(), m_MeshCache.GetLods() + m_MeshCache.GetLodCount());
+	}
+	else if (isStreamed)
+	{
+		m_Bounds = m_GLBParser.GetBounds();
+	}
+	else if (!m_IsQuantized)
+	{
+		m_Bounds = GP2_VertexQuantizer::ComputeBounds(m_MeshVertices);
+	}
+	else if (m_QuantizedVertices.size() != m_MeshVertices.size())
+	{
+		m_Bounds = GP2_VertexQuantizer::Quantize(m_MeshVertices, m_QuantizedVertices);
+	}
 
-	m_pVertexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshVertices[0]) * m_MeshVertices.size() };
-	m_pVertexBuffer->CopyBuffer(vertexStagingBuffer, graphicsQueue, queueFamilyIndices);
+	//VERTEX BUFFER
+	VkDeviceSize vertexBufferSize{ sizeof(Vertex3D) * m_MeshVertices.size() };
+	const void* pVertexData{ m_MeshVertices.data() };
+	if (isCached)
+	{
+		vertexBufferSize = m_MeshCache.GetVertexDataSize();
+		pVertexData = m_MeshCache.GetVertexData();
+	}
+	else if (isStreamed)
+	{
+		vertexBufferSize = sizeof(Vertex3D) * m_GLBParser.GetVertexCount();
+	}
+	else if (m_IsQuantized)
+	{
+		vertexBufferSize = sizeof(Vertex3DQuantized) * m_QuantizedVertices.size();
+		pVertexData = m_QuantizedVertices.data();
+	}
 
 	//INDEX BUFFER
-	GP2_Buffer indexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshIndices[0]) * m_MeshIndices.size() };
-	indexStagingBuffer.TransferDeviceLocal(m_MeshIndices.data());
+	if (isCached)
+	{
+		m_IndexType = m_MeshCache.GetIndexType();
+		m_IndexCount = m_MeshCache.GetIndexCount();
+	}
+	else if (isStreamed)
+	{
+		m_IndexType = GP2_Buffer::SelectIndexType(m_GLBParser.GetVertexCount());
+		m_IndexCount = m_GLBParser.GetIndexCount();
+	}
+	else
+	{
+		m_IndexType = GP2_Buffer::SelectIndexType(m_MeshVertices.size());
+		m_IndexCount = static_cast<uint32_t>(m_MeshIndices.size());
+	}
+	const VkDeviceSize indexBufferSize{ GP2_Buffer::GetIndexSize(m_IndexType) * m_IndexCount };
 
-	m_pIndexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshIndices[0]) * m_MeshIndices.size() };
-	m_pIndexBuffer->CopyBuffer(indexStagingBuffer, graphicsQueue, queueFamilyIndices);
+	// both go into the ranges of the arena, uploaded at their byte offsets
+	const uint32_t vertexStride{ static_cast<uint32_t>(m_IsQuantized ? sizeof(Vertex3DQuantized) : sizeof(Vertex3D)) };
+	if (m_pGeometryArena->GetVertexStride() != vertexStride)
+	{
+		throw std::runtime_error("mesh vertex format doesn't match the geometry arena!");
+	}
+	m_GeometryHandle = m_pGeometryArena->Allocate(static_cast<uint32_t>(vertexBufferSize / vertexStride), m_IndexCount, m_IndexType);
+	GP2_Buffer& vertexBuffer{ m_pGeometryArena->GetVertexBuffer() };
+	GP2_Buffer& indexBuffer{ m_pGeometryArena->GetIndexBuffer() };
+	const VkDeviceSize vertexOffset{ m_pGeometryArena->GetVertexByteOffset(m_GeometryHandle) };
+	const VkDeviceSize indexOffset{ m_pGeometryArena->GetIndexByteOffset(m_GeometryHandle) };
 
-	for (const auto& pTexture : m_pTextures)
+	if (isStreamed)
 	{
-		pTexture->CreateTextureImage("resources/texture.jpg");
-		pTexture->CreateTextureImageView();
-		pTexture->CreateTextureSampler();
+		const GP2_StagingPool::Allocation vertexStaging{ uploadContext.GetStagingPool().Allocate(vertexBufferSize) };
+		m_GLBParser.WriteVertices(static_cast<Vertex3D*>(vertexStaging.pMapped));
+		uploadContext.CopyBuffer(vertexStaging, vertexBuffer, vertexOffset);
+	}
+	else
+	{
+		uploadContext.UploadBuffer(pVertexData, vertexBufferSize, vertexBuffer, vertexOffset);
+	}
+
+	if (isCached)
+	{
+		uploadContext.UploadBuffer(m_MeshCache.GetIndexData(), indexBufferSize, indexBuffer, indexOffset);
+	}
+	else
+	{
+		const GP2_StagingPool::Allocation indexStaging{ uploadContext.GetStagingPool().Allocate(indexBufferSize) };
+		if (isStreamed)
+		{
+			m_GLBParser.WriteIndices(indexStaging.pMapped, m_IndexType);
+		}
+		else
+		{
+			GP2_Buffer::WriteIndices(indexStaging.pMapped, m_MeshIndices.data(), m_MeshIndices.size(), m_IndexType);
+		}
+		uploadContext.CopyBuffer(indexStaging, indexBuffer, indexOffset);
 	}
 
-	vertexStagingBuffer.Destroy();
-	indexStagingBuffer.Destroy();
+	m_MeshCache.Close();
+	m_GLBParser.Close();
+
+	//INDIRECT BUFFER
+	if (m_Meshlets.empty() && !m_MeshIndices.empty())
+	{
+		BuildMeshlets();
+	}
+	if (m_Lods.empty())
+	{
+		m_Lods.assign(1, MeshLod{ 0, m_IndexCount, 0, static_cast<uint32_t>(m_Meshlets.size()), 0.f });
+	}
+	m_Lod = 0;
+	CreateIndirectCommands();
 }
 
 void GP2_3DMesh::DestroyMesh()
 {
-	if (m_pIndexBuffer)
+	m_IndirectCommands = std::vector<VkDrawIndexedIndirectCommand>{};
+	m_IndirectDrawCount = 0;
+
+	if (m_GeometryHandle != GP2_GeometryArena::InvalidHandle)
 	{
-		m_pIndexBuffer->Destroy();
-		delete m_pIndexBuffer;
-		m_pIndexBuffer = nullptr;
+		m_pGeometryArena->Free(m_GeometryHandle);
+		m_GeometryHandle = GP2_GeometryArena::InvalidHandle;
 	}
 
-	if (m_pVertexBuffer)
+	// a shared texture is destroyed with the last mesh using it
+	m_pTextures.clear();
+}
+
+void GP2_3DMesh::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer, GP2_GeometryArena::BindState& bindState, GP2_FrameAllocator& frameAllocator)
+{
+	m_pGeometryArena->Bind(buffer, m_GeometryHandle, bindState);
+
+	if (m_IsQuantized)
 	{
-		m_pVertexBuffer->Destroy();
-		delete m_pVertexBuffer;
-		m_pVertexBuffer = nullptr;
+		const QuantizedMeshData quantizedConstant{ GP2_VertexQuantizer::GetMeshData(m_VertexConstant.model, m_Bounds) };
+		vkCmdPushConstants(buffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(QuantizedMeshData), &quantizedConstant);
+	}
+	else
+	{
+		vkCmdPushConstants(
+			buffer,
+			pipelineLayout,
+			VK_SHADER_STAGE_VERTEX_BIT, // Stage flag should match the push constant range in the layout
+			0,                          // Offset within the push constant block
+			sizeof(MeshData),					// Size of the push constants to update
+			&m_VertexConstant		   // Pointer to the data
+		);
+	}
+
+	if (m_IndirectCommands.empty())
+	{
+		const GP2_GeometryArena::Range& range{ m_pGeometryArena->GetRange(m_GeometryHandle) };
+		vkCmdDrawIndexed(buffer, m_Lods[m_Lod].indexCount, 1, range.firstIndex + m_Lods[m_Lod].firstIndex, static_cast<int32_t>(range.vertexOffset), 0);
+		return;
+	}
+
+	// the arena may have moved the ranges since the draws were written
+	OffsetIndirectCommands();
+	if (m_IndirectDrawCount == 0)
+	{
+		return;
+	}
+
+	// a copy per frame, the frames still in flight read the draws they were recorded with
+	const uint32_t stride{ sizeof(VkDrawIndexedIndirectCommand) };
+	const GP2_FrameAllocator::Allocation draws{ frameAllocator.Allocate(VkDeviceSize(m_IndirectDrawCount) * stride, alignof(VkDrawIndexedIndirectCommand)) };
+	memcpy(draws.pMapped, m_IndirectCommands.data(), size_t(m_IndirectDrawCount) * stride);
+
+	// without multiDrawIndirect every surviving meshlet is its own single indirect draw
+	if (m_IsMultiDrawIndirect)
+	{
+		vkCmdDrawIndexedIndirect(buffer, draws.buffer, draws.offset, m_IndirectDrawCount, stride);
+		return;
 	}
 
-	for (auto pTexture : m_pTextures)
+	for (uint32_t drawIndex = 0; drawIndex < m_IndirectDrawCount; ++drawIndex)
 	{
-		delete pTexture;
+		vkCmdDrawIndexedIndirect(buffer, draws.buffer, draws.offset + VkDeviceSize(drawIndex) * stride, 1, stride);
 	}
 }
 
-void GP2_3DMesh::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer)
+void GP2_3DMesh::Cull(const glm::mat4& view, const glm::mat4& projection)
 {
-	m_pVertexBuffer->BindAsVertexBuffer(buffer);
-	m_pIndexBuffer->BindAsIndexBuffer(buffer);
+	if (m_IndirectCommands.empty())
+	{
+		return;
+	}
+
+	const MeshLod& lod{ m_Lods[m_Lod] };
+	const GP2_MeshletCuller culler{ m_VertexConstant.model, view, projection, m_IsBackfaceCulling };
+	m_IndirectDrawCount = culler.Cull(m_Meshlets.data() + lod.firstMeshlet, lod.meshletCount, m_IndirectCommands.data(), m_DrawnTriangleCount);
+	m_IndirectFirstIndex = 0;
+	m_IndirectVertexOffset = 0;
+	OffsetIndirectCommands();
+}
+
+void GP2_3DMesh::SelectLod(const glm::mat4& view, const glm::mat4& projection, float viewportHeight, float threshold)
+{
+	if (m_Lods.size() < 2)
+	{
+		return;
+	}
+
+	const glm::mat4& model{ m_VertexConstant.model };
+	const float scale{ std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) }) };
+	const glm::vec4 center{ view * model * glm::vec4{ (m_Bounds.min + m_Bounds.max) * 0.5f, 1.f } };
+	const float radius{ glm::distance(m_Bounds.min, m_Bounds.max) * 0.5f * scale };
+	const float distance{ glm::length(glm::vec3(center)) - radius };
+
+	// with the camera inside the bounds some part of the mesh is always right in front of it
+	if (distance <= 0.f)
+	{
+		m_Lod = 0;
+		return;
+	}
 
-	vkCmdPushConstants(
-		buffer,
-		pipelineLayout,
-		VK_SHADER_STAGE_VERTEX_BIT, // Stage flag should match the push constant range in the layout
-		0,                          // Offset within the push constant block
-		sizeof(MeshData),					// Size of the push constants to update
-		&m_VertexConstant		   // Pointer to the data
-	);
+	// object space error to pixels at the nearest point of the bounds, projection[1][1] is +-1 / tan(fovY / 2)
+	const float pixelsPerError{ scale * std::abs(projection[1][1]) * viewportHeight * 0.5f / distance };
 
-	vkCmdDrawIndexed(buffer, static_cast<uint32_t>(m_MeshIndices.size()), 1, 0, 0, 0);
+	uint32_t lod{ m_Lod };
+	while (lod > 0 && m_Lods[lod].error * pixelsPerError > threshold)
+	{
+		--lod;
+	}
+	while (lod + 1 < m_Lods.size() && m_Lods[lod + 1].error * pixelsPerError <= threshold * (1.f - LodHysteresis))
+	{
+		++lod;
+	}
+	m_Lod = lod;
 }
 
 void GP2_3DMesh::AddVertex(const glm::vec3 pos, const glm::vec3 color)
@@ -102,104 +318,68 @@ void GP2_3DMesh::AddVertices(const std::vector<glm::vec3>& vertices, const std::
 	}
 }
 
-void GP2_3DMesh::AddIndices(const std::vector<uint16_t> indices)
+void GP2_3DMesh::AddIndices(const std::vector<uint32_t> indices)
 {
 	m_MeshIndices = indices; 
 }
 
-bool GP2_3DMesh::ParseOBJ(const std::string& filename, const glm::vec3 color)
+bool GP2_3DMesh::ParseOBJ(const std::string& filename, const glm::vec3 color, uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	GP2_OBJParser parser{};
+	return parser.Parse(filename, color, m_MeshVertices, m_MeshIndices, threadCount);
+}
+
+bool GP2_3DMesh::LoadOBJ(const std::string& filename, const glm::vec3 color, bool optimize, uint32_t threadCount)
 {
-	std::ifstream file(filename);
-	if (!file.is_open())
+	// the cache only holds a whole mesh, appending to added vertices goes through the parser
+	if (m_MeshVertices.empty() && m_MeshCache.Open(filename, color, GetCacheFlags(optimize)))
+	{
+		return true;
+	}
+
+	const size_t firstIndex{ m_MeshIndices.size() };
+	if (!ParseOBJ(filename, color, threadCount))
 	{
-		std::cerr << "Error: Failed to open file " << filename << std::endl;
 		return false;
 	}
 
-	std::vector<glm::vec3> positions;
-	std::vector<glm::vec3> normals;
+	ProcessImport(filename, color, optimize, firstIndex, { Submesh{ static_cast<uint32_t>(firstIndex), static_cast<uint32_t>(m_MeshIndices.size() - firstIndex), 0 } });
+	return true;
+}
 
-	std::string sCommand;
-	// start a while iteration ending when the end of file is reached (ios::eof)
-	while (!file.eof())
+bool GP2_3DMesh::LoadGLB(const std::string& filename, const glm::vec3 color, bool optimize)
+{
+	if (!optimize && !m_IsQuantized && m_MeshVertices.empty())
 	{
-		//read the first word of the string, use the >> operator (istream::operator>>) 
-		file >> sCommand;
-		//use conditional statements to process the different commands	
-		if (sCommand == "#")
+		if (!m_GLBParser.Open(filename, color))
 		{
-			// Ignore Comment
+			return false;
 		}
-		else if (sCommand == "v")
-		{
-			//Vertex
-			float x, y, z;
-			file >> x >> y >> z;
 
-			positions.emplace_back(x, y, z);
-		}
-		else if (sCommand == "vn")
-		{
-			// Vertex Normal
-			float x, y, z;
-			file >> x >> y >> z;
+		m_Meshlets.clear();
+		m_Lods.clear();
+		return true;
+	}
 
-			normals.emplace_back(x, y, z);
-		}
-		else if (sCommand == "f")
-		{
-			//if a face is read:
-			//construct the 3 vertices, add them to the vertex array
-			//add three indices to the index array
-			//add the material index as attibute to the attribute array
-
-			// Faces or triangles
-			Vertex3D vertex{};
-			size_t iPosition, iNormal;
-
-			uint32_t tempIndices[3];
-			for (size_t iFace = 0; iFace < 3; ++iFace)
-			{
-				// OBJ format uses 1-based arrays
-				file >> iPosition;
-				vertex.position = glm::vec3(positions[iPosition - 1].x, -positions[iPosition - 1].y, -positions[iPosition - 1].z);
-				vertex.color = color;
-
-				if ('/' == file.peek())//is next in buffer ==  '/' ?
-				{
-					file.ignore();//read and ignore one element ('/')
-
-					if ('/' != file.peek())
-					{
-						// Optional texture coordinate
-						/*file >> iTexCoord;
-						vertex.uv = UVs[iTexCoord - 1];*/
-					}
-
-					if ('/' == file.peek())
-					{
-						file.ignore();
-
-						// Optional vertex normal
-						file >> iNormal;
-						vertex.normal = glm::vec3(normals[iNormal - 1].x, -normals[iNormal - 1].y, -normals[iNormal - 1].z);
-					}
-				}
-
-				m_MeshVertices.push_back(vertex);
-				tempIndices[iFace] = uint32_t(m_MeshVertices.size()) - 1;
-				//indices.push_back(uint32_t(vertices.size()) - 1);
-			}
-
-			m_MeshIndices.push_back(tempIndices[0]);
-			m_MeshIndices.push_back(tempIndices[1]);
-			m_MeshIndices.push_back(tempIndices[2]);
-		}
-		//read till end of line and ignore all remaining chars
-		file.ignore(1000, '\n');
+	if (m_MeshVertices.empty() && m_MeshCache.Open(filename, color, GetCacheFlags(optimize)))
+	{
+		return true;
 	}
 
-	file.close();
+	const size_t firstIndex{ m_MeshIndices.size() };
+	std::vector<Submesh> submeshes;
+	GP2_GLBParser parser{};
+	if (!parser.Parse(filename, color, m_MeshVertices, m_MeshIndices, submeshes))
+	{
+		return false;
+	}
+
+	ProcessImport(filename, color, optimize, firstIndex, submeshes);
 	return true;
 }
 
@@ -218,3 +398,134 @@ uint32_t GP2_3DMesh::FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t ty
 
 	throw std::runtime_error("failed to find suitable memory type!");
 }
+
+uint32_t GP2_3DMesh::GetCacheFlags(bool optimize) const
+{
+	return (optimize ? GP2_MeshCache::OptimizedFlag : 0u) | (m_IsQuantized ? GP2_MeshCache::QuantizedFlag : 0u);
+}
+
+void GP2_3DMesh::ProcessImport(const std::string& filename, const glm::vec3 color, bool optimize, size_t firstIndex, const std::vector<Submesh>& submeshes)
+{
+	m_Meshlets.clear();
+	m_Lods.clear();
+
+	if (firstIndex > 0)
+	{
+		return;
+	}
+
+	if (optimize)
+	{
+		GP2_MeshOptimizer optimizer{};
+		optimizer.Optimize(m_MeshVertices, m_MeshIndices);
+	}
+
+	BuildLods(optimize);
+
+	// the optimizer reorders triangles across submeshes, the levels of detail are appended behind level 0
+	const std::vector<Submesh> cachedSubmeshes{ optimize ? std::vector<Submesh>{ Submesh{ 0, m_Lods[0].indexCount, 0 } } : submeshes };
+	const uint32_t cacheFlags{ GetCacheFlags(optimize) };
+	bool isWritten{};
+	if (m_IsQuantized)
+	{
+		m_Bounds = GP2_VertexQuantizer::Quantize(m_MeshVertices, m_QuantizedVertices);
+		isWritten = GP2_MeshCache::Write(filename, color, cacheFlags, m_QuantizedVertices, m_Bounds, m_MeshIndices, cachedSubmeshes, m_Meshlets, m_Lods);
+	}
+	else
+	{
+		isWritten = GP2_MeshCache::Write(filename, color, cacheFlags, m_MeshVertices, m_MeshIndices, cachedSubmeshes, m_Meshlets, m_Lods);
+	}
+
+	if (!isWritten)
+	{
+		std::cerr << "failed to write mesh cache for " << filename << std::endl;
+	}
+}
+
+void GP2_3DMesh::CreateIndirectCommands()
+{
+	if (m_Meshlets.empty())
+	{
+		return;
+	}
+
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+	m_IsMultiDrawIndirect = supportedFeatures.multiDrawIndirect == VK_TRUE;
+
+	// the culling writes into it, Draw copies what survived into the frame allocator
+	m_IndirectCommands.resize(m_Meshlets.size());
+
+	const MeshLod& lod{ m_Lods[m_Lod] };
+	for (uint32_t idx = 0; idx < lod.meshletCount; ++idx)
+	{
+		m_IndirectCommands[idx] = GP2_MeshletCuller::GetDrawCommand(m_Meshlets[lod.firstMeshlet + idx]);
+	}
+	m_IndirectDrawCount = lod.meshletCount;
+	m_DrawnTriangleCount = lod.indexCount / 3;
+	m_IndirectFirstIndex = 0;
+	m_IndirectVertexOffset = 0;
+	OffsetIndirectCommands();
+}
+
+void GP2_3DMesh::OffsetIndirectCommands()
+{
+	const GP2_GeometryArena::Range& range{ m_pGeometryArena->GetRange(m_GeometryHandle) };
+	if (range.firstIndex == m_IndirectFirstIndex && range.vertexOffset == m_IndirectVertexOffset)
+	{
+		return;
+	}
+
+	// unsigned wrap around moves them back as well
+	const uint32_t firstIndexDelta{ range.firstIndex - m_IndirectFirstIndex };
+	const int32_t vertexOffsetDelta{ static_cast<int32_t>(range.vertexOffset - m_IndirectVertexOffset) };
+	for (uint32_t drawIndex = 0; drawIndex < m_IndirectDrawCount; ++drawIndex)
+	{
+		m_IndirectCommands[drawIndex].firstIndex += firstIndexDelta;
+		m_IndirectCommands[drawIndex].vertexOffset += vertexOffsetDelta;
+	}
+
+	m_IndirectFirstIndex = range.firstIndex;
+	m_IndirectVertexOffset = range.vertexOffset;
+}
+
+void GP2_3DMesh::BuildLods(bool optimize)
+{
+	const MeshBounds bounds{ GP2_VertexQuantizer::ComputeBounds(m_MeshVertices) };
+	GP2_MeshSimplifier simplifier{};
+	simplifier.BuildLods(m_MeshVertices, m_MeshIndices, m_Lods, MaxLodCount, glm::distance(bounds.min, bounds.max) * MaxLodError);
+
+	// level 0 went through the whole optimizer already, the simplified levels only need a vertex cache order again
+	if (optimize)
+	{
+		GP2_MeshOptimizer optimizer{};
+		std::vector<uint32_t> lodIndices;
+		for (size_t lod = 1; lod < m_Lods.size(); ++lod)
+		{
+			const auto first{ m_MeshIndices.begin() + m_Lods[lod].firstIndex };
+			lodIndices.assign(first, first + m_Lods[lod].indexCount);
+			optimizer.OptimizeVertexCache(lodIndices, m_MeshVertices.size());
+			std::copy(lodIndices.begin(), lodIndices.end(), first);
+		}
+	}
+
+	BuildMeshlets();
+}
+
+void GP2_3DMesh::BuildMeshlets()
+{
+	if (m_Lods.empty())
+	{
+		m_Lods.assign(1, MeshLod{ 0, static_cast<uint32_t>(m_MeshIndices.size()), 0, 0, 0.f });
+	}
+
+	// the meshlets of every level are stored back to back, a level draws its own range
+	m_Meshlets.clear();
+	GP2_MeshletBuilder meshletBuilder{};
+	for (MeshLod& lod : m_Lods)
+	{
+		lod.firstMeshlet = static_cast<uint32_t>(m_Meshlets.size());
+		meshletBuilder.Build(m_MeshIndices, lod.firstIndex, lod.indexCount, m_MeshVertices, m_Meshlets);
+		lod.meshletCount = static_cast<uint32_t>(m_Meshlets.size()) - lod.firstMeshlet;
+	}
+}
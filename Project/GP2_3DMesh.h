@@ -8,8 +8,19 @@
 #include "Vertex.h"
 #include "GP2_Shader.h"
 #include "GP2_Buffer.h"
+#include "GP2_GeometryArena.h"
+#include "GP2_FrameAllocator.h"
 #include "GP2_Texture.h"
-#include "GP2_CommandPool.h"
+#include "GP2_TextureRegistry.h"
+#include "GP2_UploadContext.h"
+#include "GP2_OBJParser.h"
+#include "GP2_GLBParser.h"
+#include "GP2_MeshCache.h"
+#include "GP2_MeshOptimizer.h"
+#include "GP2_VertexQuantizer.h"
+#include "GP2_MeshletBuilder.h"
+#include "GP2_MeshSimplifier.h"
+#include "GP2_MeshletCuller.h"
 #include "vulkanbase/VulkanUtil.h"
 
 class GP2_3DMesh final
@@ -18,30 +29,84 @@ public:
 	//---------------------------
 	// Constructors & Destructor
 	//---------------------------
-	GP2_3DMesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool);
+	// Every texture slot shares the registry's texture of GetTexturePath(), the vertices and indices go into geometryArena
+	GP2_3DMesh(VulkanContext context, GP2_TextureRegistry& textureRegistry, GP2_GeometryArena& geometryArena);
 	~GP2_3DMesh() = default;
 
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices);
+	// Records the buffer copies and the first load of its textures into the upload context, the mesh can be drawn by
+	// anything submitted after the context's next Submit
+	void Initialize(GP2_UploadContext& uploadContext);
+	// Creates the GPU buffers of a loaded mesh and records the copies into the upload context without submitting them,
+	// unless a buffer is large enough to be streamed through it in slices. Textures aren't included.
+	void RecordUpload(GP2_UploadContext& uploadContext);
 	void DestroyMesh();
-	void Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer);
+	// Binds the arena's buffers unless bindState has them bound already. The indirect draws are copied into the
+	// frame allocator's current region, so frames in flight each keep the draws they were recorded with.
+	void Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer, GP2_GeometryArena::BindState& bindState, GP2_FrameAllocator& frameAllocator);
+	// Rewrites the indirect draws with the meshlets of the selected level that survive culling, until the first call every
+	// meshlet of level 0 is drawn. Only the CPU side copy is written, the next Draw hands it to the GPU.
+	void Cull(const glm::mat4& view, const glm::mat4& projection);
+	// Picks the level of detail Cull and Draw use, the coarsest one whose simplification error projects below threshold pixels.
+	// Going coarser needs LodHysteresis of margin below threshold, so a camera resting near a switch distance doesn't pop.
+	void SelectLod(const glm::mat4& view, const glm::mat4& projection, float viewportHeight, float threshold);
+
+	uint32_t GetLod() const { return m_Lod; }
+	uint32_t GetLodCount() const { return static_cast<uint32_t>(m_Lods.size()); }
+	// triangles the next Draw submits
+	uint32_t GetTriangleCount() const { return m_IndirectCommands.empty() ? m_Lods[m_Lod].indexCount / 3 : m_DrawnTriangleCount; }
 
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color);
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color, const glm::vec3 normal, const glm::vec2 texCoord);
 	void AddVertices(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const glm::vec3 color);
-	void AddIndices(const std::vector<uint16_t> indices);
+	void AddIndices(const std::vector<uint32_t> indices);
+
+	GP2_Texture* GetTexture(const int index) const { return m_pTextures[index].get(); }
+	int GetTextureCount() const { return static_cast<int>(m_pTextures.size()); }
+	// the block compressed texture written by TextureEncoder when there is one, the source image otherwise
+	static const char* GetTexturePath();
+
+	// Set once the uploaded buffers can be drawn, right away by Initialize or when the streaming batch has finished
+	void SetResident() { m_IsResident = true; }
+	bool IsResident() const { return m_IsResident; }
+
+	// Uploads Vertex3DQuantized instead of Vertex3D, set before loading so the cache holds the quantized vertices.
+	// The mesh then has to be drawn by a pipeline instantiated with Vertex3DQuantized.
+	void SetQuantized(bool isQuantized) { m_IsQuantized = isQuantized; }
+	bool IsQuantized() const { return m_IsQuantized; }
 
-	GP2_Texture* GetTexture(const int index) const { return m_pTextures[index]; }
+	// Also culls meshlets facing away from the camera, off by default since the pipelines don't cull back faces
+	void SetBackfaceCulling(bool isBackfaceCulling) { m_IsBackfaceCulling = isBackfaceCulling; }
 
-	bool ParseOBJ(const std::string& filename, const glm::vec3 color);
+	// threadCount 0 uses every core, files large enough to split are parsed in line-aligned chunks in parallel
+	bool ParseOBJ(const std::string& filename, const glm::vec3 color, uint32_t threadCount = 0);
+	// Goes through the .gp2mesh cache next to the OBJ, parses and rewrites the cache when it's missing or stale.
+	// A cache hit leaves the vertices in the mapped file until Initialize copied them to the GPU.
+	// With optimize the parsed mesh goes through GP2_MeshOptimizer before it's cached.
+	// A whole mesh also gets its level of detail chain, appended to the index buffer.
+	bool LoadOBJ(const std::string& filename, const glm::vec3 color, bool optimize = true, uint32_t threadCount = 0);
+	// Without optimize a whole mesh stays mapped and Initialize interleaves the accessors straight into the staging buffers,
+	// no CPU copy of the vertices is made and the mesh is drawn without meshlets or levels of detail.
+	// With optimize, quantization or vertices already added it goes through the same cache and processing as LoadOBJ,
+	// optimize reorders triangles across primitives so their submeshes are merged into one.
+	bool LoadGLB(const std::string& filename, const glm::vec3 color, bool optimize = false);
 
 private:
 	//-----------
 	// Functions
 	//-----------
 	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+	void CreateIndirectCommands();
+	// Moves the indirect draws, written relative to the mesh, to its range in the arena
+	void OffsetIndirectCommands();
+	uint32_t GetCacheFlags(bool optimize) const;
+	// Optimizes, simplifies and caches a whole parsed mesh, appended vertices are drawn as they are.
+	// submeshes only go into the cache's table, a mesh has a single material and is drawn as one range per level of detail.
+	void ProcessImport(const std::string& filename, const glm::vec3 color, bool optimize, size_t firstIndex, const std::vector<Submesh>& submeshes);
+	void BuildLods(bool optimize);
+	void BuildMeshlets();
 
 	//-----------
 	// Variables
@@ -49,12 +114,43 @@ private:
 	VkDevice m_Device;
 	VkPhysicalDevice m_PhysicalDevice;
 
-	GP2_Buffer* m_pVertexBuffer;
-	GP2_Buffer* m_pIndexBuffer;
+	GP2_GeometryArena* m_pGeometryArena;
+	uint32_t m_GeometryHandle;
 
 	std::vector<Vertex3D> m_MeshVertices;  
-	std::vector<uint16_t> m_MeshIndices;
-	std::vector<GP2_Texture*> m_pTextures;
+	std::vector<uint32_t> m_MeshIndices;
+	std::vector<Vertex3DQuantized> m_QuantizedVertices;
+	MeshBounds m_Bounds;
+	bool m_IsQuantized;
+	GP2_MeshCache m_MeshCache;
+	GP2_GLBParser m_GLBParser;
+	uint32_t m_IndexCount;
+	VkIndexType m_IndexType;
+
+	// up to MaxLodCount levels, each simplified by at most MaxLodError of the bounds diagonal
+	static constexpr uint32_t MaxLodCount{ 4 };
+	static constexpr float MaxLodError{ 0.05f };
+	static constexpr float LodHysteresis{ 0.25f };
+
+	std::vector<MeshLod> m_Lods;
+	uint32_t m_Lod;
+
+	std::vector<Meshlet> m_Meshlets;
+	// one per meshlet of the largest level, the first m_IndirectDrawCount are drawn
+	std::vector<VkDrawIndexedIndirectCommand> m_IndirectCommands;
+	uint32_t m_IndirectDrawCount;
+	// the arena offsets the indirect draws include
+	uint32_t m_IndirectFirstIndex;
+	uint32_t m_IndirectVertexOffset;
+	uint32_t m_DrawnTriangleCount;
+	bool m_IsMultiDrawIndirect;
+	bool m_IsBackfaceCulling;
+
+	// every texture slot uses the same file for now
+	static constexpr const char* TexturePath{ "resources/texture.jpg" };
+	static constexpr const char* CompressedTexturePath{ "resources/texture.ktx2" };
+	std::vector<std::shared_ptr<GP2_Texture>> m_pTextures;
+	bool m_IsResident;
 
 	MeshData m_VertexConstant;
 };
@@ -0,0 +1,280 @@
+#include "GP2_AssetStreamer.h"
+#include "GP2_3DMesh.h"
+#include "GP2_Texture.h"
+
+#include <iostream>
+#include <algorithm>
+
+void GP2_AssetStreamer::Initialize(const VulkanContext& context, GP2_UploadContext& uploadContext, uint32_t threadCount)
+{
+	m_pUploadContext = &uploadContext;
+
+	// the frame using the placeholder is submitted after the graphics part of its upload, so it doesn't wait for it
+	m_pPlaceholderTexture = new GP2_Texture{ context };
+	m_pPlaceholderTexture->SetName("placeholder texture");
+	m_pPlaceholderTexture->RecordPlaceholderUpload(*m_pUploadContext);
+	m_pPlaceholderTexture->CreateTextureImageView();
+	m_pPlaceholderTexture->CreateTextureSampler();
+
+	if (threadCount == 0)
+	{
+		// the render thread keeps a core of its own
+		threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, MaxLoaderThreadCount + 1) - 1;
+	}
+
+	// the loaders parse side by side, each gets its share of the cores
+	m_ParseThreadCount = std::max(std::thread::hardware_concurrency() / std::max(threadCount, 1u), 1u);
+
+	m_IsStopping = false;
+	for (uint32_t idx = 0; idx < threadCount; ++idx)
+	{
+		m_LoaderThreads.emplace_back(&GP2_AssetStreamer::RunLoader, this);
+	}
+	m_DecodePool.Initialize();
+}
+
+void GP2_AssetStreamer::Destroy()
+{
+	// its callbacks add to the loaded requests drained below
+	m_DecodePool.Destroy();
+
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+	m_Condition.notify_all();
+
+	// a loader still in Load finishes its request, only after the join nothing adds to the loaded requests anymore
+	for (std::thread& thread : m_LoaderThreads)
+	{
+		thread.join();
+	}
+	m_LoaderThreads.clear();
+
+	// loaded but never recorded, their staging memory goes back to the pool before the upload context destroys it
+	for (const Request& request : m_LoadedRequests)
+	{
+		if (request.pTexture)
+		{
+			request.pTexture->DiscardStaged();
+		}
+	}
+	m_Requests.clear();
+	m_LoadedRequests.clear();
+	m_RequestedTextures.clear();
+
+	RetireBatches(true);
+	// the placeholder may not have been submitted yet
+	m_pUploadContext->Wait(m_pUploadContext->Submit());
+
+	delete m_pPlaceholderTexture;
+	m_pPlaceholderTexture = nullptr;
+}
+
+void GP2_AssetStreamer::RequestMesh(GP2_3DMesh* pMesh, const std::string& filename, const glm::vec3 color)
+{
+	Enqueue(Request{ pMesh, nullptr, filename, color });
+
+	for (int idx = 0; idx < pMesh->GetTextureCount(); ++idx)
+	{
+		RequestTexture(pMesh->GetTexture(idx), GP2_3DMesh::GetTexturePath());
+	}
+}
+
+void GP2_AssetStreamer::RequestTexture(GP2_Texture* pTexture, const std::string& filename)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		if (pTexture->IsResident() || !m_RequestedTextures.insert(pTexture).second)
+		{
+			return;
+		}
+	}
+
+	pTexture->SetName(filename);
+	Enqueue(Request{ nullptr, pTexture, filename, glm::vec3{} });
+}
+
+void GP2_AssetStreamer::Update()
+{
+	RetireBatches(false);
+
+	std::vector<Request> loadedRequests;
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		loadedRequests.swap(m_LoadedRequests);
+	}
+
+	for (const Request& request : loadedRequests)
+	{
+		if (request.pMesh)
+		{
+			request.pMesh->RecordUpload(*m_pUploadContext);
+			continue;
+		}
+
+		request.pTexture->RecordUpload(*m_pUploadContext, true);
+		request.pTexture->CreateTextureImageView();
+		request.pTexture->CreateTextureSampler();
+	}
+
+	// one submission a frame for everything recorded, the streamed assets and whatever else went into the context.
+	// Streamed assets are polled, only what else went in might have to go out on the graphics queue right away.
+	const uint64_t uploadValue{ m_pUploadContext->Submit(true) };
+	if (!loadedRequests.empty())
+	{
+		m_Batches.push_back(Batch{ uploadValue, std::move(loadedRequests) });
+	}
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	if (m_PendingCount > 0 || m_ResidentCount + m_FailedCount == 0)
+	{
+		return;
+	}
+
+	const std::chrono::duration<double> loadTime{ std::chrono::steady_clock::now() - m_LoadStart };
+	std::cout << "Streamed " << m_ResidentCount << " assets in " << loadTime.count() * 1000.0 << " ms";
+	if (m_FailedCount > 0)
+	{
+		std::cout << ", " << m_FailedCount << " failed";
+	}
+	std::cout << std::endl;
+
+	m_ResidentCount = 0;
+	m_FailedCount = 0;
+}
+
+bool GP2_AssetStreamer::IsIdle() const
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	return m_PendingCount == 0;
+}
+
+void GP2_AssetStreamer::Enqueue(Request&& request)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		if (m_PendingCount == 0 && m_ResidentCount + m_FailedCount == 0)
+		{
+			m_LoadStart = std::chrono::steady_clock::now();
+		}
+
+		++m_PendingCount;
+	}
+
+	const std::string extension{ ".ktx2" };
+	const bool isImage{ request.pTexture && (request.filename.size() < extension.size() ||
+						request.filename.compare(request.filename.size() - extension.size(), extension.size(), extension) != 0) };
+	if (isImage)
+	{
+		const std::string filename{ request.filename };
+		m_DecodePool.Decode(filename, [this, request = std::move(request)](const uint8_t* pPixels, uint32_t width, uint32_t height) mutable
+		{
+			if (pPixels)
+			{
+				// the staging pool is thread safe, the pixels go straight into it
+				request.pTexture->Stage(pPixels, width, height, m_pUploadContext->GetStagingPool());
+			}
+			FinishLoad(std::move(request), pPixels != nullptr);
+		});
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Requests.push_back(std::move(request));
+	}
+	m_Condition.notify_one();
+}
+
+void GP2_AssetStreamer::RunLoader()
+{
+	while (true)
+	{
+		Request request{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_Condition.wait(lock, [this]() { return m_IsStopping || !m_Requests.empty(); });
+			if (m_IsStopping)
+			{
+				return;
+			}
+
+			request = std::move(m_Requests.front());
+			m_Requests.pop_front();
+		}
+
+		const bool isLoaded{ Load(request) };
+		FinishLoad(std::move(request), isLoaded);
+	}
+}
+
+void GP2_AssetStreamer::FinishLoad(Request&& request, bool isLoaded)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	if (isLoaded)
+	{
+		m_LoadedRequests.push_back(std::move(request));
+		return;
+	}
+
+	std::cerr << "Error: failed to stream " << request.filename << std::endl;
+	m_RequestedTextures.erase(request.pTexture);
+	--m_PendingCount;
+	++m_FailedCount;
+}
+
+bool GP2_AssetStreamer::Load(const Request& request) const
+{
+	if (request.pTexture)
+	{
+		return request.pTexture->Decode(request.filename);
+	}
+
+	const std::string extension{ ".glb" };
+	const bool isGLB{ request.filename.size() >= extension.size() &&
+					  request.filename.compare(request.filename.size() - extension.size(), extension.size(), extension) == 0 };
+	return isGLB ? request.pMesh->LoadGLB(request.filename, request.color)
+				 : request.pMesh->LoadOBJ(request.filename, request.color, true, m_ParseThreadCount);
+}
+
+void GP2_AssetStreamer::RetireBatches(bool isWaiting)
+{
+	// one queue finishes the batches in the order they were submitted
+	while (!m_Batches.empty())
+	{
+		Batch& batch{ m_Batches.front() };
+		if (isWaiting)
+		{
+			m_pUploadContext->Wait(batch.uploadValue);
+		}
+		else if (!m_pUploadContext->IsComplete(batch.uploadValue))
+		{
+			return;
+		}
+
+		for (const Request& request : batch.requests)
+		{
+			if (request.pMesh)
+			{
+				request.pMesh->SetResident();
+			}
+			else
+			{
+				request.pTexture->SetResident();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			for (const Request& request : batch.requests)
+			{
+				m_RequestedTextures.erase(request.pTexture);
+			}
+			m_PendingCount -= static_cast<uint32_t>(batch.requests.size());
+			m_ResidentCount += static_cast<uint32_t>(batch.requests.size());
+		}
+
+		m_Batches.pop_front();
+	}
+}
\ No newline at end of file
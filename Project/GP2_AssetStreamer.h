@@ -0,0 +1,126 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <glm/glm.hpp>
+
+#include "GP2_UploadContext.h"
+#include "GP2_ImageDecodePool.h"
+#include "vulkanbase/VulkanUtil.h"
+
+class GP2_3DMesh;
+class GP2_Texture;
+
+// Loads meshes and textures without stalling the frame. Meshes and .ktx2 textures are queued for a pool of loader threads
+// that do the file I/O and parsing, images are decoded across every spare core by a GP2_ImageDecodePool whose workers
+// write them straight into their staging buffers. Update, called once per frame on the render thread, records the uploads of
+// everything loaded since the previous call into the shared GP2_UploadContext and submits it, the assets of a batch
+// become resident once that submission has finished. Until then pipelines skip the meshes and sample the placeholder texture.
+class GP2_AssetStreamer final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_AssetStreamer() = default;
+	~GP2_AssetStreamer() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_AssetStreamer(const GP2_AssetStreamer&) = delete;
+	GP2_AssetStreamer(GP2_AssetStreamer&&) = delete;
+	GP2_AssetStreamer& operator=(const GP2_AssetStreamer&) = delete;
+	GP2_AssetStreamer& operator=(GP2_AssetStreamer&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// Starts the loader threads and the decode pool, threadCount 0 uses one loader per spare core up to MaxLoaderThreadCount.
+	// The placeholder texture is recorded into uploadContext and goes out with its next Submit.
+	void Initialize(const VulkanContext& context, GP2_UploadContext& uploadContext, uint32_t threadCount = 0);
+	// Lets the loader threads and decode workers finish the request they're on, then waits for the batches in flight.
+	// Call it before destroying any requested asset or the upload context.
+	void Destroy();
+
+	// The mesh mustn't be touched until it's resident, .glb files go through LoadGLB and anything else through LoadOBJ.
+	// The mesh's textures are requested along with it.
+	// A texture that's resident or already requested isn't loaded again, shared textures are decoded once.
+	void RequestMesh(GP2_3DMesh* pMesh, const std::string& filename, const glm::vec3 color);
+	void RequestTexture(GP2_Texture* pTexture, const std::string& filename);
+
+	// Makes the assets of finished batches resident and submits the uploads of everything loaded since the last call,
+	// along with anything else recorded into the upload context.
+	// Prints the total load time once every request since the last report is resident or failed.
+	void Update();
+
+	// nothing queued, loading or uploading
+	bool IsIdle() const;
+	GP2_Texture* GetPlaceholderTexture() const { return m_pPlaceholderTexture; }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// exactly one of pMesh and pTexture is set
+	struct Request
+	{
+		GP2_3DMesh* pMesh;
+		GP2_Texture* pTexture;
+		std::string filename;
+		glm::vec3 color;
+	};
+
+	struct Batch
+	{
+		// the upload context's submission
+		uint64_t uploadValue;
+		std::vector<Request> requests;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void Enqueue(Request&& request);
+	void RunLoader();
+	// Hands a loaded request to Update or counts it as failed
+	void FinishLoad(Request&& request, bool isLoaded);
+	bool Load(const Request& request) const;
+
+	// Retires the finished batches in submission order, waiting for each one when isWaiting
+	void RetireBatches(bool isWaiting);
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t MaxLoaderThreadCount{ 4 };
+
+	GP2_UploadContext* m_pUploadContext{};
+	GP2_Texture* m_pPlaceholderTexture{};
+
+	std::vector<std::thread> m_LoaderThreads;
+	// threads each loader splits a large OBJ over, set before the loaders start
+	uint32_t m_ParseThreadCount{ 1 };
+	GP2_ImageDecodePool m_DecodePool{};
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<Request> m_Requests;
+	std::vector<Request> m_LoadedRequests;
+	// textures between their request and their batch retiring or their decode failing
+	std::unordered_set<GP2_Texture*> m_RequestedTextures;
+	bool m_IsStopping{};
+
+	// render thread only
+	std::deque<Batch> m_Batches;
+
+	// counted from the first request after the last report
+	uint32_t m_PendingCount{};
+	uint32_t m_ResidentCount{};
+	uint32_t m_FailedCount{};
+	std::chrono::steady_clock::time_point m_LoadStart{};
+};
@@ -0,0 +1,625 @@
+#include "GP2_BlockCompressor.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	enum class BlockType { None, BC1, BC5, BC7 };
+
+	BlockType GetBlockType(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			return BlockType::BC1;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			return BlockType::BC5;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return BlockType::BC7;
+		default:
+			return BlockType::None;
+		}
+	}
+
+	// BC7 interpolation weights of 4-bit indices, out of 64
+	constexpr uint32_t BC7Weights[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Least significant bit first, the order of BC7 fields
+	class BitWriter final
+	{
+	public:
+		explicit BitWriter(uint8_t* pBlock) : m_pBlock{ pBlock }, m_Bit{} { std::memset(pBlock, 0, 16); }
+
+		void Write(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t idx = 0; idx < bitCount; ++idx, ++m_Bit)
+			{
+				m_pBlock[m_Bit / 8] |= static_cast<uint8_t>(((value >> idx) & 1) << (m_Bit % 8));
+			}
+		}
+
+	private:
+		uint8_t* m_pBlock;
+		uint32_t m_Bit;
+	};
+
+	class BitReader final
+	{
+	public:
+		explicit BitReader(const uint8_t* pBlock) : m_pBlock{ pBlock }, m_Bit{} {}
+
+		uint32_t Read(uint32_t bitCount)
+		{
+			uint32_t value{};
+			for (uint32_t idx = 0; idx < bitCount; ++idx, ++m_Bit)
+			{
+				value |= ((m_pBlock[m_Bit / 8] >> (m_Bit % 8)) & 1u) << idx;
+			}
+			return value;
+		}
+
+	private:
+		const uint8_t* m_pBlock;
+		uint32_t m_Bit;
+	};
+
+	// Endpoints at the extremes of the texels projected on their principal axis
+	template<size_t ChannelCount>
+	void FindEndpoints(const uint8_t* pTexels, float* pEndpoint0, float* pEndpoint1)
+	{
+		float mean[ChannelCount]{};
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			for (size_t channel = 0; channel < ChannelCount; ++channel)
+			{
+				mean[channel] += pTexels[texel * 4 + channel] / 16.f;
+			}
+		}
+
+		float covariance[ChannelCount][ChannelCount]{};
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			for (size_t row = 0; row < ChannelCount; ++row)
+			{
+				for (size_t column = 0; column < ChannelCount; ++column)
+				{
+					covariance[row][column] += (pTexels[texel * 4 + row] - mean[row]) * (pTexels[texel * 4 + column] - mean[column]);
+				}
+			}
+		}
+
+		// a few power iterations converge well enough for 16 texels
+		float axis[ChannelCount]{};
+		std::fill_n(axis, ChannelCount, 1.f);
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[ChannelCount]{};
+			float length{};
+			for (size_t row = 0; row < ChannelCount; ++row)
+			{
+				for (size_t column = 0; column < ChannelCount; ++column)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+				length = std::max(length, std::abs(next[row]));
+			}
+
+			if (length < 1e-6f)
+			{
+				break;
+			}
+			for (size_t channel = 0; channel < ChannelCount; ++channel)
+			{
+				axis[channel] = next[channel] / length;
+			}
+		}
+
+		float axisLengthSquared{};
+		for (size_t channel = 0; channel < ChannelCount; ++channel)
+		{
+			axisLengthSquared += axis[channel] * axis[channel];
+		}
+
+		float minProjection{};
+		float maxProjection{};
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			float projection{};
+			for (size_t channel = 0; channel < ChannelCount; ++channel)
+			{
+				projection += (pTexels[texel * 4 + channel] - mean[channel]) * axis[channel];
+			}
+			minProjection = std::min(minProjection, projection / axisLengthSquared);
+			maxProjection = std::max(maxProjection, projection / axisLengthSquared);
+		}
+
+		for (size_t channel = 0; channel < ChannelCount; ++channel)
+		{
+			pEndpoint0[channel] = std::clamp(mean[channel] + axis[channel] * minProjection, 0.f, 255.f);
+			pEndpoint1[channel] = std::clamp(mean[channel] + axis[channel] * maxProjection, 0.f, 255.f);
+		}
+	}
+
+	uint16_t To565(const float* pColor)
+	{
+		const uint32_t red{ static_cast<uint32_t>(std::lround(pColor[0] * 31.f / 255.f)) };
+		const uint32_t green{ static_cast<uint32_t>(std::lround(pColor[1] * 63.f / 255.f)) };
+		const uint32_t blue{ static_cast<uint32_t>(std::lround(pColor[2] * 31.f / 255.f)) };
+		return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+	}
+
+	void From565(uint16_t color, int* pColor)
+	{
+		const int red{ color >> 11 };
+		const int green{ (color >> 5) & 63 };
+		const int blue{ color & 31 };
+		pColor[0] = (red << 3) | (red >> 2);
+		pColor[1] = (green << 2) | (green >> 4);
+		pColor[2] = (blue << 3) | (blue >> 2);
+	}
+
+	template<size_t ChannelCount>
+	size_t FindNearest(const uint8_t* pTexel, const int (*pPalette)[4], size_t paletteSize, int& error)
+	{
+		size_t nearest{};
+		error = INT32_MAX;
+		for (size_t entry = 0; entry < paletteSize; ++entry)
+		{
+			int distance{};
+			for (size_t channel = 0; channel < ChannelCount; ++channel)
+			{
+				const int difference{ pTexel[channel] - pPalette[entry][channel] };
+				distance += difference * difference;
+			}
+
+			if (distance < error)
+			{
+				nearest = entry;
+				error = distance;
+			}
+		}
+		return nearest;
+	}
+
+	// mode 6 endpoints are 7 bits per channel plus a shared lowest bit, the p-bit picks the closer of the two
+	void QuantizeBC7Endpoint(const float* pEndpoint, uint32_t* pQuantized, uint32_t& pBit)
+	{
+		float bestError{ INFINITY };
+		for (uint32_t candidateBit = 0; candidateBit < 2; ++candidateBit)
+		{
+			uint32_t quantized[4]{};
+			float error{};
+			for (size_t channel = 0; channel < 4; ++channel)
+			{
+				quantized[channel] = static_cast<uint32_t>(std::clamp(std::lround((pEndpoint[channel] - candidateBit) / 2.f), 0l, 127l));
+				const float difference{ float((quantized[channel] << 1) | candidateBit) - pEndpoint[channel] };
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				pBit = candidateBit;
+				std::copy_n(quantized, 4, pQuantized);
+			}
+		}
+	}
+
+	// Returns the summed squared error of the block
+	int AssignBC7Indices(const uint8_t* pTexels, const uint32_t* pQuantized0, uint32_t pBit0, const uint32_t* pQuantized1, uint32_t pBit1,
+						 uint32_t* pIndices)
+	{
+		int palette[16][4]{};
+		for (size_t entry = 0; entry < 16; ++entry)
+		{
+			for (size_t channel = 0; channel < 4; ++channel)
+			{
+				const uint32_t endpoint0{ (pQuantized0[channel] << 1) | pBit0 };
+				const uint32_t endpoint1{ (pQuantized1[channel] << 1) | pBit1 };
+				palette[entry][channel] = static_cast<int>(((64 - BC7Weights[entry]) * endpoint0 + BC7Weights[entry] * endpoint1 + 32) >> 6);
+			}
+		}
+
+		int totalError{};
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			int error{};
+			pIndices[texel] = static_cast<uint32_t>(FindNearest<4>(pTexels + texel * 4, palette, 16, error));
+			totalError += error;
+		}
+		return totalError;
+	}
+}
+
+bool GP2_BlockCompressor::IsSupported(VkFormat format)
+{
+	return GetBlockType(format) != BlockType::None;
+}
+
+bool GP2_BlockCompressor::IsSRGB(VkFormat format)
+{
+	return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+uint32_t GP2_BlockCompressor::GetBlockSize(VkFormat format)
+{
+	return GetBlockType(format) == BlockType::BC1 ? 8 : 16;
+}
+
+size_t GP2_BlockCompressor::GetImageSize(VkFormat format, uint32_t width, uint32_t height)
+{
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+void GP2_BlockCompressor::EncodeBlockRows(VkFormat format, const uint8_t* pPixels, uint32_t width, uint32_t height,
+										  uint32_t firstBlockRow, uint32_t blockRowCount, uint8_t* pBlocks)
+{
+	const BlockType blockType{ GetBlockType(format) };
+	const uint32_t blockSize{ GetBlockSize(format) };
+	const uint32_t blockColumnCount{ (width + 3) / 4 };
+
+	uint8_t texels[64]{};
+	for (uint32_t blockRow = firstBlockRow; blockRow < firstBlockRow + blockRowCount; ++blockRow)
+	{
+		for (uint32_t blockColumn = 0; blockColumn < blockColumnCount; ++blockColumn)
+		{
+			for (uint32_t y = 0; y < 4; ++y)
+			{
+				const uint32_t sourceY{ std::min(blockRow * 4 + y, height - 1) };
+				for (uint32_t x = 0; x < 4; ++x)
+				{
+					const uint32_t sourceX{ std::min(blockColumn * 4 + x, width - 1) };
+					std::memcpy(texels + (y * 4 + x) * 4, pPixels + (size_t(sourceY) * width + sourceX) * 4, 4);
+				}
+			}
+
+			uint8_t* pBlock{ pBlocks + (size_t(blockRow) * blockColumnCount + blockColumn) * blockSize };
+			switch (blockType)
+			{
+			case BlockType::BC1:
+				EncodeBC1Block(texels, pBlock);
+				break;
+			case BlockType::BC5:
+				EncodeBC4Block(texels, 0, pBlock);
+				EncodeBC4Block(texels, 1, pBlock + 8);
+				break;
+			case BlockType::BC7:
+				EncodeBC7Block(texels, pBlock);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
+bool GP2_BlockCompressor::Decode(VkFormat format, const uint8_t* pBlocks, uint32_t width, uint32_t height, std::vector<uint8_t>& pixels)
+{
+	const BlockType blockType{ GetBlockType(format) };
+	const uint32_t blockSize{ GetBlockSize(format) };
+	const uint32_t blockColumnCount{ (width + 3) / 4 };
+	const uint32_t blockRowCount{ (height + 3) / 4 };
+	pixels.resize(size_t(width) * height * 4);
+
+	uint8_t texels[64]{};
+	for (uint32_t blockRow = 0; blockRow < blockRowCount; ++blockRow)
+	{
+		for (uint32_t blockColumn = 0; blockColumn < blockColumnCount; ++blockColumn)
+		{
+			const uint8_t* pBlock{ pBlocks + (size_t(blockRow) * blockColumnCount + blockColumn) * blockSize };
+			switch (blockType)
+			{
+			case BlockType::BC1:
+				DecodeBC1Block(pBlock, texels);
+				break;
+			case BlockType::BC5:
+				// normal maps rebuild z in the shader
+				for (size_t texel = 0; texel < 16; ++texel)
+				{
+					texels[texel * 4 + 2] = 0;
+					texels[texel * 4 + 3] = 255;
+				}
+				DecodeBC4Block(pBlock, 0, texels);
+				DecodeBC4Block(pBlock + 8, 1, texels);
+				break;
+			case BlockType::BC7:
+				if (!DecodeBC7Block(pBlock, texels))
+				{
+					return false;
+				}
+				break;
+			default:
+				return false;
+			}
+
+			for (uint32_t y = 0; y < 4 && blockRow * 4 + y < height; ++y)
+			{
+				const uint32_t texelCount{ std::min(4u, width - blockColumn * 4) };
+				std::memcpy(pixels.data() + (size_t(blockRow * 4 + y) * width + blockColumn * 4) * 4, texels + y * 16, size_t(texelCount) * 4);
+			}
+		}
+	}
+
+	return true;
+}
+
+void GP2_BlockCompressor::EncodeBC1Block(const uint8_t* pTexels, uint8_t* pBlock)
+{
+	float endpoint0[3]{};
+	float endpoint1[3]{};
+	FindEndpoints<3>(pTexels, endpoint0, endpoint1);
+
+	// the larger color first selects the four color mode
+	uint16_t color0{ To565(endpoint1) };
+	uint16_t color1{ To565(endpoint0) };
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices{};
+	if (color0 != color1)
+	{
+		int palette[4][4]{};
+		From565(color0, palette[0]);
+		From565(color1, palette[1]);
+		for (size_t channel = 0; channel < 3; ++channel)
+		{
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			int error{};
+			indices |= static_cast<uint32_t>(FindNearest<3>(pTexels + texel * 4, palette, 4, error)) << (texel * 2);
+		}
+	}
+
+	pBlock[0] = static_cast<uint8_t>(color0);
+	pBlock[1] = static_cast<uint8_t>(color0 >> 8);
+	pBlock[2] = static_cast<uint8_t>(color1);
+	pBlock[3] = static_cast<uint8_t>(color1 >> 8);
+	std::memcpy(pBlock + 4, &indices, 4);
+}
+
+void GP2_BlockCompressor::EncodeBC4Block(const uint8_t* pTexels, size_t channel, uint8_t* pBlock)
+{
+	uint8_t minValue{ 255 };
+	uint8_t maxValue{ 0 };
+	for (size_t texel = 0; texel < 16; ++texel)
+	{
+		minValue = std::min(minValue, pTexels[texel * 4 + channel]);
+		maxValue = std::max(maxValue, pTexels[texel * 4 + channel]);
+	}
+
+	// the larger value first selects the eight value mode
+	pBlock[0] = maxValue;
+	pBlock[1] = minValue;
+	uint64_t indices{};
+	if (maxValue != minValue)
+	{
+		int palette[8]{ maxValue, minValue };
+		for (int entry = 2; entry < 8; ++entry)
+		{
+			palette[entry] = ((8 - entry) * maxValue + (entry - 1) * minValue + 3) / 7;
+		}
+
+		for (size_t texel = 0; texel < 16; ++texel)
+		{
+			uint64_t nearest{};
+			int nearestDistance{ INT32_MAX };
+			for (size_t entry = 0; entry < 8; ++entry)
+			{
+				const int distance{ std::abs(pTexels[texel * 4 + channel] - palette[entry]) };
+				if (distance < nearestDistance)
+				{
+					nearest = entry;
+					nearestDistance = distance;
+				}
+			}
+			indices |= nearest << (texel * 3);
+		}
+	}
+
+	for (size_t idx = 0; idx < 6; ++idx)
+	{
+		pBlock[2 + idx] = static_cast<uint8_t>(indices >> (idx * 8));
+	}
+}
+
+void GP2_BlockCompressor::EncodeBC7Block(const uint8_t* pTexels, uint8_t* pBlock)
+{
+	float endpoint0[4]{};
+	float endpoint1[4]{};
+	FindEndpoints<4>(pTexels, endpoint0, endpoint1);
+
+	uint32_t quantized0[4]{};
+	uint32_t quantized1[4]{};
+	uint32_t pBit0{};
+	uint32_t pBit1{};
+	QuantizeBC7Endpoint(endpoint0, quantized0, pBit0);
+	QuantizeBC7Endpoint(endpoint1, quantized1, pBit1);
+
+	uint32_t indices[16]{};
+	int error{ AssignBC7Indices(pTexels, quantized0, pBit0, quantized1, pBit1, indices) };
+
+	// one least squares pass fits the endpoints to the chosen weights
+	float sumWeight00{}, sumWeight01{}, sumWeight11{};
+	float sumTexel0[4]{}, sumTexel1[4]{};
+	for (size_t texel = 0; texel < 16; ++texel)
+	{
+		const float weight{ BC7Weights[indices[texel]] / 64.f };
+		sumWeight00 += (1.f - weight) * (1.f - weight);
+		sumWeight01 += (1.f - weight) * weight;
+		sumWeight11 += weight * weight;
+		for (size_t channel = 0; channel < 4; ++channel)
+		{
+			sumTexel0[channel] += (1.f - weight) * pTexels[texel * 4 + channel];
+			sumTexel1[channel] += weight * pTexels[texel * 4 + channel];
+		}
+	}
+
+	const float determinant{ sumWeight00 * sumWeight11 - sumWeight01 * sumWeight01 };
+	if (std::abs(determinant) > 1e-6f)
+	{
+		float fitted0[4]{};
+		float fitted1[4]{};
+		for (size_t channel = 0; channel < 4; ++channel)
+		{
+			fitted0[channel] = std::clamp((sumWeight11 * sumTexel0[channel] - sumWeight01 * sumTexel1[channel]) / determinant, 0.f, 255.f);
+			fitted1[channel] = std::clamp((sumWeight00 * sumTexel1[channel] - sumWeight01 * sumTexel0[channel]) / determinant, 0.f, 255.f);
+		}
+
+		uint32_t fittedQuantized0[4]{};
+		uint32_t fittedQuantized1[4]{};
+		uint32_t fittedBit0{};
+		uint32_t fittedBit1{};
+		QuantizeBC7Endpoint(fitted0, fittedQuantized0, fittedBit0);
+		QuantizeBC7Endpoint(fitted1, fittedQuantized1, fittedBit1);
+
+		uint32_t fittedIndices[16]{};
+		const int fittedError{ AssignBC7Indices(pTexels, fittedQuantized0, fittedBit0, fittedQuantized1, fittedBit1, fittedIndices) };
+		if (fittedError < error)
+		{
+			error = fittedError;
+			std::copy_n(fittedQuantized0, 4, quantized0);
+			std::copy_n(fittedQuantized1, 4, quantized1);
+			std::copy_n(fittedIndices, 16, indices);
+			pBit0 = fittedBit0;
+			pBit1 = fittedBit1;
+		}
+	}
+
+	// the first index drops its highest bit, swapping the endpoints keeps it clear
+	if (indices[0] >= 8)
+	{
+		std::swap_ranges(quantized0, quantized0 + 4, quantized1);
+		std::swap(pBit0, pBit1);
+		for (uint32_t& index : indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BitWriter writer{ pBlock };
+	writer.Write(1u << 6, 7);
+	for (size_t channel = 0; channel < 4; ++channel)
+	{
+		writer.Write(quantized0[channel], 7);
+		writer.Write(quantized1[channel], 7);
+	}
+	writer.Write(pBit0, 1);
+	writer.Write(pBit1, 1);
+	writer.Write(indices[0], 3);
+	for (size_t texel = 1; texel < 16; ++texel)
+	{
+		writer.Write(indices[texel], 4);
+	}
+}
+
+void GP2_BlockCompressor::DecodeBC1Block(const uint8_t* pBlock, uint8_t* pTexels)
+{
+	const uint16_t color0{ static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8)) };
+	const uint16_t color1{ static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8)) };
+
+	int palette[4][4]{};
+	From565(color0, palette[0]);
+	From565(color1, palette[1]);
+	for (size_t channel = 0; channel < 3; ++channel)
+	{
+		if (color0 > color1)
+		{
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+		else
+		{
+			// three colors and black, the RGB formats ignore the transparency
+			palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+			palette[3][channel] = 0;
+		}
+	}
+
+	uint32_t indices{};
+	std::memcpy(&indices, pBlock + 4, 4);
+	for (size_t texel = 0; texel < 16; ++texel)
+	{
+		const int* pColor{ palette[(indices >> (texel * 2)) & 3] };
+		for (size_t channel = 0; channel < 3; ++channel)
+		{
+			pTexels[texel * 4 + channel] = static_cast<uint8_t>(pColor[channel]);
+		}
+		pTexels[texel * 4 + 3] = 255;
+	}
+}
+
+void GP2_BlockCompressor::DecodeBC4Block(const uint8_t* pBlock, size_t channel, uint8_t* pTexels)
+{
+	const int value0{ pBlock[0] };
+	const int value1{ pBlock[1] };
+
+	int palette[8]{ value0, value1 };
+	if (value0 > value1)
+	{
+		for (int entry = 2; entry < 8; ++entry)
+		{
+			palette[entry] = ((8 - entry) * value0 + (entry - 1) * value1) / 7;
+		}
+	}
+	else
+	{
+		for (int entry = 2; entry < 6; ++entry)
+		{
+			palette[entry] = ((6 - entry) * value0 + (entry - 1) * value1) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t indices{};
+	for (size_t idx = 0; idx < 6; ++idx)
+	{
+		indices |= uint64_t(pBlock[2 + idx]) << (idx * 8);
+	}
+
+	for (size_t texel = 0; texel < 16; ++texel)
+	{
+		pTexels[texel * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (texel * 3)) & 7]);
+	}
+}
+
+bool GP2_BlockCompressor::DecodeBC7Block(const uint8_t* pBlock, uint8_t* pTexels)
+{
+	BitReader reader{ pBlock };
+	if (reader.Read(7) != 1u << 6)
+	{
+		return false;
+	}
+
+	uint32_t endpoints[2][4]{};
+	for (size_t channel = 0; channel < 4; ++channel)
+	{
+		endpoints[0][channel] = reader.Read(7) << 1;
+		endpoints[1][channel] = reader.Read(7) << 1;
+	}
+	const uint32_t pBit0{ reader.Read(1) };
+	const uint32_t pBit1{ reader.Read(1) };
+
+	for (size_t texel = 0; texel < 16; ++texel)
+	{
+		const uint32_t index{ reader.Read(texel == 0 ? 3 : 4) };
+		for (size_t channel = 0; channel < 4; ++channel)
+		{
+			const uint32_t endpoint0{ endpoints[0][channel] | pBit0 };
+			const uint32_t endpoint1{ endpoints[1][channel] | pBit1 };
+			pTexels[texel * 4 + channel] = static_cast<uint8_t>(((64 - BC7Weights[index]) * endpoint0 + BC7Weights[index] * endpoint1 + 32) >> 6);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <vulkan/vulkan_core.h>
+
+// Encodes and decodes the 4x4 blocks of BC1, BC5 and BC7 images from and to tightly packed RGBA8.
+// BC1 takes RGB and drops alpha, BC5 takes the RG of normal maps, BC7 is encoded in its single subset RGBA mode 6 only.
+// Decoding is the fallback for devices without BC support, it reads BC7 mode 6 blocks only so it covers what the
+// encoder writes. Texels past the image edge are encoded as copies of the edge.
+class GP2_BlockCompressor final
+{
+public:
+	//-----------
+	// Functions
+	//-----------
+	// BC1, BC5 and BC7 in both their UNORM and SRGB variants
+	static bool IsSupported(VkFormat format);
+	static bool IsSRGB(VkFormat format);
+	static uint32_t GetBlockSize(VkFormat format);
+	static size_t GetImageSize(VkFormat format, uint32_t width, uint32_t height);
+
+	// Encodes block rows [firstBlockRow, firstBlockRow + blockRowCount) of pPixels into pBlocks, which points at the
+	// whole image's blocks. Different rows can be encoded by different threads.
+	static void EncodeBlockRows(VkFormat format, const uint8_t* pPixels, uint32_t width, uint32_t height,
+								uint32_t firstBlockRow, uint32_t blockRowCount, uint8_t* pBlocks);
+	// Returns false when a block uses a BC7 mode other than 6
+	static bool Decode(VkFormat format, const uint8_t* pBlocks, uint32_t width, uint32_t height, std::vector<uint8_t>& pixels);
+
+private:
+	//-----------
+	// Functions
+	//-----------
+	// texels are the 16 RGBA8 texels of a block in rows
+	static void EncodeBC1Block(const uint8_t* pTexels, uint8_t* pBlock);
+	static void EncodeBC4Block(const uint8_t* pTexels, size_t channel, uint8_t* pBlock);
+	static void EncodeBC7Block(const uint8_t* pTexels, uint8_t* pBlock);
+
+	static void DecodeBC1Block(const uint8_t* pBlock, uint8_t* pTexels);
+	static void DecodeBC4Block(const uint8_t* pBlock, size_t channel, uint8_t* pTexels);
+	static bool DecodeBC7Block(const uint8_t* pBlock, uint8_t* pTexels);
+};
@@ -3,11 +3,12 @@
 #include "vulkanbase/VulkanUtil.h"
 #include "vulkanbase/VulkanBase.h"
 
-GP2_Buffer::GP2_Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size) :
+GP2_Buffer::GP2_Buffer(VkDevice device, VkPhysicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size,
+                       GP2_MemoryAllocator::Category category, std::string_view name) :
     m_Device{ device },
     m_Size{ size },
     m_VkBuffer{},
-    m_VkBufferMemory{} 
+    m_Allocation{} 
 {
     // Create the buffer
     VkBufferCreateInfo bufferInfo{};
@@ -21,22 +22,8 @@ GP2_Buffer::GP2_Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBuffe
         throw std::runtime_error("Failed to create buffer!");
     }
 
-    // Allocate memory for the buffer
-    VkMemoryRequirements memRequirements{};
-    vkGetBufferMemoryRequirements(device, m_VkBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &m_VkBufferMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to allocate buffer memory!");
-    }
-
-    // Bind buffer memory
-    vkBindBufferMemory(device, m_VkBuffer, m_VkBufferMemory, 0);
+    // Place it in one of the allocator's blocks, bound already
+    m_Allocation = GP2_MemoryAllocator::Get(device).AllocateForBuffer(m_VkBuffer, properties, category, name);
 }
 
 GP2_Buffer::~GP2_Buffer()
@@ -44,57 +31,53 @@ GP2_Buffer::~GP2_Buffer()
 }
 
 //transfer to device local as name?
-void GP2_Buffer::TransferDeviceLocal(void* data)
+void GP2_Buffer::TransferDeviceLocal(const void* data)
 {
-    void* mappedData{};
-    vkMapMemory(m_Device, m_VkBufferMemory, 0, m_Size, 0, &mappedData);
+    // Copy data to the persistently mapped memory
+    memcpy(m_Allocation.pMapped, data, static_cast<size_t>(m_Size));
+    Unmap();
+}
 
-    // Copy data to mapped memory
-    memcpy(mappedData, data, static_cast<size_t>(m_Size));
+void GP2_Buffer::WriteIndices(void* pDst, const uint32_t* pIndices, size_t count, VkIndexType indexType)
+{
+    if (indexType == VK_INDEX_TYPE_UINT32)
+    {
+        memcpy(pDst, pIndices, count * sizeof(uint32_t));
+        return;
+    }
 
-    // Unmap buffer memory
-    vkUnmapMemory(m_Device, m_VkBufferMemory);
+    // narrow straight into the destination, no temporary 16-bit copy
+    uint16_t* pDstIndices{ static_cast<uint16_t*>(pDst) };
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        pDstIndices[idx] = static_cast<uint16_t>(pIndices[idx]);
+    }
 }
 
 //make visible or make host visible as name?
 void GP2_Buffer::Map(void** data)
 {
-    vkMapMemory(m_Device, m_VkBufferMemory, 0, m_Size, 0, data);
+    *data = m_Allocation.pMapped;
 }
 
-void GP2_Buffer::CopyBuffer(GP2_Buffer srcBuffer, VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices)
+void GP2_Buffer::Unmap()
 {
-    GP2_CommandPool commandPool{};
-    commandPool.Initialize(m_Device, queueFamilyIndices);
-
-    GP2_CommandBuffer commandBuffer{ commandPool.CreateCommandBuffer() };
-
-    commandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    m_Allocation.pAllocator->Flush(m_Allocation);
+}
 
+void GP2_Buffer::RecordCopy(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkDeviceSize srcOffset, VkDeviceSize size, VkDeviceSize dstOffset)
+{
     VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = m_Size;
-    vkCmdCopyBuffer(commandBuffer.GetVkCommandBuffer(), srcBuffer.GetVkBuffer(), m_VkBuffer, 1, &copyRegion);
-
-    commandBuffer.EndRecording();
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    commandBuffer.Sumbit(submitInfo);
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
-
-    const VkCommandBuffer commandBufferVk = commandBuffer.GetVkCommandBuffer();
-    vkFreeCommandBuffers(m_Device, commandPool.GetVkCommandPool(), 1, &commandBufferVk);
-
-    commandPool.Destroy();
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, m_VkBuffer, 1, &copyRegion);
 }
 
 void GP2_Buffer::Destroy()
 {
 	vkDestroyBuffer(m_Device, m_VkBuffer, nullptr);
-	vkFreeMemory(m_Device, m_VkBufferMemory, nullptr);
+	m_Allocation.pAllocator->Free(m_Allocation);
 }
 
 void GP2_Buffer::BindAsVertexBuffer(VkCommandBuffer commandBuffer)
@@ -105,23 +88,7 @@ void GP2_Buffer::BindAsVertexBuffer(VkCommandBuffer commandBuffer)
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 }
 
-void GP2_Buffer::BindAsIndexBuffer(VkCommandBuffer commandBuffer)
+void GP2_Buffer::BindAsIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType)
 {
-    vkCmdBindIndexBuffer(commandBuffer, m_VkBuffer, 0, VK_INDEX_TYPE_UINT16);
-}
-
-uint32_t GP2_Buffer::FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memProperties{};
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
-    {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("failed to find suitable memory type!");
+    vkCmdBindIndexBuffer(commandBuffer, m_VkBuffer, 0, indexType);
 }
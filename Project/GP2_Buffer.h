@@ -1,8 +1,10 @@
 #pragma once
 #include <vector>
+#include <string_view>
 
 #include "Vertex.h"
 #include "GP2_CommandPool.h"
+#include "GP2_MemoryAllocator.h"
 #include "vulkan/vulkan_core.h"
 
 class GP2_Buffer final
@@ -11,35 +13,41 @@ public:
 	//---------------------------
 	// Constructors & Destructor
 	//---------------------------
-	GP2_Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size);
+	// category and name tag the memory in GP2_MemoryAllocator's report
+	GP2_Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize size,
+			   GP2_MemoryAllocator::Category category, std::string_view name);
 	~GP2_Buffer();
 
 	//-----------
 	// Functions
 	//-----------
-	void TransferDeviceLocal(void* data);
+	void TransferDeviceLocal(const void* data);
+	// Host visible buffers stay mapped for their whole lifetime, Map hands out the pointer and Unmap flushes the writes
 	void Map(void** data);
-	void CopyBuffer(GP2_Buffer srcBuffer, VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices);
+	void Unmap();
+	// Records the copy of size bytes of srcBuffer without submitting it, srcBuffer has to outlive the command buffer's execution
+	void RecordCopy(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkDeviceSize srcOffset, VkDeviceSize size, VkDeviceSize dstOffset = 0);
 
 	void Destroy();
 	
 	void BindAsVertexBuffer(VkCommandBuffer commandBuffer);
-	void BindAsIndexBuffer(VkCommandBuffer commandBuffer);
+	void BindAsIndexBuffer(VkCommandBuffer commandBuffer, VkIndexType indexType = VK_INDEX_TYPE_UINT16);
 
 	VkBuffer GetVkBuffer() const { return m_VkBuffer; }
 	VkDeviceSize GetSizeInBytes() const { return m_Size; }
+
+	// 16-bit indices as long as every vertex can be addressed with them
+	static VkIndexType SelectIndexType(size_t vertexCount) { return vertexCount <= size_t(UINT16_MAX) + 1 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+	static VkDeviceSize GetIndexSize(VkIndexType indexType) { return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+	// Writes 32-bit source indices narrowed to the given index type, typically straight into staging memory
+	static void WriteIndices(void* pDst, const uint32_t* pIndices, size_t count, VkIndexType indexType);
 	
 private:
-	//-----------
-	// Functions
-	//----------- 
-	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
 	//-----------
 	// Variables
 	//-----------
 	VkDevice m_Device;
 	VkDeviceSize m_Size; 
 	VkBuffer m_VkBuffer;
-	VkDeviceMemory m_VkBufferMemory;
+	GP2_MemoryAllocator::Allocation m_Allocation;
 };
@@ -21,12 +21,12 @@ void GP2_CommandBuffer::Reset() const
 	vkResetCommandBuffer(m_CommandBuffer, 0);
 }
 
-void GP2_CommandBuffer::BeginRecording(VkCommandBufferUsageFlags flags) const
+void GP2_CommandBuffer::BeginRecording(VkCommandBufferUsageFlags flags, const VkCommandBufferInheritanceInfo* pInheritanceInfo) const
 {
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = flags; //optional
-	beginInfo.pInheritanceInfo = nullptr; //optional
+	beginInfo.pInheritanceInfo = pInheritanceInfo; //optional
 
 	if (vkBeginCommandBuffer(m_CommandBuffer, &beginInfo) != VK_SUCCESS)
 	{
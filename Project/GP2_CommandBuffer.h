@@ -17,7 +17,8 @@ public:
 	VkCommandBuffer GetVkCommandBuffer() const;
 
 	void Reset() const;
-	void BeginRecording(VkCommandBufferUsageFlags flags) const;
+	// pInheritanceInfo is required for secondary command buffers
+	void BeginRecording(VkCommandBufferUsageFlags flags, const VkCommandBufferInheritanceInfo* pInheritanceInfo = nullptr) const;
 	void EndRecording() const;
 
 	void Sumbit(VkSubmitInfo& info) const;
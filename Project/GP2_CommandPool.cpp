@@ -8,13 +8,18 @@ GP2_CommandPool::GP2_CommandPool() :
 }
 
 void GP2_CommandPool::Initialize(const VkDevice& device, const QueueFamilyIndices& queue)
+{
+	Initialize(device, queue.graphicsFamily.value());
+}
+
+void GP2_CommandPool::Initialize(const VkDevice& device, uint32_t queueFamilyIndex)
 {
 	m_VkDevice = device;
 
 	VkCommandPoolCreateInfo poolInfo{};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-	poolInfo.queueFamilyIndex = queue.graphicsFamily.value();
+	poolInfo.queueFamilyIndex = queueFamilyIndex;
 
 	if (vkCreateCommandPool(m_VkDevice, &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
 	{
@@ -27,12 +32,12 @@ void GP2_CommandPool::Destroy()
 	vkDestroyCommandPool(m_VkDevice, m_CommandPool, nullptr);
 }
 
-GP2_CommandBuffer GP2_CommandPool::CreateCommandBuffer() const
+GP2_CommandBuffer GP2_CommandPool::CreateCommandBuffer(VkCommandBufferLevel level) const
 {
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.commandPool = m_CommandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.level = level;
 	allocInfo.commandBufferCount = 1;
 
 	VkCommandBuffer commandBuffer{};
@@ -48,6 +53,11 @@ GP2_CommandBuffer GP2_CommandPool::CreateCommandBuffer() const
 	return cmdBuffer; 
 }
 
+void GP2_CommandPool::Reset() const
+{
+	vkResetCommandPool(m_VkDevice, m_CommandPool, 0);
+}
+
 VkCommandPool GP2_CommandPool::GetVkCommandPool() const
 {
 	return m_CommandPool;
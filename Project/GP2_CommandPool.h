@@ -15,10 +15,14 @@ public:
 	//-----------
 	// Functions
 	//-----------
+	// A pool for the graphics family
 	void Initialize(const VkDevice& device, const QueueFamilyIndices& queue);
+	void Initialize(const VkDevice& device, uint32_t queueFamilyIndex);
 	void Destroy();
 
-	GP2_CommandBuffer CreateCommandBuffer() const;
+	GP2_CommandBuffer CreateCommandBuffer(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const;
+	// Resets every command buffer of the pool, none of them may be pending
+	void Reset() const;
 	VkCommandPool GetVkCommandPool() const;
 
 private:
@@ -3,6 +3,7 @@
 #include <vector>
 #include "Vertex.h"
 #include "GP2_Buffer.h"
+#include "GP2_FrameAllocator.h"
 #include "vulkan/vulkan_core.h"
 #include "vulkanbase/VulkanUtil.h"
 #include "vulkanbase/VulkanBase.h"
@@ -20,8 +21,9 @@ public:
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(const VulkanContext& context, VkImageView textureImageView, VkSampler textureSampler); 
+	void Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator, VkImageView textureImageView, VkSampler textureSampler); 
 
+	// Writes the UBO into the current frame of the frame allocator, so it has to be set again every frame before binding
 	void SetUBO(UBO data, size_t index);
 
 	const VkDescriptorSetLayout& GetDescriptorSetLayout()
@@ -30,6 +32,8 @@ public:
 	}
 
 	void CreateDescriptorSets(VkImageView textureImageView, VkSampler textureSampler);
+	// Points the set at another texture, it may not be in use by a pending command buffer
+	void UpdateTexture(VkImageView textureImageView, VkSampler textureSampler, size_t index);
 
 	void BindDescriptorSet(VkCommandBuffer buffer, VkPipelineLayout layout, size_t index);
 
@@ -38,7 +42,6 @@ private:
 	// Functions
 	//-----------
 	void CreateDescriptorSetLayout(const VulkanContext& context);
-	void CreateUBOs(const VulkanContext& context);
 
 	//-----------
 	// Variables
@@ -50,8 +53,9 @@ private:
 	VkDescriptorPool m_DescriptorPool;
 	std::vector<VkDescriptorSet> m_DescriptorSets;
 
-	std::vector<GP2_Buffer*> m_UBOs;
-	std::vector<void*> m_UBOsMapped;
+	// the UBO binding is a dynamic range of the frame allocator's buffer, moved by the offset of the last SetUBO
+	GP2_FrameAllocator* m_pFrameAllocator;
+	std::vector<uint32_t> m_UBOOffsets;
 
 	size_t m_Count;
 };
@@ -59,13 +63,15 @@ private:
 template<class UBO>
 GP2_DescriptorPool<UBO>::GP2_DescriptorPool(VkDevice device, size_t count) :
 	m_Device{ device },
-	m_Size{ sizeof(VertexUBO) },
+	m_Size{ sizeof(UBO) },
 	m_Count(count),
+	m_pFrameAllocator{ nullptr },
+	m_UBOOffsets(count, 0),
 	m_DescriptorPool{ nullptr },
 	m_DescriptorSetLayout{ nullptr }
 {
 	std::array<VkDescriptorPoolSize, 2> poolSizes{};
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
@@ -85,20 +91,16 @@ GP2_DescriptorPool<UBO>::GP2_DescriptorPool(VkDevice device, size_t count) :
 template<class UBO>
 GP2_DescriptorPool<UBO>::~GP2_DescriptorPool()
 {
-	for (size_t i = 0; i < m_Count; ++i)
-	{
-		m_UBOs[i]->Destroy();
-	}
-
 	vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
 	vkDestroyDescriptorSetLayout(m_Device, m_DescriptorSetLayout, nullptr);
 }
 
 template<class UBO>
-inline void GP2_DescriptorPool<UBO>::Initialize(const VulkanContext& context, VkImageView textureImageView, VkSampler textureSampler)
+inline void GP2_DescriptorPool<UBO>::Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator, VkImageView textureImageView, VkSampler textureSampler)
 {
+	m_pFrameAllocator = &frameAllocator;
+
 	CreateDescriptorSetLayout(context);
-	CreateUBOs(context);
 	CreateDescriptorSets(textureImageView, textureSampler);
 }
 
@@ -122,7 +124,7 @@ void GP2_DescriptorPool<UBO>::CreateDescriptorSets(VkImageView textureImageView,
 	for (size_t idx = 0; idx < m_Count; ++idx) 
 	{
 		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = m_UBOs[idx]->GetVkBuffer();
+		bufferInfo.buffer = m_pFrameAllocator->GetVkBuffer();
 		bufferInfo.offset = 0;
 		bufferInfo.range = m_Size;
 
@@ -137,7 +139,7 @@ void GP2_DescriptorPool<UBO>::CreateDescriptorSets(VkImageView textureImageView,
 		descriptorWrites[0].dstSet = m_DescriptorSets[idx];  
 		descriptorWrites[0].dstBinding = 0; 
 		descriptorWrites[0].dstArrayElement = 0; 
-		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; 
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; 
 		descriptorWrites[0].descriptorCount = 1; 
 		descriptorWrites[0].pBufferInfo = &bufferInfo; 
 
@@ -153,11 +155,31 @@ void GP2_DescriptorPool<UBO>::CreateDescriptorSets(VkImageView textureImageView,
 	}
 }
 
+template<class UBO>
+void GP2_DescriptorPool<UBO>::UpdateTexture(VkImageView textureImageView, VkSampler textureSampler, size_t index)
+{
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = textureImageView;
+	imageInfo.sampler = textureSampler;
+
+	VkWriteDescriptorSet descriptorWrite{};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = m_DescriptorSets[index];
+	descriptorWrite.dstBinding = 1;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+}
+
 template<class UBO>
 void GP2_DescriptorPool<UBO>::BindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, size_t index)
 {
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
-		&m_DescriptorSets[index], 0, nullptr);
+		&m_DescriptorSets[index], 1, &m_UBOOffsets[index]);
 }
 
 template<class UBO>
@@ -165,7 +187,7 @@ inline void GP2_DescriptorPool<UBO>::CreateDescriptorSetLayout(const VulkanConte
 {
 	VkDescriptorSetLayoutBinding uboLayoutBinding{}; 
 	uboLayoutBinding.binding = 0; 
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; 
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; 
 	uboLayoutBinding.descriptorCount = 1; 
 	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; 
 	uboLayoutBinding.pImmutableSamplers = nullptr; // Optional
@@ -189,22 +211,8 @@ inline void GP2_DescriptorPool<UBO>::CreateDescriptorSetLayout(const VulkanConte
 	}
 }
 
-template<class UBO>
-inline void GP2_DescriptorPool<UBO>::CreateUBOs(const VulkanContext& context)
-{
-	m_UBOs.resize(m_Count);
-	m_UBOsMapped.resize(m_Count);
-	
-	for (int uboIndex = 0; uboIndex < m_Count; ++uboIndex)
-	{
-		m_UBOs[uboIndex] = new GP2_Buffer(context.device, context.physicalDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_Size);
-		m_UBOs[uboIndex]->Map(&m_UBOsMapped[uboIndex]);
-	}
-}
-
 template<class UBO>
 inline void GP2_DescriptorPool<UBO>::SetUBO(UBO src, size_t index)
 {
-	memcpy(m_UBOsMapped[index], &src, m_Size); 
+	m_UBOOffsets[index] = static_cast<uint32_t>(m_pFrameAllocator->Push(src).offset);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "GP2_FrameAllocator.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+void GP2_FrameAllocator::Initialize(const VulkanContext& context, VkDeviceSize frameSize)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+	m_MinAlignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+
+	// every region starts aligned
+	m_FrameSize = (frameSize + m_MinAlignment - 1) / m_MinAlignment * m_MinAlignment;
+
+	// coherent, so writes need no flush before the frame is submitted
+	m_pBuffer = std::make_unique<GP2_Buffer>(context.device, context.physicalDevice,
+		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+		VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_FrameSize * MAX_FRAMES_IN_FLIGHT,
+		GP2_MemoryAllocator::Category::Uniform, "frame allocator");
+
+	void* pMapped{};
+	m_pBuffer->Map(&pMapped);
+	m_pMapped = static_cast<char*>(pMapped);
+
+	m_FrameBegin = 0;
+	m_Head = 0;
+	m_PeakUsage = 0;
+}
+
+void GP2_FrameAllocator::Destroy()
+{
+	if (m_pBuffer)
+	{
+		m_pBuffer->Destroy();
+		m_pBuffer.reset();
+	}
+	m_pMapped = nullptr;
+}
+
+void GP2_FrameAllocator::BeginFrame(uint32_t frameIndex)
+{
+	m_PeakUsage = std::max(m_PeakUsage, m_Head.load() - m_FrameBegin);
+
+	m_FrameBegin = (frameIndex % MAX_FRAMES_IN_FLIGHT) * m_FrameSize;
+	m_Head = m_FrameBegin;
+}
+
+GP2_FrameAllocator::Allocation GP2_FrameAllocator::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	alignment = std::max(alignment, m_MinAlignment);
+
+	// bump the head, racing allocations retry with the head they lost to
+	VkDeviceSize head{ m_Head.load(std::memory_order_relaxed) };
+	VkDeviceSize offset{};
+	do
+	{
+		offset = (head + alignment - 1) / alignment * alignment;
+		if (offset + size > m_FrameBegin + m_FrameSize)
+		{
+			throw std::runtime_error("frame allocator is out of space!");
+		}
+	} while (!m_Head.compare_exchange_weak(head, offset + size, std::memory_order_relaxed));
+
+	return Allocation{ m_pBuffer->GetVkBuffer(), offset, m_pMapped + offset };
+}
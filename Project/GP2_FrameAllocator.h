@@ -0,0 +1,88 @@
+#pragma once
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+
+#include "GP2_Buffer.h"
+#include "vulkanbase/VulkanUtil.h"
+
+// One persistently mapped buffer split into a region per frame in flight, handing out transient per frame data such as
+// uniform blocks, indirect draws and dynamic geometry with a bump pointer. Every allocation is a range of the same VkBuffer,
+// bound with a dynamic descriptor offset, a vertex/index binding offset or an indirect buffer offset, so writing per frame
+// data creates no Vulkan objects.
+// A frame's region is reclaimed as a whole by BeginFrame once the fence of the frame that last used it has signalled.
+// Allocate is thread safe, BeginFrame isn't.
+class GP2_FrameAllocator final
+{
+public:
+	//-----------
+	// Structs
+	//-----------
+	struct Allocation
+	{
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		void* pMapped;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_FrameAllocator() = default;
+	~GP2_FrameAllocator() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_FrameAllocator(const GP2_FrameAllocator&) = delete;
+	GP2_FrameAllocator(GP2_FrameAllocator&&) = delete;
+	GP2_FrameAllocator& operator=(const GP2_FrameAllocator&) = delete;
+	GP2_FrameAllocator& operator=(GP2_FrameAllocator&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// frameSize bytes for each of the MAX_FRAMES_IN_FLIGHT regions
+	void Initialize(const VulkanContext& context, VkDeviceSize frameSize = DefaultFrameSize);
+	void Destroy();
+
+	// Starts allocating from frameIndex's region, only after waiting for the fence of the frame that used it last
+	void BeginFrame(uint32_t frameIndex);
+
+	// Aligned to minUniformBufferOffsetAlignment at least, so any allocation can back a dynamic uniform buffer.
+	// Throws when the frame's region is full.
+	Allocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 1);
+	template <class T>
+	Allocation Push(const T& data);
+
+	VkBuffer GetVkBuffer() const { return m_pBuffer->GetVkBuffer(); }
+	VkDeviceSize GetFrameSize() const { return m_FrameSize; }
+	// the most bytes a frame has used so far
+	VkDeviceSize GetPeakUsage() const { return m_PeakUsage; }
+
+	static constexpr VkDeviceSize DefaultFrameSize{ 4ull * 1024 * 1024 };
+
+private:
+	//-----------
+	// Variables
+	//-----------
+	std::unique_ptr<GP2_Buffer> m_pBuffer{};
+	char* m_pMapped{};
+
+	VkDeviceSize m_FrameSize{};
+	VkDeviceSize m_MinAlignment{ 1 };
+
+	// offsets into the whole buffer, the current frame's region is [m_FrameBegin, m_FrameBegin + m_FrameSize)
+	VkDeviceSize m_FrameBegin{};
+	std::atomic<VkDeviceSize> m_Head{};
+	VkDeviceSize m_PeakUsage{};
+};
+
+template <class T>
+GP2_FrameAllocator::Allocation GP2_FrameAllocator::Push(const T& data)
+{
+	const Allocation allocation{ Allocate(sizeof(T), alignof(T)) };
+	memcpy(allocation.pMapped, &data, sizeof(T));
+	return allocation;
+}
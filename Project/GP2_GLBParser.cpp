@@ -0,0 +1,700 @@
+#include "GP2_GLBParser.h"
+
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	// just enough of a JSON document for the glTF chunk, object members keep their names in names, parallel to elements
+	struct JsonValue
+	{
+		enum class Type { Null, Boolean, Number, String, Array, Object };
+
+		Type type{ Type::Null };
+		double number{};
+		std::string string;
+		std::vector<JsonValue> elements;
+		std::vector<std::string> names;
+
+		const JsonValue* Find(const char* pName) const
+		{
+			for (size_t idx = 0; idx < names.size(); ++idx)
+			{
+				if (names[idx] == pName)
+				{
+					return &elements[idx];
+				}
+			}
+			return nullptr;
+		}
+
+		const JsonValue* At(size_t index) const
+		{
+			return type == Type::Array && index < elements.size() ? &elements[index] : nullptr;
+		}
+	};
+
+	// deeper documents than this aren't glTF
+	constexpr int MaxJsonDepth{ 64 };
+
+	const char* SkipWhitespace(const char* pCursor, const char* pEnd)
+	{
+		while (pCursor < pEnd && (*pCursor == ' ' || *pCursor == '\t' || *pCursor == '\n' || *pCursor == '\r'))
+		{
+			++pCursor;
+		}
+		return pCursor;
+	}
+
+	bool ParseString(const char*& pCursor, const char* pEnd, std::string& string)
+	{
+		// pCursor is on the opening quote
+		++pCursor;
+		string.clear();
+		while (pCursor < pEnd && *pCursor != '"')
+		{
+			if (*pCursor != '\\')
+			{
+				string.push_back(*pCursor++);
+				continue;
+			}
+
+			if (++pCursor == pEnd)
+			{
+				return false;
+			}
+
+			switch (*pCursor++)
+			{
+			case '"': string.push_back('"'); break;
+			case '\\': string.push_back('\\'); break;
+			case '/': string.push_back('/'); break;
+			case 'b': string.push_back('\b'); break;
+			case 'f': string.push_back('\f'); break;
+			case 'n': string.push_back('\n'); break;
+			case 'r': string.push_back('\r'); break;
+			case 't': string.push_back('\t'); break;
+			case 'u':
+			{
+				// names and uris only, a code point outside ASCII is kept as a placeholder
+				uint32_t codePoint{};
+				if (pEnd - pCursor < 4 || std::from_chars(pCursor, pCursor + 4, codePoint, 16).ptr != pCursor + 4)
+				{
+					return false;
+				}
+				pCursor += 4;
+				string.push_back(codePoint < 0x80 ? static_cast<char>(codePoint) : '?');
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		if (pCursor == pEnd)
+		{
+			return false;
+		}
+		++pCursor;
+		return true;
+	}
+
+	bool ParseValue(const char*& pCursor, const char* pEnd, JsonValue& value, int depth)
+	{
+		pCursor = SkipWhitespace(pCursor, pEnd);
+		if (pCursor == pEnd || depth > MaxJsonDepth)
+		{
+			return false;
+		}
+
+		const auto matches{ [&](const char* pLiteral)
+			{
+				const size_t length{ strlen(pLiteral) };
+				if (static_cast<size_t>(pEnd - pCursor) < length || memcmp(pCursor, pLiteral, length) != 0)
+				{
+					return false;
+				}
+				pCursor += length;
+				return true;
+			} };
+
+		switch (*pCursor)
+		{
+		case '{':
+		{
+			value.type = JsonValue::Type::Object;
+			pCursor = SkipWhitespace(pCursor + 1, pEnd);
+			if (pCursor < pEnd && *pCursor == '}')
+			{
+				++pCursor;
+				return true;
+			}
+
+			while (true)
+			{
+				pCursor = SkipWhitespace(pCursor, pEnd);
+				if (pCursor == pEnd || *pCursor != '"' || !ParseString(pCursor, pEnd, value.names.emplace_back()))
+				{
+					return false;
+				}
+
+				pCursor = SkipWhitespace(pCursor, pEnd);
+				if (pCursor == pEnd || *pCursor++ != ':' || !ParseValue(pCursor, pEnd, value.elements.emplace_back(), depth + 1))
+				{
+					return false;
+				}
+
+				pCursor = SkipWhitespace(pCursor, pEnd);
+				if (pCursor == pEnd)
+				{
+					return false;
+				}
+				if (*pCursor == '}')
+				{
+					++pCursor;
+					return true;
+				}
+				if (*pCursor++ != ',')
+				{
+					return false;
+				}
+			}
+		}
+		case '[':
+		{
+			value.type = JsonValue::Type::Array;
+			pCursor = SkipWhitespace(pCursor + 1, pEnd);
+			if (pCursor < pEnd && *pCursor == ']')
+			{
+				++pCursor;
+				return true;
+			}
+
+			while (true)
+			{
+				if (!ParseValue(pCursor, pEnd, value.elements.emplace_back(), depth + 1))
+				{
+					return false;
+				}
+
+				pCursor = SkipWhitespace(pCursor, pEnd);
+				if (pCursor == pEnd)
+				{
+					return false;
+				}
+				if (*pCursor == ']')
+				{
+					++pCursor;
+					return true;
+				}
+				if (*pCursor++ != ',')
+				{
+					return false;
+				}
+			}
+		}
+		case '"':
+			value.type = JsonValue::Type::String;
+			return ParseString(pCursor, pEnd, value.string);
+		case 't':
+			value.type = JsonValue::Type::Boolean;
+			value.number = 1.0;
+			return matches("true");
+		case 'f':
+			value.type = JsonValue::Type::Boolean;
+			return matches("false");
+		case 'n':
+			return matches("null");
+		default:
+		{
+			value.type = JsonValue::Type::Number;
+			const std::from_chars_result result{ std::from_chars(pCursor, pEnd, value.number) };
+			if (result.ec != std::errc{})
+			{
+				return false;
+			}
+			pCursor = result.ptr;
+			return true;
+		}
+		}
+	}
+
+	// every number looked up is an index, count, offset or enum that fits 32 bits, anything else falls back
+	bool IsUint(const JsonValue* pValue)
+	{
+		return pValue && pValue->type == JsonValue::Type::Number && pValue->number >= 0.0 && pValue->number <= double(UINT32_MAX);
+	}
+
+	double GetNumber(const JsonValue* pObject, const char* pName, double fallback)
+	{
+		const JsonValue* pValue{ pObject ? pObject->Find(pName) : nullptr };
+		return IsUint(pValue) ? pValue->number : fallback;
+	}
+
+	const JsonValue* GetElement(const JsonValue* pArray, const JsonValue* pIndex)
+	{
+		return pArray && IsUint(pIndex) ? pArray->At(static_cast<size_t>(pIndex->number)) : nullptr;
+	}
+
+	uint32_t GetComponentSize(uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case 5120: case 5121: return 1;
+		case 5122: case 5123: return 2;
+		case 5125: case 5126: return 4;
+		default: return 0;
+		}
+	}
+
+	uint32_t GetComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0;
+	}
+
+	template<typename SourceType>
+	bool AreIndicesInRange(const char* pSource, uint32_t count, uint32_t vertexCount)
+	{
+		SourceType maxIndex{};
+		for (uint32_t idx = 0; idx < count; ++idx)
+		{
+			SourceType index;
+			memcpy(&index, pSource + size_t(idx) * sizeof(SourceType), sizeof(SourceType));
+			maxIndex = std::max(maxIndex, index);
+		}
+		return count == 0 || maxIndex < vertexCount;
+	}
+
+	template<typename SourceType, typename IndexType>
+	void CopyIndices(const char* pSource, uint32_t count, uint32_t firstVertex, IndexType* pIndices)
+	{
+		for (uint32_t idx = 0; idx < count; ++idx)
+		{
+			SourceType index;
+			memcpy(&index, pSource + size_t(idx) * sizeof(SourceType), sizeof(SourceType));
+			pIndices[idx] = static_cast<IndexType>(firstVertex + index);
+		}
+	}
+}
+
+bool GP2_GLBParser::Open(const std::string& filename, const glm::vec3 color)
+{
+	Close();
+
+	if (!m_File.Open(filename))
+	{
+		std::cerr << "Error: Failed to open file " << filename << std::endl;
+		return false;
+	}
+
+	m_Color = color;
+	if (!ReadPrimitives())
+	{
+		std::cerr << "Error: Malformed glTF data in " << filename << std::endl;
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void GP2_GLBParser::Close()
+{
+	m_File.Close();
+	m_Primitives.clear();
+	m_Submeshes.clear();
+	m_Bounds = MeshBounds{};
+	m_VertexCount = 0;
+	m_IndexCount = 0;
+}
+
+bool GP2_GLBParser::ReadPrimitives()
+{
+	// 12 byte header, then the JSON chunk and an optional BIN chunk, both 4 byte aligned
+	const char* pData{ m_File.GetData() };
+	const size_t size{ m_File.GetSize() };
+
+	uint32_t header[3]{};
+	if (size < sizeof(header) + 8)
+	{
+		return false;
+	}
+	memcpy(header, pData, sizeof(header));
+	if (header[0] != Magic || header[1] != 2 || header[2] > size)
+	{
+		return false;
+	}
+
+	const char* pJson{};
+	size_t jsonSize{};
+	const char* pBin{};
+	size_t binSize{};
+	for (size_t offset = sizeof(header); offset + 8 <= header[2];)
+	{
+		uint32_t chunkHeader[2]{};
+		memcpy(chunkHeader, pData + offset, sizeof(chunkHeader));
+		offset += sizeof(chunkHeader);
+		if (chunkHeader[0] > header[2] - offset)
+		{
+			return false;
+		}
+
+		if (chunkHeader[1] == JsonChunk && !pJson)
+		{
+			pJson = pData + offset;
+			jsonSize = chunkHeader[0];
+		}
+		else if (chunkHeader[1] == BinChunk && !pBin)
+		{
+			pBin = pData + offset;
+			binSize = chunkHeader[0];
+		}
+		offset += (size_t(chunkHeader[0]) + 3) & ~size_t(3);
+	}
+
+	JsonValue root{};
+	const char* pCursor{ pJson };
+	if (!pJson || !ParseValue(pCursor, pJson + jsonSize, root, 0) || root.type != JsonValue::Type::Object)
+	{
+		return false;
+	}
+
+	const JsonValue* pAccessors{ root.Find("accessors") };
+	const JsonValue* pBufferViews{ root.Find("bufferViews") };
+	const JsonValue* pBuffers{ root.Find("buffers") };
+	const JsonValue* pMeshes{ root.Find("meshes") };
+	if (!pMeshes)
+	{
+		// a scene without geometry is still a valid file
+		return true;
+	}
+
+	// only the GLB stored buffer is supported, that's buffer 0 without an uri
+	const JsonValue* pBuffer{ pBuffers ? pBuffers->At(0) : nullptr };
+	const bool hasBinBuffer{ pBin && pBuffer && !pBuffer->Find("uri") };
+
+	const auto resolveAccessor{ [&](const JsonValue* pIndex, Accessor& accessor)
+		{
+			accessor = Accessor{};
+			if (!pIndex)
+			{
+				return true;
+			}
+
+			const JsonValue* pAccessor{ GetElement(pAccessors, pIndex) };
+			const JsonValue* pViewIndex{ pAccessor ? pAccessor->Find("bufferView") : nullptr };
+			const JsonValue* pType{ pAccessor ? pAccessor->Find("type") : nullptr };
+			if (!pViewIndex || !pType || pAccessor->Find("sparse") || !hasBinBuffer)
+			{
+				return false;
+			}
+
+			const JsonValue* pView{ GetElement(pBufferViews, pViewIndex) };
+			if (!pView || GetNumber(pView, "buffer", 0.0) != 0.0)
+			{
+				return false;
+			}
+
+			accessor.componentType = static_cast<uint32_t>(GetNumber(pAccessor, "componentType", 0.0));
+			accessor.componentCount = GetComponentCount(pType->string);
+			accessor.count = static_cast<uint32_t>(GetNumber(pAccessor, "count", 0.0));
+			const JsonValue* pNormalized{ pAccessor->Find("normalized") };
+			accessor.isNormalized = pNormalized && pNormalized->number != 0.0;
+
+			const size_t elementSize{ size_t(GetComponentSize(accessor.componentType)) * accessor.componentCount };
+			const size_t viewOffset{ static_cast<size_t>(GetNumber(pView, "byteOffset", 0.0)) };
+			const size_t viewLength{ static_cast<size_t>(GetNumber(pView, "byteLength", 0.0)) };
+			const size_t accessorOffset{ static_cast<size_t>(GetNumber(pAccessor, "byteOffset", 0.0)) };
+			accessor.stride = static_cast<uint32_t>(GetNumber(pView, "byteStride", static_cast<double>(elementSize)));
+
+			// the last element has to end inside the view and the view inside the BIN chunk
+			if (elementSize == 0 || accessor.stride < elementSize || viewOffset + viewLength > binSize ||
+				(accessor.count > 0 && accessorOffset + size_t(accessor.count - 1) * accessor.stride + elementSize > viewLength))
+			{
+				return false;
+			}
+
+			accessor.pData = pBin + viewOffset + accessorOffset;
+			return true;
+		} };
+
+	for (const JsonValue& mesh : pMeshes->elements)
+	{
+		const JsonValue* pPrimitives{ mesh.Find("primitives") };
+		if (!pPrimitives)
+		{
+			continue;
+		}
+
+		for (const JsonValue& primitiveValue : pPrimitives->elements)
+		{
+			if (GetNumber(&primitiveValue, "mode", TriangleMode) != TriangleMode)
+			{
+				std::cerr << "Warning: skipped a glTF primitive that isn't a triangle list" << std::endl;
+				continue;
+			}
+
+			const JsonValue* pAttributes{ primitiveValue.Find("attributes") };
+			const JsonValue* pPosition{ pAttributes ? pAttributes->Find("POSITION") : nullptr };
+			if (!pPosition)
+			{
+				continue;
+			}
+
+			Primitive primitive{};
+			if (!resolveAccessor(pPosition, primitive.positions) ||
+				!resolveAccessor(pAttributes->Find("NORMAL"), primitive.normals) ||
+				!resolveAccessor(pAttributes->Find("TEXCOORD_0"), primitive.texCoords) ||
+				!resolveAccessor(pAttributes->Find("COLOR_0"), primitive.colors) ||
+				!resolveAccessor(primitiveValue.Find("indices"), primitive.indices))
+			{
+				return false;
+			}
+
+			// every attribute has to cover every vertex, indices have to be unsigned integers
+			const Accessor& positions{ primitive.positions };
+			const auto isAttributeValid{ [&](const Accessor& accessor, uint32_t minComponents)
+				{
+					return !accessor.pData || (accessor.count == positions.count && accessor.componentCount >= minComponents);
+				} };
+			const uint32_t indexType{ primitive.indices.componentType };
+			if (positions.componentType != ComponentFloat || positions.componentCount != 3 ||
+				!isAttributeValid(primitive.normals, 3) || !isAttributeValid(primitive.texCoords, 2) || !isAttributeValid(primitive.colors, 3) ||
+				(primitive.normals.pData && primitive.normals.componentType != ComponentFloat) ||
+				(primitive.indices.pData && (primitive.indices.componentCount != 1 || primitive.indices.stride != GetComponentSize(indexType) ||
+											 (indexType != ComponentByte && indexType != ComponentShort && indexType != ComponentInt))))
+			{
+				return false;
+			}
+
+			// checked once here so the writes can't fail and never reference another primitive's vertices
+			const bool areIndicesInRange{ !primitive.indices.pData ||
+				(indexType == ComponentByte && AreIndicesInRange<uint8_t>(primitive.indices.pData, primitive.indices.count, positions.count)) ||
+				(indexType == ComponentShort && AreIndicesInRange<uint16_t>(primitive.indices.pData, primitive.indices.count, positions.count)) ||
+				(indexType == ComponentInt && AreIndicesInRange<uint32_t>(primitive.indices.pData, primitive.indices.count, positions.count)) };
+			if (!areIndicesInRange)
+			{
+				return false;
+			}
+
+			const uint64_t sourceIndexCount{ primitive.indices.pData ? primitive.indices.count : positions.count };
+			const uint32_t indexCount{ static_cast<uint32_t>(sourceIndexCount - sourceIndexCount % 3) };
+			if (uint64_t(m_VertexCount) + positions.count > UINT32_MAX || uint64_t(m_IndexCount) + indexCount > UINT32_MAX)
+			{
+				return false;
+			}
+
+			// positions get flipped like the vertices, so the accessor bounds are flipped along
+			const JsonValue* pMin{ GetElement(pAccessors, pPosition)->Find("min") };
+			const JsonValue* pMax{ GetElement(pAccessors, pPosition)->Find("max") };
+			if (pMin && pMax && pMin->elements.size() == 3 && pMax->elements.size() == 3 && positions.count > 0)
+			{
+				const glm::vec3 minimum{ float(pMin->elements[0].number), -float(pMax->elements[1].number), -float(pMax->elements[2].number) };
+				const glm::vec3 maximum{ float(pMax->elements[0].number), -float(pMin->elements[1].number), -float(pMin->elements[2].number) };
+				const bool isFirst{ m_VertexCount == 0 };
+				m_Bounds.min = isFirst ? minimum : glm::min(m_Bounds.min, minimum);
+				m_Bounds.max = isFirst ? maximum : glm::max(m_Bounds.max, maximum);
+			}
+
+			primitive.firstVertex = m_VertexCount;
+			m_Submeshes.push_back(Submesh{ m_IndexCount, indexCount, 0 });
+			m_Primitives.push_back(primitive);
+			m_VertexCount += positions.count;
+			m_IndexCount += indexCount;
+		}
+	}
+
+	return true;
+}
+
+void GP2_GLBParser::WriteVertices(Vertex3D* pVertices) const
+{
+	for (const Primitive& primitive : m_Primitives)
+	{
+		WritePrimitiveVertices(primitive, pVertices + primitive.firstVertex);
+	}
+}
+
+void GP2_GLBParser::WriteIndices(void* pIndices, VkIndexType indexType) const
+{
+	for (size_t idx = 0; idx < m_Primitives.size(); ++idx)
+	{
+		const Submesh& submesh{ m_Submeshes[idx] };
+		if (indexType == VK_INDEX_TYPE_UINT16)
+		{
+			WritePrimitiveIndices(m_Primitives[idx], submesh.indexCount, static_cast<uint16_t*>(pIndices) + submesh.firstIndex);
+		}
+		else
+		{
+			WritePrimitiveIndices(m_Primitives[idx], submesh.indexCount, static_cast<uint32_t*>(pIndices) + submesh.firstIndex);
+		}
+	}
+}
+
+bool GP2_GLBParser::Parse(const std::string& filename, const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices,
+						  std::vector<Submesh>& submeshes)
+{
+	if (!Open(filename, color))
+	{
+		return false;
+	}
+
+	const size_t firstVertex{ vertices.size() };
+	const size_t firstIndex{ indices.size() };
+	vertices.resize(firstVertex + m_VertexCount);
+	indices.resize(firstIndex + m_IndexCount);
+	WriteVertices(vertices.data() + firstVertex);
+	WriteIndices(indices.data() + firstIndex, VK_INDEX_TYPE_UINT32);
+
+	for (uint32_t idx = static_cast<uint32_t>(firstIndex); idx < indices.size(); ++idx)
+	{
+		indices[idx] += static_cast<uint32_t>(firstVertex);
+	}
+	for (const Submesh& submesh : m_Submeshes)
+	{
+		submeshes.push_back(Submesh{ submesh.firstIndex + static_cast<uint32_t>(firstIndex), submesh.indexCount, 0 });
+	}
+
+	Close();
+	return true;
+}
+
+void GP2_GLBParser::WritePrimitiveVertices(const Primitive& primitive, Vertex3D* pVertices) const
+{
+	const Accessor& positions{ primitive.positions };
+	const Accessor& normals{ primitive.normals };
+	const Accessor& texCoords{ primitive.texCoords };
+	const Accessor& colors{ primitive.colors };
+
+	// Every vertex is assembled in registers and stored whole, in order, which is what write-combined staging memory wants.
+	// The common all-float layout reads every attribute with a fixed stride and no per-component conversion.
+	if ((!texCoords.pData || texCoords.componentType == ComponentFloat) && !colors.pData)
+	{
+		for (uint32_t idx = 0; idx < positions.count; ++idx)
+		{
+			Vertex3D vertex{};
+			memcpy(&vertex.position, positions.pData + size_t(idx) * positions.stride, sizeof(glm::vec3));
+			vertex.position.y = -vertex.position.y;
+			vertex.position.z = -vertex.position.z;
+			vertex.color = m_Color;
+
+			if (normals.pData)
+			{
+				memcpy(&vertex.normal, normals.pData + size_t(idx) * normals.stride, sizeof(glm::vec3));
+				vertex.normal.y = -vertex.normal.y;
+				vertex.normal.z = -vertex.normal.z;
+			}
+			if (texCoords.pData)
+			{
+				memcpy(&vertex.texCoord, texCoords.pData + size_t(idx) * texCoords.stride, sizeof(glm::vec2));
+			}
+
+			pVertices[idx] = vertex;
+		}
+		return;
+	}
+
+	for (uint32_t idx = 0; idx < positions.count; ++idx)
+	{
+		float values[4]{};
+		Vertex3D vertex{};
+
+		ReadFloats(positions, idx, values);
+		vertex.position = glm::vec3{ values[0], -values[1], -values[2] };
+		vertex.color = m_Color;
+
+		if (normals.pData)
+		{
+			ReadFloats(normals, idx, values);
+			vertex.normal = glm::vec3{ values[0], -values[1], -values[2] };
+		}
+		if (texCoords.pData)
+		{
+			ReadFloats(texCoords, idx, values);
+			vertex.texCoord = glm::vec2{ values[0], values[1] };
+		}
+		if (colors.pData)
+		{
+			ReadFloats(colors, idx, values);
+			vertex.color = glm::vec3{ values[0], values[1], values[2] };
+		}
+
+		pVertices[idx] = vertex;
+	}
+}
+
+template<typename IndexType>
+void GP2_GLBParser::WritePrimitiveIndices(const Primitive& primitive, uint32_t indexCount, IndexType* pIndices) const
+{
+	const Accessor& indices{ primitive.indices };
+	if (!indices.pData)
+	{
+		for (uint32_t idx = 0; idx < indexCount; ++idx)
+		{
+			pIndices[idx] = static_cast<IndexType>(primitive.firstVertex + idx);
+		}
+		return;
+	}
+
+	switch (indices.componentType)
+	{
+	case ComponentByte:
+		CopyIndices<uint8_t>(indices.pData, indexCount, primitive.firstVertex, pIndices);
+		break;
+	case ComponentShort:
+		CopyIndices<uint16_t>(indices.pData, indexCount, primitive.firstVertex, pIndices);
+		break;
+	default:
+		CopyIndices<uint32_t>(indices.pData, indexCount, primitive.firstVertex, pIndices);
+		break;
+	}
+}
+
+void GP2_GLBParser::ReadFloats(const Accessor& accessor, uint32_t index, float* pValues)
+{
+	const char* pElement{ accessor.pData + size_t(index) * accessor.stride };
+	for (uint32_t component = 0; component < accessor.componentCount; ++component)
+	{
+		switch (accessor.componentType)
+		{
+		case ComponentFloat:
+			memcpy(&pValues[component], pElement + component * sizeof(float), sizeof(float));
+			break;
+		case ComponentByte:
+		{
+			const float value{ static_cast<float>(reinterpret_cast<const uint8_t*>(pElement)[component]) };
+			pValues[component] = accessor.isNormalized ? value / 255.f : value;
+			break;
+		}
+		case ComponentSignedByte:
+		{
+			const float value{ static_cast<float>(reinterpret_cast<const int8_t*>(pElement)[component]) };
+			pValues[component] = accessor.isNormalized ? std::max(value / 127.f, -1.f) : value;
+			break;
+		}
+		case ComponentShort:
+		{
+			uint16_t value;
+			memcpy(&value, pElement + component * sizeof(uint16_t), sizeof(uint16_t));
+			pValues[component] = accessor.isNormalized ? value / 65535.f : static_cast<float>(value);
+			break;
+		}
+		case ComponentSignedShort:
+		{
+			int16_t value;
+			memcpy(&value, pElement + component * sizeof(int16_t), sizeof(int16_t));
+			pValues[component] = accessor.isNormalized ? std::max(value / 32767.f, -1.f) : static_cast<float>(value);
+			break;
+		}
+		default:
+			pValues[component] = 0.f;
+			break;
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "Vertex.h"
+#include "GP2_MappedFile.h"
+
+// Binary glTF 2.0 (.glb) reader. The file stays mapped after Open and the accessors are read straight out of the
+// BIN chunk, so the vertices and indices can be written into mapped staging memory without a CPU copy of the mesh.
+// Every triangle primitive of every mesh becomes a Submesh of one shared vertex and index buffer.
+// Node transforms, sparse accessors and external buffers aren't supported, positions and normals get the same
+// y and z flip as GP2_OBJParser so both formats of one asset line up.
+class GP2_GLBParser final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_GLBParser() = default;
+	~GP2_GLBParser() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_GLBParser(const GP2_GLBParser&) = delete;
+	GP2_GLBParser(GP2_GLBParser&&) = delete;
+	GP2_GLBParser& operator=(const GP2_GLBParser&) = delete;
+	GP2_GLBParser& operator=(GP2_GLBParser&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// Maps the file and resolves the primitives, vertices without COLOR_0 get color.
+	// Returns false when the file isn't a valid .glb or an accessor points outside the BIN chunk.
+	bool Open(const std::string& filename, const glm::vec3 color);
+	void Close();
+
+	// Interleaves GetVertexCount() vertices into pVertices, one pass over every primitive
+	void WriteVertices(Vertex3D* pVertices) const;
+	// Writes GetIndexCount() indices narrowed to indexType, already offset to the shared vertex buffer
+	void WriteIndices(void* pIndices, VkIndexType indexType) const;
+
+	// Open, then appends to vertices and indices like GP2_OBJParser::Parse, the submeshes are offset the same way
+	bool Parse(const std::string& filename, const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices,
+			   std::vector<Submesh>& submeshes);
+
+	bool IsOpen() const { return m_File.IsOpen(); }
+	uint32_t GetVertexCount() const { return m_VertexCount; }
+	uint32_t GetIndexCount() const { return m_IndexCount; }
+	// from the POSITION accessor min and max the format requires, so no pass over the vertices is needed
+	const MeshBounds& GetBounds() const { return m_Bounds; }
+	const std::vector<Submesh>& GetSubmeshes() const { return m_Submeshes; }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Accessor
+	{
+		const char* pData;
+		uint32_t count;
+		uint32_t stride;
+		uint32_t componentType;
+		uint32_t componentCount;
+		bool isNormalized;
+	};
+
+	struct Primitive
+	{
+		Accessor positions;
+		Accessor normals;
+		Accessor texCoords;
+		Accessor colors;
+		Accessor indices;
+		uint32_t firstVertex;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// Walks the JSON chunk, fills m_Primitives, m_Submeshes and the totals
+	bool ReadPrimitives();
+	void WritePrimitiveVertices(const Primitive& primitive, Vertex3D* pVertices) const;
+	template<typename IndexType>
+	void WritePrimitiveIndices(const Primitive& primitive, uint32_t indexCount, IndexType* pIndices) const;
+
+	static void ReadFloats(const Accessor& accessor, uint32_t index, float* pValues);
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t Magic{ 0x46546C67 };
+	static constexpr uint32_t JsonChunk{ 0x4E4F534A };
+	static constexpr uint32_t BinChunk{ 0x004E4942 };
+
+	static constexpr uint32_t ComponentSignedByte{ 5120 };
+	static constexpr uint32_t ComponentByte{ 5121 };
+	static constexpr uint32_t ComponentSignedShort{ 5122 };
+	static constexpr uint32_t ComponentShort{ 5123 };
+	static constexpr uint32_t ComponentInt{ 5125 };
+	static constexpr uint32_t ComponentFloat{ 5126 };
+	static constexpr uint32_t TriangleMode{ 4 };
+
+	GP2_MappedFile m_File{};
+	glm::vec3 m_Color{};
+
+	std::vector<Primitive> m_Primitives;
+	std::vector<Submesh> m_Submeshes;
+	MeshBounds m_Bounds{};
+	uint32_t m_VertexCount{};
+	uint32_t m_IndexCount{};
+};
@@ -0,0 +1,305 @@
+#include "GP2_GeometryArena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void GP2_GeometryArena::Initialize(const VulkanContext& context, GP2_UploadContext& uploadContext, uint32_t vertexStride,
+								   uint32_t vertexCapacity, VkDeviceSize indexCapacityBytes)
+{
+	m_Context = context;
+	m_pUploadContext = &uploadContext;
+	m_VertexStride = vertexStride;
+	m_VertexCapacity = std::max(vertexCapacity, 1u);
+	m_IndexUnitCapacity = std::max<uint64_t>(indexCapacityBytes / IndexUnitSize, 2);
+}
+
+void GP2_GeometryArena::Destroy()
+{
+	for (RetiredBuffers& retired : m_RetiredBuffers)
+	{
+		retired.vertexBuffer.Destroy();
+		retired.indexBuffer.Destroy();
+	}
+	m_RetiredBuffers.clear();
+
+	if (m_pVertexBuffer)
+	{
+		m_pVertexBuffer->Destroy();
+		m_pIndexBuffer->Destroy();
+		m_pVertexBuffer.reset();
+		m_pIndexBuffer.reset();
+	}
+
+	m_Ranges.clear();
+	m_RangeAllocations.clear();
+	m_UnusedHandles.clear();
+	m_RangeCount = 0;
+}
+
+uint32_t GP2_GeometryArena::Allocate(uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType)
+{
+	if (!m_pVertexBuffer)
+	{
+		Reallocate(m_VertexCapacity, m_IndexUnitCapacity);
+	}
+
+	const uint64_t indexUnitCount{ GetIndexUnitCount(indexCount, indexType) };
+	const uint64_t indexAlignment{ indexType == VK_INDEX_TYPE_UINT32 ? 2ull : 1ull };
+
+	RangeAllocation allocation{};
+	if (!TryAllocate(vertexCount, indexUnitCount, indexAlignment, allocation))
+	{
+		// compacting is tried first when the free space adds up
+		uint32_t vertexCapacity{ m_VertexCapacity };
+		uint64_t indexUnitCapacity{ m_IndexUnitCapacity };
+		while (vertexCapacity - m_VertexAllocator.GetUsedSize() < uint64_t(vertexCount) + 1)
+		{
+			vertexCapacity *= 2;
+		}
+		while (indexUnitCapacity - m_IndexAllocator.GetUsedSize() < indexUnitCount + indexAlignment)
+		{
+			indexUnitCapacity *= 2;
+		}
+		Reallocate(vertexCapacity, indexUnitCapacity);
+
+		// the packed free space can still be just below the size class searched for
+		while (!TryAllocate(vertexCount, indexUnitCount, indexAlignment, allocation))
+		{
+			Reallocate(m_VertexCapacity * 2, m_IndexUnitCapacity * 2);
+		}
+	}
+
+	uint32_t handle{};
+	if (m_UnusedHandles.empty())
+	{
+		handle = static_cast<uint32_t>(m_Ranges.size());
+		m_Ranges.emplace_back();
+		m_RangeAllocations.emplace_back();
+	}
+	else
+	{
+		handle = m_UnusedHandles.back();
+		m_UnusedHandles.pop_back();
+	}
+
+	m_Ranges[handle] = Range{ 0, vertexCount, 0, indexCount, indexType };
+	m_RangeAllocations[handle] = allocation;
+	UpdateRange(handle);
+	++m_RangeCount;
+	return handle;
+}
+
+void GP2_GeometryArena::Free(uint32_t handle)
+{
+	// after Destroy there's nothing left to free
+	if (handle >= m_RangeAllocations.size() || m_RangeAllocations[handle].vertexHandle == GP2_TLSFAllocator::InvalidHandle)
+	{
+		return;
+	}
+
+	m_VertexAllocator.Free(m_RangeAllocations[handle].vertexHandle);
+	m_IndexAllocator.Free(m_RangeAllocations[handle].indexHandle);
+	m_RangeAllocations[handle] = RangeAllocation{ GP2_TLSFAllocator::InvalidHandle, GP2_TLSFAllocator::InvalidHandle };
+	m_UnusedHandles.push_back(handle);
+	--m_RangeCount;
+}
+
+void GP2_GeometryArena::Update()
+{
+	++m_Frame;
+
+	// the copies out of them have finished and so has every frame that was submitted before the reallocation
+	const auto isUnused{ [this](const RetiredBuffers& retired)
+	{
+		return m_Frame - retired.frame > MAX_FRAMES_IN_FLIGHT && m_pUploadContext->IsComplete(retired.uploadValue);
+	} };
+
+	for (RetiredBuffers& retired : m_RetiredBuffers)
+	{
+		if (isUnused(retired))
+		{
+			retired.vertexBuffer.Destroy();
+			retired.indexBuffer.Destroy();
+		}
+	}
+	m_RetiredBuffers.erase(std::remove_if(m_RetiredBuffers.begin(), m_RetiredBuffers.end(), isUnused), m_RetiredBuffers.end());
+}
+
+void GP2_GeometryArena::Compact()
+{
+	if (m_pVertexBuffer)
+	{
+		Reallocate(m_VertexCapacity, m_IndexUnitCapacity);
+	}
+}
+
+VkDeviceSize GP2_GeometryArena::GetIndexByteOffset(uint32_t handle) const
+{
+	return m_IndexAllocator.GetOffset(m_RangeAllocations[handle].indexHandle) * IndexUnitSize;
+}
+
+void GP2_GeometryArena::Bind(VkCommandBuffer commandBuffer, uint32_t handle, BindState& state) const
+{
+	const VkBuffer vertexBuffer{ m_pVertexBuffer->GetVkBuffer() };
+	if (state.vertexBuffer != vertexBuffer)
+	{
+		const VkDeviceSize offset{ 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		state.vertexBuffer = vertexBuffer;
+		++state.bindCount;
+	}
+
+	const VkBuffer indexBuffer{ m_pIndexBuffer->GetVkBuffer() };
+	const VkIndexType indexType{ m_Ranges[handle].indexType };
+	if (state.indexBuffer != indexBuffer || state.indexType != indexType)
+	{
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+		state.indexBuffer = indexBuffer;
+		state.indexType = indexType;
+		++state.bindCount;
+	}
+}
+
+GP2_GeometryArena::Stats GP2_GeometryArena::GetStats() const
+{
+	Stats stats{};
+	stats.rangeCount = m_RangeCount;
+	stats.vertexCapacity = m_VertexCapacity;
+	stats.usedVertexCount = static_cast<uint32_t>(m_VertexAllocator.GetUsedSize());
+	stats.indexCapacityBytes = m_IndexUnitCapacity * IndexUnitSize;
+	stats.usedIndexBytes = m_IndexAllocator.GetUsedSize() * IndexUnitSize;
+	stats.reallocationCount = m_ReallocationCount;
+	return stats;
+}
+
+void GP2_GeometryArena::PrintStats(std::ostream& stream, const char* name) const
+{
+	const Stats stats{ GetStats() };
+	stream << name << " geometry: " << stats.rangeCount << " meshes, " << stats.usedVertexCount << " of " << stats.vertexCapacity << " vertices, "
+		   << stats.usedIndexBytes / 1024.0 << " of " << stats.indexCapacityBytes / 1024.0 << " KB of indices, "
+		   << stats.reallocationCount << " reallocations" << std::endl;
+}
+
+void GP2_GeometryArena::PrintBinds(std::ostream& stream, const char* name, uint32_t drawnMeshCount, const BindState& state)
+{
+	stream << name << ": " << drawnMeshCount << " meshes drawn with " << state.bindCount << " buffer binds, "
+		   << drawnMeshCount * 2 << " with buffers per mesh" << std::endl;
+}
+
+bool GP2_GeometryArena::TryAllocate(uint32_t vertexCount, uint64_t indexUnitCount, uint64_t indexAlignment, RangeAllocation& allocation)
+{
+	allocation.vertexHandle = m_VertexAllocator.Allocate(std::max(vertexCount, 1u), 1);
+	if (allocation.vertexHandle == GP2_TLSFAllocator::InvalidHandle)
+	{
+		return false;
+	}
+
+	allocation.indexHandle = m_IndexAllocator.Allocate(std::max<uint64_t>(indexUnitCount, 1), indexAlignment);
+	if (allocation.indexHandle == GP2_TLSFAllocator::InvalidHandle)
+	{
+		m_VertexAllocator.Free(allocation.vertexHandle);
+		return false;
+	}
+
+	return true;
+}
+
+void GP2_GeometryArena::Reallocate(uint32_t vertexCapacity, uint64_t indexUnitCapacity)
+{
+	std::unique_ptr<GP2_Buffer> pVertexBuffer{ std::make_unique<GP2_Buffer>(m_Context.device, m_Context.physicalDevice,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VkDeviceSize(vertexCapacity) * m_VertexStride,
+		GP2_MemoryAllocator::Category::Geometry, "arena vertices, stride " + std::to_string(m_VertexStride)) };
+	std::unique_ptr<GP2_Buffer> pIndexBuffer{ std::make_unique<GP2_Buffer>(m_Context.device, m_Context.physicalDevice,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexUnitCapacity * IndexUnitSize,
+		GP2_MemoryAllocator::Category::Geometry, "arena indices, stride " + std::to_string(m_VertexStride)) };
+
+	GP2_TLSFAllocator vertexAllocator{};
+	vertexAllocator.Initialize(vertexCapacity);
+	GP2_TLSFAllocator indexAllocator{};
+	indexAllocator.Initialize(indexUnitCapacity);
+
+	// a fresh allocator hands out its range front to back, so the live ranges end up packed
+	std::vector<VkBufferCopy> vertexCopies;
+	std::vector<VkBufferCopy> indexCopies;
+	for (uint32_t handle = 0; handle < m_RangeAllocations.size(); ++handle)
+	{
+		RangeAllocation& allocation{ m_RangeAllocations[handle] };
+		if (allocation.vertexHandle == GP2_TLSFAllocator::InvalidHandle)
+		{
+			continue;
+		}
+
+		const Range& range{ m_Ranges[handle] };
+		const uint64_t indexUnitCount{ GetIndexUnitCount(range.indexCount, range.indexType) };
+		const VkDeviceSize srcVertexOffset{ m_VertexAllocator.GetOffset(allocation.vertexHandle) * m_VertexStride };
+		const VkDeviceSize srcIndexOffset{ m_IndexAllocator.GetOffset(allocation.indexHandle) * IndexUnitSize };
+
+		allocation.vertexHandle = vertexAllocator.Allocate(std::max(range.vertexCount, 1u), 1);
+		allocation.indexHandle = indexAllocator.Allocate(std::max<uint64_t>(indexUnitCount, 1), range.indexType == VK_INDEX_TYPE_UINT32 ? 2 : 1);
+		if (allocation.vertexHandle == GP2_TLSFAllocator::InvalidHandle || allocation.indexHandle == GP2_TLSFAllocator::InvalidHandle)
+		{
+			throw std::runtime_error("geometry arena reallocation doesn't fit its ranges!");
+		}
+
+		vertexCopies.push_back(VkBufferCopy{ srcVertexOffset, vertexAllocator.GetOffset(allocation.vertexHandle) * m_VertexStride,
+											 VkDeviceSize(range.vertexCount) * m_VertexStride });
+		indexCopies.push_back(VkBufferCopy{ srcIndexOffset, indexAllocator.GetOffset(allocation.indexHandle) * IndexUnitSize,
+											indexUnitCount * IndexUnitSize });
+	}
+
+	if (m_pVertexBuffer)
+	{
+		const VkCommandBuffer commandBuffer{ m_pUploadContext->GetCommandBuffer() };
+
+		// uploads into the old buffers recorded before have to land before they're copied out
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		vertexCopies.erase(std::remove_if(vertexCopies.begin(), vertexCopies.end(), [](const VkBufferCopy& copy) { return copy.size == 0; }), vertexCopies.end());
+		indexCopies.erase(std::remove_if(indexCopies.begin(), indexCopies.end(), [](const VkBufferCopy& copy) { return copy.size == 0; }), indexCopies.end());
+		if (!vertexCopies.empty())
+		{
+			vkCmdCopyBuffer(commandBuffer, m_pVertexBuffer->GetVkBuffer(), pVertexBuffer->GetVkBuffer(), static_cast<uint32_t>(vertexCopies.size()), vertexCopies.data());
+		}
+		if (!indexCopies.empty())
+		{
+			vkCmdCopyBuffer(commandBuffer, m_pIndexBuffer->GetVkBuffer(), pIndexBuffer->GetVkBuffer(), static_cast<uint32_t>(indexCopies.size()), indexCopies.data());
+		}
+
+		m_RetiredBuffers.push_back(RetiredBuffers{ m_pUploadContext->GetRecordingValue(), m_Frame, *m_pVertexBuffer, *m_pIndexBuffer });
+		++m_ReallocationCount;
+	}
+
+	m_pVertexBuffer = std::move(pVertexBuffer);
+	m_pIndexBuffer = std::move(pIndexBuffer);
+	m_VertexAllocator = std::move(vertexAllocator);
+	m_IndexAllocator = std::move(indexAllocator);
+	m_VertexCapacity = vertexCapacity;
+	m_IndexUnitCapacity = indexUnitCapacity;
+
+	for (uint32_t handle = 0; handle < m_RangeAllocations.size(); ++handle)
+	{
+		if (m_RangeAllocations[handle].vertexHandle != GP2_TLSFAllocator::InvalidHandle)
+		{
+			UpdateRange(handle);
+		}
+	}
+}
+
+void GP2_GeometryArena::UpdateRange(uint32_t handle)
+{
+	Range& range{ m_Ranges[handle] };
+	const RangeAllocation& allocation{ m_RangeAllocations[handle] };
+	range.vertexOffset = static_cast<uint32_t>(m_VertexAllocator.GetOffset(allocation.vertexHandle));
+	range.firstIndex = static_cast<uint32_t>(m_IndexAllocator.GetOffset(allocation.indexHandle) / (range.indexType == VK_INDEX_TYPE_UINT32 ? 2 : 1));
+}
+
+uint64_t GP2_GeometryArena::GetIndexUnitCount(uint32_t indexCount, VkIndexType indexType)
+{
+	return indexType == VK_INDEX_TYPE_UINT32 ? uint64_t(indexCount) * 2 : indexCount;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+
+#include "GP2_Buffer.h"
+#include "GP2_TLSFAllocator.h"
+#include "GP2_UploadContext.h"
+#include "vulkanbase/VulkanUtil.h"
+
+// One device local vertex buffer and one index buffer shared by every mesh of a vertex layout. Meshes own ranges of
+// them and draw with firstIndex and vertexOffset, so a whole mesh list is drawn from a single bind, ready for one
+// multi-draw indirect. Vertices are sub-allocated in whole vertices, indices in 16-bit units with 32-bit indices
+// starting on 4 bytes, so the index buffer is bound once per index type. When a range doesn't fit the live ranges are
+// copied, packed, into new buffers, twice as large unless compacting was enough. Render thread only.
+class GP2_GeometryArena final
+{
+public:
+	static constexpr uint32_t InvalidHandle{ UINT32_MAX };
+
+	//-----------
+	// Structs
+	//-----------
+	// in the arena's units, vertexOffset in vertices and firstIndex in indices of indexType
+	struct Range
+	{
+		uint32_t vertexOffset;
+		uint32_t vertexCount;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		VkIndexType indexType;
+	};
+
+	// What a command buffer has bound, consecutive draws out of the same buffers skip their binds
+	struct BindState
+	{
+		VkBuffer vertexBuffer;
+		VkBuffer indexBuffer;
+		VkIndexType indexType;
+		uint32_t bindCount;
+	};
+
+	struct Stats
+	{
+		uint32_t rangeCount;
+		uint32_t vertexCapacity;
+		uint32_t usedVertexCount;
+		VkDeviceSize indexCapacityBytes;
+		VkDeviceSize usedIndexBytes;
+		uint32_t reallocationCount;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_GeometryArena() = default;
+	~GP2_GeometryArena() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_GeometryArena(const GP2_GeometryArena&) = delete;
+	GP2_GeometryArena(GP2_GeometryArena&&) = delete;
+	GP2_GeometryArena& operator=(const GP2_GeometryArena&) = delete;
+	GP2_GeometryArena& operator=(GP2_GeometryArena&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// The buffers are created on the first Allocate
+	void Initialize(const VulkanContext& context, GP2_UploadContext& uploadContext, uint32_t vertexStride,
+					uint32_t vertexCapacity = DefaultVertexCapacity, VkDeviceSize indexCapacityBytes = DefaultIndexCapacityBytes);
+	// Nothing may draw from the arena anymore
+	void Destroy();
+
+	// Reserves the ranges of a mesh, compacting or growing the buffers when they don't fit. That records copies into
+	// the upload context and moves every range, so submit the upload context before the next frame draws from the arena.
+	uint32_t Allocate(uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType);
+	void Free(uint32_t handle);
+	// Destroys the buffers replaced by a reallocation once nothing uses them anymore, once per frame
+	void Update();
+
+	// Moves every range to the front of new buffers of the same size, same rules as Allocate
+	void Compact();
+
+	const Range& GetRange(uint32_t handle) const { return m_Ranges[handle]; }
+	GP2_Buffer& GetVertexBuffer() { return *m_pVertexBuffer; }
+	GP2_Buffer& GetIndexBuffer() { return *m_pIndexBuffer; }
+	VkDeviceSize GetVertexByteOffset(uint32_t handle) const { return VkDeviceSize(m_Ranges[handle].vertexOffset) * m_VertexStride; }
+	VkDeviceSize GetIndexByteOffset(uint32_t handle) const;
+	uint32_t GetVertexStride() const { return m_VertexStride; }
+
+	// Binds the arena's buffers for a draw of the range unless state says they are bound already
+	void Bind(VkCommandBuffer commandBuffer, uint32_t handle, BindState& state) const;
+
+	Stats GetStats() const;
+	void PrintStats(std::ostream& stream, const char* name) const;
+	// The binds of a recorded mesh list against the two per mesh it took with a vertex and index buffer of its own
+	static void PrintBinds(std::ostream& stream, const char* name, uint32_t drawnMeshCount, const BindState& state);
+
+	static constexpr uint32_t DefaultVertexCapacity{ 1u << 16 };
+	static constexpr VkDeviceSize DefaultIndexCapacityBytes{ 1ull << 20 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct RangeAllocation
+	{
+		uint32_t vertexHandle;
+		uint32_t indexHandle;
+	};
+
+	struct RetiredBuffers
+	{
+		uint64_t uploadValue;
+		uint32_t frame;
+		GP2_Buffer vertexBuffer;
+		GP2_Buffer indexBuffer;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// sizes in the allocators' units
+	bool TryAllocate(uint32_t vertexCount, uint64_t indexUnitCount, uint64_t indexAlignment, RangeAllocation& allocation);
+	// copies every live range, packed, into new buffers of the given capacity
+	void Reallocate(uint32_t vertexCapacity, uint64_t indexUnitCapacity);
+	void UpdateRange(uint32_t handle);
+
+	static uint64_t GetIndexUnitCount(uint32_t indexCount, VkIndexType indexType);
+
+	//-----------
+	// Variables
+	//-----------
+	// indices are allocated in 16-bit units
+	static constexpr VkDeviceSize IndexUnitSize{ sizeof(uint16_t) };
+
+	VulkanContext m_Context{};
+	GP2_UploadContext* m_pUploadContext{};
+	uint32_t m_VertexStride{};
+	uint32_t m_VertexCapacity{};
+	uint64_t m_IndexUnitCapacity{};
+
+	std::unique_ptr<GP2_Buffer> m_pVertexBuffer{};
+	std::unique_ptr<GP2_Buffer> m_pIndexBuffer{};
+	GP2_TLSFAllocator m_VertexAllocator{};
+	GP2_TLSFAllocator m_IndexAllocator{};
+
+	// indexed by handle, a freed handle's slot is reused
+	std::vector<Range> m_Ranges;
+	std::vector<RangeAllocation> m_RangeAllocations;
+	std::vector<uint32_t> m_UnusedHandles;
+	uint32_t m_RangeCount{};
+
+	std::vector<RetiredBuffers> m_RetiredBuffers;
+	uint32_t m_Frame{};
+	uint32_t m_ReallocationCount{};
+};
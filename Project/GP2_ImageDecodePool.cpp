@@ -0,0 +1,110 @@
+#include "GP2_ImageDecodePool.h"
+#include "GP2_MappedFile.h"
+
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <stb_image.h>
+
+void GP2_ImageDecodePool::Initialize(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	m_IsStopping = false;
+	for (uint32_t idx = 0; idx < threadCount; ++idx)
+	{
+		m_Workers.emplace_back(&GP2_ImageDecodePool::RunWorker, this);
+	}
+}
+
+void GP2_ImageDecodePool::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+		m_PendingCount -= static_cast<uint32_t>(m_Jobs.size());
+		m_Jobs.clear();
+	}
+	m_JobCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+	m_IdleCondition.notify_all();
+}
+
+void GP2_ImageDecodePool::Decode(const std::string& filePath, Callback callback)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		++m_PendingCount;
+		m_Jobs.push_back(Job{ filePath, std::move(callback) });
+	}
+	m_JobCondition.notify_one();
+}
+
+void GP2_ImageDecodePool::Wait()
+{
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	m_IdleCondition.wait(lock, [this]() { return m_PendingCount == 0; });
+}
+
+void GP2_ImageDecodePool::RunWorker()
+{
+	while (true)
+	{
+		Job job{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_JobCondition.wait(lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+			if (m_IsStopping)
+			{
+				return;
+			}
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+
+		DecodeFile(job);
+
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		if (--m_PendingCount == 0)
+		{
+			m_IdleCondition.notify_all();
+		}
+	}
+}
+
+void GP2_ImageDecodePool::DecodeFile(const Job& job)
+{
+	// decoding from the mapping skips stb's buffered reads and the copy into them
+	GP2_MappedFile file{};
+	if (!file.Open(job.filePath) || file.GetSize() > size_t(INT_MAX))
+	{
+		std::cerr << "Error: failed to read " << job.filePath << std::endl;
+		job.callback(nullptr, 0, 0);
+		return;
+	}
+
+	int width{};
+	int height{};
+	int channelCount{};
+	stbi_uc* pPixels{ stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.GetData()), static_cast<int>(file.GetSize()),
+											&width, &height, &channelCount, STBI_rgb_alpha) };
+	if (!pPixels)
+	{
+		// the failure reason is thread local
+		std::cerr << "Error: failed to decode " << job.filePath << ": " << stbi_failure_reason() << std::endl;
+		job.callback(nullptr, 0, 0);
+		return;
+	}
+
+	job.callback(pPixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	stbi_image_free(pPixels);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+// Decodes JPEG, PNG and the other stb_image formats on a pool of worker threads. A worker maps the file, decodes it to
+// RGBA8 and hands the pixels to the job's callback on that same thread. The decoded buffer is released once the
+// callback returns, so the callback copies what it keeps, typically straight into mapped staging memory.
+class GP2_ImageDecodePool final
+{
+public:
+	// pPixels is nullptr when the file couldn't be read or decoded, the reason is printed already
+	using Callback = std::function<void(const uint8_t* pPixels, uint32_t width, uint32_t height)>;
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_ImageDecodePool() = default;
+	~GP2_ImageDecodePool() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_ImageDecodePool(const GP2_ImageDecodePool&) = delete;
+	GP2_ImageDecodePool(GP2_ImageDecodePool&&) = delete;
+	GP2_ImageDecodePool& operator=(const GP2_ImageDecodePool&) = delete;
+	GP2_ImageDecodePool& operator=(GP2_ImageDecodePool&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// threadCount 0 uses every core but the calling thread's
+	void Initialize(uint32_t threadCount = 0);
+	// Lets the workers finish the job they're on, the queued ones are dropped without calling back
+	void Destroy();
+
+	void Decode(const std::string& filePath, Callback callback);
+	// Blocks until every job submitted so far has called back
+	void Wait();
+
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Job
+	{
+		std::string filePath;
+		Callback callback;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void RunWorker();
+	static void DecodeFile(const Job& job);
+
+	//-----------
+	// Variables
+	//-----------
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_JobCondition;
+	std::condition_variable m_IdleCondition;
+	std::deque<Job> m_Jobs;
+	// queued and running
+	uint32_t m_PendingCount{};
+	bool m_IsStopping{};
+};
@@ -0,0 +1,540 @@
+#include "GP2_JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+	// the pool the current thread belongs to and its index in it
+	thread_local const GP2_JobSystem* t_pJobSystem{};
+	thread_local uint32_t t_ThreadIndex{ GP2_JobSystem::InvalidThreadIndex };
+
+	// rounds an idle worker looks for jobs before it goes to sleep
+	constexpr uint32_t SpinCount{ 64 };
+}
+
+GP2_JobSystem::Deque::Deque() :
+	m_pJobs{ new std::atomic<Job*>[JobCapacity] }
+{
+	static_assert((JobCapacity & (JobCapacity - 1)) == 0, "the job capacity has to be a power of two");
+}
+
+bool GP2_JobSystem::Deque::Push(Job* pJob)
+{
+	const int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) };
+	const int64_t top{ m_Top.load(std::memory_order_acquire) };
+	if (bottom - top >= int64_t(JobCapacity))
+	{
+		return false;
+	}
+
+	// a thief seeing the new bottom sees the job
+	m_pJobs[bottom & (JobCapacity - 1)].store(pJob, std::memory_order_relaxed);
+	m_Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+GP2_JobSystem::Job* GP2_JobSystem::Deque::Pop()
+{
+	// the bottom is taken before the top is read, against a thief reading them the other way round
+	const int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) - 1 };
+	m_Bottom.store(bottom, std::memory_order_seq_cst);
+	int64_t top{ m_Top.load(std::memory_order_seq_cst) };
+
+	if (top > bottom)
+	{
+		// empty
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* pJob{ m_pJobs[bottom & (JobCapacity - 1)].load(std::memory_order_relaxed) };
+	if (top == bottom)
+	{
+		// the last job, a thief may be taking it at the same time
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			pJob = nullptr;
+		}
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return pJob;
+}
+
+GP2_JobSystem::Job* GP2_JobSystem::Deque::Steal()
+{
+	int64_t top{ m_Top.load(std::memory_order_seq_cst) };
+	const int64_t bottom{ m_Bottom.load(std::memory_order_seq_cst) };
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* pJob{ m_pJobs[top & (JobCapacity - 1)].load(std::memory_order_relaxed) };
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return pJob;
+}
+
+void GP2_JobSystem::Initialize(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	for (uint32_t idx = 0; idx < threadCount; ++idx)
+	{
+		std::unique_ptr<Thread> pThread{ new Thread{} };
+		// any odd seed will do for the xorshift picking victims
+		pThread->randomState = idx * 2 + 1;
+		m_Threads.push_back(std::move(pThread));
+	}
+
+	t_pJobSystem = this;
+	t_ThreadIndex = 0;
+
+	m_IsStopping = false;
+	for (uint32_t idx = 1; idx < threadCount; ++idx)
+	{
+		m_Workers.emplace_back(&GP2_JobSystem::RunWorker, this, idx);
+	}
+}
+
+void GP2_JobSystem::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		m_IsStopping = true;
+		++m_WakeGeneration;
+	}
+	m_SleepCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+
+	// the heap jobs spawned from outside the pool and never run
+	for (Job* pJob : m_pSharedJobs)
+	{
+		delete pJob;
+	}
+	m_pSharedJobs.clear();
+	for (Job* pJob : m_pMainThreadJobs)
+	{
+		if (pJob->ownerIndex == InvalidThreadIndex)
+		{
+			delete pJob;
+		}
+	}
+	m_pMainThreadJobs.clear();
+
+	m_Threads.clear();
+	if (t_pJobSystem == this)
+	{
+		t_pJobSystem = nullptr;
+		t_ThreadIndex = InvalidThreadIndex;
+	}
+}
+
+void GP2_JobSystem::Run(Function function, Counter* pCounter, Counter* pDependency)
+{
+	const uint32_t threadIndex{ GetThreadIndex() };
+	Job* pJob{ AllocateJob(threadIndex) };
+	pJob->function = std::move(function);
+	pJob->pCounter = pCounter;
+	if (pCounter)
+	{
+		Increment(*pCounter);
+	}
+
+	if (pDependency)
+	{
+		AddDependent(*pDependency, threadIndex, pJob);
+		return;
+	}
+	Push(threadIndex, pJob);
+}
+
+void GP2_JobSystem::RunOnMainThread(Function function, Counter* pCounter)
+{
+	Job* pJob{ AllocateJob(GetThreadIndex()) };
+	pJob->function = std::move(function);
+	pJob->pCounter = pCounter;
+	if (pCounter)
+	{
+		Increment(*pCounter);
+	}
+
+	std::lock_guard<std::mutex> lock{ m_MainThreadMutex };
+	m_pMainThreadJobs.push_back(pJob);
+	m_MainThreadJobCount.fetch_add(1, std::memory_order_release);
+}
+
+void GP2_JobSystem::RunMainThreadJobs()
+{
+	while (Job* pJob{ PopMainThreadJob() })
+	{
+		Execute(0, pJob);
+	}
+}
+
+void GP2_JobSystem::Wait(Counter& counter)
+{
+	const uint32_t threadIndex{ GetThreadIndex() };
+	while (!counter.IsDone())
+	{
+		Job* pJob{ threadIndex == 0 ? PopMainThreadJob() : nullptr };
+		if (!pJob)
+		{
+			pJob = FindJob(threadIndex);
+		}
+
+		if (pJob)
+		{
+			Execute(threadIndex, pJob);
+			continue;
+		}
+		std::this_thread::yield();
+	}
+}
+
+uint32_t GP2_JobSystem::GetRangeCount(uint32_t count, uint32_t minRangeSize, uint32_t maxRangeCount) const
+{
+	const uint32_t threadCount{ std::max(std::min(GetThreadCount(), maxRangeCount), 1u) };
+	return std::clamp(count / std::max(minRangeSize, 1u), 1u, threadCount);
+}
+
+uint32_t GP2_JobSystem::GetThreadIndex() const
+{
+	return t_pJobSystem == this ? t_ThreadIndex : InvalidThreadIndex;
+}
+
+GP2_JobSystem::Stats GP2_JobSystem::GetStats() const
+{
+	Stats stats{};
+	for (const std::unique_ptr<Thread>& pThread : m_Threads)
+	{
+		stats.jobCount += pThread->jobCount.load(std::memory_order_relaxed);
+		stats.stealCount += pThread->stealCount.load(std::memory_order_relaxed);
+		stats.failedStealCount += pThread->failedStealCount.load(std::memory_order_relaxed);
+		stats.inlineCount += pThread->inlineCount.load(std::memory_order_relaxed);
+		stats.sleepCount += pThread->sleepCount.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void GP2_JobSystem::ResetStats()
+{
+	for (std::unique_ptr<Thread>& pThread : m_Threads)
+	{
+		pThread->jobCount = 0;
+		pThread->stealCount = 0;
+		pThread->failedStealCount = 0;
+		pThread->inlineCount = 0;
+		pThread->sleepCount = 0;
+	}
+}
+
+void GP2_JobSystem::PrintStats(std::ostream& stream) const
+{
+	const Stats stats{ GetStats() };
+	stream << "Job system: " << stats.jobCount << " jobs on " << GetThreadCount() << " threads, " << stats.stealCount << " stolen, "
+		   << stats.failedStealCount << " failed steals, " << stats.inlineCount << " run inline, " << stats.sleepCount
+		   << " times a worker went to sleep" << std::endl;
+}
+
+void GP2_JobSystem::RunWorker(uint32_t threadIndex)
+{
+	t_pJobSystem = this;
+	t_ThreadIndex = threadIndex;
+	Thread& thread{ *m_Threads[threadIndex] };
+
+	uint32_t idleCount{};
+	while (!m_IsStopping.load(std::memory_order_relaxed))
+	{
+		if (Job* pJob{ FindJob(threadIndex) })
+		{
+			Execute(threadIndex, pJob);
+			idleCount = 0;
+			continue;
+		}
+
+		if (++idleCount < SpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		idleCount = 0;
+
+		// announced before the last look, so a job spawned after it either is found or wakes this thread
+		m_SleepingCount.fetch_add(1, std::memory_order_seq_cst);
+		uint64_t generation{};
+		{
+			std::lock_guard<std::mutex> lock{ m_SleepMutex };
+			generation = m_WakeGeneration;
+		}
+
+		if (Job* pJob{ FindJob(threadIndex) })
+		{
+			m_SleepingCount.fetch_sub(1, std::memory_order_relaxed);
+			Execute(threadIndex, pJob);
+			continue;
+		}
+
+		thread.sleepCount.fetch_add(1, std::memory_order_relaxed);
+		std::unique_lock<std::mutex> lock{ m_SleepMutex };
+		m_SleepCondition.wait(lock, [this, generation]() { return m_IsStopping || m_WakeGeneration != generation; });
+		m_SleepingCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	t_pJobSystem = nullptr;
+	t_ThreadIndex = InvalidThreadIndex;
+}
+
+GP2_JobSystem::Job* GP2_JobSystem::AllocateJob(uint32_t threadIndex)
+{
+	if (threadIndex == InvalidThreadIndex)
+	{
+		return new Job{ nullptr, nullptr, InvalidThreadIndex, nullptr };
+	}
+
+	Thread& thread{ *m_Threads[threadIndex] };
+	if (thread.pFreeJobs.empty())
+	{
+		for (Job* pJob{ thread.pReturnedJobs.exchange(nullptr, std::memory_order_acquire) }; pJob; pJob = pJob->pNext)
+		{
+			thread.pFreeJobs.push_back(pJob);
+		}
+	}
+
+	if (thread.pFreeJobs.empty())
+	{
+		// as many jobs as were ever in flight at once, spawning doesn't wait for any to finish
+		thread.pJobBlocks.emplace_back(new Job[JobBlockSize]);
+		for (uint32_t idx = 0; idx < JobBlockSize; ++idx)
+		{
+			Job& job{ thread.pJobBlocks.back()[idx] };
+			job.ownerIndex = threadIndex;
+			thread.pFreeJobs.push_back(&job);
+		}
+	}
+
+	Job* pJob{ thread.pFreeJobs.back() };
+	thread.pFreeJobs.pop_back();
+	return pJob;
+}
+
+void GP2_JobSystem::FreeJob(uint32_t threadIndex, Job* pJob)
+{
+	if (pJob->ownerIndex == InvalidThreadIndex)
+	{
+		delete pJob;
+		return;
+	}
+
+	Thread& owner{ *m_Threads[pJob->ownerIndex] };
+	if (pJob->ownerIndex == threadIndex)
+	{
+		owner.pFreeJobs.push_back(pJob);
+		return;
+	}
+
+	// the owner only ever takes the whole list, so a job can't come back while it's being pushed
+	pJob->pNext = owner.pReturnedJobs.load(std::memory_order_relaxed);
+	while (!owner.pReturnedJobs.compare_exchange_weak(pJob->pNext, pJob, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+}
+
+void GP2_JobSystem::Push(uint32_t threadIndex, Job* pJob)
+{
+	if (threadIndex == InvalidThreadIndex)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_SharedMutex };
+			m_pSharedJobs.push_back(pJob);
+			m_SharedJobCount.fetch_add(1, std::memory_order_release);
+		}
+		WakeWorker();
+		return;
+	}
+
+	if (!m_Threads[threadIndex]->deque.Push(pJob))
+	{
+		// running it here is always correct, only the order changes
+		m_Threads[threadIndex]->inlineCount.fetch_add(1, std::memory_order_relaxed);
+		Execute(threadIndex, pJob);
+		return;
+	}
+	WakeWorker();
+}
+
+void GP2_JobSystem::WakeWorker()
+{
+	// pairs with the sleeping count a worker raises before its last look for jobs
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_SleepingCount.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		++m_WakeGeneration;
+	}
+	m_SleepCondition.notify_one();
+}
+
+GP2_JobSystem::Job* GP2_JobSystem::FindJob(uint32_t threadIndex)
+{
+	if (threadIndex != InvalidThreadIndex)
+	{
+		if (Job* pJob{ m_Threads[threadIndex]->deque.Pop() })
+		{
+			return pJob;
+		}
+	}
+
+	if (m_SharedJobCount.load(std::memory_order_acquire) > 0)
+	{
+		std::lock_guard<std::mutex> lock{ m_SharedMutex };
+		if (!m_pSharedJobs.empty())
+		{
+			Job* pJob{ m_pSharedJobs.front() };
+			m_pSharedJobs.pop_front();
+			m_SharedJobCount.fetch_sub(1, std::memory_order_relaxed);
+			return pJob;
+		}
+	}
+
+	const uint32_t threadCount{ GetThreadCount() };
+	if (threadCount < 2)
+	{
+		return nullptr;
+	}
+
+	// a random victim spreads the thieves over the deques instead of all of them hitting the same one
+	uint32_t victim{};
+	if (threadIndex != InvalidThreadIndex)
+	{
+		uint32_t& state{ m_Threads[threadIndex]->randomState };
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		victim = state % threadCount;
+	}
+
+	for (uint32_t attempt = 0; attempt < threadCount; ++attempt, victim = (victim + 1) % threadCount)
+	{
+		if (victim == threadIndex)
+		{
+			continue;
+		}
+
+		Job* pJob{ m_Threads[victim]->deque.Steal() };
+		if (threadIndex != InvalidThreadIndex)
+		{
+			Thread& thread{ *m_Threads[threadIndex] };
+			(pJob ? thread.stealCount : thread.failedStealCount).fetch_add(1, std::memory_order_relaxed);
+		}
+		if (pJob)
+		{
+			return pJob;
+		}
+	}
+	return nullptr;
+}
+
+GP2_JobSystem::Job* GP2_JobSystem::PopMainThreadJob()
+{
+	if (m_MainThreadJobCount.load(std::memory_order_acquire) == 0)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock{ m_MainThreadMutex };
+	if (m_pMainThreadJobs.empty())
+	{
+		return nullptr;
+	}
+
+	Job* pJob{ m_pMainThreadJobs.front() };
+	m_pMainThreadJobs.pop_front();
+	m_MainThreadJobCount.fetch_sub(1, std::memory_order_relaxed);
+	return pJob;
+}
+
+void GP2_JobSystem::Execute(uint32_t threadIndex, Job* pJob)
+{
+	const Function function{ std::move(pJob->function) };
+	Counter* pCounter{ pJob->pCounter };
+	pJob->function = nullptr;
+	FreeJob(threadIndex, pJob);
+
+	function();
+	if (threadIndex != InvalidThreadIndex)
+	{
+		m_Threads[threadIndex]->jobCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (pCounter)
+	{
+		Decrement(*pCounter, threadIndex);
+	}
+}
+
+void GP2_JobSystem::AddDependent(Counter& counter, uint32_t threadIndex, Job* pJob)
+{
+	{
+		std::lock_guard<std::mutex> lock{ counter.m_Mutex };
+		if (!counter.m_IsReleased && counter.m_Value.load(std::memory_order_acquire) > 0)
+		{
+			counter.m_pDependents.push_back(pJob);
+			return;
+		}
+	}
+
+	// every job counted on it has finished already
+	Push(threadIndex, pJob);
+}
+
+void GP2_JobSystem::Increment(Counter& counter)
+{
+	// a counter used again after it was done forgets it released its dependents
+	if (counter.m_Value.fetch_add(1, std::memory_order_acq_rel) == 0)
+	{
+		std::lock_guard<std::mutex> lock{ counter.m_Mutex };
+		counter.m_IsReleased = false;
+	}
+}
+
+void GP2_JobSystem::Decrement(Counter& counter, uint32_t threadIndex)
+{
+	uint32_t value{ counter.m_Value.load(std::memory_order_relaxed) };
+	while (value > 1)
+	{
+		if (counter.m_Value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			return;
+		}
+	}
+
+	// the last job hands the dependents on before the counter reads done, a waiter may destroy it right after
+	std::vector<Job*> pDependents;
+	{
+		std::lock_guard<std::mutex> lock{ counter.m_Mutex };
+		pDependents.swap(counter.m_pDependents);
+		counter.m_IsReleased = true;
+	}
+	// a read-modify-write like every other decrement, a waiter seeing 0 then synchronizes with all of them
+	counter.m_Value.fetch_sub(1, std::memory_order_acq_rel);
+
+	for (Job* pJob : pDependents)
+	{
+		Push(threadIndex, pJob);
+	}
+}
@@ -0,0 +1,263 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+
+// Work stealing scheduler the engine's parallel work shares. Every thread of the pool owns a Chase-Lev deque: it pushes
+// and pops the jobs it spawns at the bottom, idle threads steal the oldest ones from the top of another's. The thread
+// calling Initialize is the main thread and thread 0 of the pool, it runs jobs whenever it waits for a counter. Jobs
+// run on the main thread only with RunOnMainThread, which is what GLFW calls need. Threads outside the pool may spawn
+// jobs too, they go through a shared queue the pool drains.
+class GP2_JobSystem final
+{
+public:
+	using Function = std::function<void()>;
+
+	struct Job;
+
+	// Counts the jobs run with it that haven't finished. Jobs may be added while the counter is waited for only by jobs
+	// counted on it, anything else adds them before waiting. It has to outlive its jobs and the jobs depending on it.
+	class Counter final
+	{
+	public:
+		Counter() = default;
+		~Counter() = default;
+
+		Counter(const Counter&) = delete;
+		Counter(Counter&&) = delete;
+		Counter& operator=(const Counter&) = delete;
+		Counter& operator=(Counter&&) = delete;
+
+		bool IsDone() const { return m_Value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class GP2_JobSystem;
+
+		std::atomic<uint32_t> m_Value{};
+		// only taken by the job finishing last and to add dependents
+		std::mutex m_Mutex;
+		std::vector<Job*> m_pDependents;
+		// set once the last job has handed the dependents on, until the counter is used again
+		bool m_IsReleased{};
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_JobSystem() = default;
+	~GP2_JobSystem() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_JobSystem(const GP2_JobSystem&) = delete;
+	GP2_JobSystem(GP2_JobSystem&&) = delete;
+	GP2_JobSystem& operator=(const GP2_JobSystem&) = delete;
+	GP2_JobSystem& operator=(GP2_JobSystem&&) = delete;
+
+	//-----------
+	// Structs
+	//-----------
+	struct Stats
+	{
+		uint64_t jobCount;
+		// jobs taken from another thread's deque, and the attempts that found it empty or lost the race
+		uint64_t stealCount;
+		uint64_t failedStealCount;
+		// jobs run by the spawning thread straight away because its deque was full
+		uint64_t inlineCount;
+		uint64_t sleepCount;
+	};
+
+	struct Job
+	{
+		Function function;
+		Counter* pCounter;
+		// the thread whose free list it goes back to, InvalidThreadIndex for heap jobs spawned from outside the pool
+		uint32_t ownerIndex;
+		Job* pNext;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// threadCount includes the calling thread, 0 uses every core
+	void Initialize(uint32_t threadCount = 0);
+	// Every job that has to run must have been waited for, the queued ones are dropped
+	void Destroy();
+
+	// Runs function on any thread of the pool, after every job counted on pDependency has finished when there's one.
+	// pCounter counts it until it has returned. Jobs don't throw, ParallelFor passes exceptions on itself.
+	void Run(Function function, Counter* pCounter = nullptr, Counter* pDependency = nullptr);
+	// Runs function on the main thread the next time it calls RunMainThreadJobs or waits for a counter
+	void RunOnMainThread(Function function, Counter* pCounter = nullptr);
+	// Main thread only, once a frame
+	void RunMainThreadJobs();
+	// Runs other jobs until counter is done, the main thread runs its own as well
+	void Wait(Counter& counter);
+
+	// Splits [0, count) into contiguous ranges of at least minRangeSize, at most one per thread and maxRangeCount, and
+	// calls function(rangeIndex, begin, end) for each, the calling thread taking range 0. Returns once every range has,
+	// rethrowing the first exception one threw. A single range runs inline.
+	template <class RangeFunction>
+	void ParallelFor(uint32_t count, uint32_t minRangeSize, const RangeFunction& function, uint32_t maxRangeCount = UINT32_MAX);
+	// the number of ranges ParallelFor splits count into
+	uint32_t GetRangeCount(uint32_t count, uint32_t minRangeSize, uint32_t maxRangeCount = UINT32_MAX) const;
+
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+	// 0 on the main thread, InvalidThreadIndex on threads outside the pool
+	uint32_t GetThreadIndex() const;
+	static constexpr uint32_t InvalidThreadIndex{ UINT32_MAX };
+
+	Stats GetStats() const;
+	void ResetStats();
+	void PrintStats(std::ostream& stream) const;
+
+	// jobs a thread's deque holds, once it's full the thread runs what it spawns itself
+	static constexpr uint32_t JobCapacity{ 4096 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// Chase-Lev deque with a fixed capacity (Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+	// Weak Memory Models"). Push and Pop are for the owning thread only, Steal for any thread.
+	class Deque final
+	{
+	public:
+		Deque();
+
+		bool Push(Job* pJob);
+		Job* Pop();
+		Job* Steal();
+
+	private:
+		alignas(64) std::atomic<int64_t> m_Top{};
+		alignas(64) std::atomic<int64_t> m_Bottom{};
+		std::unique_ptr<std::atomic<Job*>[]> m_pJobs;
+	};
+
+	struct alignas(64) Thread
+	{
+		Deque deque;
+		// jobs are allocated JobBlockSize at a time and never freed before Destroy
+		std::vector<std::unique_ptr<Job[]>> pJobBlocks;
+		std::vector<Job*> pFreeJobs;
+		// finished on other threads, pushed by them and taken as a whole by the owner
+		std::atomic<Job*> pReturnedJobs;
+		uint32_t randomState;
+
+		// only written by the thread itself
+		std::atomic<uint64_t> jobCount;
+		std::atomic<uint64_t> stealCount;
+		std::atomic<uint64_t> failedStealCount;
+		std::atomic<uint64_t> inlineCount;
+		std::atomic<uint64_t> sleepCount;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void RunWorker(uint32_t threadIndex);
+	Job* AllocateJob(uint32_t threadIndex);
+	void FreeJob(uint32_t threadIndex, Job* pJob);
+	void Push(uint32_t threadIndex, Job* pJob);
+	void WakeWorker();
+	// the own deque first, then the shared queue, then the other threads' deques starting at a random one
+	Job* FindJob(uint32_t threadIndex);
+	Job* PopMainThreadJob();
+	void Execute(uint32_t threadIndex, Job* pJob);
+
+	void AddDependent(Counter& counter, uint32_t threadIndex, Job* pJob);
+	static void Increment(Counter& counter);
+	void Decrement(Counter& counter, uint32_t threadIndex);
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t JobBlockSize{ 256 };
+
+	std::vector<std::unique_ptr<Thread>> m_Threads;
+	std::vector<std::thread> m_Workers;
+	std::atomic<bool> m_IsStopping{};
+
+	// jobs spawned from outside the pool
+	std::mutex m_SharedMutex;
+	std::deque<Job*> m_pSharedJobs;
+	std::atomic<uint32_t> m_SharedJobCount{};
+
+	std::mutex m_MainThreadMutex;
+	std::deque<Job*> m_pMainThreadJobs;
+	std::atomic<uint32_t> m_MainThreadJobCount{};
+
+	// idle workers sleep until the generation changes, spawning only takes the lock when one does
+	std::mutex m_SleepMutex;
+	std::condition_variable m_SleepCondition;
+	std::atomic<uint32_t> m_SleepingCount{};
+	uint64_t m_WakeGeneration{};
+};
+
+template <class RangeFunction>
+void GP2_JobSystem::ParallelFor(uint32_t count, uint32_t minRangeSize, const RangeFunction& function, uint32_t maxRangeCount)
+{
+	const uint32_t rangeCount{ GetRangeCount(count, minRangeSize, maxRangeCount) };
+	if (rangeCount <= 1)
+	{
+		if (count > 0)
+		{
+			function(0u, 0u, count);
+		}
+		return;
+	}
+
+	// the jobs only capture a pointer to it and their range, which keeps them inside std::function's own storage
+	struct State
+	{
+		const RangeFunction* pFunction;
+		uint32_t count;
+		uint32_t rangeCount;
+		std::mutex mutex;
+		std::exception_ptr pException;
+
+		void RunRange(uint32_t rangeIndex)
+		{
+			const uint32_t begin{ static_cast<uint32_t>(uint64_t(count) * rangeIndex / rangeCount) };
+			const uint32_t end{ static_cast<uint32_t>(uint64_t(count) * (rangeIndex + 1) / rangeCount) };
+			try
+			{
+				(*pFunction)(rangeIndex, begin, end);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				if (!pException)
+				{
+					pException = std::current_exception();
+				}
+			}
+		}
+	};
+
+	State state{ &function, count, rangeCount };
+	Counter counter{};
+	for (uint32_t rangeIndex = 1; rangeIndex < rangeCount; ++rangeIndex)
+	{
+		Run([pState = &state, rangeIndex]() { pState->RunRange(rangeIndex); }, &counter);
+	}
+
+	state.RunRange(0);
+	Wait(counter);
+
+	if (state.pException)
+	{
+		std::rethrow_exception(state.pException);
+	}
+}
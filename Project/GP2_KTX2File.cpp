@@ -0,0 +1,223 @@
+#include "GP2_KTX2File.h"
+#include "GP2_BlockCompressor.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+	constexpr uint8_t Identifier[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// Khronos data format descriptor values
+	constexpr uint32_t ColorModelBC1A{ 128 };
+	constexpr uint32_t ColorModelBC5{ 132 };
+	constexpr uint32_t ColorModelBC7{ 134 };
+	constexpr uint32_t ColorPrimariesBT709{ 1 };
+	constexpr uint32_t TransferLinear{ 1 };
+	constexpr uint32_t TransferSRGB{ 2 };
+
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void WritePadding(std::ofstream& file, size_t size)
+	{
+		static constexpr char zeros[16]{};
+		file.write(zeros, static_cast<std::streamsize>(size));
+	}
+}
+
+bool GP2_KTX2File::Open(const std::string& filename)
+{
+	Close();
+
+	if (!m_File.Open(filename))
+	{
+		std::cerr << "Error: failed to open " << filename << std::endl;
+		return false;
+	}
+
+	const auto fail{ [this, &filename](const char* pReason)
+	{
+		std::cerr << "Error: " << filename << ": " << pReason << std::endl;
+		Close();
+		return false;
+	} };
+
+	if (m_File.GetSize() < sizeof(Header))
+	{
+		return fail("too small for a KTX2 header");
+	}
+
+	m_pHeader = reinterpret_cast<const Header*>(m_File.GetData());
+	if (std::memcmp(m_pHeader->identifier, Identifier, sizeof(Identifier)) != 0)
+	{
+		return fail("not a KTX2 file");
+	}
+	if (!GP2_BlockCompressor::IsSupported(GetFormat()))
+	{
+		return fail("unsupported format, only BC1, BC5 and BC7 are loaded");
+	}
+	if (m_pHeader->supercompressionScheme != 0)
+	{
+		return fail("supercompressed files aren't supported");
+	}
+	if (m_pHeader->pixelWidth == 0 || m_pHeader->pixelHeight == 0 || m_pHeader->pixelDepth > 1 ||
+		m_pHeader->layerCount > 1 || m_pHeader->faceCount != 1)
+	{
+		return fail("only single 2D images are supported");
+	}
+
+	m_LevelCount = std::max(m_pHeader->levelCount, 1u);
+	if (m_File.GetSize() < sizeof(Header) + m_LevelCount * sizeof(LevelIndex))
+	{
+		return fail("truncated level index");
+	}
+
+	m_pLevels = reinterpret_cast<const LevelIndex*>(m_File.GetData() + sizeof(Header));
+	for (uint32_t level = 0; level < m_LevelCount; ++level)
+	{
+		const LevelIndex& levelIndex{ m_pLevels[level] };
+		if (levelIndex.byteOffset > m_File.GetSize() || levelIndex.byteLength > m_File.GetSize() - levelIndex.byteOffset ||
+			levelIndex.byteLength != GP2_BlockCompressor::GetImageSize(GetFormat(), GetLevelWidth(level), GetLevelHeight(level)))
+		{
+			return fail("level out of bounds or of the wrong size");
+		}
+	}
+
+	return true;
+}
+
+void GP2_KTX2File::Close()
+{
+	m_File.Close();
+	m_pHeader = nullptr;
+	m_pLevels = nullptr;
+	m_LevelCount = 0;
+}
+
+uint32_t GP2_KTX2File::GetLevelWidth(uint32_t level) const
+{
+	return std::max(m_pHeader->pixelWidth >> level, 1u);
+}
+
+uint32_t GP2_KTX2File::GetLevelHeight(uint32_t level) const
+{
+	return std::max(m_pHeader->pixelHeight >> level, 1u);
+}
+
+bool GP2_KTX2File::Write(const std::string& filename, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels)
+{
+	const std::vector<uint32_t> dataFormatDescriptor{ CreateDataFormatDescriptor(format) };
+	const size_t blockSize{ GP2_BlockCompressor::GetBlockSize(format) };
+
+	Header header{};
+	std::memcpy(header.identifier, Identifier, sizeof(Identifier));
+	header.vkFormat = static_cast<uint32_t>(format);
+	header.typeSize = 1;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.faceCount = 1;
+	header.levelCount = static_cast<uint32_t>(levels.size());
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(Header) + levels.size() * sizeof(LevelIndex));
+	header.dfdByteLength = static_cast<uint32_t>(dataFormatDescriptor.size() * sizeof(uint32_t));
+
+	// the smallest level comes first so a partial read can show something
+	std::vector<LevelIndex> levelIndices(levels.size());
+	size_t offset{ header.dfdByteOffset + header.dfdByteLength };
+	for (size_t level = levels.size(); level-- > 0;)
+	{
+		offset = AlignUp(offset, blockSize);
+		levelIndices[level] = LevelIndex{ offset, levels[level].size(), levels[level].size() };
+		offset += levels[level].size();
+	}
+
+	const std::string tempPath{ filename + ".tmp" };
+	{
+		std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		file.write(reinterpret_cast<const char*>(levelIndices.data()), static_cast<std::streamsize>(levelIndices.size() * sizeof(LevelIndex)));
+		file.write(reinterpret_cast<const char*>(dataFormatDescriptor.data()), header.dfdByteLength);
+
+		size_t position{ header.dfdByteOffset + header.dfdByteLength };
+		for (size_t level = levels.size(); level-- > 0;)
+		{
+			WritePadding(file, levelIndices[level].byteOffset - position);
+			file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+			position = levelIndices[level].byteOffset + levels[level].size();
+		}
+
+		if (!file.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code error{};
+	std::filesystem::rename(tempPath, filename, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<uint32_t> GP2_KTX2File::CreateDataFormatDescriptor(VkFormat format)
+{
+	struct Sample
+	{
+		uint32_t channel;
+		uint32_t bitOffset;
+		uint32_t bitLength;
+	};
+
+	uint32_t colorModel{ ColorModelBC7 };
+	std::vector<Sample> samples{ Sample{ 0, 0, 128 } };
+	if (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK)
+	{
+		colorModel = ColorModelBC1A;
+		samples = { Sample{ 0, 0, 64 } };
+	}
+	else if (format == VK_FORMAT_BC5_UNORM_BLOCK)
+	{
+		// red and green
+		colorModel = ColorModelBC5;
+		samples = { Sample{ 0, 0, 64 }, Sample{ 1, 64, 64 } };
+	}
+
+	const uint32_t blockByteLength{ static_cast<uint32_t>(24 + samples.size() * 16) };
+	const uint32_t transfer{ GP2_BlockCompressor::IsSRGB(format) ? TransferSRGB : TransferLinear };
+
+	std::vector<uint32_t> words{
+		4 + blockByteLength,
+		// vendor Khronos, basic descriptor type
+		0,
+		// version 2
+		2 | (blockByteLength << 16),
+		colorModel | (ColorPrimariesBT709 << 8) | (transfer << 16),
+		// 4x4 texel blocks, stored as dimension - 1
+		3 | (3 << 8),
+		GP2_BlockCompressor::GetBlockSize(format),
+		0 };
+
+	for (const Sample& sample : samples)
+	{
+		words.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+		words.push_back(0);
+		words.push_back(0);
+		words.push_back(UINT32_MAX);
+	}
+
+	return words;
+}
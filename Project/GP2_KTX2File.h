@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+#include "GP2_MappedFile.h"
+
+// KTX2 container of a single 2D image with its mip levels, limited to the BC formats GP2_BlockCompressor knows.
+// The file is mapped read-only and the levels are handed out as pointers into the mapping.
+//
+// Layout: Header | LevelIndex[levelCount] | data format descriptor | levels, smallest first
+// Levels start on a block boundary, supercompressed files aren't supported.
+class GP2_KTX2File final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_KTX2File() = default;
+	~GP2_KTX2File() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_KTX2File(const GP2_KTX2File&) = delete;
+	GP2_KTX2File(GP2_KTX2File&&) = delete;
+	GP2_KTX2File& operator=(const GP2_KTX2File&) = delete;
+	GP2_KTX2File& operator=(GP2_KTX2File&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// Maps filename and checks every level is where and as large as the header says, prints why when it isn't
+	bool Open(const std::string& filename);
+	void Close();
+
+	// levels holds the blocks of level 0 and down, written through a temporary file
+	static bool Write(const std::string& filename, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels);
+
+	bool IsOpen() const { return m_pHeader != nullptr; }
+
+	VkFormat GetFormat() const { return static_cast<VkFormat>(m_pHeader->vkFormat); }
+	uint32_t GetWidth() const { return m_pHeader->pixelWidth; }
+	uint32_t GetHeight() const { return m_pHeader->pixelHeight; }
+	uint32_t GetLevelCount() const { return m_LevelCount; }
+	uint32_t GetLevelWidth(uint32_t level) const;
+	uint32_t GetLevelHeight(uint32_t level) const;
+	const uint8_t* GetLevelData(uint32_t level) const { return reinterpret_cast<const uint8_t*>(m_File.GetData()) + m_pLevels[level].byteOffset; }
+	size_t GetLevelSize(uint32_t level) const { return static_cast<size_t>(m_pLevels[level].byteLength); }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Header
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct LevelIndex
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// the basic data format descriptor of a BC format, prefixed with its total size
+	static std::vector<uint32_t> CreateDataFormatDescriptor(VkFormat format);
+
+	//-----------
+	// Variables
+	//-----------
+	GP2_MappedFile m_File{};
+	const Header* m_pHeader{};
+	const LevelIndex* m_pLevels{};
+	// a level count of 0 in the header asks for the mips to be generated, it's stored as 1 here
+	uint32_t m_LevelCount{};
+};
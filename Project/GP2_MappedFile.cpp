@@ -0,0 +1,176 @@
+#include "GP2_MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+GP2_MappedFile::GP2_MappedFile() :
+	m_pData{},
+	m_Size{},
+	m_IsOpen{},
+#ifdef _WIN32
+	m_FileHandle{ INVALID_HANDLE_VALUE },
+	m_MappingHandle{}
+#else
+	m_FileDescriptor{ -1 }
+#endif
+{
+}
+
+GP2_MappedFile::~GP2_MappedFile()
+{
+	Close();
+}
+
+GP2_MappedFile::GP2_MappedFile(GP2_MappedFile&& other) noexcept :
+	GP2_MappedFile()
+{
+	*this = std::move(other);
+}
+
+GP2_MappedFile& GP2_MappedFile::operator=(GP2_MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+
+		std::swap(m_pData, other.m_pData);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_IsOpen, other.m_IsOpen);
+#ifdef _WIN32
+		std::swap(m_FileHandle, other.m_FileHandle);
+		std::swap(m_MappingHandle, other.m_MappingHandle);
+#else
+		std::swap(m_FileDescriptor, other.m_FileDescriptor);
+#endif
+	}
+
+	return *this;
+}
+
+bool GP2_MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	m_FileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(m_FileHandle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = static_cast<size_t>(fileSize.QuadPart);
+	m_IsOpen = true;
+
+	// mapping an empty file fails, an empty view is still a valid open file
+	if (m_Size == 0)
+	{
+		return true;
+	}
+
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_MappingHandle)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = static_cast<const char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+#else
+	m_FileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat{};
+	if (fstat(m_FileDescriptor, &fileStat) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = static_cast<size_t>(fileStat.st_size);
+	m_IsOpen = true;
+
+	if (m_Size == 0)
+	{
+		return true;
+	}
+
+	void* pMapped{ mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) };
+	if (pMapped == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	// the parsers walk the file front to back exactly once
+	madvise(pMapped, m_Size, MADV_SEQUENTIAL);
+	m_pData = static_cast<const char*>(pMapped);
+#endif
+
+	return true;
+}
+
+void GP2_MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+
+	if (m_MappingHandle)
+	{
+		CloseHandle(m_MappingHandle);
+		m_MappingHandle = nullptr;
+	}
+
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_FileHandle);
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_pData)
+	{
+		munmap(const_cast<char*>(m_pData), m_Size);
+	}
+
+	if (m_FileDescriptor >= 0)
+	{
+		close(m_FileDescriptor);
+		m_FileDescriptor = -1;
+	}
+#endif
+
+	m_pData = nullptr;
+	m_Size = 0;
+	m_IsOpen = false;
+}
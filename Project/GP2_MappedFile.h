@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+class GP2_MappedFile final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MappedFile();
+	~GP2_MappedFile();
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_MappedFile(const GP2_MappedFile&) = delete;
+	GP2_MappedFile(GP2_MappedFile&& other) noexcept;
+	GP2_MappedFile& operator=(const GP2_MappedFile&) = delete;
+	GP2_MappedFile& operator=(GP2_MappedFile&& other) noexcept;
+
+	//-----------
+	// Functions
+	//-----------
+	// Maps the whole file read-only, returns false when the file can't be opened
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_IsOpen; }
+	const char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+private:
+	//-----------
+	// Variables
+	//-----------
+	const char* m_pData;
+	size_t m_Size;
+	bool m_IsOpen;
+
+#ifdef _WIN32
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#else
+	int m_FileDescriptor;
+#endif
+};
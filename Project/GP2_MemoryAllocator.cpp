@@ -0,0 +1,586 @@
+#include "GP2_MemoryAllocator.h"
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::pair<VkDevice, GP2_MemoryAllocator*>> allocators;
+	};
+
+	Registry& GetRegistry()
+	{
+		static Registry registry{};
+		return registry;
+	}
+
+	void WriteJsonString(std::ostream& stream, const std::string& text)
+	{
+		stream << '"';
+		for (const char character : text)
+		{
+			switch (character)
+			{
+			case '"': stream << "\\\""; break;
+			case '\\': stream << "\\\\"; break;
+			case '\n': stream << "\\n"; break;
+			case '\t': stream << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+				{
+					continue;
+				}
+				stream << character;
+			}
+		}
+		stream << '"';
+	}
+}
+
+GP2_MemoryAllocator::~GP2_MemoryAllocator()
+{
+	Destroy();
+}
+
+void GP2_MemoryAllocator::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize)
+{
+	m_Device = device;
+	m_PhysicalDevice = physicalDevice;
+	m_BlockSize = blockSize;
+	m_HasMemoryBudget = IsMemoryBudgetSupported(physicalDevice);
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	m_BufferImageGranularity = properties.limits.bufferImageGranularity;
+	m_NonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+
+	Registry& registry{ GetRegistry() };
+	std::lock_guard<std::mutex> lock{ registry.mutex };
+	registry.allocators.emplace_back(device, this);
+}
+
+void GP2_MemoryAllocator::Destroy()
+{
+	if (!m_Device)
+	{
+		return;
+	}
+
+	{
+		Registry& registry{ GetRegistry() };
+		std::lock_guard<std::mutex> lock{ registry.mutex };
+		std::erase_if(registry.allocators, [this](const auto& entry) { return entry.second == this; });
+	}
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	// freeing mapped memory unmaps it
+	for (const std::unique_ptr<Block>& pBlock : m_Blocks)
+	{
+		if (pBlock)
+		{
+			vkFreeMemory(m_Device, pBlock->memory, nullptr);
+		}
+	}
+	m_Blocks.clear();
+
+	for (VkDeviceMemory memory : m_DedicatedMemory)
+	{
+		vkFreeMemory(m_Device, memory, nullptr);
+	}
+	m_DedicatedMemory.clear();
+	m_DedicatedBytes = 0;
+
+	m_Resources.clear();
+	m_UnusedResourceSlots.clear();
+	m_HeapAllocatedBytes.fill(0);
+	m_HeapUsedBytes.fill(0);
+	for (CategoryUsage& usage : m_CategoryUsage)
+	{
+		usage.resourceCount = 0;
+		usage.bytes = 0;
+	}
+
+	m_Device = VK_NULL_HANDLE;
+}
+
+GP2_MemoryAllocator& GP2_MemoryAllocator::Get(VkDevice device)
+{
+	Registry& registry{ GetRegistry() };
+	std::lock_guard<std::mutex> lock{ registry.mutex };
+	for (const auto& [allocatorDevice, pAllocator] : registry.allocators)
+	{
+		if (allocatorDevice == device)
+		{
+			return *pAllocator;
+		}
+	}
+
+	throw std::runtime_error("no memory allocator initialized for this device!");
+}
+
+bool GP2_MemoryAllocator::IsMemoryBudgetSupported(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (properties.apiVersion < VK_API_VERSION_1_1)
+	{
+		return false;
+	}
+
+	uint32_t extensionCount{};
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+	return std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension)
+	{
+		return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+	});
+}
+
+GP2_MemoryAllocator::Allocation GP2_MemoryAllocator::AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties, Category category,
+																	   std::string_view name)
+{
+	VkMemoryRequirements requirements{};
+	vkGetBufferMemoryRequirements(m_Device, buffer, &requirements);
+
+	const Allocation allocation{ Allocate(requirements, properties, true, category, name) };
+	if (vkBindBufferMemory(m_Device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+	{
+		Free(allocation);
+		throw std::runtime_error("failed to bind buffer memory!");
+	}
+	return allocation;
+}
+
+GP2_MemoryAllocator::Allocation GP2_MemoryAllocator::AllocateForImage(VkImage image, VkMemoryPropertyFlags properties, Category category,
+																	  std::string_view name, bool isLinearTiling)
+{
+	VkMemoryRequirements requirements{};
+	vkGetImageMemoryRequirements(m_Device, image, &requirements);
+
+	const Allocation allocation{ Allocate(requirements, properties, isLinearTiling, category, name) };
+	if (vkBindImageMemory(m_Device, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+	{
+		Free(allocation);
+		throw std::runtime_error("failed to bind image memory!");
+	}
+	return allocation;
+}
+
+GP2_MemoryAllocator::Allocation GP2_MemoryAllocator::AllocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+																	Category category, std::string_view name, bool isLinear)
+{
+	return Allocate(requirements, properties, isLinear, category, name);
+}
+
+void GP2_MemoryAllocator::Free(const Allocation& allocation)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	if (!m_Device || !allocation.memory)
+	{
+		return;
+	}
+
+	Resource& resource{ m_Resources[allocation.resourceIndex] };
+	m_HeapUsedBytes[resource.heapIndex] -= resource.size;
+	CategoryUsage& categoryUsage{ m_CategoryUsage[static_cast<uint32_t>(resource.category)] };
+	--categoryUsage.resourceCount;
+	categoryUsage.bytes -= resource.size;
+	resource.isAlive = false;
+	resource.name.clear();
+	m_UnusedResourceSlots.push_back(allocation.resourceIndex);
+
+	if (allocation.blockIndex == UINT32_MAX)
+	{
+		FreeDeviceMemory(allocation.memory, allocation.memoryTypeIndex, allocation.size);
+		std::erase(m_DedicatedMemory, allocation.memory);
+		m_DedicatedBytes -= allocation.size;
+		return;
+	}
+
+	Block& block{ *m_Blocks[allocation.blockIndex] };
+	block.allocator.Free(allocation.handle);
+	if (!block.allocator.IsEmpty())
+	{
+		return;
+	}
+
+	// one empty block per kind stays around, so a resource freed and created every frame doesn't reallocate it
+	const bool hasSibling{ std::any_of(m_Blocks.begin(), m_Blocks.end(), [&block](const std::unique_ptr<Block>& pOther)
+	{
+		return pOther && pOther.get() != &block && pOther->memoryTypeIndex == block.memoryTypeIndex && pOther->isLinear == block.isLinear;
+	}) };
+	if (hasSibling)
+	{
+		FreeDeviceMemory(block.memory, block.memoryTypeIndex, block.allocator.GetSize());
+		m_Blocks[allocation.blockIndex].reset();
+	}
+}
+
+void GP2_MemoryAllocator::Flush(const Allocation& allocation)
+{
+	if (!allocation.pMapped || IsCoherent(allocation.memoryTypeIndex))
+	{
+		return;
+	}
+
+	// sub-allocations start and end on nonCoherentAtomSize already, dedicated memory is flushed whole
+	VkMappedMemoryRange range{};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = allocation.memory;
+	range.offset = allocation.offset;
+	range.size = allocation.blockIndex == UINT32_MAX ? VK_WHOLE_SIZE : allocation.size;
+	vkFlushMappedMemoryRanges(m_Device, 1, &range);
+}
+
+GP2_MemoryAllocator::Stats GP2_MemoryAllocator::GetStats() const
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	Stats stats{};
+	stats.dedicatedCount = static_cast<uint32_t>(m_DedicatedMemory.size());
+	stats.allocationCount = stats.dedicatedCount;
+	stats.allocatedBytes = m_DedicatedBytes;
+	stats.usedBytes = m_DedicatedBytes;
+
+	VkDeviceSize freeBytes{};
+	VkDeviceSize largestFreeBytes{};
+	for (const std::unique_ptr<Block>& pBlock : m_Blocks)
+	{
+		if (!pBlock)
+		{
+			continue;
+		}
+
+		const GP2_TLSFAllocator& allocator{ pBlock->allocator };
+		++stats.blockCount;
+		stats.allocationCount += allocator.GetAllocationCount();
+		stats.allocatedBytes += allocator.GetSize();
+		stats.usedBytes += allocator.GetUsedSize();
+
+		// an empty block is spare room, not fragmentation
+		if (!allocator.IsEmpty())
+		{
+			freeBytes += allocator.GetSize() - allocator.GetUsedSize();
+			largestFreeBytes += allocator.GetLargestFreeRegion();
+		}
+	}
+
+	stats.deviceMemoryCount = stats.blockCount + stats.dedicatedCount;
+	stats.fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(largestFreeBytes) / static_cast<float>(freeBytes) : 0.0f;
+	stats.allocateCallCount = m_AllocateCallCount;
+	stats.allocateMilliseconds = m_AllocateMilliseconds;
+	return stats;
+}
+
+void GP2_MemoryAllocator::PrintStats(std::ostream& stream) const
+{
+	const Stats stats{ GetStats() };
+	stream << "Device memory: " << stats.allocationCount << " allocations in " << stats.deviceMemoryCount << " vkAllocateMemory ("
+		   << stats.blockCount << " blocks, " << stats.dedicatedCount << " dedicated), " << stats.usedBytes / (1024.0 * 1024.0) << " of "
+		   << stats.allocatedBytes / (1024.0 * 1024.0) << " MB used, " << stats.fragmentation * 100.0f << "% fragmented, "
+		   << stats.allocateCallCount << " allocations took " << stats.allocateMilliseconds << " ms" << std::endl;
+}
+
+GP2_MemoryAllocator::Report GP2_MemoryAllocator::GetReport(uint32_t largestResourceCount) const
+{
+	// read outside the lock, the driver's numbers don't need to match ours to the byte
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+	budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	if (m_HasMemoryBudget)
+	{
+		VkPhysicalDeviceMemoryProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		properties.pNext = &budget;
+		vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &properties);
+	}
+
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	Report report{};
+	report.hasMemoryBudget = m_HasMemoryBudget;
+	for (uint32_t idx = 0; idx < m_MemoryProperties.memoryHeapCount; ++idx)
+	{
+		const VkMemoryHeap& heap{ m_MemoryProperties.memoryHeaps[idx] };
+		HeapUsage usage{};
+		usage.heapIndex = idx;
+		usage.isDeviceLocal = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		usage.size = heap.size;
+		usage.budget = m_HasMemoryBudget ? budget.heapBudget[idx] : heap.size;
+		usage.usage = m_HasMemoryBudget ? budget.heapUsage[idx] : m_HeapAllocatedBytes[idx];
+		usage.allocatedBytes = m_HeapAllocatedBytes[idx];
+		usage.peakAllocatedBytes = m_HeapPeakBytes[idx];
+		usage.usedBytes = m_HeapUsedBytes[idx];
+		report.heaps.push_back(usage);
+	}
+	report.categories = m_CategoryUsage;
+
+	for (const Resource& resource : m_Resources)
+	{
+		if (resource.isAlive)
+		{
+			report.largestResources.push_back(ResourceUsage{ resource.name, resource.category, resource.heapIndex, resource.size, resource.isDedicated });
+		}
+	}
+
+	const size_t count{ std::min<size_t>(largestResourceCount, report.largestResources.size()) };
+	std::partial_sort(report.largestResources.begin(), report.largestResources.begin() + count, report.largestResources.end(),
+		[](const ResourceUsage& lhs, const ResourceUsage& rhs) { return lhs.size > rhs.size; });
+	report.largestResources.resize(count);
+	return report;
+}
+
+void GP2_MemoryAllocator::PrintReport(std::ostream& stream) const
+{
+	constexpr double megabyte{ 1024.0 * 1024.0 };
+	const Report report{ GetReport(0) };
+	for (const HeapUsage& heap : report.heaps)
+	{
+		stream << "Heap " << heap.heapIndex << (heap.isDeviceLocal ? " (device local): " : ": ") << heap.usedBytes / megabyte << " MB used in "
+			   << heap.allocatedBytes / megabyte << " MB allocated, peak " << heap.peakAllocatedBytes / megabyte << " MB, process usage "
+			   << heap.usage / megabyte << " of " << heap.budget / megabyte << " MB " << (report.hasMemoryBudget ? "budget" : "heap") << std::endl;
+	}
+
+	for (uint32_t idx = 0; idx < CategoryCount; ++idx)
+	{
+		const CategoryUsage& category{ report.categories[idx] };
+		stream << "  " << GetCategoryName(static_cast<Category>(idx)) << ": " << category.resourceCount << " resources, "
+			   << category.bytes / megabyte << " MB, peak " << category.peakBytes / megabyte << " MB" << std::endl;
+	}
+}
+
+void GP2_MemoryAllocator::WriteReport(std::ostream& stream, uint32_t largestResourceCount) const
+{
+	const Report report{ GetReport(largestResourceCount) };
+
+	stream << "{\n  \"hasMemoryBudget\": " << (report.hasMemoryBudget ? "true" : "false") << ",\n  \"heaps\": [";
+	for (size_t idx = 0; idx < report.heaps.size(); ++idx)
+	{
+		const HeapUsage& heap{ report.heaps[idx] };
+		stream << (idx ? ",\n" : "\n") << "    { \"index\": " << heap.heapIndex << ", \"deviceLocal\": " << (heap.isDeviceLocal ? "true" : "false")
+			   << ", \"size\": " << heap.size << ", \"budget\": " << heap.budget << ", \"usage\": " << heap.usage
+			   << ", \"allocated\": " << heap.allocatedBytes << ", \"peakAllocated\": " << heap.peakAllocatedBytes
+			   << ", \"used\": " << heap.usedBytes << " }";
+	}
+
+	stream << "\n  ],\n  \"categories\": {";
+	for (uint32_t idx = 0; idx < CategoryCount; ++idx)
+	{
+		const CategoryUsage& category{ report.categories[idx] };
+		stream << (idx ? ",\n" : "\n") << "    \"" << GetCategoryName(static_cast<Category>(idx)) << "\": { \"resources\": " << category.resourceCount
+			   << ", \"bytes\": " << category.bytes << ", \"peakBytes\": " << category.peakBytes << " }";
+	}
+
+	stream << "\n  },\n  \"largestResources\": [";
+	for (size_t idx = 0; idx < report.largestResources.size(); ++idx)
+	{
+		const ResourceUsage& resource{ report.largestResources[idx] };
+		stream << (idx ? ",\n" : "\n") << "    { \"name\": ";
+		WriteJsonString(stream, resource.name);
+		stream << ", \"category\": \"" << GetCategoryName(resource.category) << "\", \"heap\": " << resource.heapIndex
+			   << ", \"size\": " << resource.size << ", \"dedicated\": " << (resource.isDedicated ? "true" : "false") << " }";
+	}
+	stream << "\n  ]\n}" << std::endl;
+}
+
+const char* GP2_MemoryAllocator::GetCategoryName(Category category)
+{
+	switch (category)
+	{
+	case Category::Geometry: return "geometry";
+	case Category::Texture: return "texture";
+	case Category::RenderTarget: return "renderTarget";
+	case Category::Uniform: return "uniform";
+	case Category::Staging: return "staging";
+	default: return "other";
+	}
+}
+
+GP2_MemoryAllocator::Allocation GP2_MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool isLinear,
+															  Category category, std::string_view name)
+{
+	const auto start{ std::chrono::steady_clock::now() };
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	// the memory types are ordered by preference, a full heap moves on to the next type that fits
+	Allocation allocation{};
+	bool isAllocated{};
+	for (uint32_t idx = 0; idx < m_MemoryProperties.memoryTypeCount && !isAllocated; ++idx)
+	{
+		if ((requirements.memoryTypeBits & (1u << idx)) && (m_MemoryProperties.memoryTypes[idx].propertyFlags & properties) == properties)
+		{
+			isAllocated = AllocateFromType(idx, requirements, isLinear, allocation);
+		}
+	}
+
+	if (!isAllocated)
+	{
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+	allocation.resourceIndex = AddResource(allocation, category, name);
+
+	++m_AllocateCallCount;
+	m_AllocateMilliseconds += std::chrono::duration<double, std::milli>{ std::chrono::steady_clock::now() - start }.count();
+	return allocation;
+}
+
+bool GP2_MemoryAllocator::AllocateFromType(uint32_t memoryTypeIndex, const VkMemoryRequirements& requirements, bool isLinear, Allocation& allocation)
+{
+	const VkDeviceSize blockSize{ GetBlockSize(memoryTypeIndex) };
+	if (requirements.size >= blockSize / 2)
+	{
+		void* pMapped{};
+		const VkDeviceMemory memory{ AllocateDeviceMemory(memoryTypeIndex, requirements.size, &pMapped) };
+		if (!memory)
+		{
+			return false;
+		}
+
+		m_DedicatedMemory.push_back(memory);
+		m_DedicatedBytes += requirements.size;
+		allocation = Allocation{ this, memory, 0, requirements.size, pMapped, memoryTypeIndex, UINT32_MAX, 0, 0 };
+		return true;
+	}
+
+	// without a granularity to respect every resource shares the blocks
+	const bool blockIsLinear{ m_BufferImageGranularity > 1 ? isLinear : true };
+	// non coherent allocations are flushed in whole atoms, which mustn't reach into a neighbour
+	VkDeviceSize alignment{ requirements.alignment };
+	VkDeviceSize size{ requirements.size };
+	if (IsHostVisible(memoryTypeIndex) && !IsCoherent(memoryTypeIndex))
+	{
+		alignment = std::max(alignment, m_NonCoherentAtomSize);
+		size = (size + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+	}
+
+	const auto place = [&](uint32_t blockIndex)
+	{
+		Block& block{ *m_Blocks[blockIndex] };
+		const uint32_t handle{ block.allocator.Allocate(size, alignment) };
+		if (handle == GP2_TLSFAllocator::InvalidHandle)
+		{
+			return false;
+		}
+
+		const VkDeviceSize offset{ block.allocator.GetOffset(handle) };
+		void* pMapped{ block.pMapped ? static_cast<uint8_t*>(block.pMapped) + offset : nullptr };
+		allocation = Allocation{ this, block.memory, offset, size, pMapped, memoryTypeIndex, blockIndex, handle, 0 };
+		return true;
+	};
+
+	uint32_t unusedIndex{ UINT32_MAX };
+	for (uint32_t idx = 0; idx < static_cast<uint32_t>(m_Blocks.size()); ++idx)
+	{
+		const std::unique_ptr<Block>& pBlock{ m_Blocks[idx] };
+		if (!pBlock)
+		{
+			unusedIndex = std::min(unusedIndex, idx);
+			continue;
+		}
+
+		if (pBlock->memoryTypeIndex == memoryTypeIndex && pBlock->isLinear == blockIsLinear && place(idx))
+		{
+			return true;
+		}
+	}
+
+	void* pMapped{};
+	const VkDeviceMemory memory{ AllocateDeviceMemory(memoryTypeIndex, blockSize, &pMapped) };
+	if (!memory)
+	{
+		return false;
+	}
+
+	std::unique_ptr<Block> pBlock{ std::make_unique<Block>(Block{ memory, memoryTypeIndex, blockIsLinear, pMapped, GP2_TLSFAllocator{} }) };
+	pBlock->allocator.Initialize(blockSize);
+	if (unusedIndex == UINT32_MAX)
+	{
+		unusedIndex = static_cast<uint32_t>(m_Blocks.size());
+		m_Blocks.push_back(std::move(pBlock));
+	}
+	else
+	{
+		m_Blocks[unusedIndex] = std::move(pBlock);
+	}
+	return place(unusedIndex);
+}
+
+VkDeviceMemory GP2_MemoryAllocator::AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** ppMapped)
+{
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkDeviceMemory memory{};
+	if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	*ppMapped = nullptr;
+	if (IsHostVisible(memoryTypeIndex) && vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, ppMapped) != VK_SUCCESS)
+	{
+		vkFreeMemory(m_Device, memory, nullptr);
+		return VK_NULL_HANDLE;
+	}
+
+	const uint32_t heapIndex{ GetHeapIndex(memoryTypeIndex) };
+	m_HeapAllocatedBytes[heapIndex] += size;
+	m_HeapPeakBytes[heapIndex] = std::max(m_HeapPeakBytes[heapIndex], m_HeapAllocatedBytes[heapIndex]);
+	return memory;
+}
+
+void GP2_MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+	vkFreeMemory(m_Device, memory, nullptr);
+	m_HeapAllocatedBytes[GetHeapIndex(memoryTypeIndex)] -= size;
+}
+
+uint32_t GP2_MemoryAllocator::AddResource(const Allocation& allocation, Category category, std::string_view name)
+{
+	uint32_t slot{};
+	if (m_UnusedResourceSlots.empty())
+	{
+		slot = static_cast<uint32_t>(m_Resources.size());
+		m_Resources.emplace_back();
+	}
+	else
+	{
+		slot = m_UnusedResourceSlots.back();
+		m_UnusedResourceSlots.pop_back();
+	}
+
+	const uint32_t heapIndex{ GetHeapIndex(allocation.memoryTypeIndex) };
+	m_Resources[slot] = Resource{ std::string{ name }, category, heapIndex, allocation.size, allocation.blockIndex == UINT32_MAX, true };
+	m_HeapUsedBytes[heapIndex] += allocation.size;
+
+	CategoryUsage& categoryUsage{ m_CategoryUsage[static_cast<uint32_t>(category)] };
+	++categoryUsage.resourceCount;
+	categoryUsage.bytes += allocation.size;
+	categoryUsage.peakBytes = std::max(categoryUsage.peakBytes, categoryUsage.bytes);
+	return slot;
+}
+
+VkDeviceSize GP2_MemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const
+{
+	const VkDeviceSize heapSize{ m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size };
+	return std::min(m_BlockSize, heapSize / 8);
+}
+
+bool GP2_MemoryAllocator::IsHostVisible(uint32_t memoryTypeIndex) const
+{
+	return (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+bool GP2_MemoryAllocator::IsCoherent(uint32_t memoryTypeIndex) const
+{
+	return (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
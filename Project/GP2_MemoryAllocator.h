@@ -0,0 +1,231 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <string_view>
+
+#include "GP2_TLSFAllocator.h"
+#include "vulkan/vulkan_core.h"
+
+// Places buffers and images in large per memory type blocks instead of a vkAllocateMemory each, so thousands of
+// resources stay far below maxMemoryAllocationCount. Blocks are sub-allocated with GP2_TLSFAllocator. With a
+// bufferImageGranularity above 1, linear resources (buffers) and optimal images get separate blocks so they never share a
+// granularity page. Resources of half a block or more get a dedicated allocation. Host visible blocks are mapped once
+// for their whole lifetime, every allocation in them comes with its pointer.
+// Every allocation is tagged with a category and a debug name, GetReport lists the usage per heap against the
+// VK_EXT_memory_budget budgets, per category and the largest resources.
+// One per device, found with Get by the resources' constructors. Thread safe, streaming creates staging buffers on workers.
+class GP2_MemoryAllocator final
+{
+public:
+	enum class Category : uint32_t
+	{
+		// vertex, index and indirect buffers
+		Geometry,
+		Texture,
+		// depth and color attachments
+		RenderTarget,
+		Uniform,
+		Staging,
+		Other
+	};
+	static constexpr uint32_t CategoryCount{ 6 };
+
+	//-----------
+	// Structs
+	//-----------
+	struct Allocation
+	{
+		GP2_MemoryAllocator* pAllocator;
+		VkDeviceMemory memory;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		// null unless host visible
+		void* pMapped;
+		uint32_t memoryTypeIndex;
+		// UINT32_MAX for a dedicated allocation
+		uint32_t blockIndex;
+		uint32_t handle;
+		uint32_t resourceIndex;
+	};
+
+	struct Stats
+	{
+		// vkAllocateMemory calls alive, blocks and dedicated allocations
+		uint32_t deviceMemoryCount;
+		uint32_t blockCount;
+		uint32_t dedicatedCount;
+		// resources placed
+		uint32_t allocationCount;
+		VkDeviceSize allocatedBytes;
+		VkDeviceSize usedBytes;
+		// 1 - largest free region / free bytes over every block, 0 when the free space is one region per block
+		float fragmentation;
+		uint64_t allocateCallCount;
+		double allocateMilliseconds;
+	};
+
+	struct HeapUsage
+	{
+		uint32_t heapIndex;
+		bool isDeviceLocal;
+		VkDeviceSize size;
+		// from VK_EXT_memory_budget, the heap size and allocatedBytes without it
+		VkDeviceSize budget;
+		// by the whole process, including memory this allocator doesn't know about
+		VkDeviceSize usage;
+		// this allocator's vkAllocateMemory calls and the resources placed in them
+		VkDeviceSize allocatedBytes;
+		VkDeviceSize peakAllocatedBytes;
+		VkDeviceSize usedBytes;
+	};
+
+	struct CategoryUsage
+	{
+		uint32_t resourceCount;
+		VkDeviceSize bytes;
+		VkDeviceSize peakBytes;
+	};
+
+	struct ResourceUsage
+	{
+		std::string name;
+		Category category;
+		uint32_t heapIndex;
+		VkDeviceSize size;
+		bool isDedicated;
+	};
+
+	struct Report
+	{
+		bool hasMemoryBudget;
+		std::vector<HeapUsage> heaps;
+		std::array<CategoryUsage, CategoryCount> categories;
+		// largest first
+		std::vector<ResourceUsage> largestResources;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MemoryAllocator() = default;
+	~GP2_MemoryAllocator();
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_MemoryAllocator(const GP2_MemoryAllocator&) = delete;
+	GP2_MemoryAllocator(GP2_MemoryAllocator&&) = delete;
+	GP2_MemoryAllocator& operator=(const GP2_MemoryAllocator&) = delete;
+	GP2_MemoryAllocator& operator=(GP2_MemoryAllocator&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// Registers the allocator for Get, blockSize is capped at an eighth of each memory type's heap.
+	// Budgets are read when IsMemoryBudgetSupported, the device has to be created with the extension then.
+	void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DefaultBlockSize);
+	// Frees every block, allocations still alive become dangling and freeing them afterwards does nothing
+	void Destroy();
+
+	static GP2_MemoryAllocator& Get(VkDevice device);
+	// VK_EXT_memory_budget and the Vulkan 1.1 vkGetPhysicalDeviceMemoryProperties2 it's read with
+	static bool IsMemoryBudgetSupported(VkPhysicalDevice physicalDevice);
+
+	// Allocate and bind, throw when no memory type of the requirements has room. The name shows up in the report.
+	Allocation AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties, Category category, std::string_view name);
+	Allocation AllocateForImage(VkImage image, VkMemoryPropertyFlags properties, Category category, std::string_view name,
+								bool isLinearTiling = false);
+	// Allocates without binding, for resources sharing the memory that the caller binds at offsets of its own
+	Allocation AllocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Category category,
+							  std::string_view name, bool isLinear = false);
+	void Free(const Allocation& allocation);
+	// Makes host writes to a non coherent allocation visible, does nothing for coherent memory
+	void Flush(const Allocation& allocation);
+
+	Stats GetStats() const;
+	void PrintStats(std::ostream& stream) const;
+
+	// The budgets are queried on every call, not meant for every frame
+	Report GetReport(uint32_t largestResourceCount = DefaultReportResourceCount) const;
+	// One line per heap and category
+	void PrintReport(std::ostream& stream) const;
+	// The whole report as JSON, sizes in bytes
+	void WriteReport(std::ostream& stream, uint32_t largestResourceCount = DefaultReportResourceCount) const;
+
+	static const char* GetCategoryName(Category category);
+
+	static constexpr VkDeviceSize DefaultBlockSize{ 64ull * 1024 * 1024 };
+	static constexpr uint32_t DefaultReportResourceCount{ 16 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Block
+	{
+		VkDeviceMemory memory;
+		uint32_t memoryTypeIndex;
+		bool isLinear;
+		void* pMapped;
+		GP2_TLSFAllocator allocator;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		Category category;
+		uint32_t heapIndex;
+		VkDeviceSize size;
+		bool isDedicated;
+		bool isAlive;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool isLinear, Category category,
+						std::string_view name);
+	bool AllocateFromType(uint32_t memoryTypeIndex, const VkMemoryRequirements& requirements, bool isLinear, Allocation& allocation);
+	// nullptr when the heap is out of memory, host visible memory comes mapped
+	VkDeviceMemory AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** ppMapped);
+	void FreeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size);
+	uint32_t AddResource(const Allocation& allocation, Category category, std::string_view name);
+	// capped at an eighth of the memory type's heap
+	VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+
+	bool IsHostVisible(uint32_t memoryTypeIndex) const;
+	bool IsCoherent(uint32_t memoryTypeIndex) const;
+	uint32_t GetHeapIndex(uint32_t memoryTypeIndex) const { return m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex; }
+
+	//-----------
+	// Variables
+	//-----------
+	VkDevice m_Device{};
+	VkPhysicalDevice m_PhysicalDevice{};
+	bool m_HasMemoryBudget{};
+	VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+	VkDeviceSize m_BlockSize{};
+	VkDeviceSize m_BufferImageGranularity{};
+	VkDeviceSize m_NonCoherentAtomSize{};
+
+	mutable std::mutex m_Mutex;
+	// a block's index stays valid while it's alive, freed blocks leave an empty slot
+	std::vector<std::unique_ptr<Block>> m_Blocks;
+	std::vector<VkDeviceMemory> m_DedicatedMemory;
+	VkDeviceSize m_DedicatedBytes{};
+	uint64_t m_AllocateCallCount{};
+	double m_AllocateMilliseconds{};
+
+	// indexed by Allocation::resourceIndex, freed slots are reused
+	std::vector<Resource> m_Resources;
+	std::vector<uint32_t> m_UnusedResourceSlots;
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_HeapAllocatedBytes{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_HeapPeakBytes{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_HeapUsedBytes{};
+	std::array<CategoryUsage, CategoryCount> m_CategoryUsage{};
+};
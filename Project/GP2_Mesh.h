@@ -9,7 +9,8 @@
 #include "GP2_Shader.h"
 #include "GP2_Buffer.h"
 #include "GP2_Texture.h"
-#include "GP2_CommandPool.h"
+#include "GP2_UploadContext.h"
+#include "GP2_OBJParser.h"
 #include "vulkanbase/VulkanUtil.h"
 
 template<typename VertexType> 
@@ -19,13 +20,13 @@ public:
 	//---------------------------
 	// Constructors & Destructor
 	//---------------------------
-	GP2_Mesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool); 
+	GP2_Mesh(VulkanContext context);
 	~GP2_Mesh() = default;
 
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices);
+	void Initialize(GP2_UploadContext& uploadContext);
 	void DestroyMesh();
 	void Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer);
 
@@ -33,7 +34,7 @@ public:
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color, const glm::vec2 texCoord); 
 	void AddVertex(const glm::vec3 pos, const glm::vec3 color, const glm::vec3 normal); 
 	void AddVertices(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals, const glm::vec3 color);
-	void AddIndices(const std::vector<uint16_t> indices); 
+	void AddIndices(const std::vector<uint32_t> indices); 
 
 	GP2_Texture* GetTexture(const int index) const { return m_pTextures[index]; }
 
@@ -55,47 +56,48 @@ private:
 	GP2_Buffer* m_pIndexBuffer;
 	
 	std::vector<VertexType> m_MeshVertices;  
-	std::vector<uint16_t> m_MeshIndices;
+	std::vector<uint32_t> m_MeshIndices;
+	VkIndexType m_IndexType;
 	std::vector<GP2_Texture*> m_pTextures; 
 
 	MeshData m_VertexConstant; 
 };
 
 template<typename VertexType>
-GP2_Mesh<VertexType>::GP2_Mesh(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool) :
+GP2_Mesh<VertexType>::GP2_Mesh(VulkanContext context) :
 	m_Device{ context.device },
 	m_PhysicalDevice{ context.physicalDevice },
 	m_VertexConstant{ glm::mat4(1.f) },
 	m_pVertexBuffer{},
 	m_pIndexBuffer{},
+	m_IndexType{ VK_INDEX_TYPE_UINT16 },
 	m_pTextures( 5 )
 {
 	for (auto& pTexture : m_pTextures) 
 	{
-		pTexture = { context, graphicsQueue, commandPool };
+		pTexture = new GP2_Texture{ context };
 	}
 }
 
 template<typename VertexType>
-void GP2_Mesh<VertexType>::Initialize(VkQueue graphicsQueue, QueueFamilyIndices queueFamilyIndices)
+void GP2_Mesh<VertexType>::Initialize(GP2_UploadContext& uploadContext)
 {
 	//VERTEX BUFFER
-	GP2_Buffer vertexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshVertices[0])* m_MeshVertices.size()};
-	vertexStagingBuffer.TransferDeviceLocal(m_MeshVertices.data());
-
 	m_pVertexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshVertices[0])* m_MeshVertices.size()};
-	m_pVertexBuffer->CopyBuffer(vertexStagingBuffer, graphicsQueue, queueFamilyIndices);
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshVertices[0])* m_MeshVertices.size(),
+					GP2_MemoryAllocator::Category::Geometry, "mesh vertices" };
+	uploadContext.UploadBuffer(m_MeshVertices.data(), m_pVertexBuffer->GetSizeInBytes(), *m_pVertexBuffer);
 
 	//INDEX BUFFER
-	GP2_Buffer indexStagingBuffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(m_MeshIndices[0])* m_MeshIndices.size()};
-	indexStagingBuffer.TransferDeviceLocal(m_MeshIndices.data());
+	m_IndexType = GP2_Buffer::SelectIndexType(m_MeshVertices.size());
+	const VkDeviceSize indexBufferSize{ GP2_Buffer::GetIndexSize(m_IndexType) * m_MeshIndices.size() };
+
+	const GP2_StagingPool::Allocation indexStaging{ uploadContext.GetStagingPool().Allocate(indexBufferSize) };
+	GP2_Buffer::WriteIndices(indexStaging.pMapped, m_MeshIndices.data(), m_MeshIndices.size(), m_IndexType);
 
 	m_pIndexBuffer = new GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(m_MeshIndices[0])* m_MeshIndices.size()};
-	m_pIndexBuffer->CopyBuffer(indexStagingBuffer, graphicsQueue, queueFamilyIndices);
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBufferSize, GP2_MemoryAllocator::Category::Geometry, "mesh indices" };
+	uploadContext.CopyBuffer(indexStaging, *m_pIndexBuffer);
 }
 
 template<typename VertexType>
@@ -120,7 +122,7 @@ template<typename VertexType>
 void GP2_Mesh<VertexType>::Draw(VkPipelineLayout pipelineLayout, VkCommandBuffer buffer)
 {
 	m_pVertexBuffer->BindAsVertexBuffer(buffer);
-	m_pIndexBuffer->BindAsIndexBuffer(buffer);
+	m_pIndexBuffer->BindAsIndexBuffer(buffer, m_IndexType);
 
 	vkCmdPushConstants(
 		buffer,
@@ -162,7 +164,7 @@ void GP2_Mesh<VertexType>::AddVertices(const std::vector<glm::vec3>& vertices, c
 }
 
 template<typename VertexType>
-void GP2_Mesh<VertexType>::AddIndices(const std::vector<uint16_t> indices)
+void GP2_Mesh<VertexType>::AddIndices(const std::vector<uint32_t> indices)
 {
 	m_MeshIndices = indices;
 }
@@ -170,98 +172,8 @@ void GP2_Mesh<VertexType>::AddIndices(const std::vector<uint16_t> indices)
 template<typename VertexType>  
 bool GP2_Mesh<VertexType>::ParseOBJ(const std::string& filename, const glm::vec3 color)
 {
-	std::ifstream file(filename);
-	if (!file.is_open()) 
-	{
-		std::cerr << "Error: Failed to open file " << filename << std::endl;
-		return false;
-	}
-
-	std::vector<glm::vec3> positions; 
-	std::vector<glm::vec3> normals; 
-
-	std::string sCommand;
-	// start a while iteration ending when the end of file is reached (ios::eof)
-	while (!file.eof())
-	{
-		//read the first word of the string, use the >> operator (istream::operator>>) 
-		file >> sCommand;
-		//use conditional statements to process the different commands	
-		if (sCommand == "#")
-		{
-			// Ignore Comment
-		}
-		else if (sCommand == "v")
-		{
-			//Vertex
-			float x, y, z;
-			file >> x >> y >> z;
-
-			positions.emplace_back(x, y, z);
-		}
-		else if (sCommand == "vn")
-		{
-			// Vertex Normal
-			float x, y, z;
-			file >> x >> y >> z;
-
-			normals.emplace_back(x, y, z);
-		}
-		else if (sCommand == "f")
-		{
-			//if a face is read:
-			//construct the 3 vertices, add them to the vertex array
-			//add three indices to the index array
-			//add the material index as attibute to the attribute array
-
-			// Faces or triangles
-			Vertex3D vertex{};   
-			size_t iPosition, iNormal; 
-
-			uint32_t tempIndices[3];
-			for (size_t iFace = 0; iFace < 3; ++iFace)
-			{	
-				// OBJ format uses 1-based arrays
-				file >> iPosition;
-				vertex.position = glm::vec3(positions[iPosition - 1].x, -positions[iPosition - 1].y, -positions[iPosition - 1].z); 
-				vertex.color = color;
-
-				if ('/' == file.peek())//is next in buffer ==  '/' ?
-				{
-					file.ignore();//read and ignore one element ('/')
-
-					if ('/' != file.peek()) 
-					{
-						// Optional texture coordinate
-						/*file >> iTexCoord;
-						vertex.uv = UVs[iTexCoord - 1];*/
-					}
-
-					if ('/' == file.peek())
-					{
-						file.ignore();
-
-						// Optional vertex normal
-						file >> iNormal;
-						vertex.normal = glm::vec3(normals[iNormal - 1].x, -normals[iNormal - 1].y, -normals[iNormal - 1].z); 
-					}
-				}
-
-				m_MeshVertices.push_back(vertex);
-				tempIndices[iFace] = uint32_t(m_MeshVertices.size()) - 1;  
-				//indices.push_back(uint32_t(vertices.size()) - 1);
-			}
-
-			m_MeshIndices.push_back(tempIndices[0]);
-			m_MeshIndices.push_back(tempIndices[1]);
-			m_MeshIndices.push_back(tempIndices[2]);
-		}
-		//read till end of line and ignore all remaining chars
-		file.ignore(1000, '\n');
-	}
-
-	file.close(); 
-	return true;
+	GP2_OBJParser parser{};
+	return parser.Parse(filename, color, m_MeshVertices, m_MeshIndices);
 }
 
 template<typename VertexType>
@@ -0,0 +1,250 @@
+#include "GP2_MeshCache.h"
+#include "GP2_VertexQuantizer.h"
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+	constexpr char Magic[4]{ 'G', 'P', '2', 'M' };
+
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	void WritePadding(std::ofstream& file, size_t size)
+	{
+		static constexpr char zeros[16]{};
+		file.write(zeros, static_cast<std::streamsize>(size));
+	}
+}
+
+bool GP2_MeshCache::Open(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags)
+{
+	Close();
+
+	if (!m_File.Open(GetCachePath(sourceFilename)) || m_File.GetSize() < sizeof(Header))
+	{
+		m_File.Close();
+		return false;
+	}
+
+	m_pHeader = reinterpret_cast<const Header*>(m_File.GetData());
+	if (std::memcmp(m_pHeader->magic, Magic, sizeof(Magic)) != 0 || m_pHeader->version != Version ||
+		m_pHeader->color != color || m_pHeader->flags != flags ||
+		!((flags & QuantizedFlag) ? IsLayoutValid<Vertex3DQuantized>() : IsLayoutValid<Vertex3D>()))
+	{
+		Close();
+		return false;
+	}
+
+	m_pSubmeshes = reinterpret_cast<const Submesh*>(m_File.GetData() + sizeof(Header) + m_pHeader->attributeCount * sizeof(AttributeDescriptor));
+
+	// a missing source keeps the cache usable, so shipped caches don't need the OBJ next to them
+	std::error_code error{};
+	const uint64_t sourceSize{ std::filesystem::file_size(sourceFilename, error) };
+	if (error)
+	{
+		return true;
+	}
+
+	if (sourceSize == m_pHeader->sourceSize && GetFileTime(sourceFilename) == m_pHeader->sourceTime)
+	{
+		return true;
+	}
+
+	// touched but not edited (checkout, copy), the content decides
+	uint64_t sourceHash{};
+	if (sourceSize == m_pHeader->sourceSize && HashFile(sourceFilename, sourceHash) && sourceHash == m_pHeader->sourceHash)
+	{
+		return true;
+	}
+
+	Close();
+	return false;
+}
+
+void GP2_MeshCache::Close()
+{
+	m_File.Close();
+	m_pHeader = nullptr;
+	m_pSubmeshes = nullptr;
+}
+
+bool GP2_MeshCache::Write(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<Vertex3D>& vertices,
+						  const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+						  const std::vector<MeshLod>& lods)
+{
+	return WriteVertices(sourceFilename, color, flags & ~QuantizedFlag, vertices, GP2_VertexQuantizer::ComputeBounds(vertices), indices, submeshes, meshlets, lods);
+}
+
+bool GP2_MeshCache::Write(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<Vertex3DQuantized>& vertices,
+						  const MeshBounds& bounds, const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+						  const std::vector<MeshLod>& lods)
+{
+	return WriteVertices(sourceFilename, color, flags | QuantizedFlag, vertices, bounds, indices, submeshes, meshlets, lods);
+}
+
+template<typename VertexType>
+bool GP2_MeshCache::WriteVertices(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<VertexType>& vertices,
+								  const MeshBounds& bounds, const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+								  const std::vector<MeshLod>& lods)
+{
+	const auto attributes{ VertexType::GetAttributeDescriptions() };
+
+	Header header{};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	if (!HashFile(sourceFilename, header.sourceHash))
+	{
+		return false;
+	}
+	header.sourceSize = std::filesystem::file_size(sourceFilename);
+	header.sourceTime = GetFileTime(sourceFilename);
+	header.color = color;
+	header.flags = flags;
+
+	header.vertexStride = sizeof(VertexType);
+	header.attributeCount = static_cast<uint32_t>(attributes.size());
+	header.vertexCount = static_cast<uint32_t>(vertices.size());
+	header.indexCount = static_cast<uint32_t>(indices.size());
+	header.indexType = vertices.size() <= size_t(UINT16_MAX) + 1 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	header.submeshCount = static_cast<uint32_t>(submeshes.size());
+	header.meshletCount = static_cast<uint32_t>(meshlets.size());
+	header.bounds = bounds;
+	header.lodCount = static_cast<uint32_t>(lods.size());
+
+	header.meshletOffset = sizeof(Header) + attributes.size() * sizeof(AttributeDescriptor) + submeshes.size() * sizeof(Submesh);
+	header.lodOffset = header.meshletOffset + meshlets.size() * sizeof(Meshlet);
+	const size_t tableEnd{ header.lodOffset + lods.size() * sizeof(MeshLod) };
+	const size_t vertexDataSize{ vertices.size() * sizeof(VertexType) };
+	header.vertexOffset = AlignUp(tableEnd, BlobAlignment);
+	header.indexOffset = AlignUp(header.vertexOffset + vertexDataSize, BlobAlignment);
+
+	const std::string cachePath{ GetCachePath(sourceFilename) };
+	const std::string tempPath{ cachePath + ".tmp" };
+	{
+		std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		for (const VkVertexInputAttributeDescription& attribute : attributes)
+		{
+			const AttributeDescriptor descriptor{ attribute.location, static_cast<uint32_t>(attribute.format), attribute.offset };
+			file.write(reinterpret_cast<const char*>(&descriptor), sizeof(AttributeDescriptor));
+		}
+		file.write(reinterpret_cast<const char*>(submeshes.data()), static_cast<std::streamsize>(submeshes.size() * sizeof(Submesh)));
+		file.write(reinterpret_cast<const char*>(meshlets.data()), static_cast<std::streamsize>(meshlets.size() * sizeof(Meshlet)));
+		file.write(reinterpret_cast<const char*>(lods.data()), static_cast<std::streamsize>(lods.size() * sizeof(MeshLod)));
+
+		WritePadding(file, header.vertexOffset - tableEnd);
+		file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertexDataSize));
+		WritePadding(file, header.indexOffset - header.vertexOffset - vertexDataSize);
+
+		if (header.indexType == VK_INDEX_TYPE_UINT16)
+		{
+			std::vector<uint16_t> narrowedIndices(indices.begin(), indices.end());
+			file.write(reinterpret_cast<const char*>(narrowedIndices.data()), static_cast<std::streamsize>(narrowedIndices.size() * sizeof(uint16_t)));
+		}
+		else
+		{
+			file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+		}
+
+		if (!file.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code error{};
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+template<typename VertexType>
+bool GP2_MeshCache::IsLayoutValid() const
+{
+	const auto attributes{ VertexType::GetAttributeDescriptions() };
+	if (m_pHeader->vertexStride != sizeof(VertexType) || m_pHeader->attributeCount != attributes.size())
+	{
+		return false;
+	}
+
+	const size_t meshletOffset{ sizeof(Header) + attributes.size() * sizeof(AttributeDescriptor) + m_pHeader->submeshCount * sizeof(Submesh) };
+	const size_t lodOffset{ meshletOffset + m_pHeader->meshletCount * sizeof(Meshlet) };
+	const size_t tableEnd{ lodOffset + m_pHeader->lodCount * sizeof(MeshLod) };
+	if (m_pHeader->meshletOffset != meshletOffset || m_pHeader->lodOffset != lodOffset || tableEnd > m_File.GetSize() ||
+		m_pHeader->vertexOffset < tableEnd || m_pHeader->vertexOffset + GetVertexDataSize() > m_pHeader->indexOffset ||
+		m_pHeader->indexOffset + GetIndexDataSize() > m_File.GetSize())
+	{
+		return false;
+	}
+
+	const AttributeDescriptor* pDescriptors{ reinterpret_cast<const AttributeDescriptor*>(m_File.GetData() + sizeof(Header)) };
+	for (size_t idx = 0; idx < attributes.size(); ++idx)
+	{
+		if (pDescriptors[idx].location != attributes[idx].location ||
+			pDescriptors[idx].format != static_cast<uint32_t>(attributes[idx].format) ||
+			pDescriptors[idx].offset != attributes[idx].offset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint64_t GP2_MeshCache::HashBytes(const char* pData, size_t size)
+{
+	// 8 bytes per step multiply-xorshift, only used to tell edited sources apart
+	constexpr uint64_t prime{ 0x9E3779B97F4A7C15ull };
+	uint64_t hash{ size * prime };
+
+	size_t offset{};
+	for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+	{
+		uint64_t word{};
+		std::memcpy(&word, pData + offset, sizeof(uint64_t));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+
+	uint64_t tail{};
+	if (offset < size)
+	{
+		std::memcpy(&tail, pData + offset, size - offset);
+	}
+	hash = (hash ^ tail) * prime;
+	return hash ^ (hash >> 32);
+}
+
+bool GP2_MeshCache::HashFile(const std::string& filename, uint64_t& hash)
+{
+	GP2_MappedFile file{};
+	if (!file.Open(filename))
+	{
+		return false;
+	}
+
+	hash = HashBytes(file.GetData(), file.GetSize());
+	return true;
+}
+
+int64_t GP2_MeshCache::GetFileTime(const std::string& filename)
+{
+	std::error_code error{};
+	const auto fileTime{ std::filesystem::last_write_time(filename, error) };
+	return error ? 0 : static_cast<int64_t>(fileTime.time_since_epoch().count());
+}
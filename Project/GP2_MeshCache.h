@@ -0,0 +1,140 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "Vertex.h"
+#include "GP2_MappedFile.h"
+
+// Binary .gp2mesh cache stored next to the source file. The file is mapped read-only and the vertex and
+// index blobs are handed out as pointers into the mapping, so they can be copied straight into staging memory.
+//
+// Layout: Header | AttributeDescriptor[attributeCount] | Submesh[submeshCount] | Meshlet[meshletCount] | MeshLod[lodCount] | vertices | indices
+// The vertex and index blobs start on a 16 byte boundary, indices are stored already narrowed to indexType.
+class GP2_MeshCache final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MeshCache() = default;
+	~GP2_MeshCache() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_MeshCache(const GP2_MeshCache&) = delete;
+	GP2_MeshCache(GP2_MeshCache&&) = delete;
+	GP2_MeshCache& operator=(const GP2_MeshCache&) = delete;
+	GP2_MeshCache& operator=(GP2_MeshCache&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// Maps the cache of sourceFilename, returns false when it's missing, from another version or stale.
+	// A cache whose source mtime changed is still used when the source content hash matches.
+	// flags describe the processing the cached mesh went through, a cache built with other flags is stale.
+	bool Open(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags = 0);
+	void Close();
+
+	// Writes the cache of sourceFilename through a temporary file, so a half written cache is never picked up
+	static bool Write(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<Vertex3D>& vertices,
+					  const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+					  const std::vector<MeshLod>& lods);
+	// QuantizedFlag is added to flags, bounds are the ones the vertices were quantized against
+	static bool Write(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<Vertex3DQuantized>& vertices,
+					  const MeshBounds& bounds, const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+					  const std::vector<MeshLod>& lods);
+	// vertex cache, overdraw and fetch order from GP2_MeshOptimizer
+	static constexpr uint32_t OptimizedFlag{ 1u << 0 };
+	// Vertex3DQuantized instead of Vertex3D vertices
+	static constexpr uint32_t QuantizedFlag{ 1u << 1 };
+
+	static std::string GetCachePath(const std::string& sourceFilename) { return sourceFilename + ".gp2mesh"; }
+
+	bool IsOpen() const { return m_pHeader != nullptr; }
+
+	bool IsQuantized() const { return (m_pHeader->flags & QuantizedFlag) != 0; }
+
+	const void* GetVertexData() const { return m_File.GetData() + m_pHeader->vertexOffset; }
+	VkDeviceSize GetVertexDataSize() const { return VkDeviceSize(m_pHeader->vertexCount) * m_pHeader->vertexStride; }
+	const void* GetIndexData() const { return m_File.GetData() + m_pHeader->indexOffset; }
+	VkDeviceSize GetIndexDataSize() const { return VkDeviceSize(m_pHeader->indexCount) * (m_pHeader->indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t)); }
+
+	uint32_t GetVertexCount() const { return m_pHeader->vertexCount; }
+	uint32_t GetIndexCount() const { return m_pHeader->indexCount; }
+	VkIndexType GetIndexType() const { return static_cast<VkIndexType>(m_pHeader->indexType); }
+	const MeshBounds& GetBounds() const { return m_pHeader->bounds; }
+	const Submesh* GetSubmeshes() const { return m_pSubmeshes; }
+	uint32_t GetSubmeshCount() const { return m_pHeader->submeshCount; }
+	const Meshlet* GetMeshlets() const { return reinterpret_cast<const Meshlet*>(m_File.GetData() + m_pHeader->meshletOffset); }
+	uint32_t GetMeshletCount() const { return m_pHeader->meshletCount; }
+	const MeshLod* GetLods() const { return reinterpret_cast<const MeshLod*>(m_File.GetData() + m_pHeader->lodOffset); }
+	uint32_t GetLodCount() const { return m_pHeader->lodCount; }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+
+		// cache key, the source path is implied by the cache path
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint64_t sourceHash;
+		glm::vec3 color;
+		uint32_t flags;
+
+		uint32_t vertexStride;
+		uint32_t attributeCount;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t indexType;
+		uint32_t submeshCount;
+		uint32_t meshletCount;
+
+		MeshBounds bounds;
+		uint32_t lodCount;
+
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t meshletOffset;
+		uint64_t lodOffset;
+	};
+
+	struct AttributeDescriptor
+	{
+		uint32_t location;
+		uint32_t format;
+		uint32_t offset;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	template<typename VertexType>
+	bool IsLayoutValid() const;
+	template<typename VertexType>
+	static bool WriteVertices(const std::string& sourceFilename, const glm::vec3 color, uint32_t flags, const std::vector<VertexType>& vertices,
+							  const MeshBounds& bounds, const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const std::vector<Meshlet>& meshlets,
+					  const std::vector<MeshLod>& lods);
+	static uint64_t HashBytes(const char* pData, size_t size);
+	static bool HashFile(const std::string& filename, uint64_t& hash);
+	static int64_t GetFileTime(const std::string& filename);
+
+	//-----------
+	// Variables
+	//-----------
+	// bump whenever Header, the blob layout or Vertex3D changes
+	static constexpr uint32_t Version{ 4 };
+	static constexpr size_t BlobAlignment{ 16 };
+
+	GP2_MappedFile m_File{};
+	const Header* m_pHeader{};
+	const Submesh* m_pSubmeshes{};
+};
@@ -0,0 +1,339 @@
+#include "GP2_MeshOptimizer.h"
+
+#include <algorithm>
+
+void GP2_MeshOptimizer::Optimize(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices)
+{
+	OptimizeOverdraw(indices, vertices);
+	OptimizeVertexFetch(vertices, indices);
+}
+
+void GP2_MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	const size_t triangleCount{ indices.size() / 3 };
+	m_HardBoundaries.clear();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	BuildAdjacency(indices, vertexCount);
+
+	m_CacheTimes.assign(vertexCount, 0);
+	m_Emitted.assign(triangleCount, false);
+	m_DeadEnd.clear();
+	m_Scratch.clear();
+	m_Scratch.reserve(triangleCount * 3);
+
+	m_HardBoundaries.push_back(0);
+
+	// timestamp - cache time > CacheSize means the vertex is no longer in the cache
+	uint32_t timestamp{ CacheSize + 1 };
+	uint32_t cursor{};
+	uint32_t fanningVertex{ indices[0] };
+
+	while (fanningVertex != NoVertex)
+	{
+		m_Candidates.clear();
+
+		// emit every remaining triangle around the fanning vertex
+		for (uint32_t adjacent = m_TriangleOffsets[fanningVertex]; adjacent < m_TriangleOffsets[fanningVertex + 1]; ++adjacent)
+		{
+			const uint32_t triangle{ m_AdjacentTriangles[adjacent] };
+			if (m_Emitted[triangle])
+			{
+				continue;
+			}
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex{ indices[triangle * 3 + corner] };
+				m_Scratch.push_back(vertex);
+				m_DeadEnd.push_back(vertex);
+				m_Candidates.push_back(vertex);
+				--m_LiveTriangles[vertex];
+
+				if (timestamp - m_CacheTimes[vertex] > CacheSize)
+				{
+					m_CacheTimes[vertex] = timestamp++;
+				}
+			}
+
+			m_Emitted[triangle] = true;
+		}
+
+		fanningVertex = GetNextVertex(cursor, timestamp);
+	}
+
+	indices.swap(m_Scratch);
+}
+
+void GP2_MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, float threshold)
+{
+	OptimizeVertexCache(indices, vertices.size());
+
+	const size_t triangleCount{ indices.size() / 3 };
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	SplitClusters(indices, vertices.size(), threshold);
+
+	glm::vec3 meshCentroid{};
+	for (const Vertex3D& vertex : vertices)
+	{
+		meshCentroid += vertex.position;
+	}
+	meshCentroid /= static_cast<float>(vertices.size());
+
+	// clusters facing away from the mesh center occlude the rest, so they go first
+	for (Cluster& cluster : m_Clusters)
+	{
+		glm::vec3 centroid{};
+		glm::vec3 normal{};
+		float area{};
+
+		for (size_t triangle = cluster.firstTriangle; triangle < cluster.firstTriangle + cluster.triangleCount; ++triangle)
+		{
+			const glm::vec3& p0{ vertices[indices[triangle * 3 + 0]].position };
+			const glm::vec3& p1{ vertices[indices[triangle * 3 + 1]].position };
+			const glm::vec3& p2{ vertices[indices[triangle * 3 + 2]].position };
+
+			const glm::vec3 areaNormal{ glm::cross(p1 - p0, p2 - p0) };
+			const float triangleArea{ glm::length(areaNormal) };
+
+			centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+			normal += areaNormal;
+			area += triangleArea;
+		}
+
+		const float normalLength{ glm::length(normal) };
+		if (area <= 0.f || normalLength <= 0.f)
+		{
+			cluster.sortKey = 0.f;
+			continue;
+		}
+
+		cluster.sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+	}
+
+	std::stable_sort(m_Clusters.begin(), m_Clusters.end(), [](const Cluster& a, const Cluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	m_Scratch.clear();
+	m_Scratch.reserve(indices.size());
+	for (const Cluster& cluster : m_Clusters)
+	{
+		m_Scratch.insert(m_Scratch.end(), indices.begin() + cluster.firstTriangle * 3,
+						 indices.begin() + (cluster.firstTriangle + cluster.triangleCount) * 3);
+	}
+
+	indices.swap(m_Scratch);
+}
+
+void GP2_MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices)
+{
+	// m_CacheTimes doubles as the remap table here
+	m_CacheTimes.assign(vertices.size(), NoVertex);
+
+	std::vector<Vertex3D> orderedVertices{};
+	orderedVertices.reserve(vertices.size());
+
+	for (uint32_t& index : indices)
+	{
+		if (m_CacheTimes[index] == NoVertex)
+		{
+			m_CacheTimes[index] = static_cast<uint32_t>(orderedVertices.size());
+			orderedVertices.push_back(vertices[index]);
+		}
+		index = m_CacheTimes[index];
+	}
+
+	vertices.swap(orderedVertices);
+}
+
+GP2_MeshOptimizer::CacheStatistics GP2_MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+
+	uint32_t timestamp{ cacheSize + 1 };
+	size_t misses{};
+	size_t referencedCount{};
+
+	for (const uint32_t index : indices)
+	{
+		if (timestamp - cacheTimes[index] > cacheSize)
+		{
+			cacheTimes[index] = timestamp++;
+			++misses;
+		}
+
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			++referencedCount;
+		}
+	}
+
+	const size_t triangleCount{ indices.size() / 3 };
+	return CacheStatistics{
+		triangleCount ? static_cast<float>(misses) / static_cast<float>(triangleCount) : 0.f,
+		referencedCount ? static_cast<float>(misses) / static_cast<float>(referencedCount) : 0.f };
+}
+
+void GP2_MeshOptimizer::BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	m_LiveTriangles.assign(vertexCount, 0);
+	for (const uint32_t index : indices)
+	{
+		++m_LiveTriangles[index];
+	}
+
+	m_TriangleOffsets.resize(vertexCount + 1);
+	m_TriangleOffsets[0] = 0;
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		m_TriangleOffsets[vertex + 1] = m_TriangleOffsets[vertex] + m_LiveTriangles[vertex];
+	}
+
+	// m_CacheTimes is free until the Tipsify pass, it holds the per vertex fill position here
+	m_AdjacentTriangles.resize(indices.size());
+	std::vector<uint32_t>& fillCursors{ m_CacheTimes };
+	fillCursors.assign(m_TriangleOffsets.begin(), m_TriangleOffsets.end() - 1);
+	for (size_t index = 0; index < indices.size(); ++index)
+	{
+		m_AdjacentTriangles[fillCursors[indices[index]]++] = static_cast<uint32_t>(index / 3);
+	}
+}
+
+uint32_t GP2_MeshOptimizer::GetNextVertex(uint32_t& cursor, uint32_t timestamp)
+{
+	// prefer the candidate that stays in the cache longest while all its triangles are emitted
+	uint32_t nextVertex{ NoVertex };
+	int64_t bestPriority{ -1 };
+
+	for (const uint32_t vertex : m_Candidates)
+	{
+		if (m_LiveTriangles[vertex] == 0)
+		{
+			continue;
+		}
+
+		int64_t priority{};
+		const int64_t age{ static_cast<int64_t>(timestamp) - m_CacheTimes[vertex] };
+		if (age + 2 * static_cast<int64_t>(m_LiveTriangles[vertex]) <= CacheSize)
+		{
+			priority = age;
+		}
+
+		if (priority > bestPriority)
+		{
+			bestPriority = priority;
+			nextVertex = vertex;
+		}
+	}
+
+	if (nextVertex == NoVertex)
+	{
+		nextVertex = SkipDeadEnd(cursor);
+		if (nextVertex != NoVertex)
+		{
+			m_HardBoundaries.push_back(m_Scratch.size() / 3);
+		}
+	}
+
+	return nextVertex;
+}
+
+uint32_t GP2_MeshOptimizer::SkipDeadEnd(uint32_t& cursor)
+{
+	// recently emitted vertices first, they might still be in the cache
+	while (!m_DeadEnd.empty())
+	{
+		const uint32_t vertex{ m_DeadEnd.back() };
+		m_DeadEnd.pop_back();
+
+		if (m_LiveTriangles[vertex] > 0)
+		{
+			return vertex;
+		}
+	}
+
+	const uint32_t vertexCount{ static_cast<uint32_t>(m_LiveTriangles.size()) };
+	while (cursor < vertexCount)
+	{
+		if (m_LiveTriangles[cursor] > 0)
+		{
+			return cursor;
+		}
+		++cursor;
+	}
+
+	return NoVertex;
+}
+
+void GP2_MeshOptimizer::SplitClusters(const std::vector<uint32_t>& indices, size_t vertexCount, float threshold)
+{
+	m_Clusters.clear();
+	m_CacheTimes.assign(vertexCount, 0);
+	uint32_t timestamp{ CacheSize + 1 };
+
+	const size_t triangleCount{ indices.size() / 3 };
+	for (size_t boundary = 0; boundary < m_HardBoundaries.size(); ++boundary)
+	{
+		const size_t firstTriangle{ m_HardBoundaries[boundary] };
+		const size_t endTriangle{ boundary + 1 < m_HardBoundaries.size() ? m_HardBoundaries[boundary + 1] : triangleCount };
+
+		// the cache is cold at every hard boundary, advancing the timestamp past CacheSize flushes it
+		auto countMisses = [&](size_t triangle)
+		{
+			uint32_t misses{};
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex{ indices[triangle * 3 + corner] };
+				if (timestamp - m_CacheTimes[vertex] > CacheSize)
+				{
+					m_CacheTimes[vertex] = timestamp++;
+					++misses;
+				}
+			}
+			return misses;
+		};
+
+		timestamp += CacheSize + 1;
+		size_t hardMisses{};
+		for (size_t triangle = firstTriangle; triangle < endTriangle; ++triangle)
+		{
+			hardMisses += countMisses(triangle);
+		}
+
+		// split wherever the part so far is barely worse than the whole cluster, restarting with a cold cache
+		const float maxACMR{ threshold * static_cast<float>(hardMisses) / static_cast<float>(endTriangle - firstTriangle) };
+
+		timestamp += CacheSize + 1;
+		size_t clusterStart{ firstTriangle };
+		size_t clusterMisses{};
+		for (size_t triangle = firstTriangle; triangle < endTriangle; ++triangle)
+		{
+			clusterMisses += countMisses(triangle);
+
+			const size_t clusterSize{ triangle + 1 - clusterStart };
+			if (static_cast<float>(clusterMisses) / static_cast<float>(clusterSize) <= maxACMR)
+			{
+				m_Clusters.push_back(Cluster{ clusterStart, clusterSize, 0.f });
+				clusterStart = triangle + 1;
+				clusterMisses = 0;
+				timestamp += CacheSize + 1;
+			}
+		}
+
+		if (clusterStart < endTriangle)
+		{
+			m_Clusters.push_back(Cluster{ clusterStart, endTriangle - clusterStart, 0.f });
+		}
+	}
+}
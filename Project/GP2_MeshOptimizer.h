@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+// CPU-only reordering of imported meshes, the triangles and vertices stay the same, only their order changes.
+// Vertex cache: Tipsify (Sander, Nehab, Barczak 2007), overdraw: the clusters Tipsify leaves behind are split
+// where the cache allows it and sorted so outward facing clusters are drawn first, fetch: vertices by first use.
+class GP2_MeshOptimizer final
+{
+public:
+	//-----------
+	// Structs
+	//-----------
+	struct CacheStatistics
+	{
+		// vertex shader invocations per triangle (0.5 is the best a regular grid can do, 3 the worst)
+		float acmr;
+		// vertex shader invocations per referenced vertex (1 is optimal)
+		float atvr;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MeshOptimizer() = default;
+	~GP2_MeshOptimizer() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// All three passes in order, AnalyzeVertexCache measures what they gained
+	void Optimize(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices);
+
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+	// Runs OptimizeVertexCache first, threshold is how much worse than its cluster a split may leave the cache
+	void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, float threshold = 1.05f);
+	// Reorders vertices by first use in indices and drops the unreferenced ones
+	void OptimizeVertexFetch(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices);
+
+	// Simulates a FIFO post-transform cache
+	static CacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CacheSize);
+
+	static constexpr uint32_t CacheSize{ 16 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Cluster
+	{
+		size_t firstTriangle;
+		size_t triangleCount;
+		float sortKey;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount);
+	uint32_t GetNextVertex(uint32_t& cursor, uint32_t timestamp);
+	uint32_t SkipDeadEnd(uint32_t& cursor);
+	void SplitClusters(const std::vector<uint32_t>& indices, size_t vertexCount, float threshold);
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t NoVertex{ UINT32_MAX };
+
+	// kept between calls so optimizing several meshes reuses the same storage
+	std::vector<uint32_t> m_TriangleOffsets;
+	std::vector<uint32_t> m_AdjacentTriangles;
+	std::vector<uint32_t> m_LiveTriangles;
+	std::vector<uint32_t> m_CacheTimes;
+	std::vector<bool> m_Emitted;
+	std::vector<uint32_t> m_DeadEnd;
+	std::vector<uint32_t> m_Candidates;
+
+	// triangles where Tipsify had to leave the fan and the cache went cold
+	std::vector<size_t> m_HardBoundaries;
+	std::vector<Cluster> m_Clusters;
+	std::vector<uint32_t> m_Scratch;
+};
@@ -0,0 +1,344 @@
+#include "GP2_MeshSimplifier.h"
+
+#include <cmath>
+#include <cfloat>
+#include <numeric>
+#include <algorithm>
+
+float GP2_MeshSimplifier::Simplify(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError,
+								   std::vector<uint32_t>& destination)
+{
+	Prepare(vertices, indices);
+	const float error{ CollapseEdges(vertices, targetIndexCount, maxError) };
+
+	destination.assign(m_Indices.begin(), m_Indices.end());
+	return error;
+}
+
+void GP2_MeshSimplifier::BuildLods(const std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods, uint32_t maxLodCount, float maxError)
+{
+	lods.assign(1, MeshLod{ 0, static_cast<uint32_t>(indices.size()), 0, 0, 0.f });
+	Prepare(vertices, indices);
+
+	// every level carries on collapsing the one before, the quadrics still hold the planes of level 0
+	for (uint32_t lod = 1; lod < maxLodCount; ++lod)
+	{
+		const size_t targetIndexCount{ (size_t(lods[0].indexCount) / 3 >> lod) * 3 };
+		const float error{ CollapseEdges(vertices, targetIndexCount, maxError) };
+
+		if (m_Indices.empty() || m_Indices.size() > lods.back().indexCount * (1.f - MinLodReduction))
+		{
+			break;
+		}
+
+		lods.push_back(MeshLod{ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(m_Indices.size()), 0, 0, error });
+		indices.insert(indices.end(), m_Indices.begin(), m_Indices.end());
+	}
+}
+
+void GP2_MeshSimplifier::Prepare(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices)
+{
+	m_Indices.assign(indices.begin(), indices.end() - indices.size() % 3);
+	m_Remap.resize(vertices.size());
+	std::iota(m_Remap.begin(), m_Remap.end(), 0u);
+	m_ErrorSquared = 0.f;
+
+	BuildPositionIds(vertices);
+	BuildAdjacency(vertices.size());
+	ComputeQuadrics(vertices);
+	LockBorders();
+}
+
+float GP2_MeshSimplifier::CollapseEdges(const std::vector<Vertex3D>& vertices, size_t targetIndexCount, float maxError)
+{
+	const size_t targetTriangleCount{ targetIndexCount / 3 };
+	const float maxErrorSquared{ maxError * maxError };
+
+	// every pass collapses a batch of independent edges, cheapest first, then rebuilds the index buffer
+	while (m_Indices.size() / 3 > targetTriangleCount)
+	{
+		CollectCollapses(vertices);
+		std::sort(m_Collapses.begin(), m_Collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+		m_Touched.assign(vertices.size(), false);
+		size_t triangleCount{ m_Indices.size() / 3 };
+		size_t collapseCount{};
+
+		for (const Collapse& collapse : m_Collapses)
+		{
+			if (collapse.error > maxErrorSquared || triangleCount <= targetTriangleCount)
+			{
+				break;
+			}
+
+			const uint32_t toId{ m_PositionIds[collapse.to] };
+			if (m_Touched[collapse.from] || m_Touched[toId] || IsFlipped(vertices, collapse.from, collapse.to))
+			{
+				continue;
+			}
+
+			// the whole ring around from moves with it, so no other collapse this pass may rely on its old shape
+			for (uint32_t adjacent = m_TriangleOffsets[collapse.from]; adjacent < m_TriangleOffsets[collapse.from + 1]; ++adjacent)
+			{
+				const uint32_t* pTriangle{ m_Indices.data() + size_t(m_AdjacentTriangles[adjacent]) * 3 };
+				bool isRemoved{};
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					m_Touched[m_PositionIds[pTriangle[corner]]] = true;
+					isRemoved = isRemoved || m_PositionIds[pTriangle[corner]] == toId;
+				}
+				triangleCount -= isRemoved ? 1 : 0;
+			}
+
+			m_Remap[collapse.from] = collapse.to;
+			AddQuadric(m_Quadrics[toId], m_Quadrics[collapse.from]);
+			m_ErrorSquared = std::max(m_ErrorSquared, collapse.error);
+			++collapseCount;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		ApplyCollapses();
+		BuildAdjacency(vertices.size());
+	}
+
+	return std::sqrt(m_ErrorSquared);
+}
+
+void GP2_MeshSimplifier::BuildPositionIds(const std::vector<Vertex3D>& vertices)
+{
+	m_SortedVertices.resize(vertices.size());
+	std::iota(m_SortedVertices.begin(), m_SortedVertices.end(), 0u);
+	std::sort(m_SortedVertices.begin(), m_SortedVertices.end(), [&vertices](uint32_t a, uint32_t b)
+		{
+			const glm::vec3& positionA{ vertices[a].position };
+			const glm::vec3& positionB{ vertices[b].position };
+			if (positionA.x != positionB.x) return positionA.x < positionB.x;
+			if (positionA.y != positionB.y) return positionA.y < positionB.y;
+			if (positionA.z != positionB.z) return positionA.z < positionB.z;
+			return a < b;
+		});
+
+	// the first vertex of every run of equal positions stands for all of them, a run longer than one is a seam
+	m_PositionIds.resize(vertices.size());
+	m_Locked.assign(vertices.size(), false);
+	for (size_t first = 0; first < m_SortedVertices.size();)
+	{
+		size_t last{ first + 1 };
+		while (last < m_SortedVertices.size() && vertices[m_SortedVertices[last]].position == vertices[m_SortedVertices[first]].position)
+		{
+			++last;
+		}
+
+		for (size_t sorted = first; sorted < last; ++sorted)
+		{
+			m_PositionIds[m_SortedVertices[sorted]] = m_SortedVertices[first];
+		}
+		m_Locked[m_SortedVertices[first]] = last - first > 1;
+		first = last;
+	}
+}
+
+void GP2_MeshSimplifier::BuildAdjacency(size_t vertexCount)
+{
+	m_TriangleOffsets.assign(vertexCount + 1, 0);
+	for (const uint32_t index : m_Indices)
+	{
+		++m_TriangleOffsets[m_PositionIds[index] + 1];
+	}
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		m_TriangleOffsets[vertex + 1] += m_TriangleOffsets[vertex];
+	}
+
+	m_AdjacentTriangles.resize(m_Indices.size());
+	m_AdjacencyCursors.assign(m_TriangleOffsets.begin(), m_TriangleOffsets.end() - 1);
+	for (size_t index = 0; index < m_Indices.size(); ++index)
+	{
+		m_AdjacentTriangles[m_AdjacencyCursors[m_PositionIds[m_Indices[index]]]++] = static_cast<uint32_t>(index / 3);
+	}
+}
+
+void GP2_MeshSimplifier::ComputeQuadrics(const std::vector<Vertex3D>& vertices)
+{
+	m_Quadrics.assign(vertices.size(), Quadric{});
+
+	for (size_t index = 0; index < m_Indices.size(); index += 3)
+	{
+		const glm::vec3& p0{ vertices[m_Indices[index + 0]].position };
+		const glm::vec3& p1{ vertices[m_Indices[index + 1]].position };
+		const glm::vec3& p2{ vertices[m_Indices[index + 2]].position };
+
+		const glm::vec3 normal{ glm::cross(p1 - p0, p2 - p0) };
+		const float length{ glm::length(normal) };
+		if (length <= 0.f)
+		{
+			continue;
+		}
+
+		// weighted by area, so the error of a vertex is the mean squared distance to its planes
+		const double nx{ normal.x / length };
+		const double ny{ normal.y / length };
+		const double nz{ normal.z / length };
+		const double d{ -(nx * p0.x + ny * p0.y + nz * p0.z) };
+		const double area{ length * 0.5 };
+		const Quadric plane{
+			nx * nx * area, nx * ny * area, nx * nz * area, ny * ny * area, ny * nz * area, nz * nz * area,
+			nx * d * area, ny * d * area, nz * d * area,
+			d * d * area,
+			area
+		};
+
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			AddQuadric(m_Quadrics[m_PositionIds[m_Indices[index + corner]]], plane);
+		}
+	}
+}
+
+void GP2_MeshSimplifier::LockBorders()
+{
+	m_Edges.resize(m_Indices.size());
+	for (size_t index = 0; index < m_Indices.size(); ++index)
+	{
+		const uint64_t from{ m_PositionIds[m_Indices[index]] };
+		const uint64_t to{ m_PositionIds[m_Indices[index - index % 3 + (index + 1) % 3]] };
+		m_Edges[index] = from << 32 | to;
+	}
+	std::sort(m_Edges.begin(), m_Edges.end());
+
+	// an edge nobody walks the other way belongs to a single triangle, moving its ends would eat into the outline
+	for (const uint64_t edge : m_Edges)
+	{
+		const uint64_t reversedEdge{ edge << 32 | edge >> 32 };
+		if (!std::binary_search(m_Edges.begin(), m_Edges.end(), reversedEdge))
+		{
+			m_Locked[edge >> 32] = true;
+			m_Locked[edge & UINT32_MAX] = true;
+		}
+	}
+}
+
+void GP2_MeshSimplifier::CollectCollapses(const std::vector<Vertex3D>& vertices)
+{
+	m_Collapses.clear();
+
+	for (size_t index = 0; index < m_Indices.size(); ++index)
+	{
+		const uint32_t from{ m_Indices[index] };
+		const uint32_t to{ m_Indices[index - index % 3 + (index + 1) % 3] };
+		const uint32_t fromId{ m_PositionIds[from] };
+		const uint32_t toId{ m_PositionIds[to] };
+
+		// both triangles on an edge walk it, the one going up takes it. Only the cheaper direction becomes a
+		// candidate, an unlocked vertex has a position of its own, so it is its own position id
+		if (fromId > toId || (m_Locked[fromId] && m_Locked[toId]))
+		{
+			continue;
+		}
+
+		const float forwardError{ m_Locked[fromId] ? FLT_MAX : GetError(m_Quadrics[fromId], m_Quadrics[toId], vertices[to].position) };
+		const float backwardError{ m_Locked[toId] ? FLT_MAX : GetError(m_Quadrics[toId], m_Quadrics[fromId], vertices[from].position) };
+		m_Collapses.push_back(forwardError <= backwardError ? Collapse{ from, to, forwardError } : Collapse{ to, from, backwardError });
+	}
+}
+
+bool GP2_MeshSimplifier::IsFlipped(const std::vector<Vertex3D>& vertices, uint32_t from, uint32_t to) const
+{
+	const uint32_t toId{ m_PositionIds[to] };
+	const glm::vec3& target{ vertices[to].position };
+
+	for (uint32_t adjacent = m_TriangleOffsets[from]; adjacent < m_TriangleOffsets[from + 1]; ++adjacent)
+	{
+		const uint32_t* pTriangle{ m_Indices.data() + size_t(m_AdjacentTriangles[adjacent]) * 3 };
+		glm::vec3 positions[3]{};
+		glm::vec3 movedPositions[3]{};
+		bool isRemoved{};
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t id{ m_PositionIds[pTriangle[corner]] };
+			isRemoved = isRemoved || id == toId;
+			positions[corner] = vertices[pTriangle[corner]].position;
+			movedPositions[corner] = id == from ? target : positions[corner];
+		}
+
+		// triangles on the collapsed edge disappear, the rest must keep facing the same way
+		if (isRemoved)
+		{
+			continue;
+		}
+
+		const glm::vec3 normal{ glm::cross(positions[1] - positions[0], positions[2] - positions[0]) };
+		const glm::vec3 movedNormal{ glm::cross(movedPositions[1] - movedPositions[0], movedPositions[2] - movedPositions[0]) };
+		if (glm::dot(normal, movedNormal) <= 0.f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GP2_MeshSimplifier::ApplyCollapses()
+{
+	size_t writeIndex{};
+	for (size_t index = 0; index < m_Indices.size(); index += 3)
+	{
+		const uint32_t i0{ m_Remap[m_Indices[index + 0]] };
+		const uint32_t i1{ m_Remap[m_Indices[index + 1]] };
+		const uint32_t i2{ m_Remap[m_Indices[index + 2]] };
+
+		const uint32_t id0{ m_PositionIds[i0] };
+		const uint32_t id1{ m_PositionIds[i1] };
+		const uint32_t id2{ m_PositionIds[i2] };
+		if (id0 == id1 || id1 == id2 || id2 == id0)
+		{
+			continue;
+		}
+
+		m_Indices[writeIndex++] = i0;
+		m_Indices[writeIndex++] = i1;
+		m_Indices[writeIndex++] = i2;
+	}
+	m_Indices.resize(writeIndex);
+}
+
+void GP2_MeshSimplifier::AddQuadric(Quadric& quadric, const Quadric& other)
+{
+	quadric.a00 += other.a00;
+	quadric.a01 += other.a01;
+	quadric.a02 += other.a02;
+	quadric.a11 += other.a11;
+	quadric.a12 += other.a12;
+	quadric.a22 += other.a22;
+	quadric.b0 += other.b0;
+	quadric.b1 += other.b1;
+	quadric.b2 += other.b2;
+	quadric.c += other.c;
+	quadric.weight += other.weight;
+}
+
+float GP2_MeshSimplifier::GetError(const Quadric& quadric, const Quadric& other, const glm::vec3& position)
+{
+	Quadric sum{ quadric };
+	AddQuadric(sum, other);
+	if (sum.weight <= 0.0)
+	{
+		return 0.f;
+	}
+
+	const double x{ position.x };
+	const double y{ position.y };
+	const double z{ position.z };
+	const double error{
+		sum.a00 * x * x + sum.a11 * y * y + sum.a22 * z * z +
+		2.0 * (sum.a01 * x * y + sum.a02 * x * z + sum.a12 * y * z) +
+		2.0 * (sum.b0 * x + sum.b1 * y + sum.b2 * z) +
+		sum.c
+	};
+
+	return static_cast<float>(std::max(error, 0.0) / sum.weight);
+}
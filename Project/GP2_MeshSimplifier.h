@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+// Quadric error edge collapse (Garland, Heckbert 1997). A vertex only ever collapses onto one of its neighbours,
+// so the simplified triangles keep indexing the original vertices and every level of detail shares one vertex buffer.
+// Vertices on open borders and on attribute seams (several vertices at one position) are never moved.
+class GP2_MeshSimplifier final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MeshSimplifier() = default;
+	~GP2_MeshSimplifier() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// Collapses edges until destination holds at most targetIndexCount indices or the next collapse would move the
+	// surface further than maxError (object space). Returns the largest error a collapse introduced.
+	float Simplify(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError,
+				   std::vector<uint32_t>& destination);
+	// Replaces lods with the chain for indices, level 0 is indices as they are and every coarser level is appended to
+	// indices, aiming at half the triangles of the level before. Stops early once a level barely gets smaller.
+	void BuildLods(const std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods, uint32_t maxLodCount, float maxError);
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// symmetric plane quadric, error(p) = p'Ap + 2b'p + c, summed over the area weighted planes around a vertex
+	struct Quadric
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		float error;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void Prepare(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices);
+	// Returns the largest error since Prepare
+	float CollapseEdges(const std::vector<Vertex3D>& vertices, size_t targetIndexCount, float maxError);
+	void BuildPositionIds(const std::vector<Vertex3D>& vertices);
+	void BuildAdjacency(size_t vertexCount);
+	void ComputeQuadrics(const std::vector<Vertex3D>& vertices);
+	void LockBorders();
+	void CollectCollapses(const std::vector<Vertex3D>& vertices);
+	bool IsFlipped(const std::vector<Vertex3D>& vertices, uint32_t from, uint32_t to) const;
+	void ApplyCollapses();
+
+	static void AddQuadric(Quadric& quadric, const Quadric& other);
+	static float GetError(const Quadric& quadric, const Quadric& other, const glm::vec3& position);
+
+	//-----------
+	// Variables
+	//-----------
+	// a level has to drop at least this share of the triangles of the one before to be worth keeping
+	static constexpr float MinLodReduction{ 0.2f };
+
+	// kept between calls so every level of a chain reuses the same storage
+	std::vector<uint32_t> m_Indices;
+	// lowest vertex index with the same position, quadrics, locks and adjacency are kept per position
+	std::vector<uint32_t> m_PositionIds;
+	std::vector<uint32_t> m_SortedVertices;
+	std::vector<Quadric> m_Quadrics;
+	std::vector<bool> m_Locked;
+	std::vector<bool> m_Touched;
+	std::vector<uint32_t> m_Remap;
+	std::vector<uint32_t> m_TriangleOffsets;
+	std::vector<uint32_t> m_AdjacentTriangles;
+	std::vector<uint32_t> m_AdjacencyCursors;
+	std::vector<uint64_t> m_Edges;
+	std::vector<Collapse> m_Collapses;
+	float m_ErrorSquared{};
+};
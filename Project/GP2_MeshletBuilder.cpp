@@ -0,0 +1,110 @@
+#include "GP2_MeshletBuilder.h"
+
+#include <cmath>
+#include <algorithm>
+
+void GP2_MeshletBuilder::Build(const std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, std::vector<Meshlet>& meshlets)
+{
+	meshlets.clear();
+	Build(indices, 0, static_cast<uint32_t>(indices.size()), vertices, meshlets);
+}
+
+void GP2_MeshletBuilder::Build(const std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t indexCount, const std::vector<Vertex3D>& vertices, std::vector<Meshlet>& meshlets)
+{
+	m_VertexMeshlets.assign(vertices.size(), NoMeshlet);
+	m_MeshletVertices.clear();
+
+	const size_t endTriangle{ (size_t(firstIndex) + indexCount) / 3 };
+	Meshlet meshlet{};
+	meshlet.firstIndex = firstIndex;
+
+	for (size_t triangle = firstIndex / 3; triangle < endTriangle; ++triangle)
+	{
+		const uint32_t* pTriangle{ indices.data() + triangle * 3 };
+
+		uint32_t newVertices{};
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			newVertices += m_VertexMeshlets[pTriangle[corner]] != meshlets.size() ? 1 : 0;
+		}
+
+		// close the meshlet when this triangle doesn't fit anymore
+		if (m_MeshletVertices.size() + newVertices > MaxVertices || meshlet.triangleCount == MaxTriangles)
+		{
+			ComputeBounds(indices, vertices, meshlet);
+			meshlets.push_back(meshlet);
+
+			meshlet = Meshlet{};
+			meshlet.firstIndex = static_cast<uint32_t>(triangle * 3);
+			m_MeshletVertices.clear();
+		}
+
+		const uint32_t meshletIndex{ static_cast<uint32_t>(meshlets.size()) };
+		for (size_t corner = 0; corner < 3; ++corner)
+		{
+			if (m_VertexMeshlets[pTriangle[corner]] != meshletIndex)
+			{
+				m_VertexMeshlets[pTriangle[corner]] = meshletIndex;
+				m_MeshletVertices.push_back(pTriangle[corner]);
+			}
+		}
+		++meshlet.triangleCount;
+	}
+
+	if (meshlet.triangleCount > 0)
+	{
+		ComputeBounds(indices, vertices, meshlet);
+		meshlets.push_back(meshlet);
+	}
+}
+
+void GP2_MeshletBuilder::ComputeBounds(const std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, Meshlet& meshlet)
+{
+	// sphere around the box center, a bit looser than a minimal sphere but cheap and stable
+	glm::vec3 minimum{ vertices[m_MeshletVertices[0]].position };
+	glm::vec3 maximum{ minimum };
+	for (const uint32_t vertex : m_MeshletVertices)
+	{
+		minimum = glm::min(minimum, vertices[vertex].position);
+		maximum = glm::max(maximum, vertices[vertex].position);
+	}
+
+	meshlet.center = (minimum + maximum) * 0.5f;
+	meshlet.radius = 0.f;
+	for (const uint32_t vertex : m_MeshletVertices)
+	{
+		meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[vertex].position));
+	}
+
+	// the cone axis averages the triangle normals, the widest deviation from it decides the cutoff
+	const uint32_t* pIndices{ indices.data() + meshlet.firstIndex };
+	glm::vec3 normalSum{};
+	std::vector<glm::vec3>& normals{ m_TriangleNormals };
+	normals.resize(meshlet.triangleCount);
+	for (uint32_t triangle = 0; triangle < meshlet.triangleCount; ++triangle)
+	{
+		const glm::vec3& p0{ vertices[pIndices[triangle * 3 + 0]].position };
+		const glm::vec3& p1{ vertices[pIndices[triangle * 3 + 1]].position };
+		const glm::vec3& p2{ vertices[pIndices[triangle * 3 + 2]].position };
+
+		const glm::vec3 normal{ glm::cross(p1 - p0, p2 - p0) };
+		const float length{ glm::length(normal) };
+		normals[triangle] = length > 0.f ? normal / length : glm::vec3{};
+		normalSum += normals[triangle];
+	}
+
+	const float axisLength{ glm::length(normalSum) };
+	meshlet.coneAxis = axisLength > 0.f ? normalSum / axisLength : glm::vec3{ 0.f, 0.f, 1.f };
+
+	float minDot{ 1.f };
+	for (const glm::vec3& normal : normals)
+	{
+		if (glm::dot(normal, normal) > 0.f)
+		{
+			minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+		}
+	}
+
+	// a cone wider than ~85 degrees almost never culls, a cutoff of 1 disables the test
+	meshlet.coneCutoff = (axisLength > 0.f && minDot > 0.1f) ? std::sqrt(1.f - minDot * minDot) : 1.f;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+// Splits an index buffer in meshlets of at most MaxVertices unique vertices and MaxTriangles triangles.
+// Triangles are taken in index buffer order, so run GP2_MeshOptimizer first to get compact clusters.
+class GP2_MeshletBuilder final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MeshletBuilder() = default;
+	~GP2_MeshletBuilder() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// Replaces meshlets, the index buffer is left as is
+	void Build(const std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, std::vector<Meshlet>& meshlets);
+	// Appends the meshlets of indexCount indices starting at firstIndex, for index buffers holding several levels of detail
+	void Build(const std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t indexCount, const std::vector<Vertex3D>& vertices, std::vector<Meshlet>& meshlets);
+
+	static constexpr uint32_t MaxVertices{ 64 };
+	static constexpr uint32_t MaxTriangles{ 124 };
+
+private:
+	//-----------
+	// Functions
+	//-----------
+	void ComputeBounds(const std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices, Meshlet& meshlet);
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t NoMeshlet{ UINT32_MAX };
+
+	// kept between calls, m_VertexMeshlets holds the last meshlet every vertex was added to
+	std::vector<uint32_t> m_VertexMeshlets;
+	std::vector<uint32_t> m_MeshletVertices;
+	std::vector<glm::vec3> m_TriangleNormals;
+};
@@ -0,0 +1,93 @@
+#include "GP2_MeshletCuller.h"
+
+GP2_MeshletCuller::GP2_MeshletCuller(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, bool isBackfaceCulling) :
+	m_Planes{},
+	m_CameraPosition{},
+	m_IsBackfaceCulling{ isBackfaceCulling }
+{
+	// planes straight from the rows of the object to clip matrix (Gribb, Hartmann)
+	const glm::mat4 modelViewProjection{ projection * view * model };
+	const glm::vec4 row0{ modelViewProjection[0][0], modelViewProjection[1][0], modelViewProjection[2][0], modelViewProjection[3][0] };
+	const glm::vec4 row1{ modelViewProjection[0][1], modelViewProjection[1][1], modelViewProjection[2][1], modelViewProjection[3][1] };
+	const glm::vec4 row2{ modelViewProjection[0][2], modelViewProjection[1][2], modelViewProjection[2][2], modelViewProjection[3][2] };
+	const glm::vec4 row3{ modelViewProjection[0][3], modelViewProjection[1][3], modelViewProjection[2][3], modelViewProjection[3][3] };
+
+	// the near plane uses the -w..w depth range, conservative when the projection maps to 0..w
+	m_Planes[0] = row3 + row0;
+	m_Planes[1] = row3 - row0;
+	m_Planes[2] = row3 + row1;
+	m_Planes[3] = row3 - row1;
+	m_Planes[4] = row3 + row2;
+	m_Planes[5] = row3 - row2;
+
+	for (glm::vec4& plane : m_Planes)
+	{
+		const float length{ glm::length(glm::vec3{ plane.x, plane.y, plane.z }) };
+		if (length > 0.f)
+		{
+			plane = plane / length;
+		}
+	}
+
+	const glm::vec4 cameraPosition{ glm::inverse(view * model) * glm::vec4{ 0.f, 0.f, 0.f, 1.f } };
+	m_CameraPosition = glm::vec3{ cameraPosition.x, cameraPosition.y, cameraPosition.z } / cameraPosition.w;
+}
+
+bool GP2_MeshletCuller::IsVisible(const glm::vec3& center, float radius) const
+{
+	for (const glm::vec4& plane : m_Planes)
+	{
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GP2_MeshletCuller::IsVisible(const Meshlet& meshlet) const
+{
+	if (!IsVisible(meshlet.center, meshlet.radius))
+	{
+		return false;
+	}
+
+	if (m_IsBackfaceCulling)
+	{
+		const glm::vec3 toCenter{ meshlet.center - m_CameraPosition };
+		if (glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint32_t GP2_MeshletCuller::Cull(const std::vector<Meshlet>& meshlets, VkDrawIndexedIndirectCommand* pCommands) const
+{
+	uint32_t triangleCount{};
+	return Cull(meshlets.data(), static_cast<uint32_t>(meshlets.size()), pCommands, triangleCount);
+}
+
+uint32_t GP2_MeshletCuller::Cull(const Meshlet* pMeshlets, uint32_t meshletCount, VkDrawIndexedIndirectCommand* pCommands, uint32_t& triangleCount) const
+{
+	uint32_t drawCount{};
+	triangleCount = 0;
+	for (uint32_t meshlet = 0; meshlet < meshletCount; ++meshlet)
+	{
+		if (IsVisible(pMeshlets[meshlet]))
+		{
+			pCommands[drawCount++] = GetDrawCommand(pMeshlets[meshlet]);
+			triangleCount += pMeshlets[meshlet].triangleCount;
+		}
+	}
+
+	return drawCount;
+}
+
+VkDrawIndexedIndirectCommand GP2_MeshletCuller::GetDrawCommand(const Meshlet& meshlet)
+{
+	return VkDrawIndexedIndirectCommand{ meshlet.triangleCount * 3, 1, meshlet.firstIndex, 0, 0 };
+}
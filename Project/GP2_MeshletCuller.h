@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "Vertex.h"
+
+// CPU culling of meshlets against the view frustum and, optionally, their normal cone.
+// Everything is tested in the mesh's object space, so non-uniform model scales stay exact.
+class GP2_MeshletCuller final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	// The pipelines draw with VK_CULL_MODE_NONE, so back facing clusters are only culled on request
+	GP2_MeshletCuller(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, bool isBackfaceCulling);
+	~GP2_MeshletCuller() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	bool IsVisible(const glm::vec3& center, float radius) const;
+	bool IsVisible(const Meshlet& meshlet) const;
+
+	// Writes one indexed draw per visible meshlet, pCommands needs room for every meshlet, returns the draw count
+	uint32_t Cull(const std::vector<Meshlet>& meshlets, VkDrawIndexedIndirectCommand* pCommands) const;
+	// Also counts the triangles of the written draws
+	uint32_t Cull(const Meshlet* pMeshlets, uint32_t meshletCount, VkDrawIndexedIndirectCommand* pCommands, uint32_t& triangleCount) const;
+
+	static VkDrawIndexedIndirectCommand GetDrawCommand(const Meshlet& meshlet);
+
+private:
+	//-----------
+	// Variables
+	//-----------
+	// left, right, bottom, top, near, far with normalized xyz
+	glm::vec4 m_Planes[6];
+	glm::vec3 m_CameraPosition;
+	bool m_IsBackfaceCulling;
+};
@@ -0,0 +1,156 @@
+#include "GP2_MipGenerator.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP2_MIP_USE_SSE2
+#endif
+
+GP2_MipGenerator::GP2_MipGenerator() :
+	m_ToLinear{},
+	m_FromLinear{},
+	m_LinearRows{}
+{
+	for (uint32_t value = 0; value < 256; ++value)
+	{
+		const float encoded{ value / 255.f };
+		const float linear{ encoded <= 0.04045f ? encoded / 12.92f : std::pow((encoded + 0.055f) / 1.055f, 2.4f) };
+		m_ToLinear[value] = static_cast<uint16_t>(std::lround(linear * LinearMax));
+	}
+
+	for (uint32_t value = 0; value <= LinearMax; ++value)
+	{
+		const float linear{ float(value) / LinearMax };
+		const float encoded{ linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f };
+		m_FromLinear[value] = static_cast<uint8_t>(std::lround(std::clamp(encoded, 0.f, 1.f) * 255.f));
+	}
+}
+
+uint32_t GP2_MipGenerator::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levelCount{ 1 };
+	for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+	{
+		++levelCount;
+	}
+	return levelCount;
+}
+
+void GP2_MipGenerator::Generate(const uint8_t* pPixels, uint32_t width, uint32_t height, bool isSRGB, std::vector<uint8_t>& mips, std::vector<MipLevel>& levels)
+{
+	mips.clear();
+	levels.clear();
+
+	size_t size{};
+	for (uint32_t levelWidth = width, levelHeight = height; levelWidth > 1 || levelHeight > 1;)
+	{
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+		levels.push_back(MipLevel{ levelWidth, levelHeight, size });
+		size += size_t(levelWidth) * levelHeight * 4;
+	}
+	mips.resize(size);
+
+	// two source rows in linear space, padded to an even width so the filter never reads past them
+	const size_t linearRowSize{ size_t(width + 1) * 4 };
+	m_LinearRows.resize(linearRowSize * 2);
+	uint16_t* pLinearRow0{ m_LinearRows.data() };
+	uint16_t* pLinearRow1{ m_LinearRows.data() + linearRowSize };
+
+	const uint8_t* pSource{ pPixels };
+	uint32_t sourceWidth{ width };
+	uint32_t sourceHeight{ height };
+	for (const MipLevel& level : levels)
+	{
+		uint8_t* pDestination{ mips.data() + level.offset };
+		for (uint32_t y = 0; y < level.height; ++y)
+		{
+			const uint32_t sourceY{ std::min(y * 2, sourceHeight - 1) };
+			const uint32_t nextSourceY{ std::min(y * 2 + 1, sourceHeight - 1) };
+			ToLinear(pSource + size_t(sourceY) * sourceWidth * 4, sourceWidth, isSRGB, pLinearRow0);
+			ToLinear(pSource + size_t(nextSourceY) * sourceWidth * 4, sourceWidth, isSRGB, pLinearRow1);
+
+			// a single column pairs with itself
+			if (sourceWidth % 2 != 0)
+			{
+				std::copy_n(pLinearRow0 + size_t(sourceWidth - 1) * 4, 4, pLinearRow0 + size_t(sourceWidth) * 4);
+				std::copy_n(pLinearRow1 + size_t(sourceWidth - 1) * 4, 4, pLinearRow1 + size_t(sourceWidth) * 4);
+			}
+
+			Downsample(pLinearRow0, pLinearRow1, level.width, isSRGB, pDestination + size_t(y) * level.width * 4);
+		}
+
+		pSource = pDestination;
+		sourceWidth = level.width;
+		sourceHeight = level.height;
+	}
+}
+
+void GP2_MipGenerator::ToLinear(const uint8_t* pRow, uint32_t width, bool isSRGB, uint16_t* pLinearRow) const
+{
+	for (size_t idx = 0; idx < size_t(width) * 4; idx += 4)
+	{
+		for (size_t channel = 0; channel < 3; ++channel)
+		{
+			const uint8_t value{ pRow[idx + channel] };
+			pLinearRow[idx + channel] = isSRGB ? m_ToLinear[value] : static_cast<uint16_t>((value * LinearMax + 127) / 255);
+		}
+		pLinearRow[idx + 3] = static_cast<uint16_t>((pRow[idx + 3] * LinearMax + 127) / 255);
+	}
+}
+
+void GP2_MipGenerator::Downsample(const uint16_t* pLinearRow0, const uint16_t* pLinearRow1, uint32_t width, bool isSRGB, uint8_t* pRow) const
+{
+	// sums of four texels with rounding, then back to 8 bits
+	uint16_t averages[8]{};
+	uint32_t x{};
+
+#ifdef GP2_MIP_USE_SSE2
+	// two destination texels per iteration, each register holds two source texels of four channels
+	const __m128i rounding{ _mm_set1_epi16(2) };
+	for (; x + 2 <= width; x += 2)
+	{
+		const size_t sourceIndex{ size_t(x) * 8 };
+		const __m128i left{ _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pLinearRow0 + sourceIndex)),
+										  _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLinearRow1 + sourceIndex))) };
+		const __m128i right{ _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pLinearRow0 + sourceIndex + 8)),
+										   _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLinearRow1 + sourceIndex + 8))) };
+
+		// adding the upper half onto the lower one pairs the horizontal neighbours
+		const __m128i leftSum{ _mm_add_epi16(left, _mm_srli_si128(left, 8)) };
+		const __m128i rightSum{ _mm_add_epi16(right, _mm_srli_si128(right, 8)) };
+		const __m128i sums{ _mm_unpacklo_epi64(leftSum, rightSum) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(averages), _mm_srli_epi16(_mm_add_epi16(sums, rounding), 2));
+
+		for (size_t idx = 0; idx < 8; idx += 4)
+		{
+			uint8_t* pTexel{ pRow + size_t(x) * 4 + idx };
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				pTexel[channel] = isSRGB ? m_FromLinear[averages[idx + channel]] : static_cast<uint8_t>((averages[idx + channel] * 255 + LinearMax / 2) / LinearMax);
+			}
+			pTexel[3] = static_cast<uint8_t>((averages[idx + 3] * 255 + LinearMax / 2) / LinearMax);
+		}
+	}
+#endif
+
+	for (; x < width; ++x)
+	{
+		const size_t sourceIndex{ size_t(x) * 8 };
+		for (size_t channel = 0; channel < 4; ++channel)
+		{
+			const uint32_t sum{ uint32_t(pLinearRow0[sourceIndex + channel]) + pLinearRow0[sourceIndex + 4 + channel] +
+								pLinearRow1[sourceIndex + channel] + pLinearRow1[sourceIndex + 4 + channel] };
+			averages[channel] = static_cast<uint16_t>((sum + 2) / 4);
+		}
+
+		uint8_t* pTexel{ pRow + size_t(x) * 4 };
+		for (size_t channel = 0; channel < 3; ++channel)
+		{
+			pTexel[channel] = isSRGB ? m_FromLinear[averages[channel]] : static_cast<uint8_t>((averages[channel] * 255 + LinearMax / 2) / LinearMax);
+		}
+		pTexel[3] = static_cast<uint8_t>((averages[3] * 255 + LinearMax / 2) / LinearMax);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// CPU fallback for formats without linear filtering, where the mip chain can't be blitted on the GPU.
+// Every level is a 2x2 box filter of the one above, sRGB color is averaged in linear space like a blit of an
+// sRGB format would, alpha is always linear. Level sizes round down, so an odd side drops its last row or column
+// and a side of one pairs with itself.
+class GP2_MipGenerator final
+{
+public:
+	//-----------
+	// Structs
+	//-----------
+	struct MipLevel
+	{
+		uint32_t width;
+		uint32_t height;
+		// into the generated mips, level 1 starts at 0
+		size_t offset;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_MipGenerator();
+	~GP2_MipGenerator() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// floor(log2(largest side)) + 1, down to 1x1
+	static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+	// Writes levels 1 and down of the tightly packed RGBA8 image pPixels back to back into mips, level 0 stays with the caller
+	void Generate(const uint8_t* pPixels, uint32_t width, uint32_t height, bool isSRGB, std::vector<uint8_t>& mips, std::vector<MipLevel>& levels);
+
+private:
+	//-----------
+	// Functions
+	//-----------
+	// Converts one RGBA8 row to LinearBits per channel
+	void ToLinear(const uint8_t* pRow, uint32_t width, bool isSRGB, uint16_t* pLinearRow) const;
+	// Box filters two linear rows into one RGBA8 row of half the width
+	void Downsample(const uint16_t* pLinearRow0, const uint16_t* pLinearRow1, uint32_t width, bool isSRGB, uint8_t* pRow) const;
+
+	//-----------
+	// Variables
+	//-----------
+	// four of them still add up within 16 bits
+	static constexpr uint32_t LinearBits{ 14 };
+	static constexpr uint32_t LinearMax{ (1u << LinearBits) - 1 };
+
+	uint16_t m_ToLinear[256];
+	uint8_t m_FromLinear[LinearMax + 1];
+
+	std::vector<uint16_t> m_LinearRows;
+};
@@ -0,0 +1,614 @@
+#include "GP2_OBJParser.h"
+#include "GP2_MappedFile.h"
+
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP2_OBJ_USE_SSE2
+#endif
+
+namespace
+{
+	const char* FindLineEnd(const char* pCursor, const char* pEnd)
+	{
+#ifdef GP2_OBJ_USE_SSE2
+		// compare 16 bytes at a time, the movemask tells where the first newline is without branching per byte
+		const __m128i newline{ _mm_set1_epi8('\n') };
+		while (pEnd - pCursor >= 16)
+		{
+			const __m128i chunk{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCursor)) };
+			const int mask{ _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)) };
+			if (mask != 0)
+			{
+				return pCursor + std::countr_zero(static_cast<unsigned int>(mask));
+			}
+			pCursor += 16;
+		}
+#endif
+		const void* pNewline{ memchr(pCursor, '\n', static_cast<size_t>(pEnd - pCursor)) };
+		return pNewline ? static_cast<const char*>(pNewline) : pEnd;
+	}
+
+	bool IsBlank(char character)
+	{
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	const char* SkipBlanks(const char* pCursor, const char* pEnd)
+	{
+		while (pCursor < pEnd && IsBlank(*pCursor))
+		{
+			++pCursor;
+		}
+		return pCursor;
+	}
+
+	bool ParseFloat(const char*& pCursor, const char* pEnd, float& value)
+	{
+		pCursor = SkipBlanks(pCursor, pEnd);
+
+		// from_chars doesn't accept an explicit plus sign, operator>> did
+		if (pCursor < pEnd && *pCursor == '+')
+		{
+			++pCursor;
+		}
+
+		const std::from_chars_result result{ std::from_chars(pCursor, pEnd, value) };
+		if (result.ec != std::errc{})
+		{
+			return false;
+		}
+
+		pCursor = result.ptr;
+		return true;
+	}
+
+	bool ParseIndex(const char*& pCursor, const char* pEnd, int64_t& value)
+	{
+		const std::from_chars_result result{ std::from_chars(pCursor, pEnd, value) };
+		if (result.ec != std::errc{})
+		{
+			return false;
+		}
+
+		pCursor = result.ptr;
+		return true;
+	}
+
+	// OBJ uses 1-based indices, negative ones count back from the last element read so far
+	bool ResolveIndex(int64_t objIndex, size_t count, size_t& index)
+	{
+		if (objIndex > 0 && static_cast<size_t>(objIndex) <= count)
+		{
+			index = static_cast<size_t>(objIndex - 1);
+			return true;
+		}
+
+		if (objIndex < 0 && static_cast<size_t>(-objIndex) <= count)
+		{
+			index = count - static_cast<size_t>(-objIndex);
+			return true;
+		}
+
+		return false;
+	}
+
+	enum class LineType
+	{
+		Other,
+		Position,
+		Normal,
+		TexCoord,
+		Face
+	};
+
+	// reads the command, the first word of the line, and moves the cursor past it
+	LineType ReadCommand(const char*& pCursor, const char* pLineEnd)
+	{
+		const ptrdiff_t length{ pLineEnd - pCursor };
+		if (length < 2)
+		{
+			return LineType::Other;
+		}
+
+		if (pCursor[0] == 'v')
+		{
+			if (IsBlank(pCursor[1]))
+			{
+				pCursor += 1;
+				return LineType::Position;
+			}
+			if (length >= 3 && IsBlank(pCursor[2]))
+			{
+				pCursor += 2;
+				if (pCursor[-1] == 'n') return LineType::Normal;
+				if (pCursor[-1] == 't') return LineType::TexCoord;
+			}
+		}
+		else if (pCursor[0] == 'f' && IsBlank(pCursor[1]))
+		{
+			pCursor += 1;
+			return LineType::Face;
+		}
+
+		return LineType::Other;
+	}
+
+	bool ReadVec3(const char*& pCursor, const char* pLineEnd, glm::vec3& value)
+	{
+		return ParseFloat(pCursor, pLineEnd, value.x) && ParseFloat(pCursor, pLineEnd, value.y) && ParseFloat(pCursor, pLineEnd, value.z);
+	}
+
+	// the optional w component is ignored
+	bool ReadVec2(const char*& pCursor, const char* pLineEnd, glm::vec2& value)
+	{
+		return ParseFloat(pCursor, pLineEnd, value.x) && ParseFloat(pCursor, pLineEnd, value.y);
+	}
+
+	// reads one p, p/t, p//n or p/t/n corner, absent attributes are left at 0
+	bool ReadCorner(const char*& pCursor, const char* pLineEnd, int64_t& position, int64_t& texCoord, int64_t& normal)
+	{
+		pCursor = SkipBlanks(pCursor, pLineEnd);
+
+		position = texCoord = normal = 0;
+		if (!ParseIndex(pCursor, pLineEnd, position))
+		{
+			return false;
+		}
+
+		if (pCursor < pLineEnd && *pCursor == '/')
+		{
+			++pCursor;
+
+			// Optional texture coordinate
+			if (pCursor < pLineEnd && *pCursor != '/' && !ParseIndex(pCursor, pLineEnd, texCoord))
+			{
+				return false;
+			}
+
+			// Optional vertex normal
+			if (pCursor < pLineEnd && *pCursor == '/')
+			{
+				++pCursor;
+				if (!ParseIndex(pCursor, pLineEnd, normal))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// resolves an index stored by the chunk parser, count is what the file had read up to the face like ResolveIndex's
+	bool ResolveChunkIndex(int64_t value, bool isRelative, size_t chunkBase, size_t count, size_t& index)
+	{
+		const int64_t globalIndex{ isRelative ? static_cast<int64_t>(chunkBase) + value : value - 1 };
+		if (globalIndex < 0 || static_cast<size_t>(globalIndex) >= count)
+		{
+			return false;
+		}
+
+		index = static_cast<size_t>(globalIndex);
+		return true;
+	}
+
+	template<typename Task>
+	void RunParallel(size_t taskCount, uint32_t threadCount, const Task& task)
+	{
+		std::atomic<size_t> nextTask{ 0 };
+		const auto worker{ [&]()
+		{
+			for (size_t taskIdx = nextTask++; taskIdx < taskCount; taskIdx = nextTask++)
+			{
+				task(taskIdx);
+			}
+		} };
+
+		std::vector<std::thread> threads;
+		const size_t workerCount{ std::min<size_t>(threadCount, taskCount) };
+		for (size_t threadIdx = 1; threadIdx < workerCount; ++threadIdx)
+		{
+			threads.emplace_back(worker);
+		}
+
+		worker();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	constexpr uint8_t RelativePosition{ 1 << 0 };
+	constexpr uint8_t RelativeTexCoord{ 1 << 1 };
+	constexpr uint8_t RelativeNormal{ 1 << 2 };
+
+	// below this a chunk costs more to schedule than to parse
+	constexpr size_t MinChunkSize{ 256 * 1024 };
+	constexpr uint32_t ChunksPerThread{ 4 };
+	constexpr size_t CornersPerEmitTask{ 64 * 1024 };
+}
+
+bool GP2_OBJParser::Parse(const std::string& filename, const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount)
+{
+	GP2_MappedFile file{};
+	if (!file.Open(filename))
+	{
+		std::cerr << "Error: Failed to open file " << filename << std::endl;
+		return false;
+	}
+
+	const char* pBegin{ file.GetData() };
+	const char* pEnd{ file.GetData() + file.GetSize() };
+
+	m_Positions.clear();
+	m_Normals.clear();
+	m_TexCoords.clear();
+	m_Corners.clear();
+
+	const bool useThreads{ threadCount > 1 && file.GetSize() >= 2 * MinChunkSize };
+	const bool succeeded{ useThreads ? ParseParallel(pBegin, pEnd, threadCount) : ParseBuffer(pBegin, pEnd) };
+
+	if (!succeeded)
+	{
+		std::cerr << "Error: Malformed OBJ data in " << filename << std::endl;
+		return false;
+	}
+
+	EmitVertices(color, vertices, indices, useThreads ? threadCount : 1);
+	return true;
+}
+
+bool GP2_OBJParser::ParseParallel(const char* pBegin, const char* pEnd, uint32_t threadCount)
+{
+	// 1. split in line-aligned chunks, a few more than threads so uneven chunks balance out
+	const size_t fileSize{ static_cast<size_t>(pEnd - pBegin) };
+	const size_t chunkCount{ std::max<size_t>(1, std::min<size_t>(size_t(threadCount) * ChunksPerThread, fileSize / MinChunkSize)) };
+
+	m_Chunks.resize(chunkCount);
+
+	const char* pChunkBegin{ pBegin };
+	for (size_t chunkIdx = 0; chunkIdx < chunkCount; ++chunkIdx)
+	{
+		const char* pChunkEnd{ pEnd };
+		if (chunkIdx + 1 < chunkCount)
+		{
+			pChunkEnd = std::max(pChunkBegin, pBegin + fileSize * (chunkIdx + 1) / chunkCount);
+			pChunkEnd = FindLineEnd(pChunkEnd, pEnd);
+			pChunkEnd = (pChunkEnd < pEnd) ? pChunkEnd + 1 : pEnd;
+		}
+
+		Chunk& chunk{ m_Chunks[chunkIdx] };
+		chunk.pBegin = pChunkBegin;
+		chunk.pEnd = pChunkEnd;
+		chunk.positions.clear();
+		chunk.normals.clear();
+		chunk.texCoords.clear();
+		chunk.corners.clear();
+		chunk.succeeded = false;
+
+		pChunkBegin = pChunkEnd;
+	}
+
+	// 2. parse every chunk into its own arrays
+	RunParallel(chunkCount, threadCount, [this](size_t chunkIdx) { m_Chunks[chunkIdx].succeeded = ParseChunk(m_Chunks[chunkIdx]); });
+
+	// 3. prefix sums turn chunk-local counts into global bases, faces keep their file order
+	size_t positionCount{}, normalCount{}, texCoordCount{}, cornerCount{};
+	for (Chunk& chunk : m_Chunks)
+	{
+		if (!chunk.succeeded)
+		{
+			return false;
+		}
+
+		chunk.positionBase = positionCount;
+		chunk.normalBase = normalCount;
+		chunk.texCoordBase = texCoordCount;
+		chunk.cornerBase = cornerCount;
+
+		positionCount += chunk.positions.size();
+		normalCount += chunk.normals.size();
+		texCoordCount += chunk.texCoords.size();
+		cornerCount += chunk.corners.size();
+	}
+
+	// gather the attribute arrays so faces can reference data from any chunk
+	m_Positions.resize(positionCount);
+	m_Normals.resize(normalCount);
+	m_TexCoords.resize(texCoordCount);
+	m_Corners.resize(cornerCount);
+
+	RunParallel(chunkCount, threadCount, [this](size_t chunkIdx)
+	{
+		const Chunk& chunk{ m_Chunks[chunkIdx] };
+		std::copy(chunk.positions.begin(), chunk.positions.end(), m_Positions.begin() + chunk.positionBase);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), m_Normals.begin() + chunk.normalBase);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), m_TexCoords.begin() + chunk.texCoordBase);
+	});
+
+	// 4. resolve the corners against the global arrays
+	RunParallel(chunkCount, threadCount, [this](size_t chunkIdx) { m_Chunks[chunkIdx].succeeded = ResolveChunk(m_Chunks[chunkIdx]); });
+
+	return std::all_of(m_Chunks.begin(), m_Chunks.end(), [](const Chunk& chunk) { return chunk.succeeded; });
+}
+
+bool GP2_OBJParser::ParseChunk(Chunk& chunk)
+{
+	const char* pLine{ chunk.pBegin };
+	while (pLine < chunk.pEnd)
+	{
+		const char* pLineEnd{ FindLineEnd(pLine, chunk.pEnd) };
+		const char* pCursor{ SkipBlanks(pLine, pLineEnd) };
+
+		switch (ReadCommand(pCursor, pLineEnd))
+		{
+		case LineType::Position:
+			if (!ReadVec3(pCursor, pLineEnd, chunk.positions.emplace_back())) return false;
+			break;
+		case LineType::Normal:
+			if (!ReadVec3(pCursor, pLineEnd, chunk.normals.emplace_back())) return false;
+			break;
+		case LineType::TexCoord:
+			if (!ReadVec2(pCursor, pLineEnd, chunk.texCoords.emplace_back())) return false;
+			break;
+		case LineType::Face:
+			for (size_t iFace = 0; iFace < 3; ++iFace)
+			{
+				FaceCorner corner{};
+				if (!ReadCorner(pCursor, pLineEnd, corner.position, corner.texCoord, corner.normal))
+				{
+					return false;
+				}
+				corner.positionCount = static_cast<uint32_t>(chunk.positions.size());
+				corner.texCoordCount = static_cast<uint32_t>(chunk.texCoords.size());
+				corner.normalCount = static_cast<uint32_t>(chunk.normals.size());
+
+				// negative indices depend on how much this chunk has read so far, make them chunk relative now
+				if (corner.position < 0)
+				{
+					corner.position += static_cast<int64_t>(chunk.positions.size());
+					corner.relativeMask |= RelativePosition;
+				}
+				if (corner.texCoord < 0)
+				{
+					corner.texCoord += static_cast<int64_t>(chunk.texCoords.size());
+					corner.relativeMask |= RelativeTexCoord;
+				}
+				if (corner.normal < 0)
+				{
+					corner.normal += static_cast<int64_t>(chunk.normals.size());
+					corner.relativeMask |= RelativeNormal;
+				}
+
+				chunk.corners.push_back(corner);
+			}
+			break;
+		default:
+			break;
+		}
+
+		pLine = (pLineEnd < chunk.pEnd) ? pLineEnd + 1 : chunk.pEnd;
+	}
+
+	return true;
+}
+
+bool GP2_OBJParser::ResolveChunk(const Chunk& chunk)
+{
+	for (size_t cornerIdx = 0; cornerIdx < chunk.corners.size(); cornerIdx += 3)
+	{
+		// same as ParseFace, attributes missing on a corner carry over from the previous one of the face
+		CornerKey key{ NoIndex, NoIndex, NoIndex };
+
+		for (size_t iFace = 0; iFace < 3; ++iFace)
+		{
+			const FaceCorner& corner{ chunk.corners[cornerIdx + iFace] };
+			size_t index{};
+
+			if (!ResolveChunkIndex(corner.position, corner.relativeMask & RelativePosition, chunk.positionBase, chunk.positionBase + corner.positionCount, index))
+			{
+				return false;
+			}
+			key.position = static_cast<uint32_t>(index);
+
+			if (corner.texCoord != 0 || (corner.relativeMask & RelativeTexCoord))
+			{
+				if (!ResolveChunkIndex(corner.texCoord, corner.relativeMask & RelativeTexCoord, chunk.texCoordBase, chunk.texCoordBase + corner.texCoordCount, index))
+				{
+					return false;
+				}
+				key.texCoord = static_cast<uint32_t>(index);
+			}
+
+			if (corner.normal != 0 || (corner.relativeMask & RelativeNormal))
+			{
+				if (!ResolveChunkIndex(corner.normal, corner.relativeMask & RelativeNormal, chunk.normalBase, chunk.normalBase + corner.normalCount, index))
+				{
+					return false;
+				}
+				key.normal = static_cast<uint32_t>(index);
+			}
+
+			m_Corners[chunk.cornerBase + cornerIdx + iFace] = key;
+		}
+	}
+
+	return true;
+}
+
+bool GP2_OBJParser::ParseBuffer(const char* pBegin, const char* pEnd)
+{
+	const char* pLine{ pBegin };
+	while (pLine < pEnd)
+	{
+		const char* pLineEnd{ FindLineEnd(pLine, pEnd) };
+		const char* pCursor{ SkipBlanks(pLine, pLineEnd) };
+
+		// everything unknown (comments, groups, materials) is skipped
+		switch (ReadCommand(pCursor, pLineEnd))
+		{
+		case LineType::Position:
+			if (!ReadVec3(pCursor, pLineEnd, m_Positions.emplace_back())) return false;
+			break;
+		case LineType::Normal:
+			if (!ReadVec3(pCursor, pLineEnd, m_Normals.emplace_back())) return false;
+			break;
+		case LineType::TexCoord:
+			if (!ReadVec2(pCursor, pLineEnd, m_TexCoords.emplace_back())) return false;
+			break;
+		case LineType::Face:
+			if (!ParseFace(pCursor, pLineEnd)) return false;
+			break;
+		default:
+			break;
+		}
+
+		pLine = (pLineEnd < pEnd) ? pLineEnd + 1 : pEnd;
+	}
+
+	return true;
+}
+
+bool GP2_OBJParser::ParseFace(const char* pCursor, const char* pLineEnd)
+{
+	// Faces or triangles, attributes missing on a corner carry over from the previous one of the face
+	CornerKey key{ NoIndex, NoIndex, NoIndex };
+
+	for (size_t iFace = 0; iFace < 3; ++iFace)
+	{
+		int64_t iPosition{}, iTexCoord{}, iNormal{};
+		if (!ReadCorner(pCursor, pLineEnd, iPosition, iTexCoord, iNormal))
+		{
+			return false;
+		}
+
+		size_t index{};
+		if (!ResolveIndex(iPosition, m_Positions.size(), index))
+		{
+			return false;
+		}
+		key.position = static_cast<uint32_t>(index);
+
+		if (iTexCoord != 0)
+		{
+			if (!ResolveIndex(iTexCoord, m_TexCoords.size(), index))
+			{
+				return false;
+			}
+			key.texCoord = static_cast<uint32_t>(index);
+		}
+
+		if (iNormal != 0)
+		{
+			if (!ResolveIndex(iNormal, m_Normals.size(), index))
+			{
+				return false;
+			}
+			key.normal = static_cast<uint32_t>(index);
+		}
+
+		m_Corners.push_back(key);
+	}
+
+	return true;
+}
+
+void GP2_OBJParser::EmitVertices(const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount) const
+{
+	const size_t vertexOffset{ vertices.size() };
+	const size_t indexOffset{ indices.size() };
+	const size_t cornerCount{ m_Corners.size() };
+
+	indices.resize(indexOffset + cornerCount);
+
+	if (!m_WeldVertices)
+	{
+		// one vertex per corner, every slot is known up front so this splits over the threads
+		vertices.resize(vertexOffset + cornerCount);
+
+		const size_t taskCount{ (cornerCount + CornersPerEmitTask - 1) / CornersPerEmitTask };
+		RunParallel(taskCount, threadCount, [&](size_t taskIdx)
+		{
+			const size_t cornerEnd{ std::min(cornerCount, (taskIdx + 1) * CornersPerEmitTask) };
+			for (size_t cornerIdx = taskIdx * CornersPerEmitTask; cornerIdx < cornerEnd; ++cornerIdx)
+			{
+				vertices[vertexOffset + cornerIdx] = MakeVertex(m_Corners[cornerIdx], color);
+				indices[indexOffset + cornerIdx] = static_cast<uint32_t>(vertexOffset + cornerIdx);
+			}
+		});
+
+		return;
+	}
+
+	// open addressing table from corner key to welded vertex, sized to stay at most half full
+	size_t tableSize{ 16 };
+	while (tableSize < cornerCount * 2)
+	{
+		tableSize *= 2;
+	}
+
+	std::vector<uint32_t> table(tableSize, NoIndex);
+	std::vector<CornerKey> uniqueKeys;
+	uniqueKeys.reserve(cornerCount / 2);
+
+	for (size_t cornerIdx = 0; cornerIdx < cornerCount; ++cornerIdx)
+	{
+		const CornerKey& key{ m_Corners[cornerIdx] };
+
+		uint32_t hash{ key.position * 0x9E3779B1u };
+		hash ^= key.texCoord * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+		hash ^= key.normal * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+
+		size_t slot{ hash & (tableSize - 1) };
+		while (table[slot] != NoIndex && !(uniqueKeys[table[slot]] == key))
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == NoIndex)
+		{
+			table[slot] = static_cast<uint32_t>(uniqueKeys.size());
+			uniqueKeys.push_back(key);
+		}
+
+		indices[indexOffset + cornerIdx] = static_cast<uint32_t>(vertexOffset) + table[slot];
+	}
+
+	vertices.reserve(vertexOffset + uniqueKeys.size());
+	for (const CornerKey& key : uniqueKeys)
+	{
+		vertices.push_back(MakeVertex(key, color));
+	}
+}
+
+Vertex3D GP2_OBJParser::MakeVertex(const CornerKey& key, const glm::vec3 color) const
+{
+	Vertex3D vertex{};
+	vertex.color = color;
+
+	const glm::vec3& position{ m_Positions[key.position] };
+	vertex.position = glm::vec3(position.x, -position.y, -position.z);
+
+	if (key.texCoord != NoIndex)
+	{
+		const glm::vec2& texCoord{ m_TexCoords[key.texCoord] };
+		vertex.texCoord = glm::vec2(texCoord.x, 1.f - texCoord.y);
+	}
+
+	if (key.normal != NoIndex)
+	{
+		const glm::vec3& normal{ m_Normals[key.normal] };
+		vertex.normal = glm::vec3(normal.x, -normal.y, -normal.z);
+	}
+
+	return vertex;
+}
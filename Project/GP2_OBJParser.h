@@ -0,0 +1,102 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+// Memory-mapped OBJ reader. Corners with the same (position, texcoord, normal) tuple are welded into one
+// Vertex3D (y and z flipped like before), only the first triangle of every face is kept.
+class GP2_OBJParser final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_OBJParser() = default;
+	~GP2_OBJParser() = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// Appends to vertices and indices, new indices are offset by the vertices already present.
+	// With more than one thread the file is split in line-aligned chunks that are parsed in parallel,
+	// the result is identical to the serial parse, malformed files fail the same way.
+	bool Parse(const std::string& filename, const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount = 1);
+
+	// Without welding every face corner gets its own vertex, like the old stream parser
+	void SetWeldVertices(bool weldVertices) { m_WeldVertices = weldVertices; }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// 0 means the attribute is absent, relative (negative) OBJ indices are stored relative to the chunk start
+	struct FaceCorner
+	{
+		int64_t position;
+		int64_t texCoord;
+		int64_t normal;
+		// what the chunk had read when it reached the face, like the serial parse no index may reach past it
+		uint32_t positionCount;
+		uint32_t texCoordCount;
+		uint32_t normalCount;
+		uint8_t relativeMask;
+	};
+
+	// resolved 0-based attribute indices of a corner, NoIndex when absent
+	struct CornerKey
+	{
+		uint32_t position;
+		uint32_t texCoord;
+		uint32_t normal;
+
+		bool operator==(const CornerKey& other) const = default;
+	};
+
+	struct Chunk
+	{
+		const char* pBegin;
+		const char* pEnd;
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec2> texCoords;
+		std::vector<FaceCorner> corners;
+
+		size_t positionBase;
+		size_t normalBase;
+		size_t texCoordBase;
+		size_t cornerBase;
+		bool succeeded;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	bool ParseParallel(const char* pBegin, const char* pEnd, uint32_t threadCount);
+	bool ParseChunk(Chunk& chunk);
+	bool ResolveChunk(const Chunk& chunk);
+
+	bool ParseBuffer(const char* pBegin, const char* pEnd);
+	bool ParseFace(const char* pCursor, const char* pLineEnd);
+
+	void EmitVertices(const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount) const;
+	Vertex3D MakeVertex(const CornerKey& key, const glm::vec3 color) const;
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t NoIndex{ UINT32_MAX };
+
+	bool m_WeldVertices{ true };
+
+	// kept between calls so parsing several files reuses the same storage
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::vec3> m_Normals;
+	std::vector<glm::vec2> m_TexCoords;
+	std::vector<CornerKey> m_Corners;
+
+	std::vector<Chunk> m_Chunks;
+};
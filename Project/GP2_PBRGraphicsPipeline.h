@@ -23,12 +23,13 @@ public:
 	//-----------
 	// Functions
 	//-----------
-	void Initialize(const VulkanContext& context, VkImageView textureImageView, VkSampler textureSampler);
+	void Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator, VkImageView textureImageView, VkSampler textureSampler);
 
 	void Cleanup();
 
 	void Record(const GP2_CommandBuffer& buffer, VkExtent2D extent, int imageIdx);
-	void DrawScene(const GP2_CommandBuffer& buffer);
+	// Binds the descriptor set of imageIdx, the frame in flight's slot SetUBO wrote to
+	void DrawScene(const GP2_CommandBuffer& buffer, int imageIdx);
 	void AddMesh(pMesh3D mesh);
 
 	void SetUBO(UBOPBR ubo, size_t uboIndex); 
@@ -51,6 +52,7 @@ private:
 	GP2_Shader<Vertex3D> m_Shader;
 	std::vector<pMesh3D> m_pMeshes;
 	GP2_DescriptorPool<UBOPBR>* m_pDescriptorPool; 
+	GP2_FrameAllocator* m_pFrameAllocator;
 };
 
 template<class UBOPBR>
@@ -61,22 +63,24 @@ inline GP2_PBRGraphicsPipeline<UBOPBR>::GP2_PBRGraphicsPipeline(const std::strin
 	m_PipelineLayout{},
 	m_Shader{ vertexShaderFile, fragmentShaderFile },
 	m_pMeshes{},
-	m_pDescriptorPool{}
+	m_pDescriptorPool{},
+	m_pFrameAllocator{}
 {
 }
 
 template<class UBOPBR>
-inline void GP2_PBRGraphicsPipeline<UBOPBR>::Initialize(const VulkanContext& context, VkImageView textureImageView, VkSampler textureSampler)
+inline void GP2_PBRGraphicsPipeline<UBOPBR>::Initialize(const VulkanContext& context, GP2_FrameAllocator& frameAllocator, VkImageView textureImageView, VkSampler textureSampler)
 {
 	m_Device = context.device; 
 	m_RenderPass = context.renderPass; 
 
 	m_Shader.Initialize(m_Device); 
+	m_pFrameAllocator = &frameAllocator;
 
 	for (pMesh3D& pMesh : m_pMeshes)
 	{
 		m_pDescriptorPool = new GP2_DescriptorPool<UBOPBR>{ m_Device, MAX_FRAMES_IN_FLIGHT }; 
-		m_pDescriptorPool->Initialize(context, pMesh->GetTexture(0).GetTextureImageView(), pMesh->GetTexture(0).GetTextureSampler());
+		m_pDescriptorPool->Initialize(context, frameAllocator, pMesh->GetTexture(0).GetTextureImageView(), pMesh->GetTexture(0).GetTextureSampler());
 	}
 
 	CreateGraphicsPipeline(); 
@@ -126,19 +130,18 @@ inline void GP2_PBRGraphicsPipeline<UBOPBR>::Record(const GP2_CommandBuffer& buf
 	scissor.extent = extent;
 	vkCmdSetScissor(buffer.GetVkCommandBuffer(), 0, 1, &scissor);
 
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx);
-
-	DrawScene(buffer);
+	DrawScene(buffer, imageIdx);
 }
 
 template<class UBOPBR>
-inline void GP2_PBRGraphicsPipeline<UBOPBR>::DrawScene(const GP2_CommandBuffer& buffer)
+inline void GP2_PBRGraphicsPipeline<UBOPBR>::DrawScene(const GP2_CommandBuffer& buffer, int imageIdx)
 {
-	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, 0);
+	m_pDescriptorPool->BindDescriptorSet(buffer.GetVkCommandBuffer(), m_PipelineLayout, imageIdx);
 
+	GP2_GeometryArena::BindState bindState{};
 	for (auto& mesh : m_pMeshes)
 	{
-		mesh->Draw(m_PipelineLayout, buffer.GetVkCommandBuffer());
+		mesh->Draw(m_PipelineLayout, buffer.GetVkCommandBuffer(), bindState, *m_pFrameAllocator);
 	}
 }
 
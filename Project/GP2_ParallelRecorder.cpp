@@ -0,0 +1,82 @@
+#include "GP2_ParallelRecorder.h"
+
+#include <algorithm>
+
+void GP2_ParallelRecorder::Initialize(VkDevice device, uint32_t queueFamilyIndex, GP2_JobSystem& jobSystem, uint32_t maxRangeCount)
+{
+	m_Device = device;
+	m_pJobSystem = &jobSystem;
+	const uint32_t threadCount{ jobSystem.GetThreadCount() };
+	m_MaxRangeCount = maxRangeCount == 0 ? threadCount : std::min(maxRangeCount, threadCount);
+
+	// any job thread may pick a range up, each gets pools of its own
+	m_ThreadFrames.resize(size_t(threadCount) * MAX_FRAMES_IN_FLIGHT);
+	for (ThreadFrame& threadFrame : m_ThreadFrames)
+	{
+		threadFrame.commandPool.Initialize(m_Device, queueFamilyIndex);
+		threadFrame.usedCount = 0;
+	}
+}
+
+void GP2_ParallelRecorder::Destroy()
+{
+	// the command buffers go with their pools
+	for (ThreadFrame& threadFrame : m_ThreadFrames)
+	{
+		threadFrame.commandPool.Destroy();
+	}
+	m_ThreadFrames.clear();
+	m_pJobSystem = nullptr;
+}
+
+void GP2_ParallelRecorder::BeginFrame(uint32_t frameIndex)
+{
+	m_FrameIndex = frameIndex % MAX_FRAMES_IN_FLIGHT;
+	for (uint32_t threadIndex = 0; threadIndex < m_pJobSystem->GetThreadCount(); ++threadIndex)
+	{
+		ThreadFrame& threadFrame{ m_ThreadFrames[size_t(threadIndex) * MAX_FRAMES_IN_FLIGHT + m_FrameIndex] };
+		threadFrame.commandPool.Reset();
+		threadFrame.usedCount = 0;
+	}
+}
+
+const std::vector<VkCommandBuffer>& GP2_ParallelRecorder::Record(VkRenderPass renderPass, VkFramebuffer framebuffer, uint32_t count,
+																  const RecordFunction& record)
+{
+	m_CommandBuffers.clear();
+	if (count == 0)
+	{
+		return m_CommandBuffers;
+	}
+
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = renderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = framebuffer;
+
+	// every range writes its own slot, whichever thread records it
+	m_CommandBuffers.resize(m_pJobSystem->GetRangeCount(count, MinDrawsPerRange, m_MaxRangeCount));
+	m_pJobSystem->ParallelFor(count, MinDrawsPerRange, [this, &inheritanceInfo, &record](uint32_t rangeIndex, uint32_t begin, uint32_t end)
+	{
+		m_CommandBuffers[rangeIndex] = RecordRange(inheritanceInfo, record, rangeIndex, begin, end);
+	}, m_MaxRangeCount);
+	return m_CommandBuffers;
+}
+
+VkCommandBuffer GP2_ParallelRecorder::RecordRange(const VkCommandBufferInheritanceInfo& inheritanceInfo, const RecordFunction& record,
+												  uint32_t rangeIndex, uint32_t begin, uint32_t end)
+{
+	// the pool of the thread the job landed on, no other thread touches it this frame
+	ThreadFrame& threadFrame{ m_ThreadFrames[size_t(m_pJobSystem->GetThreadIndex()) * MAX_FRAMES_IN_FLIGHT + m_FrameIndex] };
+	if (threadFrame.usedCount == threadFrame.commandBuffers.size())
+	{
+		threadFrame.commandBuffers.push_back(threadFrame.commandPool.CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+	}
+	const GP2_CommandBuffer& commandBuffer{ threadFrame.commandBuffers[threadFrame.usedCount++] };
+
+	commandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritanceInfo);
+	record(commandBuffer.GetVkCommandBuffer(), rangeIndex, begin, end);
+	commandBuffer.EndRecording();
+	return commandBuffer.GetVkCommandBuffer();
+}
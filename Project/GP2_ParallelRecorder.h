@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include "GP2_JobSystem.h"
+#include "GP2_CommandPool.h"
+#include "GP2_CommandBuffer.h"
+#include "vulkanbase/VulkanUtil.h"
+
+// Records the draws of a render pass on the job system's threads. A draw list is split into contiguous ranges, each
+// recorded into a secondary command buffer that inherits the render pass, and the primary command buffer executes them
+// in range order with vkCmdExecuteCommands. Command buffers come from a command pool per job thread and frame in flight,
+// so no pool is ever used by two threads and a frame's pools are reset as a whole. The calling thread records the first
+// range itself. Render thread only, the record function runs on the job threads.
+class GP2_ParallelRecorder final
+{
+public:
+	// Records draws [begin, end) into commandBuffer, which has no state bound yet. rangeIndex is below GetRangeCount().
+	using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t rangeIndex, uint32_t begin, uint32_t end)>;
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_ParallelRecorder() = default;
+	~GP2_ParallelRecorder() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_ParallelRecorder(const GP2_ParallelRecorder&) = delete;
+	GP2_ParallelRecorder(GP2_ParallelRecorder&&) = delete;
+	GP2_ParallelRecorder& operator=(const GP2_ParallelRecorder&) = delete;
+	GP2_ParallelRecorder& operator=(GP2_ParallelRecorder&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	// At most maxRangeCount ranges a draw list, 0 uses every thread of jobSystem. With 1 callers record inline.
+	void Initialize(VkDevice device, uint32_t queueFamilyIndex, GP2_JobSystem& jobSystem, uint32_t maxRangeCount = 0);
+	// None of the command buffers may be pending anymore
+	void Destroy();
+
+	// Resets the pools of frameIndex, only after waiting for the fence of the frame that used them last
+	void BeginFrame(uint32_t frameIndex);
+	// Splits count draws into ranges of at least MinDrawsPerRange, GetRangeCount at most, and records them in parallel into
+	// secondary command buffers for subpass 0 of renderPass. Returns them in draw order once every range is recorded, valid
+	// until the next call. Rethrows the first exception a range threw.
+	const std::vector<VkCommandBuffer>& Record(VkRenderPass renderPass, VkFramebuffer framebuffer, uint32_t count, const RecordFunction& record);
+
+	uint32_t GetRangeCount() const { return m_MaxRangeCount; }
+	bool IsParallel() const { return m_MaxRangeCount > 1; }
+
+	// below it handing a range to another thread costs more than the recording it spreads
+	static constexpr uint32_t MinDrawsPerRange{ 64 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// a thread's pool for one frame in flight, its secondaries are reused from frame to frame. A thread may record
+	// several ranges of a draw list, each into a command buffer of its own.
+	struct ThreadFrame
+	{
+		GP2_CommandPool commandPool;
+		std::vector<GP2_CommandBuffer> commandBuffers;
+		uint32_t usedCount;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	VkCommandBuffer RecordRange(const VkCommandBufferInheritanceInfo& inheritanceInfo, const RecordFunction& record, uint32_t rangeIndex,
+								uint32_t begin, uint32_t end);
+
+	//-----------
+	// Variables
+	//-----------
+	VkDevice m_Device{};
+	GP2_JobSystem* m_pJobSystem{};
+	uint32_t m_MaxRangeCount{};
+	// MAX_FRAMES_IN_FLIGHT per job thread, the calling thread's first
+	std::vector<ThreadFrame> m_ThreadFrames;
+	uint32_t m_FrameIndex{};
+
+	std::vector<VkCommandBuffer> m_CommandBuffers;
+};
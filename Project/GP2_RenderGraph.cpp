@@ -0,0 +1,772 @@
+#include "GP2_RenderGraph.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+void GP2_RenderGraph::Initialize(VkDevice device)
+{
+	m_Device = device;
+}
+
+void GP2_RenderGraph::Destroy()
+{
+	for (Pass& pass : m_Passes)
+	{
+		for (VkFramebuffer framebuffer : pass.framebuffers)
+		{
+			vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+		}
+		vkDestroyRenderPass(m_Device, pass.renderPass, nullptr);
+	}
+
+	// imported images belong to whoever imported them
+	for (Resource& resource : m_Resources)
+	{
+		if (resource.isImported)
+		{
+			continue;
+		}
+		for (VkImageView view : resource.views)
+		{
+			vkDestroyImageView(m_Device, view, nullptr);
+		}
+		for (VkImage image : resource.images)
+		{
+			vkDestroyImage(m_Device, image, nullptr);
+		}
+	}
+
+	if (m_TransientAllocation.pAllocator)
+	{
+		m_TransientAllocation.pAllocator->Free(m_TransientAllocation);
+	}
+	m_TransientAllocation = {};
+
+	m_Passes.clear();
+	m_Resources.clear();
+	m_FinalBarriers = {};
+	m_Stats = {};
+}
+
+GP2_RenderGraph::ResourceHandle GP2_RenderGraph::ImportImage(std::string_view name, VkFormat format, VkExtent2D extent,
+															 const std::vector<VkImage>& images, const std::vector<VkImageView>& views,
+															 VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkImageLayout finalLayout)
+{
+	if (images.empty() || images.size() != views.size())
+	{
+		throw std::runtime_error("render graph import needs a view for every image!");
+	}
+
+	Resource resource{};
+	resource.name = name;
+	resource.format = format;
+	resource.extent = extent;
+	resource.aspectMask = GetAspectMask(format);
+	resource.isImported = true;
+	resource.images = images;
+	resource.views = views;
+	resource.initialLayout = initialLayout;
+	resource.initialStage = initialStage;
+	resource.finalLayout = finalLayout;
+	m_Resources.push_back(std::move(resource));
+	return static_cast<ResourceHandle>(m_Resources.size() - 1);
+}
+
+GP2_RenderGraph::ResourceHandle GP2_RenderGraph::CreateImage(std::string_view name, VkFormat format, VkExtent2D extent)
+{
+	Resource resource{};
+	resource.name = name;
+	resource.format = format;
+	resource.extent = extent;
+	resource.aspectMask = GetAspectMask(format);
+	resource.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	m_Resources.push_back(std::move(resource));
+	return static_cast<ResourceHandle>(m_Resources.size() - 1);
+}
+
+GP2_RenderGraph::PassHandle GP2_RenderGraph::AddPass(std::string_view name, RecordFunction record, VkSubpassContents contents)
+{
+	Pass pass{};
+	pass.name = name;
+	pass.record = std::move(record);
+	pass.contents = contents;
+	m_Passes.push_back(std::move(pass));
+	return static_cast<PassHandle>(m_Passes.size() - 1);
+}
+
+void GP2_RenderGraph::WriteColor(PassHandle pass, ResourceHandle resource, const VkClearColorValue* pClearValue)
+{
+	if (IsDepthFormat(m_Resources[resource].format))
+	{
+		throw std::runtime_error("render graph color attachment has a depth format!");
+	}
+
+	VkClearValue clearValue{};
+	if (pClearValue)
+	{
+		clearValue.color = *pClearValue;
+	}
+	AddAccess(pass, resource, AccessType::ColorWrite, pClearValue != nullptr, clearValue);
+}
+
+void GP2_RenderGraph::WriteDepth(PassHandle pass, ResourceHandle resource, const VkClearDepthStencilValue* pClearValue)
+{
+	if (!IsDepthFormat(m_Resources[resource].format))
+	{
+		throw std::runtime_error("render graph depth attachment has no depth format!");
+	}
+
+	VkClearValue clearValue{};
+	if (pClearValue)
+	{
+		clearValue.depthStencil = *pClearValue;
+	}
+	AddAccess(pass, resource, AccessType::DepthWrite, pClearValue != nullptr, clearValue);
+}
+
+void GP2_RenderGraph::ReadDepth(PassHandle pass, ResourceHandle resource)
+{
+	if (!IsDepthFormat(m_Resources[resource].format))
+	{
+		throw std::runtime_error("render graph depth attachment has no depth format!");
+	}
+	AddAccess(pass, resource, AccessType::DepthRead, false, VkClearValue{});
+}
+
+void GP2_RenderGraph::ReadTexture(PassHandle pass, ResourceHandle resource)
+{
+	AddAccess(pass, resource, AccessType::TextureRead, false, VkClearValue{});
+}
+
+void GP2_RenderGraph::AddAccess(PassHandle pass, ResourceHandle resource, AccessType type, bool hasClear, VkClearValue clearValue)
+{
+	// one access says everything the pass does with an image, two could want it in two layouts at once
+	std::vector<Access>& accesses{ m_Passes[pass].accesses };
+	if (std::any_of(accesses.begin(), accesses.end(), [resource](const Access& access) { return access.resource == resource; }))
+	{
+		throw std::runtime_error("render graph pass accesses an image twice!");
+	}
+	accesses.push_back(Access{ resource, type, hasClear, clearValue });
+}
+
+GP2_RenderGraph::Usage GP2_RenderGraph::GetUsage(const Resource& resource, AccessType type) const
+{
+	switch (type)
+	{
+	case AccessType::ColorWrite:
+		// loading and blending read the attachment too
+		return Usage{ VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true, true };
+	case AccessType::DepthWrite:
+		return Usage{ VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true, true };
+	case AccessType::DepthRead:
+		return Usage{ VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false, true };
+	case AccessType::TextureRead:
+	default:
+		// depth stays in its read only layout, so depth tests and sampling in a row need no transition
+		return Usage{ IsDepthFormat(resource.format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false, false };
+	}
+}
+
+void GP2_RenderGraph::Compile()
+{
+	m_Stats = {};
+	m_Stats.passCount = static_cast<uint32_t>(m_Passes.size());
+
+	CullPasses();
+	ComputeLifetimes();
+	CreateTransientImages();
+
+	// every image starts the frame in its initial layout, a transient one after whatever used its memory last, the frame
+	// before included
+	std::vector<State> states(m_Resources.size());
+	for (size_t idx = 0; idx < m_Resources.size(); ++idx)
+	{
+		const Resource& resource{ m_Resources[idx] };
+		State& state{ states[idx] };
+		state.layout = resource.initialLayout;
+		if (resource.isImported)
+		{
+			// the semaphore wait makes the contents visible, the stage is what the first use has to wait for
+			state.writeStageMask = resource.initialStage;
+			state.hasContents = resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+			continue;
+		}
+
+		for (const Resource& other : m_Resources)
+		{
+			const bool isAliased{ !other.isImported && other.firstPass != UINT32_MAX && resource.firstPass != UINT32_MAX &&
+				other.offset < resource.offset + resource.requirements.size && resource.offset < other.offset + other.requirements.size };
+			if (isAliased)
+			{
+				state.writeStageMask |= other.lastStageMask;
+				state.writeAccessMask |= other.lastAccessMask;
+			}
+		}
+	}
+
+	for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+	{
+		Pass& pass{ m_Passes[passIndex] };
+		if (pass.isCulled)
+		{
+			continue;
+		}
+
+		std::vector<VkAttachmentDescription> attachments;
+		std::vector<VkAttachmentReference> references;
+		// the transitions of every attachment go in here, waiting for all of them at once
+		VkSubpassDependency dependency{};
+		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependency.dstSubpass = 0;
+
+		for (const Access& access : pass.accesses)
+		{
+			const Resource& resource{ m_Resources[access.resource] };
+			const Usage usage{ GetUsage(resource, access.type) };
+			State& state{ states[access.resource] };
+			if (!usage.isWrite && !state.hasContents)
+			{
+				throw std::runtime_error("render graph pass reads an image nothing wrote!");
+			}
+
+			// writes wait for every earlier access, reads for a write their stages haven't seen yet
+			const bool isTransition{ state.layout != usage.layout };
+			const bool isHazard{ usage.isWrite ? (state.writeStageMask | state.readStageMask) != 0
+				: state.writeStageMask != 0 && (state.visibleStageMask & usage.stageMask) != usage.stageMask };
+			if (isTransition || isHazard)
+			{
+				const VkPipelineStageFlags srcStageMask{ isTransition || usage.isWrite ? state.writeStageMask | state.readStageMask : state.writeStageMask };
+				++m_Stats.transitionCount;
+				if (usage.isAttachment)
+				{
+					dependency.srcStageMask |= srcStageMask;
+					dependency.dstStageMask |= usage.stageMask;
+					dependency.srcAccessMask |= state.writeAccessMask;
+					dependency.dstAccessMask |= usage.accessMask;
+					++m_Stats.mergedTransitionCount;
+				}
+				else
+				{
+					VkImageMemoryBarrier barrier{};
+					barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					barrier.srcAccessMask = state.writeAccessMask;
+					barrier.dstAccessMask = usage.accessMask;
+					barrier.oldLayout = state.layout;
+					barrier.newLayout = usage.layout;
+					barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.subresourceRange = { resource.aspectMask, 0, 1, 0, 1 };
+					pass.barriers.barriers.push_back(Barrier{ access.resource, barrier });
+					pass.barriers.srcStageMask |= srcStageMask;
+					pass.barriers.dstStageMask |= usage.stageMask;
+					++m_Stats.imageBarrierCount;
+				}
+			}
+
+			if (usage.isAttachment)
+			{
+				if (attachments.empty())
+				{
+					pass.extent = resource.extent;
+				}
+				else if (resource.extent.width != pass.extent.width || resource.extent.height != pass.extent.height)
+				{
+					throw std::runtime_error("render graph pass has attachments of different sizes!");
+				}
+
+				VkAttachmentDescription attachment{};
+				attachment.format = resource.format;
+				attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp = access.hasClear ? VK_ATTACHMENT_LOAD_OP_CLEAR : state.hasContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.storeOp = IsReadAfter(passIndex, access.resource) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.initialLayout = state.layout;
+				attachment.finalLayout = usage.layout;
+
+				// the transition into the final layout of an imported image goes with its last pass
+				if (resource.isImported && resource.lastPass == passIndex && resource.finalLayout != usage.layout)
+				{
+					attachment.finalLayout = resource.finalLayout;
+					++m_Stats.transitionCount;
+					++m_Stats.mergedTransitionCount;
+				}
+
+				references.push_back(VkAttachmentReference{ static_cast<uint32_t>(attachments.size()), usage.layout });
+				attachments.push_back(attachment);
+				pass.attachments.push_back(access.resource);
+				pass.clearValues.push_back(access.clearValue);
+			}
+
+			if (usage.isWrite)
+			{
+				state.writeStageMask = usage.stageMask;
+				state.writeAccessMask = usage.accessMask & WriteAccessMask;
+				state.readStageMask = 0;
+				state.visibleStageMask = 0;
+				state.hasContents = true;
+			}
+			else
+			{
+				state.readStageMask |= usage.stageMask;
+				state.visibleStageMask |= usage.stageMask;
+			}
+			state.layout = usage.isAttachment ? attachments.back().finalLayout : usage.layout;
+		}
+
+		if (pass.barriers.srcStageMask == 0)
+		{
+			pass.barriers.srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		}
+		if (dependency.srcStageMask == 0)
+		{
+			dependency.srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		}
+
+		CreateRenderPass(pass, attachments, references, dependency);
+		CreateFramebuffers(pass);
+	}
+
+	// imported images whose last use wasn't an attachment still have to end up in their final layout
+	m_FinalBarriers = {};
+	for (size_t idx = 0; idx < m_Resources.size(); ++idx)
+	{
+		const Resource& resource{ m_Resources[idx] };
+		const State& state{ states[idx] };
+		if (!resource.isImported || resource.firstPass == UINT32_MAX || state.layout == resource.finalLayout)
+		{
+			continue;
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = state.writeAccessMask;
+		barrier.dstAccessMask = 0;
+		barrier.oldLayout = state.layout;
+		barrier.newLayout = resource.finalLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange = { resource.aspectMask, 0, 1, 0, 1 };
+		m_FinalBarriers.barriers.push_back(Barrier{ static_cast<ResourceHandle>(idx), barrier });
+		m_FinalBarriers.srcStageMask |= state.writeStageMask | state.readStageMask;
+		m_FinalBarriers.dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		++m_Stats.transitionCount;
+		++m_Stats.imageBarrierCount;
+	}
+
+	for (const Pass& pass : m_Passes)
+	{
+		m_Stats.barrierCount += !pass.isCulled && !pass.barriers.barriers.empty();
+	}
+	m_Stats.barrierCount += !m_FinalBarriers.barriers.empty();
+}
+
+VkRenderPass GP2_RenderGraph::GetRenderPass(PassHandle pass) const
+{
+	return m_Passes[pass].renderPass;
+}
+
+VkImageView GP2_RenderGraph::GetImageView(ResourceHandle resource, uint32_t imageIndex) const
+{
+	const std::vector<VkImageView>& views{ m_Resources[resource].views };
+	return views.empty() ? VK_NULL_HANDLE : views[imageIndex % views.size()];
+}
+
+void GP2_RenderGraph::Execute(VkCommandBuffer commandBuffer, uint32_t imageIndex) const
+{
+	for (const Pass& pass : m_Passes)
+	{
+		if (pass.isCulled)
+		{
+			continue;
+		}
+
+		RecordBarriers(commandBuffer, pass.barriers, imageIndex);
+
+		const VkFramebuffer framebuffer{ pass.framebuffers[imageIndex % pass.framebuffers.size()] };
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = pass.renderPass;
+		renderPassInfo.framebuffer = framebuffer;
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = pass.extent;
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+		renderPassInfo.pClearValues = pass.clearValues.data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, pass.contents);
+		pass.record(PassContext{ commandBuffer, pass.renderPass, framebuffer, pass.extent, imageIndex });
+		vkCmdEndRenderPass(commandBuffer);
+	}
+
+	RecordBarriers(commandBuffer, m_FinalBarriers, imageIndex);
+}
+
+void GP2_RenderGraph::PrintStats(std::ostream& stream) const
+{
+	const auto megabytes{ [](VkDeviceSize bytes) { return bytes / (1024.0 * 1024.0); } };
+
+	stream << "Render graph: " << m_Stats.passCount - m_Stats.culledPassCount << " of " << m_Stats.passCount << " passes kept, "
+		   << m_Stats.transitionCount << " layout transitions and dependencies a frame, " << m_Stats.mergedTransitionCount
+		   << " of them folded into render passes, the rest " << m_Stats.imageBarrierCount << " image barriers in " << m_Stats.barrierCount
+		   << " pipeline barriers" << std::endl;
+	stream << "  " << m_Stats.transientCount << " transient images in " << megabytes(m_Stats.allocatedBytes) << " MB instead of "
+		   << megabytes(m_Stats.transientBytes) << " MB, aliasing saved " << megabytes(m_Stats.transientBytes - m_Stats.allocatedBytes) << " MB"
+		   << std::endl;
+}
+
+void GP2_RenderGraph::CullPasses()
+{
+	// walked backwards: a pass stays when it writes an imported image or one a kept pass after it needs
+	std::vector<bool> isNeeded(m_Resources.size());
+	for (size_t passIndex = m_Passes.size(); passIndex-- > 0;)
+	{
+		Pass& pass{ m_Passes[passIndex] };
+		pass.isCulled = std::none_of(pass.accesses.begin(), pass.accesses.end(), [this, &isNeeded](const Access& access)
+		{
+			const Resource& resource{ m_Resources[access.resource] };
+			return GetUsage(resource, access.type).isWrite && (resource.isImported || isNeeded[access.resource]);
+		});
+		if (pass.isCulled)
+		{
+			++m_Stats.culledPassCount;
+			continue;
+		}
+
+		// a clear doesn't need what came before, any other access does
+		for (const Access& access : pass.accesses)
+		{
+			isNeeded[access.resource] = !access.hasClear;
+		}
+	}
+}
+
+void GP2_RenderGraph::ComputeLifetimes()
+{
+	for (Resource& resource : m_Resources)
+	{
+		resource.firstPass = UINT32_MAX;
+		resource.lastPass = UINT32_MAX;
+		resource.usage = 0;
+		resource.lastStageMask = 0;
+		resource.lastAccessMask = 0;
+	}
+
+	for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+	{
+		const Pass& pass{ m_Passes[passIndex] };
+		if (pass.isCulled)
+		{
+			continue;
+		}
+
+		for (const Access& access : pass.accesses)
+		{
+			Resource& resource{ m_Resources[access.resource] };
+			const Usage usage{ GetUsage(resource, access.type) };
+			if (resource.firstPass == UINT32_MAX)
+			{
+				resource.firstPass = passIndex;
+			}
+			resource.lastPass = passIndex;
+			resource.usage |= usage.usage;
+
+			// the same as walking the frame in Compile ends with
+			if (usage.isWrite)
+			{
+				resource.lastStageMask = usage.stageMask;
+				resource.lastAccessMask = usage.accessMask & WriteAccessMask;
+			}
+			else
+			{
+				resource.lastStageMask |= usage.stageMask;
+			}
+		}
+	}
+}
+
+void GP2_RenderGraph::CreateTransientImages()
+{
+	std::vector<ResourceHandle> transients;
+	for (ResourceHandle handle = 0; handle < m_Resources.size(); ++handle)
+	{
+		Resource& resource{ m_Resources[handle] };
+		if (resource.isImported || resource.firstPass == UINT32_MAX)
+		{
+			continue;
+		}
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { resource.extent.width, resource.extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = resource.format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = resource.usage;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VkImage image{};
+		if (vkCreateImage(m_Device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create image!");
+		}
+		resource.images.push_back(image);
+		vkGetImageMemoryRequirements(m_Device, image, &resource.requirements);
+
+		transients.push_back(handle);
+		++m_Stats.transientCount;
+		m_Stats.transientBytes += resource.requirements.size;
+	}
+
+	if (transients.empty())
+	{
+		return;
+	}
+
+	// one allocation every transient image fits in at its offset
+	VkMemoryRequirements requirements{};
+	requirements.size = PlaceTransientImages(transients);
+	requirements.alignment = 1;
+	requirements.memoryTypeBits = UINT32_MAX;
+	for (ResourceHandle handle : transients)
+	{
+		requirements.alignment = std::max(requirements.alignment, m_Resources[handle].requirements.alignment);
+		requirements.memoryTypeBits &= m_Resources[handle].requirements.memoryTypeBits;
+	}
+	if (requirements.memoryTypeBits == 0)
+	{
+		throw std::runtime_error("render graph transient images share no memory type!");
+	}
+
+	m_TransientAllocation = GP2_MemoryAllocator::Get(m_Device).AllocateMemory(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		GP2_MemoryAllocator::Category::RenderTarget, "render graph transients");
+	m_Stats.allocatedBytes = requirements.size;
+
+	for (ResourceHandle handle : transients)
+	{
+		Resource& resource{ m_Resources[handle] };
+		if (vkBindImageMemory(m_Device, resource.images[0], m_TransientAllocation.memory, m_TransientAllocation.offset + resource.offset) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to bind image memory!");
+		}
+		resource.views.push_back(CreateImageView(resource.images[0], resource.format, resource.aspectMask));
+	}
+}
+
+VkDeviceSize GP2_RenderGraph::PlaceTransientImages(const std::vector<ResourceHandle>& transients)
+{
+	// largest first, so the small ones fill the gaps between them
+	std::vector<ResourceHandle> order{ transients };
+	std::stable_sort(order.begin(), order.end(), [this](ResourceHandle left, ResourceHandle right)
+	{
+		return m_Resources[left].requirements.size > m_Resources[right].requirements.size;
+	});
+
+	std::vector<ResourceHandle> placed;
+	VkDeviceSize size{};
+	for (ResourceHandle handle : order)
+	{
+		Resource& resource{ m_Resources[handle] };
+		const VkDeviceSize alignment{ std::max<VkDeviceSize>(resource.requirements.alignment, 1) };
+
+		// the offset only moves past an image in the way, every offset skipped overlapped it too, so the first one found is the lowest
+		VkDeviceSize offset{};
+		bool isMoved{ true };
+		while (isMoved)
+		{
+			isMoved = false;
+			for (ResourceHandle placedHandle : placed)
+			{
+				const Resource& other{ m_Resources[placedHandle] };
+				const bool isAlive{ other.firstPass <= resource.lastPass && resource.firstPass <= other.lastPass };
+				const VkDeviceSize otherEnd{ other.offset + other.requirements.size };
+				if (isAlive && offset < otherEnd && other.offset < offset + resource.requirements.size)
+				{
+					offset = (otherEnd + alignment - 1) / alignment * alignment;
+					isMoved = true;
+				}
+			}
+		}
+
+		resource.offset = offset;
+		size = std::max(size, offset + resource.requirements.size);
+		placed.push_back(handle);
+	}
+	return size;
+}
+
+bool GP2_RenderGraph::IsReadAfter(uint32_t passIndex, ResourceHandle resource) const
+{
+	for (uint32_t laterIndex = passIndex + 1; laterIndex < m_Passes.size(); ++laterIndex)
+	{
+		const Pass& pass{ m_Passes[laterIndex] };
+		if (pass.isCulled)
+		{
+			continue;
+		}
+
+		for (const Access& access : pass.accesses)
+		{
+			if (access.resource == resource)
+			{
+				return !access.hasClear;
+			}
+		}
+	}
+
+	// imported images are used after the frame
+	return m_Resources[resource].isImported;
+}
+
+void GP2_RenderGraph::CreateRenderPass(Pass& pass, const std::vector<VkAttachmentDescription>& attachments,
+									   const std::vector<VkAttachmentReference>& references, const VkSubpassDependency& dependency)
+{
+	std::vector<VkAttachmentReference> colorReferences;
+	VkAttachmentReference depthReference{};
+	bool hasDepth{};
+	for (const VkAttachmentReference& reference : references)
+	{
+		if (!IsDepthFormat(attachments[reference.attachment].format))
+		{
+			colorReferences.push_back(reference);
+			continue;
+		}
+
+		if (hasDepth)
+		{
+			throw std::runtime_error("render graph pass has more than one depth attachment!");
+		}
+		depthReference = reference;
+		hasDepth = true;
+	}
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+	subpass.pColorAttachments = colorReferences.data();
+	subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = dependency.dstStageMask != 0 ? 1 : 0;
+	renderPassInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(m_Device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create render pass!");
+	}
+}
+
+void GP2_RenderGraph::CreateFramebuffers(Pass& pass)
+{
+	// a framebuffer for every image of the imported attachments, transient ones are the same in each
+	size_t framebufferCount{ 1 };
+	for (ResourceHandle handle : pass.attachments)
+	{
+		framebufferCount = std::max(framebufferCount, m_Resources[handle].views.size());
+	}
+
+	pass.framebuffers.resize(framebufferCount);
+	std::vector<VkImageView> views(pass.attachments.size());
+	for (size_t framebufferIndex = 0; framebufferIndex < framebufferCount; ++framebufferIndex)
+	{
+		for (size_t idx = 0; idx < pass.attachments.size(); ++idx)
+		{
+			views[idx] = GetImageView(pass.attachments[idx], static_cast<uint32_t>(framebufferIndex));
+		}
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = pass.renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+		framebufferInfo.pAttachments = views.data();
+		framebufferInfo.width = pass.extent.width;
+		framebufferInfo.height = pass.extent.height;
+		framebufferInfo.layers = 1;
+
+		if (vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &pass.framebuffers[framebufferIndex]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create framebuffer!");
+		}
+	}
+}
+
+void GP2_RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch, uint32_t imageIndex) const
+{
+	if (batch.barriers.empty())
+	{
+		return;
+	}
+
+	std::vector<VkImageMemoryBarrier> barriers;
+	barriers.reserve(batch.barriers.size());
+	for (const Barrier& barrier : batch.barriers)
+	{
+		const std::vector<VkImage>& images{ m_Resources[barrier.resource].images };
+		VkImageMemoryBarrier& imageBarrier{ barriers.emplace_back(barrier.barrier) };
+		imageBarrier.image = images[imageIndex % images.size()];
+	}
+
+	vkCmdPipelineBarrier(commandBuffer, batch.srcStageMask, batch.dstStageMask, 0, 0, nullptr, 0, nullptr,
+		static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+VkImageView GP2_RenderGraph::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask) const
+{
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = aspectMask;
+	viewInfo.subresourceRange.baseMipLevel = 0;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	VkImageView imageView{};
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create image view!");
+	}
+	return imageView;
+}
+
+bool GP2_RenderGraph::IsDepthFormat(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+VkImageAspectFlags GP2_RenderGraph::GetAspectMask(VkFormat format)
+{
+	if (!IsDepthFormat(format))
+	{
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+
+	const bool hasStencil{ format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT };
+	return hasStencil ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+}
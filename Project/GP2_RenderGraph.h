@@ -0,0 +1,251 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <string_view>
+#include <cstdint>
+
+#include "GP2_MemoryAllocator.h"
+#include "vulkanbase/VulkanUtil.h"
+
+// Frame graph of render passes that declare the images they read and write. Compile turns the declarations into
+// everything that used to be written by hand around a pass:
+// - Passes whose results nothing reads and that write no imported image are culled.
+// - Every pass becomes a VkRenderPass and framebuffers. Load and store ops follow from what came before and what reads
+//   the attachments afterwards.
+// - The layout transitions of attachments go into the render pass. Its attachment layouts and a single external
+//   dependency cover the stages and accesses of all of them. Images a pass samples get explicit barriers, merged into
+//   one vkCmdPipelineBarrier before the pass.
+// - Transient images live in one allocation. Those whose lifetimes don't overlap share memory, and their first use
+//   waits for the last use of whatever shared it before.
+// Declare everything, Compile once, then Execute every frame. Render thread only.
+class GP2_RenderGraph final
+{
+public:
+	using ResourceHandle = uint32_t;
+	using PassHandle = uint32_t;
+
+	//-----------
+	// Structs
+	//-----------
+	struct PassContext
+	{
+		VkCommandBuffer commandBuffer;
+		VkRenderPass renderPass;
+		VkFramebuffer framebuffer;
+		VkExtent2D extent;
+		uint32_t imageIndex;
+	};
+
+	// Records the pass inside its render pass, begun with the contents it was added with
+	using RecordFunction = std::function<void(const PassContext& context)>;
+
+	struct Stats
+	{
+		uint32_t passCount;
+		uint32_t culledPassCount;
+		// layout transitions and dependencies a frame needs, those folded into render passes and the image barriers the
+		// rest became, issued with barrierCount vkCmdPipelineBarrier calls
+		uint32_t transitionCount;
+		uint32_t mergedTransitionCount;
+		uint32_t imageBarrierCount;
+		uint32_t barrierCount;
+		uint32_t transientCount;
+		// what the transient images would take one allocation each, against the aliased allocation
+		VkDeviceSize transientBytes;
+		VkDeviceSize allocatedBytes;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_RenderGraph() = default;
+	~GP2_RenderGraph() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_RenderGraph(const GP2_RenderGraph&) = delete;
+	GP2_RenderGraph(GP2_RenderGraph&&) = delete;
+	GP2_RenderGraph& operator=(const GP2_RenderGraph&) = delete;
+	GP2_RenderGraph& operator=(GP2_RenderGraph&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	void Initialize(VkDevice device);
+	// Destroys the render passes, framebuffers and transient images, none of them may be in use anymore
+	void Destroy();
+
+	// An image owned elsewhere, like the swapchain's. With several images Execute picks one by its imageIndex. Its
+	// contents are undefined at the start of a frame when initialLayout is, and become available at initialStage, where
+	// the semaphore signalling them is waited for. The graph leaves it in finalLayout at the end of the frame.
+	ResourceHandle ImportImage(std::string_view name, VkFormat format, VkExtent2D extent, const std::vector<VkImage>& images,
+							   const std::vector<VkImageView>& views, VkImageLayout initialLayout, VkPipelineStageFlags initialStage,
+							   VkImageLayout finalLayout);
+	// An image the graph creates and owns, its usage follows from the passes using it. Its contents don't outlive the frame.
+	ResourceHandle CreateImage(std::string_view name, VkFormat format, VkExtent2D extent);
+
+	PassHandle AddPass(std::string_view name, RecordFunction record, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+	// Color attachment, cleared when pClearValue is set, loaded when an earlier pass or the import left contents in it
+	void WriteColor(PassHandle pass, ResourceHandle resource, const VkClearColorValue* pClearValue = nullptr);
+	// Depth attachment with depth writes, cleared when pClearValue is set
+	void WriteDepth(PassHandle pass, ResourceHandle resource, const VkClearDepthStencilValue* pClearValue = nullptr);
+	// Depth attachment tested against without writing
+	void ReadDepth(PassHandle pass, ResourceHandle resource);
+	// Sampled by the pass's fragment shaders
+	void ReadTexture(PassHandle pass, ResourceHandle resource);
+
+	// Throws when a declaration is inconsistent, like a pass reading an image nothing wrote. Once, after every declaration.
+	void Compile();
+	// The render pass pipelines of a pass are created against, VK_NULL_HANDLE when it was culled
+	VkRenderPass GetRenderPass(PassHandle pass) const;
+	bool IsCulled(PassHandle pass) const { return m_Passes[pass].isCulled; }
+	VkImageView GetImageView(ResourceHandle resource, uint32_t imageIndex = 0) const;
+
+	// Records every pass that wasn't culled with its barriers, imageIndex picks the imported images
+	void Execute(VkCommandBuffer commandBuffer, uint32_t imageIndex) const;
+
+	const Stats& GetStats() const { return m_Stats; }
+	void PrintStats(std::ostream& stream) const;
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	enum class AccessType : uint32_t
+	{
+		ColorWrite,
+		DepthWrite,
+		DepthRead,
+		TextureRead
+	};
+
+	struct Access
+	{
+		ResourceHandle resource;
+		AccessType type;
+		bool hasClear;
+		VkClearValue clearValue;
+	};
+
+	// what an access needs from the image
+	struct Usage
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags stageMask;
+		VkAccessFlags accessMask;
+		VkImageUsageFlags usage;
+		bool isWrite;
+		bool isAttachment;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		VkFormat format;
+		VkExtent2D extent;
+		VkImageAspectFlags aspectMask;
+		bool isImported;
+		std::vector<VkImage> images;
+		std::vector<VkImageView> views;
+		VkImageLayout initialLayout;
+		VkPipelineStageFlags initialStage;
+		VkImageLayout finalLayout;
+
+		// the first and last kept pass using it, UINT32_MAX when none does
+		uint32_t firstPass;
+		uint32_t lastPass;
+
+		// transient images only
+		VkImageUsageFlags usage;
+		VkMemoryRequirements requirements;
+		VkDeviceSize offset;
+		// how the frame leaves it, what the next image in its memory waits for
+		VkPipelineStageFlags lastStageMask;
+		VkAccessFlags lastAccessMask;
+	};
+
+	// an image barrier whose image is picked when executing
+	struct Barrier
+	{
+		ResourceHandle resource;
+		VkImageMemoryBarrier barrier;
+	};
+
+	struct BarrierBatch
+	{
+		std::vector<Barrier> barriers;
+		VkPipelineStageFlags srcStageMask;
+		VkPipelineStageFlags dstStageMask;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		RecordFunction record;
+		VkSubpassContents contents;
+		std::vector<Access> accesses;
+		bool isCulled;
+
+		BarrierBatch barriers;
+		std::vector<ResourceHandle> attachments;
+		VkRenderPass renderPass;
+		VkExtent2D extent;
+		// one per imported image when an attachment is imported
+		std::vector<VkFramebuffer> framebuffers;
+		std::vector<VkClearValue> clearValues;
+	};
+
+	// where an image stands while the passes are walked
+	struct State
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags writeStageMask;
+		VkAccessFlags writeAccessMask;
+		VkPipelineStageFlags readStageMask;
+		// stages the last write was made visible to
+		VkPipelineStageFlags visibleStageMask;
+		bool hasContents;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	void AddAccess(PassHandle pass, ResourceHandle resource, AccessType type, bool hasClear, VkClearValue clearValue);
+	Usage GetUsage(const Resource& resource, AccessType type) const;
+
+	void CullPasses();
+	void ComputeLifetimes();
+	void CreateTransientImages();
+	// Places every transient image at the lowest offset where it overlaps no image alive at the same time, returns the size
+	VkDeviceSize PlaceTransientImages(const std::vector<ResourceHandle>& transients);
+	// whether a kept pass after passIndex needs the contents it leaves in resource
+	bool IsReadAfter(uint32_t passIndex, ResourceHandle resource) const;
+	void CreateRenderPass(Pass& pass, const std::vector<VkAttachmentDescription>& attachments,
+						  const std::vector<VkAttachmentReference>& references, const VkSubpassDependency& dependency);
+	void CreateFramebuffers(Pass& pass);
+	void RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch, uint32_t imageIndex) const;
+	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask) const;
+
+	static bool IsDepthFormat(VkFormat format);
+	static VkImageAspectFlags GetAspectMask(VkFormat format);
+
+	//-----------
+	// Variables
+	//-----------
+	// the accesses a later use has to wait on, reads are ordered by stage alone
+	static constexpr VkAccessFlags WriteAccessMask{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT };
+
+	VkDevice m_Device{};
+
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	// images left in their final layout after the last pass
+	BarrierBatch m_FinalBarriers{};
+
+	GP2_MemoryAllocator::Allocation m_TransientAllocation{};
+	Stats m_Stats{};
+};
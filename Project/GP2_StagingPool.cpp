@@ -0,0 +1,129 @@
+#include "GP2_StagingPool.h"
+
+#include <algorithm>
+
+void GP2_StagingPool::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize chunkSize, uint32_t maxChunkCount)
+{
+	m_Device = device;
+	m_PhysicalDevice = physicalDevice;
+	m_ChunkSize = chunkSize;
+	m_MaxChunkCount = std::max(maxChunkCount, 1u);
+}
+
+void GP2_StagingPool::Destroy()
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+	for (std::unique_ptr<Chunk>& pChunk : m_Chunks)
+	{
+		pChunk->buffer.Destroy();
+	}
+	m_Chunks.clear();
+
+	for (std::optional<GP2_Buffer>& buffer : m_DedicatedBuffers)
+	{
+		if (buffer)
+		{
+			buffer->Destroy();
+		}
+	}
+	m_DedicatedBuffers.clear();
+	m_UnusedDedicatedSlots.clear();
+}
+
+GP2_StagingPool::Allocation GP2_StagingPool::Allocate(VkDeviceSize size)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	if (size <= m_ChunkSize)
+	{
+		for (uint32_t idx = 0; idx <= m_Chunks.size(); ++idx)
+		{
+			if (idx == m_Chunks.size())
+			{
+				if (m_Chunks.size() >= m_MaxChunkCount)
+				{
+					break;
+				}
+
+				// every chunk is full, the pool grows by one
+				std::unique_ptr<Chunk> pChunk{ new Chunk{ CreateStagingBuffer(m_ChunkSize, "staging chunk"), nullptr, GP2_TLSFAllocator{} } };
+				pChunk->buffer.Map(&pChunk->pMapped);
+				pChunk->allocator.Initialize(m_ChunkSize);
+				m_Chunks.push_back(std::move(pChunk));
+			}
+
+			Chunk& chunk{ *m_Chunks[idx] };
+			const uint32_t handle{ chunk.allocator.Allocate(size, Alignment) };
+			if (handle == GP2_TLSFAllocator::InvalidHandle)
+			{
+				continue;
+			}
+
+			const VkDeviceSize offset{ chunk.allocator.GetOffset(handle) };
+			return Allocation{ this, chunk.buffer.GetVkBuffer(), offset, size, static_cast<uint8_t*>(chunk.pMapped) + offset, idx, handle };
+		}
+	}
+
+	// too large for a chunk or every chunk is in use by uploads still in flight
+	uint32_t slot{};
+	if (m_UnusedDedicatedSlots.empty())
+	{
+		slot = static_cast<uint32_t>(m_DedicatedBuffers.size());
+		m_DedicatedBuffers.emplace_back();
+	}
+	else
+	{
+		slot = m_UnusedDedicatedSlots.back();
+		m_UnusedDedicatedSlots.pop_back();
+	}
+
+	m_DedicatedBuffers[slot].emplace(CreateStagingBuffer(size, "dedicated staging"));
+	void* pMapped{};
+	m_DedicatedBuffers[slot]->Map(&pMapped);
+	++m_DedicatedCount;
+	m_DedicatedBytes += size;
+	return Allocation{ this, m_DedicatedBuffers[slot]->GetVkBuffer(), 0, size, pMapped, UINT32_MAX, slot };
+}
+
+void GP2_StagingPool::Free(const Allocation& allocation)
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	if (allocation.chunkIndex != UINT32_MAX)
+	{
+		if (allocation.chunkIndex < m_Chunks.size())
+		{
+			m_Chunks[allocation.chunkIndex]->allocator.Free(allocation.handle);
+		}
+		return;
+	}
+
+	if (allocation.handle < m_DedicatedBuffers.size() && m_DedicatedBuffers[allocation.handle])
+	{
+		m_DedicatedBuffers[allocation.handle]->Destroy();
+		m_DedicatedBuffers[allocation.handle].reset();
+		m_UnusedDedicatedSlots.push_back(allocation.handle);
+	}
+}
+
+GP2_StagingPool::Stats GP2_StagingPool::GetStats() const
+{
+	std::lock_guard<std::mutex> lock{ m_Mutex };
+
+	Stats stats{};
+	stats.chunkCount = static_cast<uint32_t>(m_Chunks.size());
+	stats.chunkBytes = m_ChunkSize * m_Chunks.size();
+	for (const std::unique_ptr<Chunk>& pChunk : m_Chunks)
+	{
+		stats.usedBytes += pChunk->allocator.GetUsedSize();
+	}
+	stats.dedicatedCount = m_DedicatedCount;
+	stats.dedicatedBytes = m_DedicatedBytes;
+	return stats;
+}
+
+GP2_Buffer GP2_StagingPool::CreateStagingBuffer(VkDeviceSize size, std::string_view name) const
+{
+	return GP2_Buffer{ m_Device, m_PhysicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+					   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size, GP2_MemoryAllocator::Category::Staging, name };
+}
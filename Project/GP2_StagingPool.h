@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+#include "GP2_Buffer.h"
+#include "GP2_TLSFAllocator.h"
+#include "vulkan/vulkan_core.h"
+
+// Staging memory for uploads, ranges of a few persistently mapped chunks that live as long as the pool instead of a
+// staging buffer created, mapped and destroyed per upload. Chunks are sub-allocated with GP2_TLSFAllocator and only
+// created when the ones there are full, up to maxChunkCount. What doesn't fit in them gets a buffer of its own, freed
+// with it. Thread safe, textures are staged on decode workers.
+class GP2_StagingPool final
+{
+public:
+	//-----------
+	// Structs
+	//-----------
+	struct Allocation
+	{
+		GP2_StagingPool* pPool;
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		// host coherent, written data needs no flush
+		void* pMapped;
+		// UINT32_MAX for a buffer of its own
+		uint32_t chunkIndex;
+		uint32_t handle;
+	};
+
+	struct Stats
+	{
+		uint32_t chunkCount;
+		VkDeviceSize chunkBytes;
+		VkDeviceSize usedBytes;
+		// allocations that didn't fit in the chunks
+		uint64_t dedicatedCount;
+		VkDeviceSize dedicatedBytes;
+	};
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_StagingPool() = default;
+	~GP2_StagingPool() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_StagingPool(const GP2_StagingPool&) = delete;
+	GP2_StagingPool(GP2_StagingPool&&) = delete;
+	GP2_StagingPool& operator=(const GP2_StagingPool&) = delete;
+	GP2_StagingPool& operator=(GP2_StagingPool&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize chunkSize = DefaultChunkSize,
+					uint32_t maxChunkCount = DefaultMaxChunkCount);
+	// Destroys every chunk, freeing allocations still alive afterwards does nothing
+	void Destroy();
+
+	// Aligned for buffer and image copies of any format
+	Allocation Allocate(VkDeviceSize size);
+	void Free(const Allocation& allocation);
+
+	VkDeviceSize GetChunkSize() const { return m_ChunkSize; }
+	Stats GetStats() const;
+
+	static constexpr VkDeviceSize DefaultChunkSize{ 16ull * 1024 * 1024 };
+	static constexpr uint32_t DefaultMaxChunkCount{ 4 };
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Chunk
+	{
+		GP2_Buffer buffer;
+		void* pMapped;
+		GP2_TLSFAllocator allocator;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	GP2_Buffer CreateStagingBuffer(VkDeviceSize size, std::string_view name) const;
+
+	//-----------
+	// Variables
+	//-----------
+	// the largest texel block of a compressed format
+	static constexpr VkDeviceSize Alignment{ 16 };
+
+	VkDevice m_Device{};
+	VkPhysicalDevice m_PhysicalDevice{};
+	VkDeviceSize m_ChunkSize{};
+	uint32_t m_MaxChunkCount{};
+
+	mutable std::mutex m_Mutex;
+	std::vector<std::unique_ptr<Chunk>> m_Chunks;
+	// a dedicated buffer's slot stays empty once it's freed, until another one reuses it
+	std::vector<std::optional<GP2_Buffer>> m_DedicatedBuffers;
+	std::vector<uint32_t> m_UnusedDedicatedSlots;
+	uint64_t m_DedicatedCount{};
+	VkDeviceSize m_DedicatedBytes{};
+};
@@ -0,0 +1,273 @@
+#include "GP2_TLSFAllocator.h"
+
+#include <bit>
+#include <algorithm>
+
+void GP2_TLSFAllocator::Initialize(uint64_t size)
+{
+	m_Regions.clear();
+	m_UnusedRegions.clear();
+	m_FirstLevelMap = 0;
+	std::fill(std::begin(m_SecondLevelMaps), std::end(m_SecondLevelMaps), 0u);
+	for (auto& heads : m_FreeHeads)
+	{
+		std::fill(std::begin(heads), std::end(heads), InvalidHandle);
+	}
+
+	m_Size = size;
+	m_UsedSize = 0;
+	m_AllocationCount = 0;
+	m_FreeRegionCount = 0;
+
+	InsertFree(CreateRegion(0, size));
+}
+
+uint32_t GP2_TLSFAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	size = std::max<uint64_t>(size, 1);
+	alignment = std::max<uint64_t>(alignment, 1);
+
+	// any region of the searched list fits the size at its worst alignment
+	uint32_t firstLevel{};
+	uint32_t secondLevel{};
+	MapSearch(size + alignment - 1, firstLevel, secondLevel);
+	if (firstLevel >= FirstLevelCount)
+	{
+		return InvalidHandle;
+	}
+
+	const uint32_t index{ FindFree(firstLevel, secondLevel) };
+	if (index == InvalidHandle)
+	{
+		return InvalidHandle;
+	}
+	RemoveFree(index);
+
+	// the alignment padding in front goes to the previous region when that's free, a region of its own otherwise
+	const uint64_t alignedOffset{ (m_Regions[index].offset + alignment - 1) & ~(alignment - 1) };
+	const uint64_t padding{ alignedOffset - m_Regions[index].offset };
+	if (padding > 0)
+	{
+		const uint32_t previous{ m_Regions[index].previousPhysical };
+		if (previous != InvalidHandle && m_Regions[previous].isFree)
+		{
+			RemoveFree(previous);
+			m_Regions[previous].size += padding;
+			InsertFree(previous);
+		}
+		else
+		{
+			const uint32_t paddingIndex{ CreateRegion(m_Regions[index].offset, padding) };
+			m_Regions[paddingIndex].previousPhysical = previous;
+			m_Regions[paddingIndex].nextPhysical = index;
+			if (previous != InvalidHandle)
+			{
+				m_Regions[previous].nextPhysical = paddingIndex;
+			}
+			m_Regions[index].previousPhysical = paddingIndex;
+			InsertFree(paddingIndex);
+		}
+
+		m_Regions[index].offset = alignedOffset;
+		m_Regions[index].size -= padding;
+	}
+
+	// the rest stays free behind it
+	if (m_Regions[index].size > size)
+	{
+		const uint32_t restIndex{ CreateRegion(alignedOffset + size, m_Regions[index].size - size) };
+		const uint32_t next{ m_Regions[index].nextPhysical };
+		m_Regions[restIndex].previousPhysical = index;
+		m_Regions[restIndex].nextPhysical = next;
+		if (next != InvalidHandle)
+		{
+			m_Regions[next].previousPhysical = restIndex;
+		}
+		m_Regions[index].nextPhysical = restIndex;
+		m_Regions[index].size = size;
+		InsertFree(restIndex);
+	}
+
+	m_Regions[index].isFree = false;
+	m_UsedSize += size;
+	++m_AllocationCount;
+	return index;
+}
+
+void GP2_TLSFAllocator::Free(uint32_t handle)
+{
+	uint32_t index{ handle };
+	m_UsedSize -= m_Regions[index].size;
+	--m_AllocationCount;
+
+	const uint32_t next{ m_Regions[index].nextPhysical };
+	if (next != InvalidHandle && m_Regions[next].isFree)
+	{
+		RemoveFree(next);
+		m_Regions[index].size += m_Regions[next].size;
+		m_Regions[index].nextPhysical = m_Regions[next].nextPhysical;
+		if (m_Regions[next].nextPhysical != InvalidHandle)
+		{
+			m_Regions[m_Regions[next].nextPhysical].previousPhysical = index;
+		}
+		ReleaseRegion(next);
+	}
+
+	const uint32_t previous{ m_Regions[index].previousPhysical };
+	if (previous != InvalidHandle && m_Regions[previous].isFree)
+	{
+		RemoveFree(previous);
+		m_Regions[previous].size += m_Regions[index].size;
+		m_Regions[previous].nextPhysical = m_Regions[index].nextPhysical;
+		if (m_Regions[index].nextPhysical != InvalidHandle)
+		{
+			m_Regions[m_Regions[index].nextPhysical].previousPhysical = previous;
+		}
+		ReleaseRegion(index);
+		index = previous;
+	}
+
+	InsertFree(index);
+}
+
+uint64_t GP2_TLSFAllocator::GetLargestFreeRegion() const
+{
+	if (m_FirstLevelMap == 0)
+	{
+		return 0;
+	}
+
+	// the largest region is in the highest list, which isn't sorted
+	const uint32_t firstLevel{ static_cast<uint32_t>(63 - std::countl_zero(m_FirstLevelMap)) };
+	const uint32_t secondLevel{ static_cast<uint32_t>(31 - std::countl_zero(m_SecondLevelMaps[firstLevel])) };
+	uint64_t largestSize{};
+	for (uint32_t index = m_FreeHeads[firstLevel][secondLevel]; index != InvalidHandle; index = m_Regions[index].nextFree)
+	{
+		largestSize = std::max(largestSize, m_Regions[index].size);
+	}
+	return largestSize;
+}
+
+void GP2_TLSFAllocator::MapInsert(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	if (size < SmallSize)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(size / (SmallSize / SecondLevelCount));
+		return;
+	}
+
+	const uint32_t topBit{ static_cast<uint32_t>(63 - std::countl_zero(size)) };
+	secondLevel = static_cast<uint32_t>(size >> (topBit - SecondLevelCountLog2)) ^ SecondLevelCount;
+	firstLevel = topBit - FirstLevelShift + 1;
+}
+
+void GP2_TLSFAllocator::MapSearch(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	// rounded up to the next list boundary
+	uint64_t round{ SmallSize / SecondLevelCount - 1 };
+	if (size >= SmallSize)
+	{
+		const uint32_t topBit{ static_cast<uint32_t>(63 - std::countl_zero(size)) };
+		round = (1ull << (topBit - SecondLevelCountLog2)) - 1;
+	}
+	if (size > UINT64_MAX - round)
+	{
+		firstLevel = FirstLevelCount;
+		return;
+	}
+	MapInsert(size + round, firstLevel, secondLevel);
+}
+
+uint32_t GP2_TLSFAllocator::CreateRegion(uint64_t offset, uint64_t size)
+{
+	const Region region{ offset, size, InvalidHandle, InvalidHandle, InvalidHandle, InvalidHandle, false };
+	if (m_UnusedRegions.empty())
+	{
+		m_Regions.push_back(region);
+		return static_cast<uint32_t>(m_Regions.size() - 1);
+	}
+
+	const uint32_t index{ m_UnusedRegions.back() };
+	m_UnusedRegions.pop_back();
+	m_Regions[index] = region;
+	return index;
+}
+
+void GP2_TLSFAllocator::ReleaseRegion(uint32_t index)
+{
+	m_UnusedRegions.push_back(index);
+}
+
+void GP2_TLSFAllocator::InsertFree(uint32_t index)
+{
+	uint32_t firstLevel{};
+	uint32_t secondLevel{};
+	MapInsert(m_Regions[index].size, firstLevel, secondLevel);
+
+	Region& region{ m_Regions[index] };
+	region.isFree = true;
+	region.previousFree = InvalidHandle;
+	region.nextFree = m_FreeHeads[firstLevel][secondLevel];
+	if (region.nextFree != InvalidHandle)
+	{
+		m_Regions[region.nextFree].previousFree = index;
+	}
+	m_FreeHeads[firstLevel][secondLevel] = index;
+
+	m_FirstLevelMap |= 1ull << firstLevel;
+	m_SecondLevelMaps[firstLevel] |= 1u << secondLevel;
+	++m_FreeRegionCount;
+}
+
+void GP2_TLSFAllocator::RemoveFree(uint32_t index)
+{
+	uint32_t firstLevel{};
+	uint32_t secondLevel{};
+	MapInsert(m_Regions[index].size, firstLevel, secondLevel);
+
+	Region& region{ m_Regions[index] };
+	if (region.previousFree != InvalidHandle)
+	{
+		m_Regions[region.previousFree].nextFree = region.nextFree;
+	}
+	else
+	{
+		m_FreeHeads[firstLevel][secondLevel] = region.nextFree;
+	}
+	if (region.nextFree != InvalidHandle)
+	{
+		m_Regions[region.nextFree].previousFree = region.previousFree;
+	}
+
+	if (m_FreeHeads[firstLevel][secondLevel] == InvalidHandle)
+	{
+		m_SecondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+		if (m_SecondLevelMaps[firstLevel] == 0)
+		{
+			m_FirstLevelMap &= ~(1ull << firstLevel);
+		}
+	}
+
+	region.isFree = false;
+	--m_FreeRegionCount;
+}
+
+uint32_t GP2_TLSFAllocator::FindFree(uint32_t firstLevel, uint32_t secondLevel) const
+{
+	uint32_t secondLevelMap{ m_SecondLevelMaps[firstLevel] & (~0u << secondLevel) };
+	if (secondLevelMap == 0)
+	{
+		// any list of a larger power of two fits
+		const uint64_t firstLevelMap{ firstLevel + 1 < FirstLevelCount ? m_FirstLevelMap & (~0ull << (firstLevel + 1)) : 0 };
+		if (firstLevelMap == 0)
+		{
+			return InvalidHandle;
+		}
+
+		firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+		secondLevelMap = m_SecondLevelMaps[firstLevel];
+	}
+
+	return m_FreeHeads[firstLevel][static_cast<uint32_t>(std::countr_zero(secondLevelMap))];
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Two level segregated fit sub-allocator handing out offsets into a range it doesn't own, a device memory block for
+// GP2_MemoryAllocator. Free regions are kept in lists by size class, 16 per power of two, found through two bitmaps,
+// so allocating and freeing are constant time. Freed regions merge with their free neighbours right away.
+// Not thread safe, the owner locks.
+class GP2_TLSFAllocator final
+{
+public:
+	static constexpr uint32_t InvalidHandle{ UINT32_MAX };
+
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_TLSFAllocator() = default;
+	~GP2_TLSFAllocator() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_TLSFAllocator(const GP2_TLSFAllocator&) = delete;
+	GP2_TLSFAllocator(GP2_TLSFAllocator&&) = default;
+	GP2_TLSFAllocator& operator=(const GP2_TLSFAllocator&) = delete;
+	GP2_TLSFAllocator& operator=(GP2_TLSFAllocator&&) = default;
+
+	//-----------
+	// Functions
+	//-----------
+	// Starts over with the whole range free, outstanding handles become invalid
+	void Initialize(uint64_t size);
+
+	// Returns InvalidHandle when no free region fits, alignment has to be a power of two
+	uint32_t Allocate(uint64_t size, uint64_t alignment);
+	void Free(uint32_t handle);
+
+	uint64_t GetOffset(uint32_t handle) const { return m_Regions[handle].offset; }
+	uint64_t GetSize() const { return m_Size; }
+	uint64_t GetUsedSize() const { return m_UsedSize; }
+	uint32_t GetAllocationCount() const { return m_AllocationCount; }
+	uint32_t GetFreeRegionCount() const { return m_FreeRegionCount; }
+	uint64_t GetLargestFreeRegion() const;
+	bool IsEmpty() const { return m_AllocationCount == 0; }
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	// neighbours are region indices, InvalidHandle at either end
+	struct Region
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t previousPhysical;
+		uint32_t nextPhysical;
+		uint32_t previousFree;
+		uint32_t nextFree;
+		bool isFree;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// the list a region of this size belongs in
+	static void MapInsert(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+	// the first list whose every region is at least this size
+	static void MapSearch(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+	uint32_t CreateRegion(uint64_t offset, uint64_t size);
+	void ReleaseRegion(uint32_t index);
+	void InsertFree(uint32_t index);
+	void RemoveFree(uint32_t index);
+	uint32_t FindFree(uint32_t firstLevel, uint32_t secondLevel) const;
+
+	//-----------
+	// Variables
+	//-----------
+	static constexpr uint32_t SecondLevelCountLog2{ 4 };
+	static constexpr uint32_t SecondLevelCount{ 1u << SecondLevelCountLog2 };
+	// regions below SmallSize share the first list, split linearly
+	static constexpr uint32_t FirstLevelShift{ 8 };
+	static constexpr uint64_t SmallSize{ 1ull << FirstLevelShift };
+	static constexpr uint32_t FirstLevelCount{ 64 - FirstLevelShift + 1 };
+
+	std::vector<Region> m_Regions;
+	std::vector<uint32_t> m_UnusedRegions;
+
+	uint64_t m_FirstLevelMap{};
+	uint32_t m_SecondLevelMaps[FirstLevelCount]{};
+	uint32_t m_FreeHeads[FirstLevelCount][SecondLevelCount]{};
+
+	uint64_t m_Size{};
+	uint64_t m_UsedSize{};
+	uint32_t m_AllocationCount{};
+	uint32_t m_FreeRegionCount{};
+};
@@ -1,62 +1,333 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <stb_image.h>
 #include "GP2_Texture.h"
 #include "GP2_Buffer.h"
+#include "GP2_KTX2File.h"
+#include "GP2_BlockCompressor.h"
 
-GP2_Texture::GP2_Texture(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool) :
+GP2_Texture::GP2_Texture(VulkanContext context) :
 	m_VulkanContext{ context },
-	m_CommandPool{ commandPool },
-	m_GraphicsQueue{ graphicsQueue },
+	m_Name{},
 	m_TextureImage{},
-	m_TextureImageMemory{},
+	m_TextureImageAllocation{},
 	m_TextureImageView{},
-	m_TextureSampler{}
+	m_TextureSampler{},
+	m_Format{ ImageFormat },
+	m_MipLevels{ 1 },
+	m_Levels{},
+	m_LevelData{},
+	m_Staging{},
+	m_pPixels{},
+	m_Width{},
+	m_Height{},
+	m_IsResident{}
 {
 }
 
 GP2_Texture::~GP2_Texture()
 {
+	FreePixels();
+	if (m_Staging)
+	{
+		m_Staging->pPool->Free(*m_Staging);
+	}
+
 	vkDestroySampler(m_VulkanContext.device, m_TextureSampler, nullptr);
 	vkDestroyImageView(m_VulkanContext.device, m_TextureImageView, nullptr);
 
 	vkDestroyImage(m_VulkanContext.device, m_TextureImage, nullptr);
-	vkFreeMemory(m_VulkanContext.device, m_TextureImageMemory, nullptr);
+	if (m_TextureImageAllocation.pAllocator)
+	{
+		m_TextureImageAllocation.pAllocator->Free(m_TextureImageAllocation);
+	}
 }
 
-void GP2_Texture::CreateTextureImage(const char* filePath)
+void GP2_Texture::CreateTextureImage(const char* filePath, GP2_UploadContext& uploadContext)
 {
-	int texWidth, texHeight, texChannels; 
-	stbi_uc* pixels = stbi_load("resources/texture.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4; 
-
-	if (!pixels) 
+	m_Name = filePath;
+	if (!Decode(filePath)) 
 	{
 		throw std::runtime_error("failed to load texture image!"); 
 	}
 
-	GP2_Buffer stagingBuffer{ m_VulkanContext.device, m_VulkanContext.physicalDevice, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, imageSize };
+	// the upload ends in the transition to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL on the graphics queue, draws submitted after it wait for it
+	RecordUpload(uploadContext);
+	m_IsResident = true;
+}
+
+bool GP2_Texture::Decode(const std::string& filePath)
+{
+	FreePixels();
+
+	const std::string extension{ ".ktx2" };
+	if (filePath.size() >= extension.size() && filePath.compare(filePath.size() - extension.size(), extension.size(), extension) == 0)
+	{
+		return DecodeKTX2(filePath);
+	}
+
+	int texChannels{};
+	m_pPixels = stbi_load(filePath.c_str(), &m_Width, &m_Height, &texChannels, STBI_rgb_alpha);
+	if (!m_pPixels)
+	{
+		std::cerr << "Error: failed to decode " << filePath << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+
+	PrepareLevels(m_pPixels, static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height));
+	return true;
+}
+
+void GP2_Texture::Stage(const uint8_t* pPixels, uint32_t width, uint32_t height, GP2_StagingPool& stagingPool)
+{
+	FreePixels();
+
+	m_Width = static_cast<int>(width);
+	m_Height = static_cast<int>(height);
+	PrepareLevels(pPixels, width, height);
+	StagePixels(pPixels, stagingPool);
+
+	// copied, only the level offsets are needed for the upload
+	m_LevelData = std::vector<uint8_t>{};
+}
+
+void GP2_Texture::PrepareLevels(const uint8_t* pPixels, uint32_t width, uint32_t height)
+{
+	m_Format = ImageFormat;
+	m_MipLevels = GP2_MipGenerator::GetMipLevelCount(width, height);
+	m_Levels = { GP2_MipGenerator::MipLevel{ width, height, 0 } };
+	if (m_MipLevels > 1 && !IsLinearBlitSupported(m_Format))
+	{
+		std::vector<GP2_MipGenerator::MipLevel> mips;
+		GP2_MipGenerator generator{};
+		generator.Generate(pPixels, width, height, true, m_LevelData, mips);
+
+		// staged right behind level 0
+		for (const GP2_MipGenerator::MipLevel& mip : mips)
+		{
+			m_Levels.push_back(GP2_MipGenerator::MipLevel{ mip.width, mip.height, size_t(width) * height * 4 + mip.offset });
+		}
+	}
+}
+
+bool GP2_Texture::DecodeKTX2(const std::string& filePath)
+{
+	GP2_KTX2File file{};
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+
+	const VkFormat fileFormat{ file.GetFormat() };
+	const bool isCompressed{ IsCompressedFormatSupported(fileFormat) };
+	m_Format = isCompressed ? fileFormat : (GP2_BlockCompressor::IsSRGB(fileFormat) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM);
+	m_Width = static_cast<int>(file.GetWidth());
+	m_Height = static_cast<int>(file.GetHeight());
+	m_MipLevels = file.GetLevelCount();
+
+	std::vector<uint8_t> pixels;
+	for (uint32_t level = 0; level < file.GetLevelCount(); ++level)
+	{
+		m_Levels.push_back(GP2_MipGenerator::MipLevel{ file.GetLevelWidth(level), file.GetLevelHeight(level), m_LevelData.size() });
+		if (isCompressed)
+		{
+			m_LevelData.insert(m_LevelData.end(), file.GetLevelData(level), file.GetLevelData(level) + file.GetLevelSize(level));
+			continue;
+		}
+
+		if (!GP2_BlockCompressor::Decode(fileFormat, file.GetLevelData(level), file.GetLevelWidth(level), file.GetLevelHeight(level), pixels))
+		{
+			std::cerr << "Error: failed to decode " << filePath << ": BC7 blocks other than mode 6 have no fallback" << std::endl;
+			FreePixels();
+			return false;
+		}
+		m_LevelData.insert(m_LevelData.end(), pixels.begin(), pixels.end());
+	}
+
+	return true;
+}
+
+void GP2_Texture::RecordUpload(GP2_UploadContext& uploadContext, bool isDeferred)
+{
+	RecordImageUpload(uploadContext, m_pPixels, isDeferred);
+	FreePixels();
+}
+
+void GP2_Texture::RecordPlaceholderUpload(GP2_UploadContext& uploadContext)
+{
+	const uint32_t whiteTexel{ 0xFFFFFFFF };
+	m_Format = ImageFormat;
+	m_MipLevels = 1;
+	m_Levels = { GP2_MipGenerator::MipLevel{ 1, 1, 0 } };
+	RecordImageUpload(uploadContext, &whiteTexel, false);
+}
+
+void GP2_Texture::StagePixels(const void* pPixels, GP2_StagingPool& stagingPool)
+{
+	const size_t pixelsSize{ pPixels ? size_t(m_Levels[0].width) * m_Levels[0].height * 4 : 0 };
+	m_Staging = stagingPool.Allocate(pixelsSize + m_LevelData.size());
 
-	stagingBuffer.TransferDeviceLocal(pixels);
+	void* pMappedData{ m_Staging->pMapped };
+	if (pPixels)
+	{
+		memcpy(pMappedData, pPixels, pixelsSize);
+	}
+	if (!m_LevelData.empty())
+	{
+		memcpy(static_cast<uint8_t*>(pMappedData) + pixelsSize, m_LevelData.data(), m_LevelData.size());
+	}
+}
 
-	stbi_image_free(pixels);
+void GP2_Texture::DiscardStaged()
+{
+	FreePixels();
+	if (m_Staging)
+	{
+		m_Staging->pPool->Free(*m_Staging);
+		m_Staging.reset();
+	}
+}
 
-	CreateImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		m_TextureImage, m_TextureImageMemory);
+void GP2_Texture::RecordImageUpload(GP2_UploadContext& uploadContext, const void* pPixels, bool isDeferred)
+{
+	if (!m_Staging)
+	{
+		StagePixels(pPixels, uploadContext.GetStagingPool());
+	}
+	const GP2_StagingPool::Allocation staging{ *m_Staging };
+	uploadContext.AddStaging(staging);
+	m_Staging.reset();
+	const VkCommandBuffer transferCommandBuffer{ uploadContext.GetTransferCommandBuffer() };
+
+	// levels Decode didn't prepare are blitted from level 0 on the GPU
+	const uint32_t width{ m_Levels[0].width };
+	const uint32_t height{ m_Levels[0].height };
+	const bool isBlitted{ m_Levels.size() < m_MipLevels };
+
+	VkImageUsageFlags usage{ VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT };
+	if (isBlitted)
+	{
+		usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+	CreateImage(width, height, m_MipLevels, m_Format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_TextureImage, m_TextureImageAllocation);
 
 	// copy staging buffer to image
-	TransitionImageLayout(m_TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	CopyBufferToImage(stagingBuffer.GetVkBuffer(), m_TextureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+	TransitionImageLayout(transferCommandBuffer, m_TextureImage, m_Format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_MipLevels);
+	CopyBufferToImage(transferCommandBuffer, staging.buffer, staging.offset, m_TextureImage, m_Levels);
+	uploadContext.ReleaseImage(m_TextureImage, VK_IMAGE_ASPECT_COLOR_BIT, m_MipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	// prepare it for shader access, blits and the fragment shader stage need the graphics queue
+	const VkCommandBuffer commandBuffer{ isDeferred ? uploadContext.GetDeferredCommandBuffer() : uploadContext.GetCommandBuffer() };
+	if (isBlitted)
+	{
+		RecordMipBlits(commandBuffer, width, height);
+	}
+	else
+	{
+		TransitionImageLayout(commandBuffer, m_TextureImage, m_Format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_MipLevels);
+	}
+}
+
+void GP2_Texture::RecordMipBlits(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = m_TextureImage;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.levelCount = 1;
+
+	int32_t mipWidth{ static_cast<int32_t>(width) };
+	int32_t mipHeight{ static_cast<int32_t>(height) };
+	for (uint32_t level = 1; level < m_MipLevels; ++level)
+	{
+		// the level above has been written, it's the source of this blit
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		const int32_t nextWidth{ std::max(mipWidth / 2, 1) };
+		const int32_t nextHeight{ std::max(mipHeight / 2, 1) };
+
+		VkImageBlit blit{};
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+		vkCmdBlitImage(commandBuffer, m_TextureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_TextureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR);
+
+		// done as a source, the fragment shader can have it
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// the last level is only ever written
+	barrier.subresourceRange.baseMipLevel = m_MipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+bool GP2_Texture::IsLinearBlitSupported(VkFormat format) const
+{
+	// blitting an image onto itself with VK_FILTER_LINEAR needs all three
+	const VkFormatFeatureFlags requiredFeatures{ VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT };
 
-	// prepare it for shader access
-	TransitionImageLayout(m_TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	VkFormatProperties properties{};
+	vkGetPhysicalDeviceFormatProperties(m_VulkanContext.physicalDevice, format, &properties);
+	return (properties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+bool GP2_Texture::IsCompressedFormatSupported(VkFormat format) const
+{
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(m_VulkanContext.physicalDevice, &supportedFeatures);
+
+	VkFormatProperties properties{};
+	vkGetPhysicalDeviceFormatProperties(m_VulkanContext.physicalDevice, format, &properties);
+	return supportedFeatures.textureCompressionBC && (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+void GP2_Texture::FreePixels()
+{
+	if (m_pPixels)
+	{
+		stbi_image_free(m_pPixels);
+		m_pPixels = nullptr;
+	}
 
-	stagingBuffer.Destroy();
+	m_LevelData = std::vector<uint8_t>{};
+	m_Levels.clear();
 }
 
 void GP2_Texture::CreateTextureImageView()
 {
-	m_TextureImageView = CreateImageView(m_TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT); 
+	m_TextureImageView = CreateImageView(m_TextureImage, m_Format, VK_IMAGE_ASPECT_COLOR_BIT, m_MipLevels); 
 }
 
 void GP2_Texture::CreateTextureSampler()
@@ -71,22 +342,23 @@ void GP2_Texture::CreateTextureSampler()
 	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT; 
 	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT; 
 	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT; 
-	// Enable anisotropic filtering
-	samplerInfo.anisotropyEnable = VK_FALSE; 
+	// Enable anisotropic filtering, the samplerAnisotropy feature is required by IsDeviceSuitable
+	samplerInfo.anisotropyEnable = VK_TRUE; 
 
 	VkPhysicalDeviceProperties properties{};
 	vkGetPhysicalDeviceProperties(m_VulkanContext.physicalDevice, &properties);
 	// Set max anisotropy level to max supported by physical device
-	samplerInfo.maxAnisotropy = 1.f; 
+	samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy; 
 
 	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK; 
 	samplerInfo.unnormalizedCoordinates = VK_FALSE; 
 	samplerInfo.compareEnable = VK_FALSE;
 	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.mipLodBias = std::clamp(MipLodBias, -properties.limits.maxSamplerLodBias, properties.limits.maxSamplerLodBias);
+	// the whole chain, from level 0 down to the 1x1 level
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	samplerInfo.maxLod = static_cast<float>(m_MipLevels);
 
 	if (vkCreateSampler(m_VulkanContext.device, &samplerInfo, nullptr, &m_TextureSampler) != VK_SUCCESS)
 	{
@@ -94,42 +366,7 @@ void GP2_Texture::CreateTextureSampler()
 	}
 }
 
-VkCommandBuffer GP2_Texture::BeginSingleTimeCommands()
-{
-	VkCommandBufferAllocateInfo allocInfo{}; 
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO; 
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; 
-	allocInfo.commandPool = m_CommandPool.GetVkCommandPool(); 
-	allocInfo.commandBufferCount = 1; 
-
-	VkCommandBuffer commandBuffer; 
-	vkAllocateCommandBuffers(m_VulkanContext.device, &allocInfo, &commandBuffer);
-
-	VkCommandBufferBeginInfo beginInfo{}; 
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; 
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; 
-
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-	return commandBuffer; 
-}
-
-void GP2_Texture::EndSingleTimeCommands(VkCommandBuffer commandBuffer)
-{
-	vkEndCommandBuffer(commandBuffer); 
-
-	VkSubmitInfo submitInfo{}; 
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO; 
-	submitInfo.commandBufferCount = 1; 
-	submitInfo.pCommandBuffers = &commandBuffer; 
-
-	vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE); 
-	vkQueueWaitIdle(m_GraphicsQueue); 
-
-	vkFreeCommandBuffers(m_VulkanContext.device, m_CommandPool.GetVkCommandPool(), 1, &commandBuffer); 
-}
-
-VkImageView GP2_Texture::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) 
+VkImageView GP2_Texture::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) 
 {
 	VkImageViewCreateInfo viewInfo{}; 
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO; 
@@ -138,7 +375,7 @@ VkImageView GP2_Texture::CreateImageView(VkImage image, VkFormat format, VkImage
 	viewInfo.format = format;
 	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 	viewInfo.subresourceRange.aspectMask = aspectFlags;
@@ -153,7 +390,7 @@ VkImageView GP2_Texture::CreateImageView(VkImage image, VkFormat format, VkImage
 	return imageView;
 }
 
-void GP2_Texture::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void GP2_Texture::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, GP2_MemoryAllocator::Allocation& imageAllocation)
 {
 	// 1. Create Image
 	VkImageCreateInfo imageInfo{};
@@ -162,7 +399,7 @@ void GP2_Texture::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 	imageInfo.extent.width = width;
 	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -176,28 +413,14 @@ void GP2_Texture::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 		throw std::runtime_error("failed to create image!");
 	}
 
-	// 2. Allocate Memory for Image
-	VkMemoryRequirements memRequirements{};
-	vkGetImageMemoryRequirements(m_VulkanContext.device, image, &memRequirements);
-
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-	if (vkAllocateMemory(m_VulkanContext.device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to allocate image memory!");
-	}
-
-	// 3. Bind Memory to Image
-	vkBindImageMemory(m_VulkanContext.device, image, imageMemory, 0);
+	// 2. Place it in one of the allocator's blocks, bound already
+	imageAllocation = GP2_MemoryAllocator::Get(m_VulkanContext.device).AllocateForImage(image, properties, GP2_MemoryAllocator::Category::Texture,
+		m_Name.empty() ? std::string_view{ "texture" } : std::string_view{ m_Name }, tiling == VK_IMAGE_TILING_LINEAR);
 }
 
-void GP2_Texture::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+void GP2_Texture::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+										uint32_t mipLevels)
 {
-	VkCommandBuffer commandBuffer{ BeginSingleTimeCommands() };
-
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.oldLayout = oldLayout;
@@ -211,7 +434,7 @@ void GP2_Texture::TransitionImageLayout(VkImage image, VkFormat format, VkImageL
 	// image's specific part affected by barrier
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -270,60 +493,43 @@ void GP2_Texture::TransitionImageLayout(VkImage image, VkFormat format, VkImageL
 		0, nullptr,
 		1, &barrier
 	);
-
-	EndSingleTimeCommands(commandBuffer);
 }
 
-void GP2_Texture::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+void GP2_Texture::CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image,
+									const std::vector<GP2_MipGenerator::MipLevel>& levels)
 {
-	VkCommandBuffer commandBuffer{ BeginSingleTimeCommands() };
-
-	VkBufferImageCopy region{};
-	// byte offset in buffer, at which pixel values start
-	region.bufferOffset = 0;
-	// how pixels laid out in memory, here stightly packed
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-
-	// which part of image want to copy pixels
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
-
-	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = {
-		width,
-		height,
-		1
-	};
+	std::vector<VkBufferImageCopy> regions(levels.size());
+	for (size_t level = 0; level < levels.size(); ++level)
+	{
+		VkBufferImageCopy& region{ regions[level] };
+		// byte offset in buffer, at which pixel values start
+		region.bufferOffset = bufferOffset + levels[level].offset;
+		// how pixels laid out in memory, here stightly packed (in blocks for compressed formats)
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+
+		// which part of image want to copy pixels
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = static_cast<uint32_t>(level);
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = {
+			levels[level].width,
+			levels[level].height,
+			1
+		};
+	}
 
 	vkCmdCopyBufferToImage(
 		commandBuffer,
 		buffer,
 		image,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // which layout image is going to be in
-		1,
-		&region
+		static_cast<uint32_t>(regions.size()),
+		regions.data()
 	);
-
-	EndSingleTimeCommands(commandBuffer);
-}
-
-uint32_t GP2_Texture::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(m_VulkanContext.physicalDevice, &memProperties);
-
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-	{
-		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-		{
-			return i;
-		}
-	}
-
-	throw std::runtime_error("failed to find suitable memory type!");
 }
 
 bool GP2_Texture::HasStencilComponent(VkFormat format)
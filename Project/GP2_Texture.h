@@ -2,7 +2,14 @@
 #include "vulkanbase/VulkanUtil.h"
 #include "vulkanbase/VulkanBase.h"
 
-#include "GP2_CommandPool.h"
+#include <string>
+#include <vector>
+#include <optional>
+
+#include "GP2_Buffer.h"
+#include "GP2_MemoryAllocator.h"
+#include "GP2_UploadContext.h"
+#include "GP2_MipGenerator.h"
 
 class GP2_Texture final
 {
@@ -10,34 +17,74 @@ public:
 	//---------------------------
 	// Constructors & Destructor
 	//---------------------------
-	GP2_Texture(VulkanContext context, VkQueue graphicsQueue, GP2_CommandPool commandPool);
+	GP2_Texture(VulkanContext context);
 	~GP2_Texture();
 
 	//-----------
 	// Functions
 	//-----------
-	void CreateTextureImage(const char* filePath); 
+	// Decodes the file and records its upload into the context, resident once the context's next Submit has gone out
+	void CreateTextureImage(const char* filePath, GP2_UploadContext& uploadContext);
 	void CreateTextureImageView(); 
 	void CreateTextureSampler(); 
 
-	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
-	void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-					 VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-	void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+	// Streaming is split in the decode, which doesn't record anything and can run on a loader thread,
+	// and the upload recorded on the render thread. Returns false when the file can't be read.
+	// When the format can't be blitted with linear filtering the mip chain is generated here on the CPU.
+	// .ktx2 files bring their mips and are uploaded as they are, or decoded to RGBA8 when the device can't sample their format.
+	bool Decode(const std::string& filePath);
+	// Takes RGBA8 pixels decoded elsewhere, typically by a GP2_ImageDecodePool worker, and writes them with their mips
+	// straight into staging memory of the pool. Like Decode it can run on any thread, RecordUpload then only records the copy.
+	void Stage(const uint8_t* pPixels, uint32_t width, uint32_t height, GP2_StagingPool& stagingPool);
+	// Creates the image from the decoded pixels and records their copy, the mip chain blits and layout transitions into
+	// the upload context, which takes the staging memory over. The copy goes on the transfer command buffer, the rest on
+	// the deferred one when isDeferred, for textures polled with IsComplete that no frame waits for.
+	void RecordUpload(GP2_UploadContext& uploadContext, bool isDeferred = false);
+	// Frees what Decode or Stage prepared for an upload that won't be recorded anymore
+	void DiscardStaged();
+	// Same as RecordUpload for a single opaque white texel
+	void RecordPlaceholderUpload(GP2_UploadContext& uploadContext);
+
+	// Shows up in the memory report, the file path for streamed textures
+	void SetName(const std::string& name) { m_Name = name; }
+	const std::string& GetName() const { return m_Name; }
+
+	// set once the upload has finished on the GPU
+	void SetResident() { m_IsResident = true; }
+	bool IsResident() const { return m_IsResident; }
+
+	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
+	void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
+					 VkMemoryPropertyFlags properties, VkImage& image, GP2_MemoryAllocator::Allocation& imageAllocation);
+	// Transitions the first mipLevels levels
+	void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+							   uint32_t mipLevels = 1);
 
 	VkImageView GetTextureImageView() const { return m_TextureImageView; }
 	VkSampler GetTextureSampler() const { return m_TextureSampler; }
+	uint32_t GetMipLevels() const { return m_MipLevels; }
 
 private:
 	//-----------
 	// Functions
 	//-----------
-	VkCommandBuffer BeginSingleTimeCommands();
-	void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
+	bool DecodeKTX2(const std::string& filePath);
+	// Level 0 and, when the format can't be blitted, the CPU generated mips
+	void PrepareLevels(const uint8_t* pPixels, uint32_t width, uint32_t height);
+	// Stages pPixels as level 0 when given, followed by m_LevelData
+	void StagePixels(const void* pPixels, GP2_StagingPool& stagingPool);
 
-	void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-
-	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+	// One copy with a region per level, levels holds their offsets from bufferOffset
+	void CopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image,
+						   const std::vector<GP2_MipGenerator::MipLevel>& levels);
+	// Stages pPixels like StagePixels unless Stage did already
+	void RecordImageUpload(GP2_UploadContext& uploadContext, const void* pPixels, bool isDeferred);
+	// Fills levels 1 and down from level 0, leaves every level in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	void RecordMipBlits(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height);
+	bool IsLinearBlitSupported(VkFormat format) const;
+	// textureCompressionBC is enabled whenever the device supports it
+	bool IsCompressedFormatSupported(VkFormat format) const;
+	void FreePixels();
 
 	bool HasStencilComponent(VkFormat format);
 
@@ -45,11 +92,28 @@ private:
 	// Variables
 	//-----------
 	VulkanContext m_VulkanContext;
-	GP2_CommandPool m_CommandPool;
-	VkQueue m_GraphicsQueue;
+	std::string m_Name;
 
 	VkImage m_TextureImage;
-	VkDeviceMemory m_TextureImageMemory;
+	GP2_MemoryAllocator::Allocation m_TextureImageAllocation;
 	VkImageView m_TextureImageView;
 	VkSampler m_TextureSampler;
+
+	static constexpr VkFormat ImageFormat{ VK_FORMAT_R8G8B8A8_SRGB };
+	// slightly sharper than the box filtered levels, within maxSamplerLodBias
+	static constexpr float MipLodBias{ -0.25f };
+	VkFormat m_Format;
+	uint32_t m_MipLevels;
+	// the levels Decode prepared, with their offsets into the staging memory. Fewer than m_MipLevels are blitted.
+	std::vector<GP2_MipGenerator::MipLevel> m_Levels;
+	// every level after m_pPixels, or all of them for .ktx2 files
+	std::vector<uint8_t> m_LevelData;
+	// filled by Stage, handed to the upload context by RecordUpload
+	std::optional<GP2_StagingPool::Allocation> m_Staging;
+
+	// stbi_uc, stb_image.h stays out of headers since main.cpp includes it with STB_IMAGE_IMPLEMENTATION
+	unsigned char* m_pPixels;
+	int m_Width;
+	int m_Height;
+	bool m_IsResident;
 };
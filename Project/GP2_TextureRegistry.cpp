@@ -0,0 +1,38 @@
+#include "GP2_TextureRegistry.h"
+#include "GP2_Texture.h"
+
+#include <filesystem>
+#include <algorithm>
+
+void GP2_TextureRegistry::Initialize(const VulkanContext& context)
+{
+	m_Context = context;
+}
+
+std::shared_ptr<GP2_Texture> GP2_TextureRegistry::Acquire(const std::string& filePath)
+{
+	std::weak_ptr<GP2_Texture>& pEntry{ m_Textures[GetKey(filePath)] };
+	std::shared_ptr<GP2_Texture> pTexture{ pEntry.lock() };
+	if (pTexture)
+	{
+		return pTexture;
+	}
+
+	// not make_shared, the control block of an expired entry shouldn't keep the texture's memory around
+	pTexture = std::shared_ptr<GP2_Texture>{ new GP2_Texture{ m_Context } };
+	pEntry = pTexture;
+	return pTexture;
+}
+
+size_t GP2_TextureRegistry::GetTextureCount() const
+{
+	return std::count_if(m_Textures.begin(), m_Textures.end(), [](const auto& entry) { return !entry.second.expired(); });
+}
+
+std::string GP2_TextureRegistry::GetKey(const std::string& filePath)
+{
+	// a file that can't be resolved keeps its spelling, loading it reports the error
+	std::error_code error{};
+	const std::filesystem::path canonicalPath{ std::filesystem::weakly_canonical(filePath, error) };
+	return error ? filePath : canonicalPath.generic_string();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "vulkanbase/VulkanUtil.h"
+
+class GP2_Texture;
+
+// Hands out shared handles to one GP2_Texture per file, keyed by its canonical path so different spellings of the
+// same file share an image, view and sampler. A texture is destroyed with its last handle, the registry only keeps
+// a weak reference. Acquiring doesn't load anything, the first user loads it and everyone else sees IsResident.
+// Render thread only.
+class GP2_TextureRegistry final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_TextureRegistry() = default;
+	~GP2_TextureRegistry() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_TextureRegistry(const GP2_TextureRegistry&) = delete;
+	GP2_TextureRegistry(GP2_TextureRegistry&&) = delete;
+	GP2_TextureRegistry& operator=(const GP2_TextureRegistry&) = delete;
+	GP2_TextureRegistry& operator=(GP2_TextureRegistry&&) = delete;
+
+	//-----------
+	// Functions
+	//-----------
+	void Initialize(const VulkanContext& context);
+
+	std::shared_ptr<GP2_Texture> Acquire(const std::string& filePath);
+
+	// textures with at least one handle alive
+	size_t GetTextureCount() const;
+
+private:
+	//-----------
+	// Functions
+	//-----------
+	static std::string GetKey(const std::string& filePath);
+
+	//-----------
+	// Variables
+	//-----------
+	VulkanContext m_Context{};
+
+	std::unordered_map<std::string, std::weak_ptr<GP2_Texture>> m_Textures;
+};
@@ -32,7 +32,9 @@ inline void GP2_UniformBufferObject<VertexUBO>::Initialize(const VulkanContext&
 		context.physicalDevice,
 		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		sizeof(VertexUBO) 
+		sizeof(VertexUBO),
+		GP2_MemoryAllocator::Category::Uniform,
+		"uniform buffer"
 	);
 }
 
@@ -0,0 +1,430 @@
+#include "GP2_UploadContext.h"
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+void GP2_UploadContext::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkQueue transferQueue,
+								   const QueueFamilyIndices& queueFamilyIndices)
+{
+	m_Device = device;
+	m_Queue = graphicsQueue;
+	m_GraphicsFamily = queueFamilyIndices.graphicsFamily.value();
+	m_CommandPool.Initialize(m_Device, m_GraphicsFamily);
+
+	// a transfer queue of the graphics family would gain nothing but the ownership transfers
+	if (transferQueue && queueFamilyIndices.transferFamily && queueFamilyIndices.transferFamily.value() != m_GraphicsFamily)
+	{
+		m_TransferQueue = transferQueue;
+		m_TransferFamily = queueFamilyIndices.transferFamily.value();
+		m_TransferCommandPool.Initialize(m_Device, m_TransferFamily);
+	}
+
+	m_StagingPool.Initialize(m_Device, physicalDevice);
+}
+
+void GP2_UploadContext::Destroy()
+{
+	Wait(m_SubmittedValue);
+
+	for (const GP2_StagingPool::Allocation& staging : m_StagingAllocations)
+	{
+		m_StagingPool.Free(staging);
+	}
+	m_StagingAllocations.clear();
+	m_BufferReleases.clear();
+	m_ImageReleases.clear();
+	m_IsRecording = false;
+	m_IsTransferRecording = false;
+	m_IsDeferredRecording = false;
+
+	m_StagingPool.Destroy();
+	m_CommandPool.Destroy();
+	if (HasTransferQueue())
+	{
+		m_TransferCommandPool.Destroy();
+	}
+}
+
+VkCommandBuffer GP2_UploadContext::GetCommandBuffer()
+{
+	if (!m_IsRecording)
+	{
+		m_CommandBuffer = m_CommandPool.CreateCommandBuffer();
+		m_CommandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		m_IsRecording = true;
+	}
+	return m_CommandBuffer.GetVkCommandBuffer();
+}
+
+VkCommandBuffer GP2_UploadContext::GetTransferCommandBuffer()
+{
+	if (!HasTransferQueue())
+	{
+		return GetCommandBuffer();
+	}
+
+	if (!m_IsTransferRecording)
+	{
+		m_TransferCommandBuffer = m_TransferCommandPool.CreateCommandBuffer();
+		m_TransferCommandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		m_IsTransferRecording = true;
+	}
+	return m_TransferCommandBuffer.GetVkCommandBuffer();
+}
+
+VkCommandBuffer GP2_UploadContext::GetDeferredCommandBuffer()
+{
+	if (!HasTransferQueue())
+	{
+		return GetCommandBuffer();
+	}
+
+	if (!m_IsDeferredRecording)
+	{
+		m_DeferredCommandBuffer = m_CommandPool.CreateCommandBuffer();
+		m_DeferredCommandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		m_IsDeferredRecording = true;
+	}
+	return m_DeferredCommandBuffer.GetVkCommandBuffer();
+}
+
+void GP2_UploadContext::ReleaseBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+	if (!HasTransferQueue())
+	{
+		return;
+	}
+
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = m_TransferFamily;
+	barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+	m_BufferReleases.push_back(barrier);
+}
+
+void GP2_UploadContext::ReleaseImage(VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels, VkImageLayout layout)
+{
+	if (!HasTransferQueue())
+	{
+		return;
+	}
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = layout;
+	barrier.newLayout = layout;
+	barrier.srcQueueFamilyIndex = m_TransferFamily;
+	barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = aspectMask;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	m_ImageReleases.push_back(barrier);
+}
+
+void GP2_UploadContext::AddStaging(const GP2_StagingPool::Allocation& staging)
+{
+	m_StagingAllocations.push_back(staging);
+}
+
+void GP2_UploadContext::CopyBuffer(const GP2_StagingPool::Allocation& staging, GP2_Buffer& dstBuffer, VkDeviceSize dstOffset)
+{
+	dstBuffer.RecordCopy(GetTransferCommandBuffer(), staging.buffer, staging.offset, staging.size, dstOffset);
+	ReleaseBuffer(dstBuffer.GetVkBuffer(), dstOffset, staging.size);
+	AddStaging(staging);
+}
+
+void GP2_UploadContext::UploadBuffer(const void* pData, VkDeviceSize size, GP2_Buffer& dstBuffer, VkDeviceSize dstOffset)
+{
+	const auto start{ std::chrono::steady_clock::now() };
+
+	if (size <= m_StagingPool.GetChunkSize())
+	{
+		const GP2_StagingPool::Allocation staging{ m_StagingPool.Allocate(size) };
+		memcpy(staging.pMapped, pData, static_cast<size_t>(size));
+		CopyBuffer(staging, dstBuffer, dstOffset);
+
+		m_Stats.pooledBytes += size;
+		m_Stats.pooledMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return;
+	}
+
+	// a slice is only written again once the submission copying out of it has finished
+	const VkDeviceSize sliceSize{ m_StagingPool.GetChunkSize() / 2 };
+	const GP2_StagingPool::Allocation slices[2]{ m_StagingPool.Allocate(sliceSize), m_StagingPool.Allocate(sliceSize) };
+	uint64_t sliceValues[2]{};
+
+	const uint8_t* pBytes{ static_cast<const uint8_t*>(pData) };
+	uint32_t sliceIndex{};
+	for (VkDeviceSize offset = 0; offset < size; offset += sliceSize, ++sliceIndex)
+	{
+		const uint32_t slot{ sliceIndex % 2 };
+		const VkDeviceSize copySize{ std::min(sliceSize, size - offset) };
+
+		Wait(sliceValues[slot]);
+		memcpy(slices[slot].pMapped, pBytes + offset, static_cast<size_t>(copySize));
+		dstBuffer.RecordCopy(GetTransferCommandBuffer(), slices[slot].buffer, slices[slot].offset, copySize, dstOffset + offset);
+		ReleaseBuffer(dstBuffer.GetVkBuffer(), dstOffset + offset, copySize);
+		sliceValues[slot] = Submit();
+	}
+
+	// the other slice's last submission finishes before this one
+	m_Submissions.back().stagingAllocations.push_back(slices[0]);
+	m_Submissions.back().stagingAllocations.push_back(slices[1]);
+
+	m_Stats.slicedBytes += size;
+	m_Stats.slicedMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_Stats.sliceCount += sliceIndex;
+}
+
+uint64_t GP2_UploadContext::Submit(bool isPolled)
+{
+	if (!m_IsRecording && !m_IsTransferRecording && !m_IsDeferredRecording)
+	{
+		return m_SubmittedValue;
+	}
+
+	Submission submission{ m_SubmittedValue + 1, GP2_CommandBuffer{}, VK_NULL_HANDLE, VK_NULL_HANDLE, {}, VK_NULL_HANDLE, {} };
+	submission.stagingAllocations.swap(m_StagingAllocations);
+
+	if (m_IsTransferRecording)
+	{
+		// the releases, the graphics part acquires the same ranges
+		const VkCommandBuffer transferCommandBuffer{ m_TransferCommandBuffer.GetVkCommandBuffer() };
+		for (VkBufferMemoryBarrier& barrier : m_BufferReleases)
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		}
+		for (VkImageMemoryBarrier& barrier : m_ImageReleases)
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		}
+		vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+			static_cast<uint32_t>(m_BufferReleases.size()), m_BufferReleases.data(), static_cast<uint32_t>(m_ImageReleases.size()), m_ImageReleases.data());
+		m_TransferCommandBuffer.EndRecording();
+		m_IsTransferRecording = false;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &submission.transferSemaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create upload semaphore!");
+		}
+		submission.transferFence = CreateFence();
+		submission.transferCommandBuffer = m_TransferCommandBuffer;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submission.transferCommandBuffer.Sumbit(submitInfo);
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &submission.transferSemaphore;
+		if (vkQueueSubmit(m_TransferQueue, 1, &submitInfo, submission.transferFence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit transfer uploads!");
+		}
+		++m_Stats.transferSubmitCount;
+
+		GP2_CommandBuffer acquireCommandBuffer{ m_CommandPool.CreateCommandBuffer() };
+		acquireCommandBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		for (VkBufferMemoryBarrier& barrier : m_BufferReleases)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+									VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		}
+		for (VkImageMemoryBarrier& barrier : m_ImageReleases)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		}
+		vkCmdPipelineBarrier(acquireCommandBuffer.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+			static_cast<uint32_t>(m_BufferReleases.size()), m_BufferReleases.data(), static_cast<uint32_t>(m_ImageReleases.size()), m_ImageReleases.data());
+		acquireCommandBuffer.EndRecording();
+		submission.commandBuffers.push_back(acquireCommandBuffer);
+	}
+	m_BufferReleases.clear();
+	m_ImageReleases.clear();
+
+	const bool isDeferred{ isPolled && submission.transferFence && !m_IsRecording };
+	if (m_IsRecording)
+	{
+		// buffer copies have no barrier of their own, image uploads end in theirs already
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+								VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(m_CommandBuffer.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+		m_CommandBuffer.EndRecording();
+		m_IsRecording = false;
+		submission.commandBuffers.push_back(m_CommandBuffer);
+	}
+	if (m_IsDeferredRecording)
+	{
+		m_DeferredCommandBuffer.EndRecording();
+		m_IsDeferredRecording = false;
+		submission.commandBuffers.push_back(m_DeferredCommandBuffer);
+	}
+
+	m_SubmittedValue = submission.value;
+	m_Submissions.push_back(std::move(submission));
+
+	// the frames submitted next rely on the graphics work, the queue waits for the transfer part then
+	if (!isDeferred)
+	{
+		for (Submission& pending : m_Submissions)
+		{
+			if (!pending.fence)
+			{
+				SubmitGraphics(pending);
+			}
+		}
+	}
+	else
+	{
+		++m_Stats.deferredSubmitCount;
+	}
+	return m_SubmittedValue;
+}
+
+void GP2_UploadContext::Update()
+{
+	// a deferred graphics part goes out once its transfer part has finished, the ones after it wait for it
+	for (Submission& submission : m_Submissions)
+	{
+		if (submission.fence)
+		{
+			continue;
+		}
+		if (vkGetFenceStatus(m_Device, submission.transferFence) != VK_SUCCESS)
+		{
+			break;
+		}
+		SubmitGraphics(submission);
+	}
+
+	while (!m_Submissions.empty() && m_Submissions.front().fence && vkGetFenceStatus(m_Device, m_Submissions.front().fence) == VK_SUCCESS)
+	{
+		Retire(m_Submissions.front());
+		m_Submissions.pop_front();
+	}
+}
+
+bool GP2_UploadContext::IsComplete(uint64_t value)
+{
+	Update();
+	return value <= m_CompletedValue;
+}
+
+void GP2_UploadContext::Wait(uint64_t value)
+{
+	while (!m_Submissions.empty() && m_Submissions.front().value <= value)
+	{
+		Submission& submission{ m_Submissions.front() };
+		if (!submission.fence)
+		{
+			vkWaitForFences(m_Device, 1, &submission.transferFence, VK_TRUE, UINT64_MAX);
+			SubmitGraphics(submission);
+		}
+
+		vkWaitForFences(m_Device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+		Retire(submission);
+		m_Submissions.pop_front();
+	}
+}
+
+void GP2_UploadContext::SubmitGraphics(Submission& submission)
+{
+	submission.fence = CreateFence();
+
+	std::vector<VkCommandBuffer> commandBuffers;
+	for (const GP2_CommandBuffer& commandBuffer : submission.commandBuffers)
+	{
+		commandBuffers.push_back(commandBuffer.GetVkCommandBuffer());
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+	submitInfo.pCommandBuffers = commandBuffers.data();
+
+	// signaled already when the graphics part was deferred
+	const VkPipelineStageFlags waitStage{ VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+	if (submission.transferSemaphore)
+	{
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &submission.transferSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+	}
+
+	if (vkQueueSubmit(m_Queue, 1, &submitInfo, submission.fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit uploads!");
+	}
+}
+
+void GP2_UploadContext::Retire(Submission& submission)
+{
+	for (const GP2_StagingPool::Allocation& staging : submission.stagingAllocations)
+	{
+		m_StagingPool.Free(staging);
+	}
+
+	vkDestroyFence(m_Device, submission.fence, nullptr);
+	for (const GP2_CommandBuffer& commandBuffer : submission.commandBuffers)
+	{
+		const VkCommandBuffer vkCommandBuffer{ commandBuffer.GetVkCommandBuffer() };
+		vkFreeCommandBuffers(m_Device, m_CommandPool.GetVkCommandPool(), 1, &vkCommandBuffer);
+	}
+
+	if (submission.transferFence)
+	{
+		vkDestroyFence(m_Device, submission.transferFence, nullptr);
+		vkDestroySemaphore(m_Device, submission.transferSemaphore, nullptr);
+		const VkCommandBuffer transferCommandBuffer{ submission.transferCommandBuffer.GetVkCommandBuffer() };
+		vkFreeCommandBuffers(m_Device, m_TransferCommandPool.GetVkCommandPool(), 1, &transferCommandBuffer);
+	}
+
+	m_CompletedValue = submission.value;
+}
+
+VkFence GP2_UploadContext::CreateFence() const
+{
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkFence fence{};
+	if (vkCreateFence(m_Device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create upload fence!");
+	}
+	return fence;
+}
+
+void GP2_UploadContext::PrintStats(std::ostream& stream) const
+{
+	const auto throughput{ [](uint64_t bytes, double milliseconds)
+	{
+		return milliseconds > 0.0 ? bytes / (1024.0 * 1024.0) / (milliseconds / 1000.0) : 0.0;
+	} };
+
+	const GP2_StagingPool::Stats poolStats{ m_StagingPool.GetStats() };
+	stream << "Uploads: " << m_SubmittedValue << " submissions on the " << (HasTransferQueue() ? "transfer" : "graphics") << " queue, "
+		   << m_Stats.deferredSubmitCount << " of " << m_Stats.transferSubmitCount << " transfer parts didn't hold up the graphics queue, staging pool of " << poolStats.chunkCount << " x "
+		   << m_StagingPool.GetChunkSize() / (1024 * 1024) << " MB chunks, " << poolStats.dedicatedCount << " staging buffers of their own ("
+		   << poolStats.dedicatedBytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+	stream << "  pooled: " << m_Stats.pooledBytes / (1024.0 * 1024.0) << " MB at " << throughput(m_Stats.pooledBytes, m_Stats.pooledMilliseconds)
+		   << " MB/s, sliced: " << m_Stats.slicedBytes / (1024.0 * 1024.0) << " MB in " << m_Stats.sliceCount << " slices at "
+		   << throughput(m_Stats.slicedBytes, m_Stats.slicedMilliseconds) << " MB/s" << std::endl;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#include "GP2_Buffer.h"
+#include "GP2_StagingPool.h"
+#include "GP2_CommandPool.h"
+#include "GP2_CommandBuffer.h"
+#include "vulkanbase/VulkanUtil.h"
+
+// Records the buffer copies, image uploads and barriers of any number of resources and submits them together with a
+// fence. Every submission is known by an increasing value, so callers wait for or poll the uploads of the resources
+// they need instead of draining the queue after each copy. Staging memory comes from a GP2_StagingPool, ranges handed
+// over go back to it once the submission they're used in has finished.
+// With a transfer queue of its own the copies out of staging memory run on it, so streaming overlaps rendering. What
+// they wrote is released to the graphics queue family and acquired there by the graphics part of the submission,
+// which waits for the transfer part with a semaphore. Without one every command goes into one graphics command buffer.
+// Render thread only, except for the staging pool.
+class GP2_UploadContext final
+{
+public:
+	//---------------------------
+	// Constructors & Destructor
+	//---------------------------
+	GP2_UploadContext() = default;
+	~GP2_UploadContext() = default;
+
+	//------------
+	// Rule of 5
+	//------------
+	GP2_UploadContext(const GP2_UploadContext&) = delete;
+	GP2_UploadContext(GP2_UploadContext&&) = delete;
+	GP2_UploadContext& operator=(const GP2_UploadContext&) = delete;
+	GP2_UploadContext& operator=(GP2_UploadContext&&) = delete;
+
+	//-----------
+	// Structs
+	//-----------
+	// host side staging throughput of UploadBuffer, from the allocation until the copy is recorded
+	struct Stats
+	{
+		uint64_t pooledBytes;
+		double pooledMilliseconds;
+		// uploads larger than a chunk, including the waits for their slices
+		uint64_t slicedBytes;
+		double slicedMilliseconds;
+		uint32_t sliceCount;
+		// submissions with a transfer part, and those whose graphics part waited until the transfer part had finished
+		uint32_t transferSubmitCount;
+		uint32_t deferredSubmitCount;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// transferQueue is VK_NULL_HANDLE when there's no transfer queue family of its own, or it isn't to be used
+	void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkQueue transferQueue,
+					const QueueFamilyIndices& queueFamilyIndices);
+	// Waits for every submission, whatever is recorded and not submitted is dropped
+	void Destroy();
+
+	// Copies out of staging memory, everything a transfer only queue can do. What they write has to be handed over with
+	// ReleaseBuffer or ReleaseImage. Begun on first use, like the other command buffers.
+	VkCommandBuffer GetTransferCommandBuffer();
+	// Graphics queue work that frames submitted after the next Submit rely on, like layout transitions of attachments
+	// and copies between device local buffers. It goes out with the transfer part, the graphics queue waits for it then.
+	VkCommandBuffer GetCommandBuffer();
+	// Graphics queue work only resources polled with IsComplete rely on, like mip blits of streamed textures. With a
+	// transfer queue and a polled Submit it goes out once the transfer part has finished.
+	VkCommandBuffer GetDeferredCommandBuffer();
+	// Hands a range written on the transfer command buffer over to the graphics queue family, nothing without a
+	// transfer queue. Images are released in the layout they were left in and stay in it.
+	void ReleaseBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+	void ReleaseImage(VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels, VkImageLayout layout);
+	bool HasTransferQueue() const { return m_TransferQueue != VK_NULL_HANDLE; }
+
+	GP2_StagingPool& GetStagingPool() { return m_StagingPool; }
+	// Takes over staging memory read by a command recorded into the next submission, freed once it has finished
+	void AddStaging(const GP2_StagingPool::Allocation& staging);
+	// Records the copy of the whole staging range into dstBuffer and takes it over
+	void CopyBuffer(const GP2_StagingPool::Allocation& staging, GP2_Buffer& dstBuffer, VkDeviceSize dstOffset = 0);
+	// Stages size bytes of pData and records their copy into dstBuffer. Data larger than a staging chunk streams through
+	// two half chunk slices, submitted one after the other, so writing a slice overlaps the copy out of the previous one.
+	// That submits whatever was recorded before, the command buffers have to be fetched again afterwards.
+	void UploadBuffer(const void* pData, VkDeviceSize size, GP2_Buffer& dstBuffer, VkDeviceSize dstOffset = 0);
+
+	// Submits everything recorded since the last call and returns its value, the last value when nothing was recorded.
+	// The graphics part ends in a barrier making its transfers visible to everything submitted after it on the same
+	// queue, so draws don't have to wait for it, only the resource lifetime does. isPolled says nothing is drawn from
+	// the submission's resources before IsComplete, its graphics part then waits on the CPU for the transfer part
+	// instead of holding up the graphics queue, unless GetCommandBuffer was recorded into.
+	uint64_t Submit(bool isPolled = false);
+	// Submits the deferred graphics parts whose transfer part has finished and retires the finished submissions
+	void Update();
+	bool IsComplete(uint64_t value);
+	void Wait(uint64_t value);
+
+	// the value the next Submit returns
+	uint64_t GetRecordingValue() const { return m_SubmittedValue + 1; }
+	uint32_t GetSubmitCount() const { return static_cast<uint32_t>(m_SubmittedValue); }
+
+	const Stats& GetStats() const { return m_Stats; }
+	void PrintStats(std::ostream& stream) const;
+
+private:
+	//-----------
+	// Structs
+	//-----------
+	struct Submission
+	{
+		uint64_t value;
+		// empty without a transfer part
+		GP2_CommandBuffer transferCommandBuffer;
+		VkSemaphore transferSemaphore;
+		VkFence transferFence;
+		// the acquires, the graphics work and the deferred graphics work, in that order
+		std::vector<GP2_CommandBuffer> commandBuffers;
+		VkFence fence;
+		std::vector<GP2_StagingPool::Allocation> stagingAllocations;
+	};
+
+	//-----------
+	// Functions
+	//-----------
+	// Graphics parts go out in submission order, the earlier deferred ones with it
+	void SubmitGraphics(Submission& submission);
+	void Retire(Submission& submission);
+	VkFence CreateFence() const;
+
+	//-----------
+	// Variables
+	//-----------
+	VkDevice m_Device{};
+	VkQueue m_Queue{};
+	VkQueue m_TransferQueue{};
+	uint32_t m_GraphicsFamily{};
+	uint32_t m_TransferFamily{};
+	GP2_CommandPool m_CommandPool{};
+	GP2_CommandPool m_TransferCommandPool{};
+	GP2_StagingPool m_StagingPool;
+
+	GP2_CommandBuffer m_CommandBuffer{};
+	GP2_CommandBuffer m_TransferCommandBuffer{};
+	GP2_CommandBuffer m_DeferredCommandBuffer{};
+	bool m_IsRecording{};
+	bool m_IsTransferRecording{};
+	bool m_IsDeferredRecording{};
+	std::vector<VkBufferMemoryBarrier> m_BufferReleases;
+	std::vector<VkImageMemoryBarrier> m_ImageReleases;
+	std::vector<GP2_StagingPool::Allocation> m_StagingAllocations;
+
+	// in submission order, their graphics parts finish in that order on one queue
+	std::deque<Submission> m_Submissions;
+	uint64_t m_SubmittedValue{};
+	uint64_t m_CompletedValue{};
+
+	Stats m_Stats{};
+};
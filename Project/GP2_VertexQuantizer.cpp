@@ -0,0 +1,103 @@
+#include "GP2_VertexQuantizer.h"
+
+namespace
+{
+	// a flat axis still needs a non-zero scale to divide by
+	glm::vec3 GetExtent(const MeshBounds& bounds)
+	{
+		const glm::vec3 extent{ bounds.max - bounds.min };
+		return glm::vec3{ extent.x > 0.f ? extent.x : 1.f, extent.y > 0.f ? extent.y : 1.f, extent.z > 0.f ? extent.z : 1.f };
+	}
+
+	float SignNotZero(float value)
+	{
+		return value >= 0.f ? 1.f : -1.f;
+	}
+}
+
+MeshBounds GP2_VertexQuantizer::ComputeBounds(const std::vector<Vertex3D>& vertices)
+{
+	if (vertices.empty())
+	{
+		return MeshBounds{ glm::vec3{}, glm::vec3{} };
+	}
+
+	MeshBounds bounds{ vertices[0].position, vertices[0].position };
+	for (const Vertex3D& vertex : vertices)
+	{
+		bounds.min = glm::min(bounds.min, vertex.position);
+		bounds.max = glm::max(bounds.max, vertex.position);
+	}
+
+	return bounds;
+}
+
+MeshBounds GP2_VertexQuantizer::Quantize(const std::vector<Vertex3D>& vertices, std::vector<Vertex3DQuantized>& quantizedVertices)
+{
+	const MeshBounds bounds{ ComputeBounds(vertices) };
+
+	quantizedVertices.resize(vertices.size());
+	for (size_t idx = 0; idx < vertices.size(); ++idx)
+	{
+		quantizedVertices[idx] = QuantizeVertex(vertices[idx], bounds);
+	}
+
+	return bounds;
+}
+
+Vertex3DQuantized GP2_VertexQuantizer::QuantizeVertex(const Vertex3D& vertex, const MeshBounds& bounds)
+{
+	const glm::vec3 relative{ (vertex.position - bounds.min) / GetExtent(bounds) };
+	const bool hasNormal{ glm::dot(vertex.normal, vertex.normal) > 0.f };
+
+	Vertex3DQuantized quantized{};
+	quantized.position[0] = glm::packUnorm2x16(glm::vec2{ relative.x, relative.y });
+	quantized.position[1] = glm::packUnorm2x16(glm::vec2{ relative.z, 0.f });
+	quantized.normal = hasNormal ? glm::packSnorm2x16(EncodeOctahedral(vertex.normal)) : 0u;
+	quantized.color = glm::packUnorm4x8(glm::vec4{ vertex.color, hasNormal ? 1.f : 0.f });
+	quantized.texCoord = glm::packHalf2x16(vertex.texCoord);
+
+	return quantized;
+}
+
+Vertex3D GP2_VertexQuantizer::DequantizeVertex(const Vertex3DQuantized& vertex, const MeshBounds& bounds)
+{
+	const glm::vec2 positionXY{ glm::unpackUnorm2x16(vertex.position[0]) };
+	const glm::vec2 positionZ{ glm::unpackUnorm2x16(vertex.position[1]) };
+	const glm::vec4 color{ glm::unpackUnorm4x8(vertex.color) };
+
+	Vertex3D dequantized{};
+	dequantized.position = glm::vec3{ positionXY.x, positionXY.y, positionZ.x } * GetExtent(bounds) + bounds.min;
+	dequantized.color = glm::vec3{ color.x, color.y, color.z };
+	dequantized.normal = color.w > 0.f ? DecodeOctahedral(glm::unpackSnorm2x16(vertex.normal)) : glm::vec3{};
+	dequantized.texCoord = glm::unpackHalf2x16(vertex.texCoord);
+
+	return dequantized;
+}
+
+QuantizedMeshData GP2_VertexQuantizer::GetMeshData(const glm::mat4& model, const MeshBounds& bounds)
+{
+	return QuantizedMeshData{ model, glm::vec4{ GetExtent(bounds), 0.f }, glm::vec4{ bounds.min, 0.f } };
+}
+
+glm::vec2 GP2_VertexQuantizer::EncodeOctahedral(const glm::vec3& normal)
+{
+	// project on the octahedron, the lower half is folded over the diagonals
+	const glm::vec3 projected{ normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z)) };
+	if (projected.z >= 0.f)
+	{
+		return glm::vec2{ projected.x, projected.y };
+	}
+
+	return glm::vec2{ (1.f - glm::abs(projected.y)) * SignNotZero(projected.x), (1.f - glm::abs(projected.x)) * SignNotZero(projected.y) };
+}
+
+glm::vec3 GP2_VertexQuantizer::DecodeOctahedral(const glm::vec2& encoded)
+{
+	glm::vec3 normal{ encoded.x, encoded.y, 1.f - glm::abs(encoded.x) - glm::abs(encoded.y) };
+	const float fold{ glm::max(-normal.z, 0.f) };
+	normal.x += normal.x >= 0.f ? -fold : fold;
+	normal.y += normal.y >= 0.f ? -fold : fold;
+
+	return glm::normalize(normal);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+// Packs Vertex3D into Vertex3DQuantized, positions are stored relative to the mesh bounds so the
+// full 16 bits cover the mesh, the bounds go to the vertex shader through QuantizedMeshData.
+class GP2_VertexQuantizer final
+{
+public:
+	//-----------
+	// Functions
+	//-----------
+	static MeshBounds ComputeBounds(const std::vector<Vertex3D>& vertices);
+
+	// Replaces quantizedVertices, returns the bounds to draw them with
+	static MeshBounds Quantize(const std::vector<Vertex3D>& vertices, std::vector<Vertex3DQuantized>& quantizedVertices);
+	static Vertex3DQuantized QuantizeVertex(const Vertex3D& vertex, const MeshBounds& bounds);
+	// Same decoding as shaders/objshader_quantized.vert, to measure the error on the CPU
+	static Vertex3D DequantizeVertex(const Vertex3DQuantized& vertex, const MeshBounds& bounds);
+
+	static QuantizedMeshData GetMeshData(const glm::mat4& model, const MeshBounds& bounds);
+
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+	static glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+};
@@ -3,6 +3,9 @@
 #include <glm/glm.hpp>
 #include <array>
 
+struct MeshData;
+struct QuantizedMeshData;
+
 struct Vertex2D
 {
 	glm::vec2 position;
@@ -51,6 +54,9 @@ struct Vertex3D
 	glm::vec3 normal;
 	glm::vec2 texCoord;
 
+	// push constants a mesh with this vertex type draws with
+	using MeshConstants = MeshData;
+
 	static VkVertexInputBindingDescription GetBindingDescription() 
 	{
 		VkVertexInputBindingDescription bindingDescription{}; 
@@ -91,6 +97,60 @@ struct Vertex3D
 	}
 };
 
+// 20 instead of 44 bytes, produced from Vertex3D by GP2_VertexQuantizer
+struct Vertex3DQuantized
+{
+	// 16-bit unorm xyz relative to the mesh bounds (packUnorm2x16 pairs), w unused
+	uint32_t position[2];
+	// octahedral encoded, 16-bit snorm
+	uint32_t normal;
+	// rgba8 unorm, alpha is 0 for vertices without a normal so they stay unlit
+	uint32_t color;
+	// half floats
+	uint32_t texCoord;
+
+	using MeshConstants = QuantizedMeshData;
+
+	static VkVertexInputBindingDescription GetBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(Vertex3DQuantized);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+		//POSITION
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = offsetof(Vertex3DQuantized, position);
+
+		//COLOR
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[1].offset = offsetof(Vertex3DQuantized, color);
+
+		//NORMAL
+		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+		attributeDescriptions[2].offset = offsetof(Vertex3DQuantized, normal);
+
+		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[3].offset = offsetof(Vertex3DQuantized, texCoord);
+
+		return attributeDescriptions;
+	}
+};
+
 struct VertexUBO 
 {
 	//glm::mat4 model;
@@ -107,4 +167,55 @@ struct ViewProjection
 struct MeshData 
 {
 	glm::mat4 model;
-};
\ No newline at end of file
+};
+
+// position = inPosition * positionScale + positionOffset, rebuilds the bounds the mesh was quantized against
+struct QuantizedMeshData
+{
+	glm::mat4 model;
+	glm::vec4 positionScale;
+	glm::vec4 positionOffset;
+};
+
+// axis aligned, in the same (flipped) space as the vertex positions
+struct MeshBounds
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+// range of the mesh index buffer drawn with a single vkCmdDrawIndexed
+struct Submesh
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+};
+
+// contiguous range of the mesh index buffer, drawn with one VkDrawIndexedIndirectCommand when it survives culling
+struct Meshlet
+{
+	uint32_t firstIndex;
+	uint32_t triangleCount;
+
+	// bounding sphere
+	glm::vec3 center;
+	float radius;
+
+	// normal cone, every triangle faces away from a viewer for which
+	// dot(center - viewer, coneAxis) >= coneCutoff * length(center - viewer) + radius
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+// one level of detail, level 0 is the full mesh and every level indexes the same vertex buffer
+struct MeshLod
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+
+	// largest object space distance the simplifier moved the surface away from level 0
+	float error;
+};
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_GLBParser.h"
+
+// Usage: GLBParserBenchmark <file.glb|file.obj> [iterations]
+// Imports the file the way GP2_3DMesh does without optimization and writes it into a buffer standing in for the
+// staging memory: a .glb is interleaved straight from the mapping, an OBJ is parsed into vectors and copied.
+// Peak RSS covers the whole process, so run it once per format of the same asset to compare them.
+
+namespace
+{
+	size_t GetPeakResidentBytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+	}
+
+	bool EndsWith(const std::string& string, const std::string& suffix)
+	{
+		return string.size() >= suffix.size() && string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.glb|file.obj> [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string filename{ argv[1] };
+	const int iterations{ argc > 2 ? std::max(1, std::atoi(argv[2])) : 5 };
+	const bool isGLB{ EndsWith(filename, ".glb") };
+	const glm::vec3 color{ 1.f, 1.f, 1.f };
+
+	const size_t startResident{ GetPeakResidentBytes() };
+
+	double bestTime{ 1e30 };
+	size_t vertexCount{};
+	size_t indexCount{};
+	size_t submeshCount{};
+	uint64_t checksum{};
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		const auto start{ std::chrono::high_resolution_clock::now() };
+
+		std::unique_ptr<Vertex3D[]> pStagingVertices;
+		std::unique_ptr<uint32_t[]> pStagingIndices;
+		if (isGLB)
+		{
+			GP2_GLBParser parser{};
+			if (!parser.Open(filename, color))
+			{
+				return EXIT_FAILURE;
+			}
+
+			vertexCount = parser.GetVertexCount();
+			indexCount = parser.GetIndexCount();
+			submeshCount = parser.GetSubmeshes().size();
+			pStagingVertices.reset(new Vertex3D[vertexCount]);
+			pStagingIndices.reset(new uint32_t[indexCount]);
+			parser.WriteVertices(pStagingVertices.get());
+			parser.WriteIndices(pStagingIndices.get(), VK_INDEX_TYPE_UINT32);
+		}
+		else
+		{
+			std::vector<Vertex3D> vertices;
+			std::vector<uint32_t> indices;
+			GP2_OBJParser parser{};
+			if (!parser.Parse(filename, color, vertices, indices))
+			{
+				return EXIT_FAILURE;
+			}
+
+			vertexCount = vertices.size();
+			indexCount = indices.size();
+			submeshCount = 1;
+			pStagingVertices.reset(new Vertex3D[vertexCount]);
+			pStagingIndices.reset(new uint32_t[indexCount]);
+			memcpy(pStagingVertices.get(), vertices.data(), sizeof(Vertex3D) * vertexCount);
+			memcpy(pStagingIndices.get(), indices.data(), sizeof(uint32_t) * indexCount);
+		}
+
+		const std::chrono::duration<double> time{ std::chrono::high_resolution_clock::now() - start };
+		bestTime = std::min(bestTime, time.count());
+
+		// keeps the writes alive and tells runs on the same asset apart when they don't match
+		checksum = 0;
+		for (size_t idx = 0; idx < indexCount; ++idx)
+		{
+			checksum = checksum * 31 + pStagingIndices[idx];
+		}
+	}
+
+	std::cout << filename << ": " << vertexCount << " vertices, " << indexCount / 3 << " triangles in " << submeshCount << " submeshes\n"
+			  << "import:   " << bestTime * 1000.0 << " ms (best of " << iterations << ")\n"
+			  << "peak RSS: " << GetPeakResidentBytes() / (1024.0 * 1024.0) << " MB (" << startResident / (1024.0 * 1024.0) << " MB at start)\n"
+			  << "indices checksum: " << checksum << "\n";
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "GP2_ImageDecodePool.h"
+
+// Usage: ImageDecodeBenchmark <image|directory>... [--repeat N]
+// Decodes every image N times through GP2_ImageDecodePool for 1, 2, 4... threads up to the core count, copying each
+// one into a buffer standing in for its mapped staging region the way GP2_Texture::Stage does. Reports file and
+// decoded throughput in MB/s and images per second for every thread count.
+
+namespace
+{
+	bool IsImage(const std::filesystem::path& path)
+	{
+		const std::string extension{ path.extension().string() };
+		return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> filenames;
+	int repeatCount{ 4 };
+	for (int idx = 1; idx < argc; ++idx)
+	{
+		const std::string argument{ argv[idx] };
+		if (argument == "--repeat" && idx + 1 < argc)
+		{
+			repeatCount = std::max(1, std::atoi(argv[++idx]));
+			continue;
+		}
+
+		std::error_code error{};
+		if (std::filesystem::is_directory(argument, error))
+		{
+			for (const auto& entry : std::filesystem::recursive_directory_iterator{ argument, error })
+			{
+				if (entry.is_regular_file() && IsImage(entry.path()))
+				{
+					filenames.push_back(entry.path().string());
+				}
+			}
+			continue;
+		}
+		filenames.push_back(argument);
+	}
+
+	if (filenames.empty())
+	{
+		std::cerr << "Usage: " << argv[0] << " <image|directory>... [--repeat N]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	uint64_t fileBytes{};
+	for (const std::string& filename : filenames)
+	{
+		std::error_code error{};
+		fileBytes += std::filesystem::file_size(filename, error);
+	}
+	fileBytes *= repeatCount;
+
+	const uint32_t maxThreadCount{ std::max(std::thread::hardware_concurrency(), 1u) };
+	std::cout << filenames.size() << " images x " << repeatCount << ", " << fileBytes / (1024.0 * 1024.0) << " MB of files" << std::endl;
+
+	for (uint32_t threadCount = 1;; threadCount = std::min(threadCount * 2, maxThreadCount))
+	{
+		GP2_ImageDecodePool pool{};
+		pool.Initialize(threadCount);
+
+		std::atomic<uint64_t> decodedBytes{};
+		std::atomic<uint32_t> decodedCount{};
+		std::atomic<uint32_t> failedCount{};
+
+		const auto start{ std::chrono::steady_clock::now() };
+		for (int repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			for (const std::string& filename : filenames)
+			{
+				pool.Decode(filename, [&](const uint8_t* pPixels, uint32_t width, uint32_t height)
+				{
+					if (!pPixels)
+					{
+						++failedCount;
+						return;
+					}
+
+					const size_t size{ size_t(width) * height * 4 };
+					std::vector<uint8_t> staging(size);
+					std::memcpy(staging.data(), pPixels, size);
+					decodedBytes += size;
+					++decodedCount;
+				});
+			}
+		}
+		pool.Wait();
+		const std::chrono::duration<double> time{ std::chrono::steady_clock::now() - start };
+		pool.Destroy();
+
+		std::cout << threadCount << (threadCount == 1 ? " thread:  " : " threads: ") << time.count() * 1000.0 << " ms, "
+				  << fileBytes / (1024.0 * 1024.0) / time.count() << " MB/s read, " << decodedBytes / (1024.0 * 1024.0) / time.count()
+				  << " MB/s decoded, " << decodedCount / time.count() << " images/s";
+		if (failedCount > 0)
+		{
+			std::cout << ", " << failedCount << " failed";
+		}
+		std::cout << std::endl;
+
+		if (threadCount == maxThreadCount)
+		{
+			break;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
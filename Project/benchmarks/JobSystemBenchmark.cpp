@@ -0,0 +1,183 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+
+#include "GP2_JobSystem.h"
+
+// Usage: JobSystemBenchmark [jobCount] [--work N]
+// Microbenchmarks for GP2_JobSystem: spawning and running empty jobs on one thread, where they never leave its deque,
+// and on every core while the spawning thread doesn't help, so each one is stolen. Then runs a synthetic job graph for
+// 1, 2, 4... threads up to the core count: layers of jobs doing N rounds of integer work each, every layer depending on
+// the one before and every other job spawning children of its own, and reports the time and the speedup over 1 thread.
+
+namespace
+{
+	constexpr uint32_t LayerCount{ 16 };
+	constexpr uint32_t LayerWidth{ 256 };
+	constexpr uint32_t ChildCount{ 4 };
+
+	// keeps the compiler from dropping the work
+	uint64_t DoWork(uint64_t seed, uint32_t roundCount)
+	{
+		uint64_t state{ seed | 1 };
+		for (uint32_t round = 0; round < roundCount; ++round)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+		}
+		return state;
+	}
+
+	double MeasureEmptyJobs(GP2_JobSystem& jobSystem, uint32_t jobCount, bool isHelping)
+	{
+		const auto start{ std::chrono::steady_clock::now() };
+
+		// in batches the spawning thread's deque holds, past it the jobs would run inline
+		GP2_JobSystem::Counter counter{};
+		for (uint32_t batchStart = 0; batchStart < jobCount; batchStart += GP2_JobSystem::JobCapacity)
+		{
+			const uint32_t batchEnd{ std::min(batchStart + GP2_JobSystem::JobCapacity, jobCount) };
+			for (uint32_t idx = batchStart; idx < batchEnd; ++idx)
+			{
+				jobSystem.Run([]() {}, &counter);
+			}
+
+			if (isHelping)
+			{
+				jobSystem.Wait(counter);
+				continue;
+			}
+			while (!counter.IsDone())
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		const std::chrono::duration<double, std::nano> time{ std::chrono::steady_clock::now() - start };
+		return time.count() / jobCount;
+	}
+
+	double RunGraph(GP2_JobSystem& jobSystem, uint32_t roundCount, std::vector<uint64_t>& results)
+	{
+		const auto start{ std::chrono::steady_clock::now() };
+
+		std::unique_ptr<GP2_JobSystem::Counter[]> pCounters{ new GP2_JobSystem::Counter[LayerCount] };
+		for (uint32_t layer = 0; layer < LayerCount; ++layer)
+		{
+			GP2_JobSystem::Counter* pCounter{ &pCounters[layer] };
+			GP2_JobSystem::Counter* pDependency{ layer > 0 ? &pCounters[layer - 1] : nullptr };
+			for (uint32_t idx = 0; idx < LayerWidth; ++idx)
+			{
+				const uint32_t jobIndex{ layer * LayerWidth + idx };
+				jobSystem.Run([&jobSystem, &results, pCounter, jobIndex, roundCount]()
+				{
+					// the children go on this thread's deque and are counted on the layer, the next one waits for them too
+					if (jobIndex % 2 == 1)
+					{
+						for (uint32_t child = 0; child < ChildCount; ++child)
+						{
+							uint64_t* pResult{ &results[size_t(jobIndex) * (ChildCount + 1) + child + 1] };
+							jobSystem.Run([pResult, jobIndex, child, roundCount]() { *pResult = DoWork(jobIndex * 31 + child, roundCount); }, pCounter);
+						}
+					}
+					results[size_t(jobIndex) * (ChildCount + 1)] = DoWork(jobIndex, roundCount);
+				}, pCounter, pDependency);
+			}
+		}
+		// the last layer finishes after every other
+		jobSystem.Wait(pCounters[LayerCount - 1]);
+
+		const std::chrono::duration<double, std::milli> time{ std::chrono::steady_clock::now() - start };
+		return time.count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t jobCount{ 1000000 };
+	uint32_t roundCount{ 20000 };
+	for (int idx = 1; idx < argc; ++idx)
+	{
+		const std::string argument{ argv[idx] };
+		if (argument == "--work" && idx + 1 < argc)
+		{
+			roundCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++idx])));
+			continue;
+		}
+		jobCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[idx])));
+	}
+
+	const uint32_t maxThreadCount{ std::max(std::thread::hardware_concurrency(), 1u) };
+
+	{
+		GP2_JobSystem jobSystem{};
+		jobSystem.Initialize(1);
+		MeasureEmptyJobs(jobSystem, jobCount, true);
+		std::cout << "spawn and run, 1 thread:     " << MeasureEmptyJobs(jobSystem, jobCount, true) << " ns a job" << std::endl;
+		jobSystem.Destroy();
+	}
+
+	if (maxThreadCount > 1)
+	{
+		GP2_JobSystem jobSystem{};
+		jobSystem.Initialize(maxThreadCount);
+		MeasureEmptyJobs(jobSystem, jobCount, false);
+		jobSystem.ResetStats();
+		const double time{ MeasureEmptyJobs(jobSystem, jobCount, false) };
+		const GP2_JobSystem::Stats stats{ jobSystem.GetStats() };
+		std::cout << "spawn and steal, " << maxThreadCount << " threads: " << time << " ns a job, " << stats.stealCount << " of "
+				  << stats.jobCount << " stolen, " << stats.failedStealCount << " failed steals" << std::endl;
+		jobSystem.Destroy();
+	}
+
+	const uint32_t graphJobCount{ LayerCount * LayerWidth + LayerCount * LayerWidth / 2 * ChildCount };
+	std::cout << "job graph: " << LayerCount << " layers of " << LayerWidth << " jobs, " << graphJobCount << " jobs of " << roundCount
+			  << " rounds" << std::endl;
+
+	std::vector<uint64_t> results(size_t(LayerCount) * LayerWidth * (ChildCount + 1));
+	double singleThreadTime{};
+	for (uint32_t threadCount = 1;; threadCount = std::min(threadCount * 2, maxThreadCount))
+	{
+		GP2_JobSystem jobSystem{};
+		jobSystem.Initialize(threadCount);
+
+		// best of a few runs, the first one also warms the job slots up
+		double bestTime{ 1e30 };
+		for (int run = 0; run < 3; ++run)
+		{
+			jobSystem.ResetStats();
+			bestTime = std::min(bestTime, RunGraph(jobSystem, roundCount, results));
+		}
+		const GP2_JobSystem::Stats stats{ jobSystem.GetStats() };
+		jobSystem.Destroy();
+
+		if (threadCount == 1)
+		{
+			singleThreadTime = bestTime;
+		}
+
+		std::cout << threadCount << (threadCount == 1 ? " thread:  " : " threads: ") << bestTime << " ms, " << singleThreadTime / bestTime
+				  << "x, " << stats.stealCount << " steals" << std::endl;
+
+		if (threadCount == maxThreadCount)
+		{
+			break;
+		}
+	}
+
+	uint64_t checksum{};
+	for (uint64_t result : results)
+	{
+		checksum = checksum * 31 + result;
+	}
+	std::cout << "checksum: " << checksum << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+
+#include "GP2_TLSFAllocator.h"
+
+// Usage: MemoryAllocatorBenchmark [resourceCount] [--frames N]
+// Replays the allocations GP2_MemoryAllocator hands to GP2_TLSFAllocator for a streamed scene: vertex and index buffers
+// of a few KB to a few MB at 256 byte alignment and textures of 64 KB to 8 MB at 64 KB alignment, placed in 64 MB blocks.
+// Then frees and reallocates a tenth of them per frame. Reports the time per allocation and free, the blocks needed
+// against one vkAllocateMemory per resource, and how fragmented the free space ends up.
+
+namespace
+{
+	constexpr uint64_t BlockSize{ 64ull * 1024 * 1024 };
+
+	struct Resource
+	{
+		uint32_t block;
+		uint32_t handle;
+		uint64_t size;
+		uint64_t alignment;
+	};
+
+	// a log-uniform size, most resources are small
+	Resource MakeResource(std::mt19937& random)
+	{
+		const bool isTexture{ random() % 4 == 0 };
+		const double minSize{ isTexture ? 64.0 * 1024 : 4.0 * 1024 };
+		const double maxSize{ isTexture ? 8.0 * 1024 * 1024 : 4.0 * 1024 * 1024 };
+		std::uniform_real_distribution<double> distribution{ std::log(minSize), std::log(maxSize) };
+		return Resource{ 0, GP2_TLSFAllocator::InvalidHandle, static_cast<uint64_t>(std::exp(distribution(random))), isTexture ? 65536ull : 256ull };
+	}
+
+	void Place(std::vector<GP2_TLSFAllocator>& blocks, Resource& resource)
+	{
+		for (uint32_t idx = 0; idx < blocks.size(); ++idx)
+		{
+			resource.handle = blocks[idx].Allocate(resource.size, resource.alignment);
+			if (resource.handle != GP2_TLSFAllocator::InvalidHandle)
+			{
+				resource.block = idx;
+				return;
+			}
+		}
+
+		blocks.emplace_back();
+		blocks.back().Initialize(BlockSize);
+		resource.block = static_cast<uint32_t>(blocks.size() - 1);
+		resource.handle = blocks.back().Allocate(resource.size, resource.alignment);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t resourceCount{ 10000 };
+	uint32_t frameCount{ 1000 };
+	for (int idx = 1; idx < argc; ++idx)
+	{
+		const std::string argument{ argv[idx] };
+		if (argument == "--frames" && idx + 1 < argc)
+		{
+			frameCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++idx])));
+			continue;
+		}
+		resourceCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[idx])));
+	}
+
+	std::mt19937 random{ 42 };
+	std::vector<Resource> resources(resourceCount);
+	for (Resource& resource : resources)
+	{
+		resource = MakeResource(random);
+	}
+
+	std::vector<GP2_TLSFAllocator> blocks;
+	blocks.reserve(1024);
+
+	auto start{ std::chrono::steady_clock::now() };
+	for (Resource& resource : resources)
+	{
+		Place(blocks, resource);
+	}
+	const std::chrono::duration<double, std::nano> placeTime{ std::chrono::steady_clock::now() - start };
+
+	// churn, a tenth of the resources is replaced every frame
+	const uint32_t churnCount{ std::max(resourceCount / 10, 1u) };
+	uint64_t churnedCount{};
+	std::chrono::duration<double, std::nano> freeTime{};
+	std::chrono::duration<double, std::nano> allocateTime{};
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		std::vector<uint32_t> replaced(churnCount);
+		for (uint32_t& index : replaced)
+		{
+			index = static_cast<uint32_t>(random() % resourceCount);
+		}
+		std::sort(replaced.begin(), replaced.end());
+		replaced.erase(std::unique(replaced.begin(), replaced.end()), replaced.end());
+
+		start = std::chrono::steady_clock::now();
+		for (uint32_t index : replaced)
+		{
+			blocks[resources[index].block].Free(resources[index].handle);
+		}
+		freeTime += std::chrono::steady_clock::now() - start;
+
+		for (uint32_t index : replaced)
+		{
+			resources[index] = MakeResource(random);
+		}
+
+		start = std::chrono::steady_clock::now();
+		for (uint32_t index : replaced)
+		{
+			Place(blocks, resources[index]);
+		}
+		allocateTime += std::chrono::steady_clock::now() - start;
+		churnedCount += replaced.size();
+	}
+
+	uint64_t usedBytes{};
+	uint64_t freeBytes{};
+	uint64_t largestFreeBytes{};
+	uint32_t freeRegionCount{};
+	for (const GP2_TLSFAllocator& block : blocks)
+	{
+		usedBytes += block.GetUsedSize();
+		freeBytes += block.GetSize() - block.GetUsedSize();
+		largestFreeBytes += block.GetLargestFreeRegion();
+		freeRegionCount += block.GetFreeRegionCount();
+	}
+
+	std::cout << resourceCount << " resources, " << usedBytes / (1024.0 * 1024.0) << " MB in " << blocks.size() << " blocks of "
+			  << BlockSize / (1024 * 1024) << " MB instead of " << resourceCount << " vkAllocateMemory" << std::endl;
+	std::cout << "initial placement: " << placeTime.count() / resourceCount << " ns per allocation" << std::endl;
+	std::cout << frameCount << " frames replacing " << churnedCount << " resources: " << allocateTime.count() / churnedCount
+			  << " ns per allocation, " << freeTime.count() / churnedCount << " ns per free" << std::endl;
+	std::cout << "free space: " << freeBytes / (1024.0 * 1024.0) << " MB in " << freeRegionCount << " regions, "
+			  << (freeBytes > 0 ? (1.0 - static_cast<double>(largestFreeBytes) / freeBytes) * 100.0 : 0.0) << "% fragmented" << std::endl;
+
+	return EXIT_SUCCESS;
+}
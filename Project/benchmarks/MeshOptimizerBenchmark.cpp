@@ -0,0 +1,142 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_MeshOptimizer.h"
+
+// Usage: MeshOptimizerBenchmark [file.obj]
+// Runs the GP2_MeshOptimizer passes one by one on an OBJ (or a generated grid with shuffled triangles), reports
+// ACMR/ATVR after each and checks the optimized mesh still draws exactly the same triangles.
+
+namespace
+{
+	using Triangle = std::array<std::array<float, 3>, 3>;
+
+	// triangles by vertex position, rotated so the smallest corner comes first, the winding is kept
+	std::vector<Triangle> GetSortedTriangles(const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices)
+	{
+		std::vector<Triangle> triangles(indices.size() / 3);
+		for (size_t triangle = 0; triangle < triangles.size(); ++triangle)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const glm::vec3& position{ vertices[indices[triangle * 3 + corner]].position };
+				triangles[triangle][corner] = { position.x, position.y, position.z };
+			}
+
+			const auto smallest{ std::min_element(triangles[triangle].begin(), triangles[triangle].end()) };
+			std::rotate(triangles[triangle].begin(), smallest, triangles[triangle].end());
+		}
+
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	void GenerateGrid(uint32_t size, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices)
+	{
+		for (uint32_t y = 0; y <= size; ++y)
+		{
+			for (uint32_t x = 0; x <= size; ++x)
+			{
+				vertices.push_back(Vertex3D{ glm::vec3{ float(x), 0.f, float(y) }, glm::vec3{ 1.f, 1.f, 1.f } });
+			}
+		}
+
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const uint32_t corner{ y * (size + 1) + x };
+				indices.insert(indices.end(), { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 });
+			}
+		}
+
+		// worst case input order, deterministic so runs are comparable
+		uint32_t seed{ 12345 };
+		for (size_t triangle = indices.size() / 3 - 1; triangle > 0; --triangle)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const size_t other{ seed % (triangle + 1) };
+			std::swap_ranges(indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3, indices.begin() + other * 3);
+		}
+	}
+
+	void PrintStatistics(const char* pass, const std::vector<Vertex3D>& vertices, const std::vector<uint32_t>& indices, double seconds)
+	{
+		const GP2_MeshOptimizer::CacheStatistics statistics{ GP2_MeshOptimizer::AnalyzeVertexCache(indices, vertices.size()) };
+		std::cout << pass << "ACMR " << statistics.acmr << ", ATVR " << statistics.atvr;
+		if (seconds > 0.0)
+		{
+			std::cout << ", " << seconds * 1000.0 << " ms";
+		}
+		std::cout << "\n";
+	}
+
+	template<typename PassFunction>
+	double TimePass(PassFunction pass)
+	{
+		const auto start{ std::chrono::high_resolution_clock::now() };
+		pass();
+		const std::chrono::duration<double> elapsed{ std::chrono::high_resolution_clock::now() - start };
+		return elapsed.count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<Vertex3D> vertices;
+	std::vector<uint32_t> indices;
+
+	if (argc > 1)
+	{
+		GP2_OBJParser parser{};
+		if (!parser.Parse(argv[1], glm::vec3{ 1.f, 1.f, 1.f }, vertices, indices))
+		{
+			std::cerr << "failed to parse " << argv[1] << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << argv[1];
+	}
+	else
+	{
+		GenerateGrid(256, vertices, indices);
+		std::cout << "shuffled 256x256 grid";
+	}
+	std::cout << " (" << vertices.size() << " vertices, " << indices.size() / 3 << " triangles)\n";
+
+	const std::vector<Triangle> sourceTriangles{ GetSortedTriangles(vertices, indices) };
+	PrintStatistics("input:         ", vertices, indices, 0.0);
+
+	GP2_MeshOptimizer optimizer{};
+
+	std::vector<uint32_t> cacheIndices{ indices };
+	const double cacheSeconds{ TimePass([&]() { optimizer.OptimizeVertexCache(cacheIndices, vertices.size()); }) };
+	PrintStatistics("vertex cache:  ", vertices, cacheIndices, cacheSeconds);
+
+	const double overdrawSeconds{ TimePass([&]() { optimizer.OptimizeOverdraw(indices, vertices); }) };
+	PrintStatistics("+ overdraw:    ", vertices, indices, overdrawSeconds);
+
+	const double fetchSeconds{ TimePass([&]() { optimizer.OptimizeVertexFetch(vertices, indices); }) };
+	PrintStatistics("+ fetch order: ", vertices, indices, fetchSeconds);
+
+	// fetch order means every index is at most one past the largest index before it
+	bool isFetchOrdered{ true };
+	uint32_t nextVertex{};
+	for (const uint32_t index : indices)
+	{
+		isFetchOrdered = isFetchOrdered && index <= nextVertex;
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+
+	const bool isSameMesh{ GetSortedTriangles(vertices, indices) == sourceTriangles };
+	std::cout << "same triangles: " << (isSameMesh ? "yes" : "NO") << ", fetch ordered: " << (isFetchOrdered ? "yes" : "NO") << std::endl;
+
+	return isSameMesh && isFetchOrdered ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_MeshOptimizer.h"
+#include "GP2_MeshSimplifier.h"
+#include "GP2_VertexQuantizer.h"
+
+// Usage: MeshSimplifierBenchmark <file.obj> [lod count]
+// Builds the level of detail chain GP2_3DMesh imports with and reports triangles, error and build time per level.
+// Checks every level only references existing vertices and holds no degenerate triangles.
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.obj> [lod count]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Vertex3D> vertices;
+	std::vector<uint32_t> indices;
+	GP2_OBJParser parser{};
+	if (!parser.Parse(argv[1], glm::vec3{ 1.f, 1.f, 1.f }, vertices, indices))
+	{
+		std::cerr << "failed to parse " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	GP2_MeshOptimizer optimizer{};
+	optimizer.Optimize(vertices, indices);
+
+	const uint32_t lodCount{ argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 4u };
+	const MeshBounds bounds{ GP2_VertexQuantizer::ComputeBounds(vertices) };
+	const float size{ glm::distance(bounds.min, bounds.max) };
+
+	GP2_MeshSimplifier simplifier{};
+	std::vector<MeshLod> lods;
+	const auto start{ std::chrono::high_resolution_clock::now() };
+	simplifier.BuildLods(vertices, indices, lods, lodCount, size * 0.05f);
+	const std::chrono::duration<double> buildTime{ std::chrono::high_resolution_clock::now() - start };
+
+	bool isValid{ true };
+	for (size_t lod = 0; lod < lods.size(); ++lod)
+	{
+		// level 0 is the input as it was parsed
+		for (uint32_t index = lod == 0 ? lods[lod].indexCount : lods[lod].firstIndex; index < lods[lod].firstIndex + lods[lod].indexCount; index += 3)
+		{
+			const uint32_t i0{ indices[index] };
+			const uint32_t i1{ indices[index + 1] };
+			const uint32_t i2{ indices[index + 2] };
+			isValid = isValid && i0 < vertices.size() && i1 < vertices.size() && i2 < vertices.size() && i0 != i1 && i1 != i2 && i2 != i0;
+		}
+
+		const GP2_MeshOptimizer::CacheStatistics statistics{
+			GP2_MeshOptimizer::AnalyzeVertexCache(std::vector<uint32_t>(indices.begin() + lods[lod].firstIndex,
+				indices.begin() + lods[lod].firstIndex + lods[lod].indexCount), vertices.size()) };
+
+		std::cout << "LOD " << lod << ": " << lods[lod].indexCount / 3 << " triangles ("
+				  << 100.0 * lods[lod].indexCount / lods[0].indexCount << "%), error " << lods[lod].error << " ("
+				  << 100.0 * lods[lod].error / size << "% of the diagonal), ACMR " << statistics.acmr << "\n";
+	}
+
+	std::cout << argv[1] << ": " << lods.size() << " levels built in " << buildTime.count() * 1000.0 << " ms, "
+			  << (isValid ? "valid" : "INVALID") << "\n";
+
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
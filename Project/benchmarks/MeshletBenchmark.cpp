@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_MeshOptimizer.h"
+#include "GP2_MeshletBuilder.h"
+#include "GP2_MeshletCuller.h"
+
+// Usage: MeshletBenchmark <file.obj>
+// Builds meshlets for the optimized OBJ, checks they cover every triangle once within the size limits and reports
+// how many meshlets and triangles survive frustum and cone culling for cameras around and inside the mesh.
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.obj>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Vertex3D> vertices;
+	std::vector<uint32_t> indices;
+	GP2_OBJParser parser{};
+	if (!parser.Parse(argv[1], glm::vec3{ 1.f, 1.f, 1.f }, vertices, indices))
+	{
+		std::cerr << "failed to parse " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	GP2_MeshOptimizer optimizer{};
+	optimizer.Optimize(vertices, indices);
+
+	GP2_MeshletBuilder builder{};
+	std::vector<Meshlet> meshlets;
+	const auto start{ std::chrono::high_resolution_clock::now() };
+	builder.Build(indices, vertices, meshlets);
+	const std::chrono::duration<double> buildTime{ std::chrono::high_resolution_clock::now() - start };
+
+	// meshlets have to tile the index buffer in order
+	bool isValid{ true };
+	uint32_t nextIndex{};
+	for (const Meshlet& meshlet : meshlets)
+	{
+		std::vector<uint32_t> meshletVertices(indices.begin() + meshlet.firstIndex, indices.begin() + meshlet.firstIndex + meshlet.triangleCount * 3);
+		std::sort(meshletVertices.begin(), meshletVertices.end());
+		const size_t uniqueVertices{ static_cast<size_t>(std::unique(meshletVertices.begin(), meshletVertices.end()) - meshletVertices.begin()) };
+
+		isValid = isValid && meshlet.firstIndex == nextIndex && meshlet.triangleCount <= GP2_MeshletBuilder::MaxTriangles &&
+			uniqueVertices <= GP2_MeshletBuilder::MaxVertices;
+		nextIndex = meshlet.firstIndex + meshlet.triangleCount * 3;
+	}
+	isValid = isValid && nextIndex == indices.size();
+
+	std::cout << argv[1] << ": " << indices.size() / 3 << " triangles in " << meshlets.size() << " meshlets ("
+			  << float(indices.size() / 3) / std::max<size_t>(1, meshlets.size()) << " triangles each), built in "
+			  << buildTime.count() * 1000.0 << " ms, " << (isValid ? "valid" : "INVALID") << "\n";
+
+	glm::vec3 minimum{ vertices.empty() ? glm::vec3{} : vertices[0].position };
+	glm::vec3 maximum{ minimum };
+	for (const Vertex3D& vertex : vertices)
+	{
+		minimum = glm::min(minimum, vertex.position);
+		maximum = glm::max(maximum, vertex.position);
+	}
+	const glm::vec3 center{ (minimum + maximum) * 0.5f };
+	const float size{ glm::length(maximum - minimum) };
+
+	const glm::mat4 projection{ glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, size * 10.f) };
+	const glm::vec3 cameraPositions[]{
+		center + glm::vec3{ 0.f, 0.f, size },
+		center + glm::vec3{ size, size * 0.5f, 0.f },
+		center - glm::vec3{ 0.f, 0.f, size },
+		center
+	};
+
+	std::vector<VkDrawIndexedIndirectCommand> commands(meshlets.size());
+	for (const glm::vec3& cameraPosition : cameraPositions)
+	{
+		const glm::vec3 target{ cameraPosition == center ? center + glm::vec3{ 1.f, 0.f, 0.f } : center };
+		const glm::mat4 view{ glm::lookAt(cameraPosition, target, glm::vec3{ 0.f, 1.f, 0.f }) };
+
+		for (const bool isBackfaceCulling : { false, true })
+		{
+			const GP2_MeshletCuller culler{ glm::mat4{ 1.f }, view, projection, isBackfaceCulling };
+
+			const auto cullStart{ std::chrono::high_resolution_clock::now() };
+			const uint32_t drawCount{ culler.Cull(meshlets, commands.data()) };
+			const std::chrono::duration<double> cullTime{ std::chrono::high_resolution_clock::now() - cullStart };
+
+			size_t drawnTriangles{};
+			for (uint32_t draw = 0; draw < drawCount; ++draw)
+			{
+				drawnTriangles += commands[draw].indexCount / 3;
+			}
+
+			std::cout << (cameraPosition == center ? "inside" : "outside") << (isBackfaceCulling ? " + cones: " : ":         ")
+					  << drawCount << "/" << meshlets.size() << " meshlets, "
+					  << 100.0 * drawnTriangles / std::max<size_t>(1, indices.size() / 3) << "% of the triangles drawn, culled in "
+					  << cullTime.count() * 1000.0 << " ms\n";
+		}
+	}
+
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
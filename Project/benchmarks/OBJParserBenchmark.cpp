@@ -0,0 +1,240 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_MeshCache.h"
+
+// Usage: OBJParserBenchmark <file.obj> [iterations]
+// Times the stream tokenizer the meshes used to ship with against GP2_OBJParser, serial and at 4, 16 and 32 threads,
+// and checks every run produces the same output. Welding is off for the comparison and reported separately.
+// The welded mesh is written as a .gp2mesh cache next to the file and the cached load is timed against the parse.
+
+namespace
+{
+	// The baseline GP2_3DMesh::ParseOBJ body, unchanged apart from three things so its output can be compared:
+	// - it fills vertices and indices instead of m_MeshVertices and m_MeshIndices
+	// - indices are uint32_t, the original's uint16_t wrapped past 65535 vertices
+	// - sCommand is cleared before every read. The original kept the last command when the read at the end of the file
+	//   failed and parsed the last face a second time.
+	bool ParseOBJBaseline(const std::string& filename, const glm::vec3 color, std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::ifstream file(filename);
+		if (!file.is_open())
+		{
+			std::cerr << "Error: Failed to open file " << filename << std::endl;
+			return false;
+		}
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+
+		std::string sCommand;
+		// start a while iteration ending when the end of file is reached (ios::eof)
+		while (!file.eof())
+		{
+			sCommand.clear();
+			//read the first word of the string, use the >> operator (istream::operator>>) 
+			file >> sCommand;
+			//use conditional statements to process the different commands	
+			if (sCommand == "#")
+			{
+				// Ignore Comment
+			}
+			else if (sCommand == "v")
+			{
+				//Vertex
+				float x, y, z;
+				file >> x >> y >> z;
+
+				positions.emplace_back(x, y, z);
+			}
+			else if (sCommand == "vn")
+			{
+				// Vertex Normal
+				float x, y, z;
+				file >> x >> y >> z;
+
+				normals.emplace_back(x, y, z);
+			}
+			else if (sCommand == "f")
+			{
+				//if a face is read:
+				//construct the 3 vertices, add them to the vertex array
+				//add three indices to the index array
+				//add the material index as attibute to the attribute array
+
+				// Faces or triangles
+				Vertex3D vertex{};
+				size_t iPosition, iNormal;
+
+				uint32_t tempIndices[3];
+				for (size_t iFace = 0; iFace < 3; ++iFace)
+				{
+					// OBJ format uses 1-based arrays
+					file >> iPosition;
+					vertex.position = glm::vec3(positions[iPosition - 1].x, -positions[iPosition - 1].y, -positions[iPosition - 1].z);
+					vertex.color = color;
+
+					if ('/' == file.peek())//is next in buffer ==  '/' ?
+					{
+						file.ignore();//read and ignore one element ('/')
+
+						if ('/' != file.peek())
+						{
+							// Optional texture coordinate
+							/*file >> iTexCoord;
+							vertex.uv = UVs[iTexCoord - 1];*/
+						}
+
+						if ('/' == file.peek())
+						{
+							file.ignore();
+
+							// Optional vertex normal
+							file >> iNormal;
+							vertex.normal = glm::vec3(normals[iNormal - 1].x, -normals[iNormal - 1].y, -normals[iNormal - 1].z);
+						}
+					}
+
+					vertices.push_back(vertex);
+					tempIndices[iFace] = uint32_t(vertices.size()) - 1;
+					//indices.push_back(uint32_t(vertices.size()) - 1);
+				}
+
+				indices.push_back(tempIndices[0]);
+				indices.push_back(tempIndices[1]);
+				indices.push_back(tempIndices[2]);
+			}
+			//read till end of line and ignore all remaining chars
+			file.ignore(1000, '\n');
+		}
+
+		file.close();
+		return true;
+	}
+
+	bool IsSameOutput(const std::vector<Vertex3D>& verticesA, const std::vector<uint32_t>& indicesA,
+					  const std::vector<Vertex3D>& verticesB, const std::vector<uint32_t>& indicesB)
+	{
+		return verticesA.size() == verticesB.size() && indicesA == indicesB &&
+			std::memcmp(verticesA.data(), verticesB.data(), verticesA.size() * sizeof(Vertex3D)) == 0;
+	}
+
+	template<typename ParseFunction>
+	double TimeParse(int iterations, ParseFunction parse)
+	{
+		double bestSeconds{ 1e30 };
+		for (int iteration = 0; iteration < iterations; ++iteration)
+		{
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			parse();
+			const std::chrono::duration<double> elapsed{ std::chrono::high_resolution_clock::now() - start };
+			bestSeconds = std::min(bestSeconds, elapsed.count());
+		}
+		return bestSeconds;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.obj> [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string filename{ argv[1] };
+	const int iterations{ argc > 2 ? std::max(1, std::atoi(argv[2])) : 3 };
+	const double fileMegabytes{ static_cast<double>(std::filesystem::file_size(filename)) / (1024.0 * 1024.0) };
+	const glm::vec3 color{ 1.f, 1.f, 1.f };
+
+	std::vector<Vertex3D> streamVertices;
+	std::vector<uint32_t> streamIndices;
+	const double streamSeconds{ TimeParse(iterations, [&]()
+	{
+		streamVertices.clear();
+		streamIndices.clear();
+		ParseOBJBaseline(filename, color, streamVertices, streamIndices);
+	}) };
+
+	GP2_OBJParser parser{};
+	parser.SetWeldVertices(false);
+
+	std::vector<Vertex3D> mappedVertices;
+	std::vector<uint32_t> mappedIndices;
+	const double mappedSeconds{ TimeParse(iterations, [&]()
+	{
+		mappedVertices.clear();
+		mappedIndices.clear();
+		parser.Parse(filename, color, mappedVertices, mappedIndices);
+	}) };
+
+	bool identical{ IsSameOutput(streamVertices, streamIndices, mappedVertices, mappedIndices) };
+
+	std::cout << filename << " (" << fileMegabytes << " MB, " << mappedVertices.size() << " vertices)\n";
+	std::cout << "ifstream tokenizer:      " << streamSeconds * 1000.0 << " ms, " << fileMegabytes / streamSeconds << " MB/s\n";
+	std::cout << "GP2_OBJParser 1 thread:  " << mappedSeconds * 1000.0 << " ms, " << fileMegabytes / mappedSeconds << " MB/s, "
+			  << streamSeconds / mappedSeconds << "x\n";
+
+	for (uint32_t threadCount : { 4u, 16u, 32u })
+	{
+		std::vector<Vertex3D> parallelVertices;
+		std::vector<uint32_t> parallelIndices;
+		const double parallelSeconds{ TimeParse(iterations, [&]()
+		{
+			parallelVertices.clear();
+			parallelIndices.clear();
+			parser.Parse(filename, color, parallelVertices, parallelIndices, threadCount);
+		}) };
+
+		identical = identical && IsSameOutput(mappedVertices, mappedIndices, parallelVertices, parallelIndices);
+
+		std::cout << "GP2_OBJParser " << threadCount << " threads: " << parallelSeconds * 1000.0 << " ms, " << fileMegabytes / parallelSeconds << " MB/s, "
+				  << streamSeconds / parallelSeconds << "x\n";
+	}
+
+	std::cout << "output identical:        " << (identical ? "yes" : "NO") << std::endl;
+
+	std::vector<Vertex3D> weldedVertices;
+	std::vector<uint32_t> weldedIndices;
+	parser.SetWeldVertices(true);
+	const double weldedSeconds{ TimeParse(iterations, [&]()
+	{
+		weldedVertices.clear();
+		weldedIndices.clear();
+		parser.Parse(filename, color, weldedVertices, weldedIndices);
+	}) };
+
+	const double vertexRatio{ static_cast<double>(mappedVertices.size()) / std::max<size_t>(1, weldedVertices.size()) };
+	std::cout << "welded:                  " << weldedSeconds * 1000.0 << " ms, " << weldedVertices.size() << " vertices ("
+			  << vertexRatio << "x fewer), " << (weldedVertices.size() <= size_t(UINT16_MAX) + 1 ? "16" : "32") << "-bit indices" << std::endl;
+
+	// cached load: map, validate and copy the blobs out like Initialize does into the staging buffers
+	GP2_MeshCache::Write(filename, color, 0, weldedVertices, weldedIndices, { Submesh{ 0, static_cast<uint32_t>(weldedIndices.size()), 0 } }, {}, {});
+
+	std::vector<char> stagingMemory(weldedVertices.size() * sizeof(Vertex3D) + weldedIndices.size() * sizeof(uint32_t));
+	GP2_MeshCache meshCache{};
+	bool cacheValid{ true };
+	const double cachedSeconds{ TimeParse(iterations, [&]()
+	{
+		cacheValid = cacheValid && meshCache.Open(filename, color);
+		if (meshCache.IsOpen())
+		{
+			std::memcpy(stagingMemory.data(), meshCache.GetVertexData(), meshCache.GetVertexDataSize());
+			std::memcpy(stagingMemory.data() + meshCache.GetVertexDataSize(), meshCache.GetIndexData(), meshCache.GetIndexDataSize());
+		}
+		meshCache.Close();
+	}) };
+
+	std::cout << "gp2mesh cache:           " << cachedSeconds * 1000.0 << " ms, " << (cacheValid ? "" : "INVALID, ")
+			  << weldedSeconds / cachedSeconds << "x over the welded parse" << std::endl;
+
+	return identical && cacheValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "GP2_MipGenerator.h"
+
+// Usage: TextureMipBenchmark [texture size] [frames]
+// Generates the mip chain of a procedural texture the way GP2_Texture does when the format can't be blitted,
+// then shades a ground plane seen at a grazing angle on the CPU as a stand-in for the texture-bound fragment
+// workload: once sampling level 0 only, once trilinear from the level the derivatives select. Both are compared
+// against a supersampled reference of level 0. The texture is treated as linear so all three average alike.
+
+namespace
+{
+	constexpr uint32_t ScreenWidth{ 1280 };
+	constexpr uint32_t ScreenHeight{ 720 };
+	// reference samples per pixel along each axis
+	constexpr uint32_t SuperSampleCount{ 8 };
+	// texture repeats per world unit, camera one unit above the plane
+	constexpr float TextureScale{ 0.5f };
+	constexpr float MaxDistance{ 200.f };
+
+	struct Image
+	{
+		uint32_t width;
+		uint32_t height;
+		const uint8_t* pPixels;
+	};
+
+	// fine checkers with grid lines, the kind of detail that aliases when minified
+	std::vector<uint8_t> CreateTexture(uint32_t size)
+	{
+		std::vector<uint8_t> pixels(size_t(size) * size * 4);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const bool isChecker{ ((x / 4) + (y / 4)) % 2 == 0 };
+				const bool isLine{ x % 64 == 0 || y % 64 == 0 };
+				uint8_t* pTexel{ pixels.data() + (size_t(y) * size + x) * 4 };
+				pTexel[0] = isLine ? 255 : (isChecker ? 230 : 20);
+				pTexel[1] = isLine ? 40 : (isChecker ? 230 : 20);
+				pTexel[2] = isLine ? 40 : (isChecker ? 200 : 60);
+				pTexel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+
+	int Wrap(int coordinate, uint32_t size)
+	{
+		const int wrapped{ coordinate % static_cast<int>(size) };
+		return wrapped < 0 ? wrapped + static_cast<int>(size) : wrapped;
+	}
+
+	// repeat addressing like the texture sampler
+	void SampleBilinear(const Image& image, float u, float v, float* pColor)
+	{
+		const float x{ u * image.width - 0.5f };
+		const float y{ v * image.height - 0.5f };
+		const float floorX{ std::floor(x) };
+		const float floorY{ std::floor(y) };
+		const float tx{ x - floorX };
+		const float ty{ y - floorY };
+
+		const int x0{ Wrap(static_cast<int>(floorX), image.width) };
+		const int y0{ Wrap(static_cast<int>(floorY), image.height) };
+		const int x1{ Wrap(x0 + 1, image.width) };
+		const int y1{ Wrap(y0 + 1, image.height) };
+
+		const uint8_t* pTexels[4]{
+			image.pPixels + (size_t(y0) * image.width + x0) * 4, image.pPixels + (size_t(y0) * image.width + x1) * 4,
+			image.pPixels + (size_t(y1) * image.width + x0) * 4, image.pPixels + (size_t(y1) * image.width + x1) * 4 };
+		const float weights[4]{ (1.f - tx) * (1.f - ty), tx * (1.f - ty), (1.f - tx) * ty, tx * ty };
+
+		for (size_t channel = 0; channel < 4; ++channel)
+		{
+			pColor[channel] = pTexels[0][channel] * weights[0] + pTexels[1][channel] * weights[1] +
+							  pTexels[2][channel] * weights[2] + pTexels[3][channel] * weights[3];
+		}
+	}
+
+	// Maps a screen position below the horizon to the plane, false for the sky and the far distance
+	bool GetPlaneUV(float screenX, float screenY, float& u, float& v, float& distance)
+	{
+		const float focalLength{ float(ScreenHeight) };
+		const float slope{ (screenY - ScreenHeight * 0.5f) / focalLength };
+		if (slope <= 0.f)
+		{
+			return false;
+		}
+
+		distance = 1.f / slope;
+		if (distance > MaxDistance)
+		{
+			return false;
+		}
+
+		u = (screenX - ScreenWidth * 0.5f) / focalLength * distance * TextureScale;
+		v = distance * TextureScale;
+		return true;
+	}
+
+	// isLevel0Only skips the mips, otherwise trilinear filtering between the two levels around the selected LOD
+	void Shade(const std::vector<Image>& levels, bool isLevel0Only, std::vector<float>& frame)
+	{
+		const float focalLength{ float(ScreenHeight) };
+		const float texelScale{ float(levels[0].width) * TextureScale };
+		const float maxLod{ float(levels.size() - 1) };
+
+		for (uint32_t y = 0; y < ScreenHeight; ++y)
+		{
+			for (uint32_t x = 0; x < ScreenWidth; ++x)
+			{
+				float* pColor{ frame.data() + (size_t(y) * ScreenWidth + x) * 4 };
+				float u{}, v{}, distance{};
+				if (!GetPlaneUV(x + 0.5f, y + 0.5f, u, v, distance))
+				{
+					std::fill_n(pColor, 4, 0.f);
+					continue;
+				}
+
+				if (isLevel0Only)
+				{
+					SampleBilinear(levels[0], u, v, pColor);
+					continue;
+				}
+
+				// texels covered by one pixel along x and y, the larger one picks the level like an isotropic sampler
+				const float footprintX{ distance / focalLength * texelScale };
+				const float footprintY{ distance * distance / focalLength * texelScale };
+				const float lod{ std::clamp(std::log2(std::max(footprintX, footprintY)), 0.f, maxLod) };
+				const size_t level{ static_cast<size_t>(lod) };
+				const float blend{ lod - level };
+
+				SampleBilinear(levels[level], u, v, pColor);
+				if (blend > 0.f && level + 1 < levels.size())
+				{
+					float nextColor[4]{};
+					SampleBilinear(levels[level + 1], u, v, nextColor);
+					for (size_t channel = 0; channel < 4; ++channel)
+					{
+						pColor[channel] += (nextColor[channel] - pColor[channel]) * blend;
+					}
+				}
+			}
+		}
+	}
+
+	void ShadeReference(const Image& image, std::vector<float>& frame)
+	{
+		for (uint32_t y = 0; y < ScreenHeight; ++y)
+		{
+			for (uint32_t x = 0; x < ScreenWidth; ++x)
+			{
+				float* pColor{ frame.data() + (size_t(y) * ScreenWidth + x) * 4 };
+				std::fill_n(pColor, 4, 0.f);
+
+				for (uint32_t sampleY = 0; sampleY < SuperSampleCount; ++sampleY)
+				{
+					for (uint32_t sampleX = 0; sampleX < SuperSampleCount; ++sampleX)
+					{
+						float u{}, v{}, distance{};
+						if (!GetPlaneUV(x + (sampleX + 0.5f) / SuperSampleCount, y + (sampleY + 0.5f) / SuperSampleCount, u, v, distance))
+						{
+							continue;
+						}
+
+						float sample[4]{};
+						SampleBilinear(image, u, v, sample);
+						for (size_t channel = 0; channel < 4; ++channel)
+						{
+							pColor[channel] += sample[channel] / (SuperSampleCount * SuperSampleCount);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	double GetRootMeanSquareError(const std::vector<float>& frame, const std::vector<float>& reference)
+	{
+		double sum{};
+		for (size_t idx = 0; idx < frame.size(); ++idx)
+		{
+			const double difference{ frame[idx] - reference[idx] };
+			sum += difference * difference;
+		}
+		return std::sqrt(sum / frame.size());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const uint32_t size{ argc > 1 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[1]))) : 2048u };
+	const int frameCount{ argc > 2 ? std::max(1, std::atoi(argv[2])) : 3 };
+
+	const std::vector<uint8_t> pixels{ CreateTexture(size) };
+
+	GP2_MipGenerator generator{};
+	std::vector<uint8_t> mips;
+	std::vector<GP2_MipGenerator::MipLevel> mipLevels;
+
+	// the first run sizes the scratch rows
+	generator.Generate(pixels.data(), size, size, false, mips, mipLevels);
+	const auto generateStart{ std::chrono::steady_clock::now() };
+	generator.Generate(pixels.data(), size, size, false, mips, mipLevels);
+	const std::chrono::duration<double> generateTime{ std::chrono::steady_clock::now() - generateStart };
+
+	const double texelCount{ double(size) * size };
+	std::cout << size << "x" << size << ": " << mipLevels.size() + 1 << " levels generated in " << generateTime.count() * 1000.0 << " ms ("
+			  << texelCount / generateTime.count() / 1e6 << " Mtexels/s)" << std::endl;
+
+	std::vector<Image> levels{ Image{ size, size, pixels.data() } };
+	for (const GP2_MipGenerator::MipLevel& level : mipLevels)
+	{
+		levels.push_back(Image{ level.width, level.height, mips.data() + level.offset });
+	}
+
+	std::vector<float> reference(size_t(ScreenWidth) * ScreenHeight * 4);
+	ShadeReference(levels[0], reference);
+
+	std::vector<float> frame(reference.size());
+	for (const bool isLevel0Only : { true, false })
+	{
+		const auto shadeStart{ std::chrono::steady_clock::now() };
+		for (int idx = 0; idx < frameCount; ++idx)
+		{
+			Shade(levels, isLevel0Only, frame);
+		}
+		const std::chrono::duration<double> shadeTime{ std::chrono::steady_clock::now() - shadeStart };
+
+		std::cout << (isLevel0Only ? "level 0 only: " : "mipmapped:    ") << shadeTime.count() * 1000.0 / frameCount << " ms per "
+				  << ScreenWidth << "x" << ScreenHeight << " frame, RMSE " << GetRootMeanSquareError(frame, reference) << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
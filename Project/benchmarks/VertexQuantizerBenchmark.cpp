@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "Vertex.h"
+#include "GP2_OBJParser.h"
+#include "GP2_VertexQuantizer.h"
+
+// Usage: VertexQuantizerBenchmark <file.obj>
+// Quantizes the welded OBJ vertices to Vertex3DQuantized and reports the vertex buffer size and the largest
+// position (relative to the bounds), normal (degrees) and uv error after decoding it the way the shader does.
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file.obj>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Vertex3D> vertices;
+	std::vector<uint32_t> indices;
+	GP2_OBJParser parser{};
+	if (!parser.Parse(argv[1], glm::vec3{ 1.f, 1.f, 1.f }, vertices, indices))
+	{
+		std::cerr << "failed to parse " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Vertex3DQuantized> quantizedVertices;
+	const auto start{ std::chrono::high_resolution_clock::now() };
+	const MeshBounds bounds{ GP2_VertexQuantizer::Quantize(vertices, quantizedVertices) };
+	const std::chrono::duration<double> elapsed{ std::chrono::high_resolution_clock::now() - start };
+
+	const float boundsSize{ std::max(glm::length(bounds.max - bounds.min), 1e-6f) };
+	float maxPositionError{};
+	float maxNormalDegrees{};
+	float maxTexCoordError{};
+	for (size_t idx = 0; idx < vertices.size(); ++idx)
+	{
+		const Vertex3D decoded{ GP2_VertexQuantizer::DequantizeVertex(quantizedVertices[idx], bounds) };
+
+		maxPositionError = std::max(maxPositionError, glm::length(decoded.position - vertices[idx].position) / boundsSize);
+		maxTexCoordError = std::max(maxTexCoordError, glm::length(decoded.texCoord - vertices[idx].texCoord));
+
+		if (glm::length(vertices[idx].normal) > 0.f)
+		{
+			const float cosine{ glm::clamp(glm::dot(decoded.normal, glm::normalize(vertices[idx].normal)), -1.f, 1.f) };
+			maxNormalDegrees = std::max(maxNormalDegrees, std::acos(cosine) * 57.2957795f);
+		}
+	}
+
+	const double sourceKilobytes{ vertices.size() * sizeof(Vertex3D) / 1024.0 };
+	const double quantizedKilobytes{ quantizedVertices.size() * sizeof(Vertex3DQuantized) / 1024.0 };
+
+	std::cout << argv[1] << " (" << vertices.size() << " vertices), quantized in " << elapsed.count() * 1000.0 << " ms\n";
+	std::cout << "vertex buffer:  " << sourceKilobytes << " KB -> " << quantizedKilobytes << " KB ("
+			  << sizeof(Vertex3D) << " -> " << sizeof(Vertex3DQuantized) << " bytes per vertex)\n";
+	std::cout << "max error:      position " << maxPositionError << " of the bounds diagonal, normal "
+			  << maxNormalDegrees << " degrees, uv " << maxTexCoordError << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -15,7 +15,7 @@ QueueFamilyIndices VulkanBase::FindQueueFamilies(VkPhysicalDevice device)
 	int i = 0;
 	for (const auto& queueFamily : queueFamilies) 
 	{
-		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) 
+		if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily.has_value()) 
 		{
 			indices.graphicsFamily = i;
 		}
@@ -23,12 +23,20 @@ QueueFamilyIndices VulkanBase::FindQueueFamilies(VkPhysicalDevice device)
 		VkBool32 presentSupport = false;
 		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
 
-		if (presentSupport) 
+		if (presentSupport && !indices.presentFamily.has_value()) 
 		{
 			indices.presentFamily = i;
 		}
 
-		if (indices.isComplete()) 
+		// a transfer only family is the copy engine, a compute family the next best thing, it can copy as well
+		const bool isTransferOnly{ (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) };
+		const bool isNonGraphics{ (queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) };
+		if (isTransferOnly || (isNonGraphics && !indices.transferFamily.has_value()))
+		{
+			indices.transferFamily = i;
+		}
+
+		if (indices.isComplete() && isTransferOnly) 
 		{
 			break;
 		}
@@ -1,87 +1,25 @@
 #include "vulkanbase/VulkanBase.h"
 
-void VulkanBase::CreateFrameBuffers()
+void VulkanBase::CreateRenderGraph()
 {
-	m_SwapChainFramebuffers.resize(m_SwapChainImageViews.size());
-
-	for (size_t i = 0; i < m_SwapChainImageViews.size(); i++) 
-	{
-		std::array<VkImageView, 2> attachments = {
-			m_SwapChainImageViews[i],
-			m_DepthBuffer.GetDepthImageView()
-		};
-
-		VkFramebufferCreateInfo framebufferInfo{};
-		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebufferInfo.renderPass = m_RenderPass;
-		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-		framebufferInfo.pAttachments = attachments.data();
-		framebufferInfo.width = m_SwapChainExtent.width;
-		framebufferInfo.height = m_SwapChainExtent.height;
-		framebufferInfo.layers = 1;
-
-		if (vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &m_SwapChainFramebuffers[i]) != VK_SUCCESS) 
-		{
-			throw std::runtime_error("failed to create framebuffer!");
-		}
-	}
-}
-
-void VulkanBase::CreateRenderPass()
-{
-	VkAttachmentDescription colorAttachment{};
-	colorAttachment.format = m_SwapChainImageFormat;
-	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-	VkAttachmentReference colorAttachmentRef{};
-	colorAttachmentRef.attachment = 0;
-	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentDescription depthAttachment{};
-	depthAttachment.format = m_DepthBuffer.FindDepthFormat();
-	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentReference depthAttachmentRef{};
-	depthAttachmentRef.attachment = 1;
-	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription subpass{};
-	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpass.colorAttachmentCount = 1;
-	subpass.pColorAttachments = &colorAttachmentRef;
-	subpass.pDepthStencilAttachment = &depthAttachmentRef; 
-
-	VkSubpassDependency dependency{};
-	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT; 
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT; 
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT; 
-
-	std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment }; 
-	VkRenderPassCreateInfo renderPassInfo{};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size()); 
-	renderPassInfo.pAttachments = attachments.data(); 
-	renderPassInfo.subpassCount = 1;
-	renderPassInfo.pSubpasses = &subpass;
-	renderPassInfo.dependencyCount = 1;
-	renderPassInfo.pDependencies = &dependency;
-
-	if (vkCreateRenderPass(m_Device, &renderPassInfo, nullptr, &m_RenderPass) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create render pass!");
-	}
+	m_RenderGraph.Initialize(m_Device);
+
+	// the acquire semaphore is waited for at the color output stage, the image leaves the frame ready to present
+	const GP2_RenderGraph::ResourceHandle swapChainImage{ m_RenderGraph.ImportImage("swapchain", m_SwapChainImageFormat, m_SwapChainExtent,
+		m_SwapChainImages, m_SwapChainImageViews, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) };
+	// only the main pass uses it, the graph owns it and places it with the other transient attachments
+	const GP2_RenderGraph::ResourceHandle depthImage{ m_RenderGraph.CreateImage("depth", m_DepthBuffer.FindDepthFormat(), m_SwapChainExtent) };
+
+	// a subpass is either recorded inline or made of secondary command buffers only, so both pipelines go the same way
+	const VkSubpassContents contents{ m_ParallelRecorder.IsParallel() ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE };
+	m_MainPass = m_RenderGraph.AddPass("main", [this](const GP2_RenderGraph::PassContext& context) { RecordMainPass(context); }, contents);
+
+	const VkClearColorValue clearColor{ { 0.0f, 0.0f, 0.0f, 1.0f } };
+	const VkClearDepthStencilValue clearDepth{ 1.0f, 0 };
+	m_RenderGraph.WriteColor(m_MainPass, swapChainImage, &clearColor);
+	m_RenderGraph.WriteDepth(m_MainPass, depthImage, &clearDepth);
+
+	m_RenderGraph.Compile();
+	m_RenderPass = m_RenderGraph.GetRenderPass(m_MainPass);
 }
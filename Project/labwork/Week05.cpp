@@ -50,6 +50,10 @@ void VulkanBase::CreateLogicalDevice()
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+	if (indices.transferFamily.has_value())
+	{
+		uniqueQueueFamilies.insert(indices.transferFamily.value());
+	}
 
 	float queuePriority = 1.0f;
 	for (uint32_t queueFamily : uniqueQueueFamilies) 
@@ -72,6 +76,13 @@ void VulkanBase::CreateLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+	// meshlet draws batch into one indirect call when the device allows it, GP2_3DMesh checks the same feature
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+	deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	// block compressed textures are uploaded as they are when the device can sample them, GP2_Texture checks the same feature
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
@@ -80,8 +91,15 @@ void VulkanBase::CreateLogicalDevice()
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	// heap budgets for the memory report when the device has them, GP2_MemoryAllocator checks the same support
+	std::vector<const char*> enabledExtensions{ deviceExtensions };
+	if (GP2_MemoryAllocator::IsMemoryBudgetSupported(m_PhysicalDevice))
+	{
+		enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 	if (enableValidationLayers) 
 	{
@@ -100,4 +118,8 @@ void VulkanBase::CreateLogicalDevice()
 
 	vkGetDeviceQueue(m_Device, indices.graphicsFamily.value(), 0, &m_GraphicsQueue);
 	vkGetDeviceQueue(m_Device, indices.presentFamily.value(), 0, &m_PresentQueue);
+	if (indices.transferFamily.has_value())
+	{
+		vkGetDeviceQueue(m_Device, indices.transferFamily.value(), 0, &m_TransferQueue);
+	}
 }
\ No newline at end of file
@@ -29,6 +29,8 @@ void VulkanBase::SetupDebugMessenger()
 
 void VulkanBase::CreateSyncObjects()
 {
+	m_FramesInFlight = std::clamp(m_FramesInFlight, 1u, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
@@ -36,74 +38,77 @@ void VulkanBase::CreateSyncObjects()
 	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-	if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphore) != VK_SUCCESS ||
-		vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphore) != VK_SUCCESS ||
-		vkCreateFence(m_Device, &fenceInfo, nullptr, &m_InFlightFence) != VK_SUCCESS)
+	for (Frame& frame : m_Frames)
+	{
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS ||
+			vkCreateFence(m_Device, &fenceInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create synchronization objects for a frame!");
+		}
+	}
+
+	m_RenderFinishedSemaphores.resize(m_SwapChainImages.size());
+	for (VkSemaphore& semaphore : m_RenderFinishedSemaphores)
 	{
-		throw std::runtime_error("failed to create synchronization objects for a frame!");
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create synchronization objects for a swapchain image!");
+		}
 	}
 }
 
 void VulkanBase::DrawFrame() 
 { 
 	uint32_t imageIndex{};
+	Frame& frame{ m_Frames[m_CurrentFrame] };
 
-	vkWaitForFences(m_Device, 1, &m_InFlightFence, VK_TRUE, UINT64_MAX);
-	vkResetFences(m_Device, 1, &m_InFlightFence);
-
-	vkAcquireNextImageKHR(m_Device, m_SwapChain, UINT64_MAX, m_ImageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
-
-	m_CommandBuffer.Reset();
-	m_CommandBuffer.BeginRecording(0); 
-
-	BeginRenderPass(m_CommandBuffer, m_SwapChainFramebuffers[imageIndex], m_SwapChainExtent);
-
-	//Draw 2d graphics pipeline
-	ViewProjection vp{ glm::mat4(1.0f) ,glm::mat4(1.0f) };
-	glm::vec3 scaleFactors(1.0f, 1.0f, 1.0f);
-	vp.view = glm::scale(glm::mat4(1.0f), scaleFactors);
-	vp.view = glm::translate(vp.view, glm::vec3(0, 0, 0));
-
-	m_GP2D.SetUBO(vp, 0);
-	m_GP2D.Record(m_CommandBuffer, m_SwapChainExtent, m_CurrentFrame);
-
-	//Draw 3d graphics pipeline
-	MeshData meshData{};
-	VertexUBO ubo{};
-	meshData.model = glm::mat4(1.0f);  
+	// only the frame that used these resources last has to have finished, the others stay in flight
+	const std::chrono::steady_clock::time_point waitStart{ std::chrono::steady_clock::now() };
+	vkWaitForFences(m_Device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+	vkResetFences(m_Device, 1, &frame.inFlightFence);
+	m_FenceWaitTimes.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+	++m_FenceWaitTimes.count;
 
-	ubo.view = UpdateCamera();
-	ubo.proj = glm::perspective(glm::radians(m_FOV), m_AspectRatio, 0.1f, 10.0f);
+	// the frame that used this region last has finished, its UBOs and transient geometry can be overwritten
+	m_FrameAllocator.BeginFrame(m_CurrentFrame);
+	m_ParallelRecorder.BeginFrame(m_CurrentFrame);
 
-	m_GP3D.SetUBO(ubo, 0);
-	m_GP3D.Record(m_CommandBuffer, m_SwapChainExtent, m_CurrentFrame);
+	// uploads finished by now become resident for this frame, whatever was recorded since the last frame goes out in one submit
+	m_AssetStreamer.Update();
+	m_UploadContext.Update();
+	m_GeometryArena3D.Update();
+	m_GeometryArena2D.Update();
 
-	m_Yaw = 0;
-	m_Pitch = 0;
+	vkAcquireNextImageKHR(m_Device, m_SwapChain, UINT64_MAX, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
 
-	EndRenderPass(m_CommandBuffer);
+	GP2_CommandBuffer& commandBuffer{ frame.commandBuffer };
+	commandBuffer.Reset();
+	commandBuffer.BeginRecording(0); 
 
-	m_CommandBuffer.EndRecording(); 
+	// every pass of the graph with the barriers between them, the main pass records the pipelines through RecordMainPass
+	const std::chrono::steady_clock::time_point recordStart{ std::chrono::steady_clock::now() };
+	m_RenderGraph.Execute(commandBuffer.GetVkCommandBuffer(), imageIndex);
+	m_RecordTimes.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+	++m_RecordTimes.count;
 
-	VkCommandBuffer commandBuffer{ m_CommandBuffer.GetVkCommandBuffer() }; 
+	commandBuffer.EndRecording(); 
 
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphore };
+	VkSemaphore waitSemaphores[] = { frame.imageAvailableSemaphore };
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 	submitInfo.waitSemaphoreCount = 1;
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
-	submitInfo.pCommandBuffers = &commandBuffer;  
 
-	m_CommandBuffer.Sumbit(submitInfo);
+	commandBuffer.Sumbit(submitInfo);
 
-	VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphore };
+	VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphores[imageIndex] };
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFence) != VK_SUCCESS)
+	if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, frame.inFlightFence) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
@@ -121,6 +126,91 @@ void VulkanBase::DrawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 
 	vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+
+	const std::chrono::steady_clock::time_point presentTime{ std::chrono::steady_clock::now() };
+	if (!m_IsFirstFramePresented)
+	{
+		const std::chrono::duration<double> firstFrameTime{ presentTime - m_StartTime };
+		std::cout << "First frame presented after " << firstFrameTime.count() * 1000.0 << " ms" << std::endl;
+		m_IsFirstFramePresented = true;
+	}
+	else
+	{
+		// present to present, split on whether uploads were streaming during the frame
+		const std::chrono::duration<double, std::milli> frameTime{ presentTime - m_LastPresentTime };
+		FrameTimes& frameTimes{ m_AssetStreamer.IsIdle() ? m_IdleFrameTimes : m_StreamingFrameTimes };
+		frameTimes.milliseconds += frameTime.count();
+		++frameTimes.count;
+	}
+	m_LastPresentTime = presentTime;
+
+	m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+}
+
+void VulkanBase::RecordMainPass(const GP2_RenderGraph::PassContext& context)
+{
+	GP2_CommandBuffer commandBuffer{};
+	commandBuffer.SetVkCommandBuffer(context.commandBuffer);
+	const bool isParallel{ m_ParallelRecorder.IsParallel() };
+	m_SecondaryCommandBuffers.clear();
+
+	//Draw 2d graphics pipeline
+	ViewProjection vp{ glm::mat4(1.0f) ,glm::mat4(1.0f) };
+	glm::vec3 scaleFactors(1.0f, 1.0f, 1.0f);
+	vp.view = glm::scale(glm::mat4(1.0f), scaleFactors);
+	vp.view = glm::translate(vp.view, glm::vec3(0, 0, 0));
+
+	m_GP2D.SetUBO(vp, m_CurrentFrame);
+	if (isParallel)
+	{
+		m_GP2D.RecordSecondaries(m_ParallelRecorder, context.framebuffer, context.extent, m_CurrentFrame, m_SecondaryCommandBuffers);
+	}
+	else
+	{
+		m_GP2D.Record(commandBuffer, context.extent, m_CurrentFrame);
+	}
+
+	//Draw 3d graphics pipeline
+	MeshData meshData{};
+	VertexUBO ubo{};
+	meshData.model = glm::mat4(1.0f);  
+
+	ubo.view = UpdateCamera();
+	ubo.proj = glm::perspective(glm::radians(m_FOV), m_AspectRatio, 0.1f, 10.0f);
+
+	if (m_IsVertexQuantized)
+	{
+		RecordScene(m_GP3DQuantized, ubo, context, commandBuffer);
+	}
+	else
+	{
+		RecordScene(m_GP3D, ubo, context, commandBuffer);
+	}
+
+	m_Yaw = 0;
+	m_Pitch = 0;
+
+	if (!m_SecondaryCommandBuffers.empty())
+	{
+		vkCmdExecuteCommands(context.commandBuffer, static_cast<uint32_t>(m_SecondaryCommandBuffers.size()), m_SecondaryCommandBuffers.data());
+	}
+}
+
+void VulkanBase::PrintFrameTimes(std::ostream& stream) const
+{
+	const auto average{ [](const FrameTimes& frameTimes)
+	{
+		return frameTimes.count > 0 ? frameTimes.milliseconds / frameTimes.count : 0.0;
+	} };
+
+	stream << "Frame times with uploads on the " << (m_UploadContext.HasTransferQueue() ? "transfer" : "graphics") << " queue: "
+		   << average(m_StreamingFrameTimes) << " ms over " << m_StreamingFrameTimes.count << " frames while streaming, "
+		   << average(m_IdleFrameTimes) << " ms over " << m_IdleFrameTimes.count << " idle frames" << std::endl;
+	stream << "  " << m_FramesInFlight << " frames in flight, the CPU waited " << average(m_FenceWaitTimes)
+		   << " ms a frame for the GPU" << std::endl;
+	stream << "  recording the render graph took " << average(m_RecordTimes) << " ms a frame in " << m_ParallelRecorder.GetRangeCount()
+		   << (m_ParallelRecorder.IsParallel() ? " ranges at most on " : " range inline, ") << m_JobSystem.GetThreadCount() << " job threads"
+		   << std::endl;
 }
 
 bool checkValidationLayerSupport() 
@@ -200,7 +290,8 @@ void VulkanBase::CreateInstance()
 	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.pEngineName = "No Engine";
 	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	appInfo.apiVersion = VK_API_VERSION_1_0;
+	// 1.1 for vkGetPhysicalDeviceMemoryProperties2, which reads the memory budgets
+	appInfo.apiVersion = VK_API_VERSION_1_1;
 
 	VkInstanceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -231,26 +322,18 @@ void VulkanBase::CreateInstance()
 	}
 }
 
-void VulkanBase::BeginRenderPass(const GP2_CommandBuffer& buffer, VkFramebuffer currentBuffer, VkExtent2D extent)
+template <class Pipeline3D>
+void VulkanBase::RecordScene(Pipeline3D& pipeline, const VertexUBO& ubo, const GP2_RenderGraph::PassContext& context,
+							 const GP2_CommandBuffer& commandBuffer)
 {
-	VkRenderPassBeginInfo renderPassInfo{};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassInfo.renderPass = m_RenderPass;
-	renderPassInfo.framebuffer = currentBuffer;
-	renderPassInfo.renderArea.offset = { 0, 0 };
-	renderPassInfo.renderArea.extent = extent;
-
-	std::array<VkClearValue, 2> clearValues{};
-	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-	clearValues[1].depthStencil = { 1.0f, 0 };
-
-	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-	renderPassInfo.pClearValues = clearValues.data();
-
-	vkCmdBeginRenderPass(buffer.GetVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-}
-
-void VulkanBase::EndRenderPass(const GP2_CommandBuffer& buffer)
-{
-	vkCmdEndRenderPass(buffer.GetVkCommandBuffer()); 
+	pipeline.SetUBO(ubo, m_CurrentFrame);
+	pipeline.SetCamera(ubo.view, ubo.proj);
+	if (m_ParallelRecorder.IsParallel())
+	{
+		pipeline.RecordSecondaries(m_ParallelRecorder, context.framebuffer, context.extent, m_CurrentFrame, m_SecondaryCommandBuffers);
+	}
+	else
+	{
+		pipeline.Record(commandBuffer, context.extent, m_CurrentFrame);
+	}
 }
@@ -3,12 +3,49 @@
 
 #include "vulkanbase/VulkanBase.h"
 
-int main() {
+int main(int argc, char* argv[]) {
 	// DISABLE_LAYER_AMD_SWITCHABLE_GRAPHICS_1 = 1
 	//DISABLE_LAYER_NV_OPTIMUS_1 = 1
 	//_putenv_s("DISABLE_LAYER_AMD_SWITCHABLE_GRAPHICS_1", "1");
 	//_putenv_s("DISABLE_LAYER_NV_OPTIMUS_1", "1");
 	VulkanBase app;
+	const std::string framesInFlightOption{ "--frames-in-flight=" };
+	const std::string jobThreadsOption{ "--job-threads=" };
+	const std::string recordThreadsOption{ "--record-threads=" };
+	// quantized or full, the Vertex3D the meshes were drawn with before quantization
+	const std::string vertexFormatOption{ "--vertex-format=" };
+	// JSON file the memory report is written to at shutdown
+	const std::string memoryReportOption{ "--memory-report=" };
+	for (int idx = 1; idx < argc; ++idx)
+	{
+		const std::string argument{ argv[idx] };
+		if (argument.rfind(framesInFlightOption, 0) == 0)
+		{
+			app.SetFramesInFlight(static_cast<uint32_t>(std::stoul(argument.substr(framesInFlightOption.size()))));
+			continue;
+		}
+		if (argument.rfind(jobThreadsOption, 0) == 0)
+		{
+			app.SetJobThreadCount(static_cast<uint32_t>(std::stoul(argument.substr(jobThreadsOption.size()))));
+			continue;
+		}
+		if (argument.rfind(recordThreadsOption, 0) == 0)
+		{
+			app.SetRecordThreadCount(static_cast<uint32_t>(std::stoul(argument.substr(recordThreadsOption.size()))));
+			continue;
+		}
+		if (argument.rfind(vertexFormatOption, 0) == 0)
+		{
+			app.SetVertexQuantization(argument.substr(vertexFormatOption.size()) != "full");
+			continue;
+		}
+		if (argument.rfind(memoryReportOption, 0) == 0)
+		{
+			app.SetMemoryReportFile(argument.substr(memoryReportOption.size()));
+			continue;
+		}
+		app.AddSceneFile(argument);
+	}
 
 	try 
 	{
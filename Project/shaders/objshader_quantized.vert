@@ -0,0 +1,47 @@
+#version 450
+
+// objshader.vert for Vertex3DQuantized, the vertex fetch decodes the unorm/snorm/half formats
+layout(push_constant) uniform PushConstants 
+{
+    mat4 model; 
+    vec4 positionScale;
+    vec4 positionOffset;
+} push;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject 
+{
+    mat4 proj;
+    mat4 view; 
+} ubo;
+
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inNormal;
+layout(location = 3) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+void main() 
+{
+    vec3 position = inPosition.xyz * push.positionScale.xyz + push.positionOffset.xyz;
+
+    gl_Position = ubo.proj * ubo.view * push.model * vec4(position, 1.0);
+    outPos = vec3(push.model * vec4(position, 1.0));
+
+    outColor = inColor.rgb;
+
+    // alpha 0 marks a vertex without normal, objshader.frag leaves those unlit
+    outNormal = inColor.a > 0.0 ? mat3(transpose(inverse(push.model))) * DecodeOctahedral(inNormal) : vec3(0.0);
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "GP2_MipGenerator.h"
+#include "GP2_BlockCompressor.h"
+#include "GP2_KTX2File.h"
+
+// Usage: TextureEncoder <bc1|bc5|bc7> <input image> <output.ktx2> [--linear]
+// Encodes an image and its full mip chain into a KTX2 file GP2_Texture uploads without decoding. BC1 and BC7 are
+// sRGB unless --linear is given, BC5 is always linear and meant for the RG of normal maps. Block rows of every
+// level are spread over all cores.
+
+namespace
+{
+	bool GetFormat(const std::string& name, bool isLinear, VkFormat& format)
+	{
+		if (name == "bc1")
+		{
+			format = isLinear ? VK_FORMAT_BC1_RGB_UNORM_BLOCK : VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		}
+		else if (name == "bc5")
+		{
+			format = VK_FORMAT_BC5_UNORM_BLOCK;
+		}
+		else if (name == "bc7")
+		{
+			format = isLinear ? VK_FORMAT_BC7_UNORM_BLOCK : VK_FORMAT_BC7_SRGB_BLOCK;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: " << argv[0] << " <bc1|bc5|bc7> <input image> <output.ktx2> [--linear]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const bool isLinear{ argc > 4 && std::string{ argv[4] } == "--linear" };
+	VkFormat format{};
+	if (!GetFormat(argv[1], isLinear, format))
+	{
+		std::cerr << "unknown format " << argv[1] << ", expected bc1, bc5 or bc7" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int width{};
+	int height{};
+	int channelCount{};
+	stbi_uc* pPixels{ stbi_load(argv[2], &width, &height, &channelCount, STBI_rgb_alpha) };
+	if (!pPixels)
+	{
+		std::cerr << "failed to load " << argv[2] << ": " << stbi_failure_reason() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto encodeStart{ std::chrono::steady_clock::now() };
+
+	// mips are filtered in linear space whenever the format is decoded as sRGB
+	GP2_MipGenerator generator{};
+	std::vector<uint8_t> mips;
+	std::vector<GP2_MipGenerator::MipLevel> mipLevels;
+	generator.Generate(pPixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), GP2_BlockCompressor::IsSRGB(format), mips, mipLevels);
+
+	struct Level
+	{
+		uint32_t width;
+		uint32_t height;
+		const uint8_t* pPixels;
+	};
+	std::vector<Level> sourceLevels{ Level{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), pPixels } };
+	for (const GP2_MipGenerator::MipLevel& mipLevel : mipLevels)
+	{
+		sourceLevels.push_back(Level{ mipLevel.width, mipLevel.height, mips.data() + mipLevel.offset });
+	}
+
+	// one job per block row of every level, taken in order by all threads
+	struct Job
+	{
+		size_t level;
+		uint32_t blockRow;
+	};
+	std::vector<Job> jobs;
+	std::vector<std::vector<uint8_t>> levels(sourceLevels.size());
+	for (size_t level = 0; level < sourceLevels.size(); ++level)
+	{
+		levels[level].resize(GP2_BlockCompressor::GetImageSize(format, sourceLevels[level].width, sourceLevels[level].height));
+		for (uint32_t blockRow = 0; blockRow < (sourceLevels[level].height + 3) / 4; ++blockRow)
+		{
+			jobs.push_back(Job{ level, blockRow });
+		}
+	}
+
+	std::atomic<size_t> nextJob{};
+	const auto encode{ [&]()
+	{
+		for (size_t jobIndex = nextJob++; jobIndex < jobs.size(); jobIndex = nextJob++)
+		{
+			const Job& job{ jobs[jobIndex] };
+			const Level& source{ sourceLevels[job.level] };
+			GP2_BlockCompressor::EncodeBlockRows(format, source.pPixels, source.width, source.height, job.blockRow, 1, levels[job.level].data());
+		}
+	} };
+
+	std::vector<std::thread> threads;
+	for (uint32_t idx = 1; idx < std::max(std::thread::hardware_concurrency(), 1u); ++idx)
+	{
+		threads.emplace_back(encode);
+	}
+	encode();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	const std::chrono::duration<double> encodeTime{ std::chrono::steady_clock::now() - encodeStart };
+	stbi_image_free(pPixels);
+
+	if (!GP2_KTX2File::Write(argv[3], format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels))
+	{
+		std::cerr << "failed to write " << argv[3] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t compressedSize{};
+	for (const std::vector<uint8_t>& level : levels)
+	{
+		compressedSize += level.size();
+	}
+	const size_t uncompressedSize{ size_t(width) * height * 4 + mips.size() };
+
+	std::cout << argv[3] << ": " << width << "x" << height << ", " << levels.size() << " levels encoded in " << encodeTime.count() * 1000.0
+			  << " ms on " << threads.size() + 1 << " threads, " << compressedSize / 1024 << " KiB (RGBA8 " << uncompressedSize / 1024 << " KiB)" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <vector>
+#include <array>
 #include <cstring>
 #include <cstdlib>
 #include <cstdint>
@@ -18,15 +19,26 @@
 #include <limits>
 #include <algorithm>
 #include <memory>
+#include <chrono>
+#include <string>
+#include <fstream>
 
 #include "GP2_2DMesh.h"
 #include "GP2_3DMesh.h"
 #include "GP2_DepthBuffer.h"
 #include "GP2_CommandPool.h"
 #include "GP2_CommandBuffer.h"
+#include "GP2_JobSystem.h"
+#include "GP2_ParallelRecorder.h"
+#include "GP2_RenderGraph.h"
 #include "GP2_DescriptorPool.h"
 #include "GP2_2DGraphicsPipeline.h"
 #include "GP2_3DGraphicsPipeline.h"
+#include "GP2_AssetStreamer.h"
+#include "GP2_UploadContext.h"
+#include "GP2_MemoryAllocator.h"
+#include "GP2_FrameAllocator.h"
+#include "GP2_TextureRegistry.h"
 
 const std::vector<const char*> validationLayers = {
 	"VK_LAYER_KHRONOS_validation"
@@ -48,12 +60,53 @@ class VulkanBase
 public:
 	void run() 
 	{
+		m_StartTime = std::chrono::steady_clock::now();
+		// this thread becomes the job system's main thread, the one GLFW is used on
+		m_JobSystem.Initialize(m_JobThreadCount);
 		InitWindow();
 		initVulkan();
 		mainLoop();
 		cleanup();
 	}
 
+	// OBJ or .glb meshes streamed in after startup, add them before run
+	void AddSceneFile(const std::string& filename)
+	{
+		m_SceneFiles.push_back(filename);
+	}
+
+	// clamped to 1 to MAX_FRAMES_IN_FLIGHT, set before run
+	void SetFramesInFlight(uint32_t framesInFlight)
+	{
+		m_FramesInFlight = framesInFlight;
+	}
+
+	// threads of the job system including the main thread, 0 uses every core, set before run
+	void SetJobThreadCount(uint32_t jobThreadCount)
+	{
+		m_JobThreadCount = jobThreadCount;
+	}
+
+	// ranges the draws are split into and recorded as secondary command buffers, 0 uses every job thread and 1 records
+	// inline, set before run
+	void SetRecordThreadCount(uint32_t recordThreadCount)
+	{
+		m_RecordThreadCount = recordThreadCount;
+	}
+
+	// the full memory report is printed at shutdown and written as JSON to this file, off when empty, set before run
+	void SetMemoryReportFile(const std::string& filename)
+	{
+		m_MemoryReportFile = filename;
+	}
+
+	// scene meshes upload Vertex3DQuantized and are drawn by the quantized pipeline, on by default, off goes back to
+	// Vertex3D, set before run
+	void SetVertexQuantization(bool isVertexQuantized)
+	{
+		m_IsVertexQuantized = isVertexQuantized;
+	}
+
 private:
 	void initVulkan() 
 	{
@@ -65,6 +118,8 @@ private:
 		// week 05
 		PickPhysicalDevice();
 		CreateLogicalDevice();
+		// every buffer and image is placed through it from here on
+		m_MemoryAllocator.Initialize(m_Device, m_PhysicalDevice);
 
 		// week 04 
 		CreateSwapChain();
@@ -72,16 +127,26 @@ private:
 
 		// week 02
 		m_CommandPool.Initialize(m_Device, FindQueueFamilies(m_PhysicalDevice)); 
-		m_CommandBuffer = m_CommandPool.CreateCommandBuffer(); 
-
-		// Depth Buffer
-		m_DepthBuffer.CreateDepthResources(); 
+		for (Frame& frame : m_Frames)
+		{
+			frame.commandBuffer = m_CommandPool.CreateCommandBuffer();
+		}
+		m_ParallelRecorder.Initialize(m_Device, FindQueueFamilies(m_PhysicalDevice).graphicsFamily.value(), m_JobSystem, m_RecordThreadCount);
+		// every startup copy and transition is recorded into it and goes out in one submit at the end
+		m_UploadContext.Initialize(m_Device, m_PhysicalDevice, m_GraphicsQueue, m_IsTransferQueueUsed ? m_TransferQueue : VK_NULL_HANDLE,
+			FindQueueFamilies(m_PhysicalDevice));
 
 		//Create Vulkan Context
 		VulkanContext m_Context{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent };
 
+		// per frame UBOs and transient geometry, a region per frame in flight
+		m_FrameAllocator.Initialize(m_Context);
+		// every mesh of a vertex layout is drawn out of one vertex and one index buffer
+		m_GeometryArena2D.Initialize(m_Context, m_UploadContext, sizeof(Vertex2D));
+		m_GeometryArena3D.Initialize(m_Context, m_UploadContext, m_IsVertexQuantized ? sizeof(Vertex3DQuantized) : sizeof(Vertex3D));
+
 		// Square Mesh 1
-		std::unique_ptr<GP2_2DMesh> m_pSquareMesh1{ std::make_unique<GP2_2DMesh>(m_Context, m_GraphicsQueue, m_CommandPool) };
+		std::unique_ptr<GP2_2DMesh> m_pSquareMesh1{ std::make_unique<GP2_2DMesh>(m_Context, m_GeometryArena2D) };
 
 		m_pSquareMesh1->AddVertex({ -0.5f, -0.5f, 0.f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f });
 		m_pSquareMesh1->AddVertex({ 0.5f, -0.5f, 0.f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f });
@@ -89,11 +154,11 @@ private:
 		m_pSquareMesh1->AddVertex({ -0.5f, 0.5f, 0.f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f });
 		m_pSquareMesh1->AddIndices({ 0, 1, 2, 2, 3, 0 });
 
-		m_pSquareMesh1->Initialize(m_GraphicsQueue, FindQueueFamilies(m_PhysicalDevice));
+		m_pSquareMesh1->Initialize(m_UploadContext);
 		m_GP2D.AddMesh(std::move(m_pSquareMesh1));
 
 		// Square Mesh 2 (Adjusted Position)
-		std::unique_ptr<GP2_2DMesh> m_pSquareMesh2{ std::make_unique<GP2_2DMesh>(m_Context, m_GraphicsQueue, m_CommandPool) };
+		std::unique_ptr<GP2_2DMesh> m_pSquareMesh2{ std::make_unique<GP2_2DMesh>(m_Context, m_GeometryArena2D) };
 
 		float overlapOffset = 0.3f; // Adjust as needed
 
@@ -103,16 +168,52 @@ private:
 		m_pSquareMesh2->AddVertex({ -0.5f + overlapOffset, 0.5f - overlapOffset, -0.5f }, { 1.0f, 1.0f, 1.0f }, { 0.0f, 1.0f });
 		m_pSquareMesh2->AddIndices({ 0, 1, 2, 2, 3, 0 });
 
-		m_pSquareMesh2->Initialize(m_GraphicsQueue, FindQueueFamilies(m_PhysicalDevice));
+		m_pSquareMesh2->Initialize(m_UploadContext);
 		m_GP2D.AddMesh(std::move(m_pSquareMesh2));
+
+		// Streamed 3D meshes, drawn once their upload has finished
+		m_AssetStreamer.Initialize(m_Context, m_UploadContext);
+		m_TextureRegistry.Initialize(m_Context);
+		m_GP3D.SetPlaceholderTexture(m_AssetStreamer.GetPlaceholderTexture());
+		m_GP3DQuantized.SetPlaceholderTexture(m_AssetStreamer.GetPlaceholderTexture());
+
+		for (const std::string& filename : m_SceneFiles)
+		{
+			std::unique_ptr<GP2_3DMesh> pMesh{ std::make_unique<GP2_3DMesh>(m_Context, m_TextureRegistry, m_GeometryArena3D) };
+			pMesh->SetQuantized(m_IsVertexQuantized);
+			m_AssetStreamer.RequestMesh(pMesh.get(), filename, { 1.f, 1.f, 1.f });
+			if (m_IsVertexQuantized)
+			{
+				m_GP3DQuantized.AddMesh(std::move(pMesh));
+			}
+			else
+			{
+				m_GP3D.AddMesh(std::move(pMesh));
+			}
+		}
+
+		if (!m_SceneFiles.empty())
+		{
+			std::cout << m_SceneFiles.size() << " meshes share " << m_TextureRegistry.GetTextureCount() << " textures" << std::endl;
+		}
 		
-		CreateRenderPass(); 
-		m_GP2D.Initialize(VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent }); 
-		m_GP3D.Initialize(VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent });
-		CreateFrameBuffers(); 
+		// the render pass and framebuffers of every pass, the depth buffer among the graph's transient attachments
+		CreateRenderGraph(); 
+		m_GP2D.Initialize(VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent }, m_FrameAllocator); 
+		// only the pipeline of the scene's vertex format is created
+		if (m_IsVertexQuantized)
+		{
+			m_GP3DQuantized.Initialize(VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent }, m_FrameAllocator);
+		}
+		else
+		{
+			m_GP3D.Initialize(VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent }, m_FrameAllocator);
+		}
 
 		// week 06
 		CreateSyncObjects();
+
+		m_UploadContext.Submit();
 	}
 
 	void mainLoop() 
@@ -120,6 +221,8 @@ private:
 		while (!glfwWindowShouldClose(m_Window)) 
 		{
 			glfwPollEvents();
+			// whatever the jobs left for the main thread, GLFW calls among it
+			m_JobSystem.RunMainThreadJobs();
 			// week 06
 			DrawFrame();
 		}
@@ -128,21 +231,60 @@ private:
 
 	void cleanup() 
 	{
-		vkDestroySemaphore(m_Device, m_RenderFinishedSemaphore, nullptr);
-		vkDestroySemaphore(m_Device, m_ImageAvailableSemaphore, nullptr);
-		vkDestroyFence(m_Device, m_InFlightFence, nullptr);
-		
-		m_CommandPool.Destroy();  
+		m_AssetStreamer.Destroy();
+		PrintFrameTimes(std::cout);
+		m_JobSystem.PrintStats(std::cout);
+		m_RenderGraph.PrintStats(std::cout);
+		m_UploadContext.PrintStats(std::cout);
+		m_UploadContext.Destroy();
+		m_MemoryAllocator.PrintStats(std::cout);
+		// for comparing runs, everything is still alive here
+		if (!m_MemoryReportFile.empty())
+		{
+			m_MemoryAllocator.PrintReport(std::cout);
+			std::ofstream memoryReport{ m_MemoryReportFile, std::ios::trunc };
+			if (memoryReport.is_open())
+			{
+				m_MemoryAllocator.WriteReport(memoryReport);
+			}
+			else
+			{
+				std::cerr << "Error: Failed to open file " << m_MemoryReportFile << std::endl;
+			}
+		}
+		m_GeometryArena2D.PrintStats(std::cout, "2D");
+		m_GeometryArena3D.PrintStats(std::cout, "3D");
 
-		for (auto framebuffer : m_SwapChainFramebuffers) 
+		for (VkSemaphore semaphore : m_RenderFinishedSemaphores)
 		{
-			vkDestroyFramebuffer(m_Device, framebuffer, nullptr);
+			vkDestroySemaphore(m_Device, semaphore, nullptr);
 		}
+		for (const Frame& frame : m_Frames)
+		{
+			vkDestroySemaphore(m_Device, frame.imageAvailableSemaphore, nullptr);
+			vkDestroyFence(m_Device, frame.inFlightFence, nullptr);
+		}
+		
+		m_ParallelRecorder.Destroy();
+		// nothing spawns jobs past this point
+		m_JobSystem.Destroy();
+		m_CommandPool.Destroy();  
 
 		m_GP2D.Cleanup(); 
-		m_GP3D.Cleanup();
+		if (m_IsVertexQuantized)
+		{
+			m_GP3DQuantized.Cleanup();
+		}
+		else
+		{
+			m_GP3D.Cleanup();
+		}
+		m_FrameAllocator.Destroy();
+		m_GeometryArena2D.Destroy();
+		m_GeometryArena3D.Destroy();
 
-		vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
+		// the render passes, framebuffers and transient attachments
+		m_RenderGraph.Destroy();
 
 		for (auto imageView : m_SwapChainImageViews) 
 		{
@@ -157,6 +299,7 @@ private:
 		vkDestroyImage(m_Device, m_TextureImage, nullptr);
 		vkFreeMemory(m_Device, m_TextureImageMemory, nullptr);
 
+		m_MemoryAllocator.Destroy();
 		vkDestroyDevice(m_Device, nullptr);
 
 		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
@@ -180,12 +323,30 @@ private:
 		}
 	}
 
+	// Device memory, declared before everything it places so it's destroyed after them
+	GP2_MemoryAllocator m_MemoryAllocator;
+	std::string m_MemoryReportFile;
+
 	// Graphics Pipelines
 	GP2_2DGraphicsPipeline<ViewProjection> m_GP2D{ "shaders/shader.vert.spv", "shaders/shader.frag.spv" };    
 	GP2_3DGraphicsPipeline<VertexUBO> m_GP3D{ "shaders/objshader.vert.spv", "shaders/objshader.frag.spv" };   
+	GP2_3DGraphicsPipeline<VertexUBO, Vertex3DQuantized> m_GP3DQuantized{ "shaders/objshader_quantized.vert.spv", "shaders/objshader.frag.spv" };
+	// which of the two draws the scene, the 3D geometry arena holds that one's vertices
+	bool m_IsVertexQuantized{ true };
+
+	// Asset Streaming
+	GP2_AssetStreamer m_AssetStreamer;
+	GP2_TextureRegistry m_TextureRegistry;
+	std::vector<std::string> m_SceneFiles;
+
+	// Uploads
+	GP2_UploadContext m_UploadContext;
+	GP2_FrameAllocator m_FrameAllocator;
+	GP2_GeometryArena m_GeometryArena2D;
+	GP2_GeometryArena m_GeometryArena3D;
 
 	// Depth Buffer
-	GP2_DepthBuffer m_DepthBuffer{ VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent }, m_GraphicsQueue, m_CommandPool };
+	GP2_DepthBuffer m_DepthBuffer{ VulkanContext{ m_Device, m_PhysicalDevice, m_RenderPass, m_SwapChainExtent } };
 
 	// Camera
 	glm::vec2 m_LastMousePosition{ 0.f, 0.f };
@@ -220,18 +381,25 @@ private:
 	// CommandBuffer concept
 
 	GP2_CommandPool m_CommandPool;
-	GP2_CommandBuffer m_CommandBuffer;
+	GP2_JobSystem m_JobSystem;
+	uint32_t m_JobThreadCount{ 0 };
+	GP2_ParallelRecorder m_ParallelRecorder;
+	uint32_t m_RecordThreadCount{ 0 };
+	// the draws the pipelines recorded into secondaries this frame, executed together
+	std::vector<VkCommandBuffer> m_SecondaryCommandBuffers;
 
 	QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
 	
 	// Week 03
 	// Renderpass concept
 		
-	std::vector<VkFramebuffer> m_SwapChainFramebuffers;
+	// the frame's passes and the barriers between them, imports the swapchain images
+	GP2_RenderGraph m_RenderGraph;
+	GP2_RenderGraph::PassHandle m_MainPass;
+	// the main pass's, the pipelines are created against it
 	VkRenderPass m_RenderPass;
 
-	void CreateFrameBuffers(); 
-	void CreateRenderPass(); 
+	void CreateRenderGraph(); 
 
 	// Week 04
 	// Swap chain and image view support
@@ -256,6 +424,10 @@ private:
 	VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
 	VkQueue m_GraphicsQueue;
 	VkQueue m_PresentQueue;
+	// VK_NULL_HANDLE when the device has no queue family for it
+	VkQueue m_TransferQueue = VK_NULL_HANDLE;
+	// false keeps uploads on the graphics queue, to compare the frame times while streaming
+	bool m_IsTransferQueueUsed{ true };
 	
 	void PickPhysicalDevice();
 	bool IsDeviceSuitable(VkPhysicalDevice device);
@@ -269,12 +441,39 @@ private:
 	VkDevice m_Device = VK_NULL_HANDLE;
 	VkSurfaceKHR m_Surface;
 
-	VkSemaphore m_ImageAvailableSemaphore; 
-	VkSemaphore m_RenderFinishedSemaphore; 
-	VkFence m_InFlightFence;
-
+	// what a frame records into and waits on, indexed by m_CurrentFrame
+	struct Frame
+	{
+		GP2_CommandBuffer commandBuffer;
+		VkSemaphore imageAvailableSemaphore;
+		VkFence inFlightFence;
+	};
+	std::array<Frame, MAX_FRAMES_IN_FLIGHT> m_Frames{};
+	// waited on by the present of an image, so there's one per swapchain image rather than per frame
+	std::vector<VkSemaphore> m_RenderFinishedSemaphores;
+
+	// 1 to MAX_FRAMES_IN_FLIGHT, with 1 the CPU waits for the GPU to finish every frame before recording the next
+	uint32_t m_FramesInFlight{ 2 };
 	uint32_t m_CurrentFrame{ 0 };
 
+	// the first present is timed from the start of run
+	std::chrono::steady_clock::time_point m_StartTime;
+	bool m_IsFirstFramePresented{ false };
+
+	// frame times while assets stream in against those once the streamer is idle, with and without m_IsTransferQueueUsed
+	struct FrameTimes
+	{
+		double milliseconds;
+		uint32_t count;
+	};
+	std::chrono::steady_clock::time_point m_LastPresentTime;
+	FrameTimes m_StreamingFrameTimes{};
+	FrameTimes m_IdleFrameTimes{};
+	// time the CPU spent waiting for a frame's fence, what the frames in flight are meant to hide
+	FrameTimes m_FenceWaitTimes{};
+	// executing the render graph, the main pass's draws recorded inline or on the job threads
+	FrameTimes m_RecordTimes{};
+
 	void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
 	void SetupDebugMessenger();
 	std::vector<const char*> GetRequiredExtensions();
@@ -283,8 +482,13 @@ private:
 
 	void CreateSyncObjects();
 	void DrawFrame();
-	void BeginRenderPass(const GP2_CommandBuffer& buffer, VkFramebuffer currentBuffer, VkExtent2D extent);
-	void EndRenderPass(const GP2_CommandBuffer& buffer);
+	void PrintFrameTimes(std::ostream& stream) const;
+	// the 2D and 3D pipelines' draws, recorded by the render graph inside the main pass
+	void RecordMainPass(const GP2_RenderGraph::PassContext& context);
+	// the 3D pipeline's part of the main pass, for whichever vertex format it draws
+	template <class Pipeline3D>
+	void RecordScene(Pipeline3D& pipeline, const VertexUBO& ubo, const GP2_RenderGraph::PassContext& context,
+					 const GP2_CommandBuffer& commandBuffer);
 
 	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) 
 	{
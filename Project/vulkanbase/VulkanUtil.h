@@ -11,7 +11,8 @@
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// the most frames VulkanBase can have in flight, per frame resources are sized for it
+const int MAX_FRAMES_IN_FLIGHT = 3;
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -28,6 +29,8 @@ struct QueueFamilyIndices
 {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	// a family that can copy but not draw, uploads on it overlap rendering. Empty when the device has none.
+	std::optional<uint32_t> transferFamily;
 
 	bool isComplete() {
 		return graphicsFamily.has_value() && presentFamily.has_value();